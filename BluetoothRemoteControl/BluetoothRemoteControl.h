@@ -23,6 +23,7 @@
 
 #include "Administrator.h"
 #include "WAVRecorder.h"
+#include "JitterBuffer.h"
 #include "HID.h"
 
 #include <interfaces/IBluetooth.h>
@@ -47,6 +48,33 @@ namespace Plugin {
             SEQUENCED_PERSIST = 0x21
         };
 
+        class VoiceStatisticsData : public Core::JSON::Container {
+        public:
+            VoiceStatisticsData(const VoiceStatisticsData&) = delete;
+            VoiceStatisticsData& operator=(const VoiceStatisticsData&) = delete;
+            VoiceStatisticsData()
+                : Core::JSON::Container()
+            {
+                Add(_T("frames"), &Frames);
+                Add(_T("lost"), &Lost);
+                Add(_T("concealed"), &Concealed);
+                Add(_T("chunks"), &Chunks);
+                Add(_T("latency"), &Latency);
+                Add(_T("maxlatency"), &MaxLatency);
+            }
+            ~VoiceStatisticsData()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Frames;
+            Core::JSON::DecUInt32 Lost;
+            Core::JSON::DecUInt32 Concealed;
+            Core::JSON::DecUInt32 Chunks;
+            Core::JSON::DecUInt32 Latency; // uS
+            Core::JSON::DecUInt32 MaxLatency; // uS
+        };
+
    private:
         class Config : public Core::JSON::Container {
         public:
@@ -140,6 +168,33 @@ namespace Plugin {
                 GATTRemote& _parent;
             };
 
+            // An ATT handle of 0 is invalid, so it can not collide with a notification.
+            static constexpr uint16_t FlushHandle = 0;
+
+            class Flusher : public Core::IDispatch {
+            public:
+                Flusher() = delete;
+                Flusher(const Flusher&) = delete;
+                Flusher& operator=(const Flusher&) = delete;
+                Flusher(GATTRemote* parent)
+                    : _parent(*parent)
+                {
+                    ASSERT(parent != nullptr);
+                }
+                ~Flusher() override
+                {
+                }
+
+            public:
+                void Dispatch() override
+                {
+                    _parent._decoupling.Flush();
+                }
+
+            private:
+                GATTRemote& _parent;
+            };
+
             class Decoupling : public Core::Thread {
             private:
                 class Slot {
@@ -148,11 +203,13 @@ namespace Plugin {
                     Slot& operator= (const Slot&) = delete;
                     Slot(const uint16_t handle, const uint8_t length, const uint8_t data[])
                         : _handle(handle)
-                        , _data(reinterpret_cast<const char*>(data), length) {
+                        , _data(reinterpret_cast<const char*>(data), length)
+                        , _received(Core::Time::Now().Ticks()) {
                     }
                     Slot(const Slot& copy)
                         : _handle(copy._handle)
-                        , _data(copy._data) {
+                        , _data(copy._data)
+                        , _received(copy._received) {
                     }
                     ~Slot() {
                     }
@@ -166,10 +223,14 @@ namespace Plugin {
                     const uint8_t* Data() const {
                         return (reinterpret_cast<const uint8_t*>(_data.c_str()));
                     }
+                    uint64_t Received() const {
+                        return (_received);
+                    }
 
                 private:
                     uint16_t _handle;
                     std::string _data;
+                    uint64_t _received;
                 };
 
             public:
@@ -197,6 +258,17 @@ namespace Plugin {
 
                     Run();
                 }
+                // Wake up the decoupling thread to deliver voice data that has been waiting for too long.
+                void Flush()
+                {
+                    static const uint8_t none = 0;
+
+                    _adminLock.Lock();
+                    _queue.emplace_back(Slot(FlushHandle, 0, &none));
+                    _adminLock.Unlock();
+
+                    Run();
+                }
                 uint32_t Worker() override
                 {
                     Block();
@@ -207,7 +279,7 @@ namespace Plugin {
                         Slot entry (_queue.front());
                         _queue.pop_front();
                         _adminLock.Unlock();
-                        _parent.Message(entry.Handle(), entry.Length(), entry.Data());
+                        _parent.Message(entry.Handle(), entry.Length(), entry.Data(), entry.Received());
                     }
 
                     return (Core::infinite);
@@ -297,11 +369,15 @@ namespace Plugin {
                     , ServiceUUID()
                     , CommandUUID()
                     , DataUUID()
+                    , VoiceChunk(0)
+                    , VoiceLatency(100)
                 {
                     Add(_T("profile"), &AudioProfile);
                     Add(_T("serviceuuid"), &ServiceUUID);
                     Add(_T("commanduuid"), &CommandUUID);
                     Add(_T("datauuid"), &DataUUID);
+                    Add(_T("voicechunk"), &VoiceChunk);
+                    Add(_T("voicelatency"), &VoiceLatency);
                 }
                 ~Config()
                 {
@@ -312,6 +388,8 @@ namespace Plugin {
                 Core::JSON::String ServiceUUID;
                 Core::JSON::String CommandUUID;
                 Core::JSON::String DataUUID;
+                Core::JSON::DecUInt16 VoiceChunk; // mS of voice per delivery, 0 delivers every frame
+                Core::JSON::DecUInt16 VoiceLatency; // mS a partial chunk may be held back
             };
 
             class Profile : public Bluetooth::Profile {
@@ -479,6 +557,18 @@ namespace Plugin {
                 , _hidInputReports()
                 , _audioProfile(nullptr)
                 , _decoder(nullptr)
+                , _startFrame(false)
+                , _currentKey(0)
+                , _flusher(Core::ProxyType<Flusher>::Create(this))
+                , _jitterBuffer()
+                , _voiceChunk(0)
+                , _voiceChunkSize(0)
+                , _voiceLatency(0)
+                , _dropped(0)
+                , _flushPending(false)
+                , _shuttingDown(false)
+                , _statisticsLock()
+                , _statistics()
             {
                 Config config;
                 config.FromString(configuration);
@@ -520,6 +610,18 @@ namespace Plugin {
                 , _hidInputReports()
                 , _audioProfile(nullptr)
                 , _decoder(nullptr)
+                , _startFrame(false)
+                , _currentKey(0)
+                , _flusher(Core::ProxyType<Flusher>::Create(this))
+                , _jitterBuffer()
+                , _voiceChunk(0)
+                , _voiceChunkSize(0)
+                , _voiceLatency(0)
+                , _dropped(0)
+                , _flushPending(false)
+                , _shuttingDown(false)
+                , _statisticsLock()
+                , _statistics()
             {
                 if (data.KeysDataHandle.IsSet() == true) {
                     _keysDataHandles.push_back(data.KeysDataHandle.Value());
@@ -538,6 +640,17 @@ namespace Plugin {
 
             virtual ~GATTRemote()
             {
+                // No flushes are scheduled from here on, the one pending (or running) is revoked and
+                // only then the thread that handles the notifications, and schedules, is stopped.
+                _adminLock.Lock();
+                _shuttingDown = true;
+                _adminLock.Unlock();
+
+                Core::IWorkerPool::Instance().Revoke(_flusher);
+
+                _decoupling.Stop();
+                _decoupling.Wait(Core::Thread::STOPPED, Core::infinite);
+
                 if (GATTSocket::IsOpen() == true) {
                     GATTSocket::Close(Core::infinite);
                 }
@@ -599,6 +712,16 @@ namespace Plugin {
                 _audioProfile->AddRef();
                 return (_audioProfile);
             }
+            // A copy, taken when the decoupling thread is done with a notification. The _adminLock is
+            // held by that thread while calling into the parent, so the parent can not take it.
+            Voice::JitterBuffer::Statistics VoiceStatistics() const
+            {
+                _statisticsLock.Lock();
+                const Voice::JitterBuffer::Statistics result(_statistics);
+                _statisticsLock.Unlock();
+
+                return (result);
+            }
             void Reconfigure(const string& settings) {
                 Config::Profile config;
                 config.FromString(settings);
@@ -620,6 +743,8 @@ namespace Plugin {
                         config.SampleRate.Value(),
                         config.Resolution.Value());
                 }
+
+                _voiceChunkSize = ChunkSize();
             }
 
         private:
@@ -629,11 +754,20 @@ namespace Plugin {
                 // by the Message method!
                 _decoupling.Submit(handle, static_cast<uint8_t>(length), dataFrame);
             }
-            void Message(const uint16_t handle, const uint8_t length, const uint8_t buffer[])
+            void Message(const uint16_t handle, const uint8_t length, const uint8_t buffer[], const uint64_t received)
             {
                 _adminLock.Lock();
 
-                if ( (handle == _voiceDataHandle) && (_decoder != nullptr) ) {
+                if (handle == FlushHandle) {
+                    _flushPending = false;
+
+                    // Do not hold back what we have for too long, the remote might have stopped sending.
+                    if ((_jitterBuffer.IsEmpty() == false) && ((received - _jitterBuffer.Oldest()) >= (_voiceLatency * Core::Time::TicksPerMillisecond))) {
+                        Deliver(true);
+                    }
+                    ScheduleFlush();
+                }
+                else if ( (handle == _voiceDataHandle) && (_decoder != nullptr) ) {
                     uint8_t decoded[1024];
                     uint16_t sendLength = _decoder->Decode(length, buffer, sizeof(decoded), decoded);
                     if (sendLength > 0) {
@@ -642,7 +776,15 @@ namespace Plugin {
                             _startFrame = false;
                             _parent->VoiceData(_audioProfile);
                         }
-                        _parent->VoiceData(_decoder->Frames(), sendLength, decoded);
+
+                        const uint32_t dropped = _decoder->Dropped();
+                        const uint32_t lost = ((dropped != static_cast<uint32_t>(~0)) && (dropped > _dropped) ? (dropped - _dropped) : 0);
+                        _dropped = (dropped != static_cast<uint32_t>(~0) ? dropped : 0);
+
+                        _jitterBuffer.Add(received, lost, sendLength, decoded);
+
+                        Deliver(false);
+                        ScheduleFlush();
                     }
                 }
                 else if ( (std::any_of(_keysDataHandles.cbegin(), _keysDataHandles.cend(), [handle](const uint16_t reportHandle) { return (reportHandle == handle); }))
@@ -666,6 +808,13 @@ namespace Plugin {
 
                     // If we start, reset.
                     if (buffer[0] == 0) {
+                        // Whatever is still in the jitter buffer goes out before we signal the end.
+                        Deliver(true);
+
+                        const Voice::JitterBuffer::Statistics& stats(_jitterBuffer.Stats());
+                        TRACE(Flow, (_T("Voice session: %d frames, %d lost, %d concealed, %d chunks, latency %d uS (max %d uS)"),
+                            stats.Frames, stats.Lost, stats.Concealed, stats.Chunks, stats.AverageLatency, stats.MaximumLatency));
+
                         // We are done, signal that the button to speak has been released!
                         _parent->VoiceData(nullptr);
                     }
@@ -673,14 +822,59 @@ namespace Plugin {
                         // Looks like the TPress-to-talk button is pressed...
                         _decoder->Reset();
                         _startFrame = true;
+                        _dropped = 0;
+
+                        // Gaps can only be filled in if we deliver linear PCM.
+                        _jitterBuffer.Start(_voiceChunkSize, ((_audioProfile != nullptr) && (_audioProfile->Codec() == Exchange::IVoiceProducer::IProfile::codec::PCM)));
                     }
                 }
                 else if ( (handle == _batteryLevelHandle) && (length >= 1) ) {
                     _parent->BatteryLevel(buffer[0]);
                 }
 
+                _statisticsLock.Lock();
+                _statistics = _jitterBuffer.Stats();
+                _statisticsLock.Unlock();
+
                 _adminLock.Unlock();
             }
+            void Deliver(const bool force)
+            {
+                uint32_t length;
+
+                while ((length = _jitterBuffer.Length(force)) > 0) {
+                    // Frames passed on as they come keep the sequence of the decoder.
+                    const uint32_t sequence = (((_jitterBuffer.IsChunked() == false) && (_decoder != nullptr)) ? _decoder->Frames() : _jitterBuffer.Stats().Chunks);
+
+                    ASSERT(length <= Voice::JitterBuffer::MaximumChunk);
+
+                    _parent->VoiceData(sequence, static_cast<uint16_t>(length), _jitterBuffer.Data());
+                    _jitterBuffer.Delivered(length);
+                }
+            }
+            // The configured duration of a chunk in bytes of the current profile, 0 if every frame goes out as is.
+            uint32_t ChunkSize() const
+            {
+                uint32_t result = 0;
+
+                if ((_voiceChunk != 0) && (_audioProfile != nullptr)) {
+                    const uint32_t bytesPerSecond = (_audioProfile->SampleRate() * _audioProfile->Channels() * _audioProfile->Resolution()) / 8;
+                    result = std::min(static_cast<uint32_t>((static_cast<uint64_t>(bytesPerSecond) * _voiceChunk) / 1000), Voice::JitterBuffer::MaximumChunk);
+
+                    if (result == Voice::JitterBuffer::MaximumChunk) {
+                        TRACE(Flow, (_T("Voice chunk of %d ms does not fit in a delivery, limited to %d bytes"), _voiceChunk, result));
+                    }
+                }
+
+                return (result);
+            }
+            void ScheduleFlush()
+            {
+                if ((_shuttingDown == false) && (_flushPending == false) && (_jitterBuffer.IsEmpty() == false)) {
+                    _flushPending = true;
+                    Core::IWorkerPool::Instance().Schedule(Core::Time(_jitterBuffer.Oldest()).Add(_voiceLatency), _flusher);
+                }
+            }
             void Constructor(const Config& config)
             {
                 ASSERT(_parent != nullptr);
@@ -695,6 +889,9 @@ namespace Plugin {
                     TRACE(Trace::Fatal, (_T("The device is already in use. Only 1 callback allowed")));
                 }
 
+                _voiceChunk = config.VoiceChunk.Value();
+                _voiceLatency = config.VoiceLatency.Value();
+
                 _decoder = Decoders::IDecoder::Instance(config.AudioProfile.Codec.Value(), config.AudioProfile.Configuration.Value());
 
                 if (_decoder != nullptr) {
@@ -705,6 +902,8 @@ namespace Plugin {
                         config.AudioProfile.Resolution.Value());
                 }
 
+                _voiceChunkSize = ChunkSize();
+
                 TRACE(Flow, (_T("The HoG device is ready for operation")));
             }
             bool Initialize() override
@@ -1116,6 +1315,18 @@ namespace Plugin {
             Decoders::IDecoder* _decoder;
             bool _startFrame;
             uint16_t _currentKey;
+
+            // Voice frames are aggregated in the decoupling thread before they are handed over.
+            Core::ProxyType<Core::IDispatch> _flusher;
+            Voice::JitterBuffer _jitterBuffer;
+            uint16_t _voiceChunk;
+            uint32_t _voiceChunkSize;
+            uint16_t _voiceLatency;
+            uint32_t _dropped;
+            bool _flushPending;
+            bool _shuttingDown;
+            mutable Core::CriticalSection _statisticsLock;
+            Voice::JitterBuffer::Statistics _statistics;
         };
 
     public:
@@ -1249,6 +1460,7 @@ namespace Plugin {
         uint32_t get_batterylevel(Core::JSON::DecUInt8& response) const;
         uint32_t get_audioprofiles(Core::JSON::ArrayType<Core::JSON::String>& response) const;
         uint32_t get_audioprofile(const string& index, JsonData::BluetoothRemoteControl::AudioprofileData& response) const;
+        uint32_t get_voicestatistics(VoiceStatisticsData& response) const;
         void event_audiotransmission(const string& profile = "");
         void event_audioframe(const uint32_t& seq, const string& data);
         void event_batterylevelchange(const uint8_t& level);
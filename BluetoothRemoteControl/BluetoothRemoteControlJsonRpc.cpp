@@ -40,10 +40,12 @@ namespace Plugin {
         Property<Core::JSON::DecUInt8>(_T("batterylevel"), &BluetoothRemoteControl::get_batterylevel, nullptr, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("audioprofiles"), &BluetoothRemoteControl::get_audioprofiles, nullptr, this);
         Property<AudioprofileData>(_T("audioprofile"), &BluetoothRemoteControl::get_audioprofile, nullptr, this);
+        Property<VoiceStatisticsData>(_T("voicestatistics"), &BluetoothRemoteControl::get_voicestatistics, nullptr, this);
     }
 
     void BluetoothRemoteControl::UnregisterAll()
     {
+        Unregister(_T("voicestatistics"));
         Unregister(_T("revoke"));
         Unregister(_T("assign"));
         Unregister(_T("audioprofile"));
@@ -159,6 +161,33 @@ namespace Plugin {
         return (result);
     }
 
+    // Property: voicestatistics - Statistics of the (last) voice session
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_ILLEGAL_STATE: No remote has been assigned
+    uint32_t BluetoothRemoteControl::get_voicestatistics(VoiceStatisticsData& response) const
+    {
+        uint32_t result = Core::ERROR_ILLEGAL_STATE;
+
+        _adminLock.Lock();
+
+        if (_gattRemote != nullptr) {
+            const Voice::JitterBuffer::Statistics stats(_gattRemote->VoiceStatistics());
+
+            response.Frames = stats.Frames;
+            response.Lost = stats.Lost;
+            response.Concealed = stats.Concealed;
+            response.Chunks = stats.Chunks;
+            response.Latency = stats.AverageLatency;
+            response.MaxLatency = stats.MaximumLatency;
+            result = Core::ERROR_NONE;
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
     // Property: audioprofiles - Supported audio profiles
     // Return codes:
     //  - ERROR_NONE: Success
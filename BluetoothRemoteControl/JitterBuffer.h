@@ -0,0 +1,194 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+namespace WPEFramework {
+
+namespace Voice {
+
+// Collects the decoded voice frames, as they trickle in with the BLE connection interval jitter,
+// into chunks of a fixed duration. Frames reported lost by the decoder are concealed (for linear
+// PCM) by a faded copy of the previous frame followed by silence, so the chunks stay time aligned.
+class EXTERNAL JitterBuffer {
+public:
+    // A delivery carries a 16 bits length.
+    static constexpr uint32_t MaximumChunk = 0xFFFF;
+
+    struct Statistics {
+        uint32_t Frames;
+        uint32_t Lost;
+        uint32_t Concealed;
+        uint32_t Chunks;
+        uint32_t AverageLatency; // uS, from notification to delivery of the chunk
+        uint32_t MaximumLatency; // uS
+    };
+
+public:
+    JitterBuffer(const JitterBuffer&) = delete;
+    JitterBuffer& operator= (const JitterBuffer&) = delete;
+
+    JitterBuffer()
+        : _buffer()
+        , _history()
+        , _chunkSize(0)
+        , _used(0)
+        , _previous(0)
+        , _oldest(0)
+        , _newest(0)
+        , _conceal(false)
+        , _latency(0)
+        , _stats() {
+        ::memset(&_stats, 0, sizeof(_stats));
+    }
+    ~JitterBuffer() {
+    }
+
+public:
+    // A chunkSize of 0 delivers every frame as it comes in. Otherwise it is rounded down to whole
+    // frames once the first one comes in.
+    void Start(const uint32_t chunkSize, const bool conceal) {
+        _chunkSize = std::min(chunkSize, MaximumChunk);
+        _conceal = conceal;
+        _used = 0;
+        _previous = 0;
+        _oldest = 0;
+        _newest = 0;
+        _latency = 0;
+        ::memset(&_stats, 0, sizeof(_stats));
+
+        if (_buffer.size() < _chunkSize) {
+            _buffer.resize(_chunkSize);
+        }
+    }
+    void Add(const uint64_t received, const uint32_t lost, const uint16_t length, const uint8_t data[]) {
+        ASSERT(length > 0);
+
+        if ((_previous == 0) && (_chunkSize != 0)) {
+            _chunkSize = std::max(static_cast<uint32_t>(length), _chunkSize - (_chunkSize % length));
+        }
+
+        _stats.Frames++;
+        _stats.Lost += lost;
+
+        if ((_conceal == true) && (lost > 0) && (_previous > 0)) {
+            // Frames are lost, fill up the gap so what follows stays in time.
+            for (uint32_t index = 0; index < lost; index++) {
+                const uint32_t start = _used;
+                Append(received, _previous, _history.data());
+
+                int16_t* samples = reinterpret_cast<int16_t*>(&(_buffer[start]));
+                if (index == 0) {
+                    // Fade out the copy of the last frame.
+                    const uint16_t count = (_previous / sizeof(int16_t));
+                    for (uint16_t sample = 0; sample < count; sample++) {
+                        samples[sample] = static_cast<int16_t>((static_cast<int32_t>(samples[sample]) * (count - sample)) / count);
+                    }
+                } else {
+                    ::memset(samples, 0, _previous);
+                }
+                _stats.Concealed++;
+            }
+        }
+
+        Append(received, length, data);
+
+        if (_conceal == true) {
+            _history.assign(data, data + length);
+        }
+        _previous = length;
+    }
+    inline bool IsEmpty() const {
+        return (_used == 0);
+    }
+    inline bool IsChunked() const {
+        return (_chunkSize != 0);
+    }
+    inline bool IsComplete() const {
+        return ((_chunkSize == 0) ? (_used > 0) : (_used >= _chunkSize));
+    }
+    inline uint64_t Oldest() const {
+        return (_oldest);
+    }
+    inline const uint8_t* Data() const {
+        return (_buffer.data());
+    }
+    // Size of the chunk ready to go, a partial one if forced (e.g. at the end of a session).
+    // Never more than fits in a delivery, in whole frames.
+    inline uint32_t Length(const bool force) const {
+        const uint32_t length = ((IsComplete() == false) ? (force == true ? _used : 0) : (_chunkSize == 0 ? _used : _chunkSize));
+        const uint32_t limit = (_previous == 0 ? MaximumChunk : (MaximumChunk / _previous) * _previous);
+
+        return (std::min(length, limit));
+    }
+    // The chunk was delivered, keep what is left for the next one.
+    void Delivered(const uint32_t length) {
+        ASSERT(length <= _used);
+
+        const uint64_t now = Core::Time::Now().Ticks();
+        const uint32_t latency = static_cast<uint32_t>(now - _oldest);
+
+        _stats.Chunks++;
+        _latency += latency;
+        _stats.AverageLatency = static_cast<uint32_t>(_latency / _stats.Chunks);
+        if (latency > _stats.MaximumLatency) {
+            _stats.MaximumLatency = latency;
+        }
+
+        _used -= length;
+        if (_used > 0) {
+            ::memmove(_buffer.data(), &(_buffer[length]), _used);
+            _oldest = _newest;
+        } else {
+            _oldest = 0;
+        }
+    }
+    inline const Statistics& Stats() const {
+        return (_stats);
+    }
+
+private:
+    void Append(const uint64_t received, const uint16_t length, const uint8_t data[]) {
+        if (_buffer.size() < (_used + length)) {
+            _buffer.resize(_used + length);
+        }
+        ::memcpy(&(_buffer[_used]), data, length);
+        if (_used == 0) {
+            _oldest = received;
+        }
+        _newest = received;
+        _used += length;
+    }
+
+private:
+    std::vector<uint8_t> _buffer;
+    std::vector<uint8_t> _history;
+    uint32_t _chunkSize;
+    uint32_t _used;
+    uint16_t _previous;
+    uint64_t _oldest;
+    uint64_t _newest;
+    bool _conceal;
+    uint64_t _latency;
+    Statistics _stats;
+};
+
+} } // namespace WPEFramework::Voice
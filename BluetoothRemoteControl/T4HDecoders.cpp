@@ -201,93 +201,133 @@ public:
     }
 
 private:
-    int16_t DecodeNibble (const uint8_t nibble) {
+    // For every step index and nibble the (signed) difference to apply to the predicted value and the
+    // next step index, so decoding a nibble is a single lookup instead of the bit-by-bit accumulation.
+    class Table {
+    public:
+        Table(const Table&) = delete;
+        Table& operator= (const Table&) = delete;
+
+        Table() {
+            static const int8_t IndexLUT[] = {
+                -1, -1, -1, -1, 2, 4, 6, 8,
+                -1, -1, -1, -1, 2, 4, 6, 8
+            };
+
+            static const uint16_t StepSizeLUT[] = {
+                7,     8,     9,     10,    11,    12,    13,    14,
+                16,    17,    19,    21,    23,    25,    28,    31,
+                34,    37,    41,    45,    50,    55,    60,    66,
+                73,    80,    88,    97,    107,   118,   130,   143,
+                157,   173,   190,   209,   230,   253,   279,   307,
+                337,   371,   408,   449,   494,   544,   598,   658,
+                724,   796,   876,   963,   1060,  1166,  1282,  1411,
+                1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,
+                3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,
+                7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+                15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+                32767
+            };
+
+            for (uint8_t index = 0; index < Steps; index++) {
+                const int32_t step = StepSizeLUT[index];
+
+                for (uint8_t nibble = 0; nibble < 16; nibble++) {
+                    int32_t difference = (step >> 3);
+
+                    if ((nibble & 4) != 0) {
+                        difference += step;
+                    }
+                    if ((nibble & 2) != 0) {
+                        difference += (step >> 1);
+                    }
+                    if ((nibble & 1) != 0) {
+                        difference += (step >> 2);
+                    }
+
+                    int8_t next = index + IndexLUT[nibble];
+
+                    // Mind the asymmetry: only decrementing clips at -0x7FFF, so a received -0x8000 survives an increment.
+                    _entries[index][nibble].difference = ((nibble & 8) != 0 ? -difference : difference);
+                    _entries[index][nibble].minimum = ((nibble & 8) != 0 ? -0x7FFF : -0x8000);
+                    _entries[index][nibble].next = (next < 0 ? 0 : (next >= Steps ? (Steps - 1) : next));
+                }
+            }
+        }
+        ~Table() {
+        }
 
-        static const int8_t IndexLUT[] = {
-            -1, -1, -1, -1, 2, 4, 6, 8,
-            -1, -1, -1, -1, 2, 4, 6, 8
-        };
+    public:
+        static constexpr uint8_t Steps = 89;
 
-        static const uint16_t StepSizeLUT[] = {
-            7,     8,     9,     10,    11,    12,    13,    14,
-            16,    17,    19,    21,    23,    25,    28,    31,
-            34,    37,    41,    45,    50,    55,    60,    66,
-            73,    80,    88,    97,    107,   118,   130,   143,
-            157,   173,   190,   209,   230,   253,   279,   307,
-            337,   371,   408,   449,   494,   544,   598,   658,
-            724,   796,   876,   963,   1060,  1166,  1282,  1411,
-            1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,
-            3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,
-            7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
-            15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
-            32767
+        struct Entry {
+            int32_t difference;
+            int32_t minimum;
+            uint8_t next;
         };
 
-        uint16_t step = StepSizeLUT[_SI_dec];
-        uint16_t cum_diff = step >> 3;
-
-        _SI_dec += IndexLUT[nibble];
-
-        if (_SI_dec < 0) {
-            _SI_dec = 0;
-        }
-        else if (_SI_dec > 88) {
-            _SI_dec = 88;
+        inline const Entry& operator()(const uint8_t index, const uint8_t nibble) const {
+            return (_entries[index][nibble]);
         }
 
-        if ((nibble & 4) != 0) {
-            cum_diff += step;
-        }
-        if ((nibble & 2) != 0) {
-            cum_diff += step >> 1;
-        }
-        if ((nibble & 1) != 0) {
-            cum_diff += step >> 2;
-        }
-        if ((nibble & 8) != 0) {
-            if (_PV_dec < (-32767 + cum_diff)) {
-                _PV_dec = -32767;
-            }
-            else {
-                _PV_dec -= cum_diff;
-            }
-        }
-        else {
-            if (_PV_dec > (0x7fff - cum_diff)) {
-                _PV_dec = 0x7fff;
-            }
-            else {
-                _PV_dec += cum_diff;
-	    }
-        }
-        return (_PV_dec);
+    private:
+        Entry _entries[Steps][16];
+    };
+
+    static inline int32_t Apply(const int32_t predicted, const Table::Entry& entry) {
+        const int32_t value = predicted + entry.difference;
+        return (value > 0x7FFF ? 0x7FFF : (value < entry.minimum ? entry.minimum : value));
     }
+
+    // Decodes the whole frame in one go, the decoder state lives in locals while decoding, and
+    // the samples are written directly in the output buffer.
     uint16_t DecodeStream(const uint16_t lengthIn, const uint8_t dataIn[], const uint16_t lengthOut, uint8_t dataOut[])
     {
-        // TODO: check lengthOut
-        uint16_t maxStorage = (lengthOut / 4);
+        static const Table table;
+
         int16_t* output = reinterpret_cast<int16_t*>(dataOut);
+        // As before, the output holds at most a quarter of its size in samples. Two samples per
+        // byte are counted in 32 bits, this does not fit a uint16_t for the larger frames.
+        const uint16_t samples = static_cast<uint16_t>(std::min(static_cast<uint32_t>(lengthIn) * 2, static_cast<uint32_t>(lengthOut / 4)));
+        const uint16_t pairs = (samples / 2);
+        int32_t predicted = _PV_dec;
+        uint8_t index = std::min(static_cast<uint8_t>(_SI_dec), static_cast<uint8_t>(Table::Steps - 1));
+        uint16_t position = 0;
+
+        while (position < pairs) {
+            const uint8_t byte = dataIn[position];
+            const Table::Entry& low(table(index, byte & 0xF));
+            predicted = Apply(predicted, low);
+            output[0] = static_cast<int16_t>(predicted);
+
+            const Table::Entry& high(table(low.next, byte >> 4));
+            predicted = Apply(predicted, high);
+            output[1] = static_cast<int16_t>(predicted);
+
+            index = high.next;
+            output += 2;
+            position++;
+        }
 
-        for (uint16_t index = 0; index < lengthIn; index++)
-        {
-            uint8_t byte = dataIn[index];
+        // Keep the state in sync for the input that did not fit in the output.
+        for (; position < lengthIn; position++) {
+            const uint8_t byte = dataIn[position];
+            const Table::Entry& low(table(index, byte & 0xF));
+            predicted = Apply(predicted, low);
 
-            int16_t dec1 = DecodeNibble(byte & 0xF);
-            int16_t dec2 = DecodeNibble((byte >> 4) & 0xF);
+            if ((position == pairs) && ((samples & 1) != 0)) {
+                *output = static_cast<int16_t>(predicted);
+            }
 
-            if (maxStorage >= 2) {
+            const Table::Entry& high(table(low.next, byte >> 4));
+            predicted = Apply(predicted, high);
+            index = high.next;
+        }
 
-                // Add the new bytes
-                *output++ = dec1;
-                *output++ = dec2;
-                maxStorage -= 2;
-            }
-            else if (maxStorage >= 1) {
-                *output++ = dec1;
-                maxStorage -= 1;
-            }
-   	}
-        return (lengthIn * 4);
+        _PV_dec = static_cast<int16_t>(predicted);
+        _SI_dec = static_cast<int8_t>(index);
+
+        return (samples * sizeof(int16_t));
     }
 
 private:
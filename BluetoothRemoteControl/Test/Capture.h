@@ -0,0 +1,102 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../Module.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace WPEFramework {
+
+namespace Test {
+
+    // A recorded session of GATT notifications of a remote, one per line:
+    //
+    //    <time in uS> <attribute handle> <payload in hex>
+    //
+    // e.g. 1520 0x0049 0a0c4f0300, times relative to the first notification. Lines starting
+    // with a '#' are comments. Such a capture is easily converted from a btmon trace of a
+    // voice session.
+    class Capture {
+    public:
+        struct Notification {
+            uint64_t Time; // uS
+            uint16_t Handle;
+            std::vector<uint8_t> Payload;
+        };
+
+    public:
+        Capture(const Capture&) = delete;
+        Capture& operator=(const Capture&) = delete;
+
+        Capture()
+            : _notifications()
+        {
+        }
+        ~Capture()
+        {
+        }
+
+    public:
+        const std::vector<Notification>& Notifications() const
+        {
+            return (_notifications);
+        }
+        void Add(const Notification& notification)
+        {
+            _notifications.push_back(notification);
+        }
+        // Returns the number of notifications loaded.
+        uint32_t Load(const string& fileName)
+        {
+            std::ifstream file(fileName);
+            string line;
+
+            _notifications.clear();
+
+            while (std::getline(file, line)) {
+                std::istringstream fields(line);
+                string time;
+                string handle;
+                string payload;
+
+                if ((line.empty() == false) && (line[0] != '#') && (fields >> time >> handle >> payload)) {
+                    Notification entry;
+
+                    entry.Time = std::strtoull(time.c_str(), nullptr, 10);
+                    entry.Handle = static_cast<uint16_t>(std::strtoul(handle.c_str(), nullptr, 0));
+
+                    for (uint32_t index = 0; (index + 1) < payload.length(); index += 2) {
+                        entry.Payload.push_back(static_cast<uint8_t>(std::strtoul(payload.substr(index, 2).c_str(), nullptr, 16)));
+                    }
+
+                    _notifications.push_back(std::move(entry));
+                }
+            }
+
+            return (static_cast<uint32_t>(_notifications.size()));
+        }
+
+    private:
+        std::vector<Notification> _notifications;
+    };
+
+} } // namespace WPEFramework::Test
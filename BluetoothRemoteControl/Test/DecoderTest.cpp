@@ -0,0 +1,402 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Administrator.h"
+#include "Capture.h"
+
+// Bit-exact validation and samples/sec of the PCM (IMA ADPCM) voice decoder, e.g.:
+//
+//    BluetoothRemoteControlDecoderTest -capture session.txt -handle 0x0049 -expected session.wav
+//
+// The voice data notifications (-handle) of a recorded session are decoded and the samples must
+// be identical to the WAV the plugin recorded of that session. The capture, if any, and randomized
+// frames (extreme predictors and step indexes, truncated outputs) must also decode identically to
+// the reference, the nibble by nibble decoder this one replaced. Finally the samples/sec of both
+// are measured. The results are printed as JSON, the exit code is the number of mismatches.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+static constexpr uint16_t OutputSize = 1024; // As the plugin decodes into.
+static constexpr uint8_t HeaderSize = 5;
+
+// The decoder as it was, one nibble at a time, only the samples matter here.
+class Reference {
+public:
+    Reference(const Reference&) = delete;
+    Reference& operator=(const Reference&) = delete;
+
+    Reference()
+        : _PV_dec(0)
+        , _SI_dec(0)
+        , _started(false)
+    {
+    }
+
+public:
+    void Header(const uint8_t dataIn[])
+    {
+        _PV_dec = static_cast<int16_t>((dataIn[3] << 8) | dataIn[2]);
+        _SI_dec = dataIn[1];
+        _started = true;
+    }
+    // Returns the number of samples written, nothing is decoded before the first header.
+    uint16_t Decode(const uint16_t lengthIn, const uint8_t dataIn[], const uint16_t lengthOut, uint8_t dataOut[])
+    {
+        if (_started == false) {
+            return (0);
+        }
+
+        uint16_t maxStorage = (lengthOut / 4);
+        int16_t* output = reinterpret_cast<int16_t*>(dataOut);
+        uint16_t written = 0;
+
+        for (uint16_t index = 0; index < lengthIn; index++) {
+            uint8_t byte = dataIn[index];
+
+            int16_t dec1 = DecodeNibble(byte & 0xF);
+            int16_t dec2 = DecodeNibble((byte >> 4) & 0xF);
+
+            if (maxStorage >= 2) {
+                *output++ = dec1;
+                *output++ = dec2;
+                maxStorage -= 2;
+                written += 2;
+            } else if (maxStorage >= 1) {
+                *output++ = dec1;
+                maxStorage -= 1;
+                written += 1;
+            }
+        }
+
+        return (written);
+    }
+
+private:
+    int16_t DecodeNibble(const uint8_t nibble)
+    {
+        static const int8_t IndexLUT[] = {
+            -1, -1, -1, -1, 2, 4, 6, 8,
+            -1, -1, -1, -1, 2, 4, 6, 8
+        };
+
+        static const uint16_t StepSizeLUT[] = {
+            7, 8, 9, 10, 11, 12, 13, 14,
+            16, 17, 19, 21, 23, 25, 28, 31,
+            34, 37, 41, 45, 50, 55, 60, 66,
+            73, 80, 88, 97, 107, 118, 130, 143,
+            157, 173, 190, 209, 230, 253, 279, 307,
+            337, 371, 408, 449, 494, 544, 598, 658,
+            724, 796, 876, 963, 1060, 1166, 1282, 1411,
+            1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+            3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+            7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+            15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+            32767
+        };
+
+        uint16_t step = StepSizeLUT[_SI_dec];
+        uint16_t cum_diff = step >> 3;
+
+        _SI_dec += IndexLUT[nibble];
+
+        if (_SI_dec < 0) {
+            _SI_dec = 0;
+        } else if (_SI_dec > 88) {
+            _SI_dec = 88;
+        }
+
+        if ((nibble & 4) != 0) {
+            cum_diff += step;
+        }
+        if ((nibble & 2) != 0) {
+            cum_diff += step >> 1;
+        }
+        if ((nibble & 1) != 0) {
+            cum_diff += step >> 2;
+        }
+        if ((nibble & 8) != 0) {
+            if (_PV_dec < (-32767 + cum_diff)) {
+                _PV_dec = -32767;
+            } else {
+                _PV_dec -= cum_diff;
+            }
+        } else {
+            if (_PV_dec > (0x7fff - cum_diff)) {
+                _PV_dec = 0x7fff;
+            } else {
+                _PV_dec += cum_diff;
+            }
+        }
+        return (_PV_dec);
+    }
+
+private:
+    int16_t _PV_dec;
+    int8_t _SI_dec;
+    bool _started;
+};
+
+// A voice session: the header frame that starts it and the data frames.
+struct Frame {
+    std::vector<uint8_t> Data;
+    uint16_t LengthOut;
+};
+
+uint32_t Random(uint32_t& state)
+{
+    // xorshift32, the frames are the same on every run.
+    state ^= (state << 13);
+    state ^= (state >> 17);
+    state ^= (state << 5);
+    return (state);
+}
+
+// Headers with every step index and the extreme predictors, data frames of all sizes, some
+// decoded into an output too small for them.
+std::list<Frame> Randomized(const uint32_t count)
+{
+    static const int16_t Predictors[] = { 0, 1, -1, 0x7FFF, -0x7FFF, -0x8000 };
+
+    std::list<Frame> result;
+    uint32_t state = 0x2545F491;
+
+    for (uint32_t index = 0; index < count; index++) {
+        Frame frame;
+
+        if ((index % 8) == 0) {
+            const int16_t predictor = ((Random(state) & 1) != 0 ? Predictors[Random(state) % (sizeof(Predictors) / sizeof(Predictors[0]))] : static_cast<int16_t>(Random(state)));
+
+            frame.Data.push_back(static_cast<uint8_t>(index / 8));
+            frame.Data.push_back(static_cast<uint8_t>(Random(state) % 89));
+            frame.Data.push_back(static_cast<uint8_t>(predictor & 0xFF));
+            frame.Data.push_back(static_cast<uint8_t>((predictor >> 8) & 0xFF));
+            frame.Data.push_back(0);
+            frame.LengthOut = OutputSize;
+        } else {
+            uint16_t length;
+
+            do {
+                length = 2 + static_cast<uint16_t>(Random(state) % 255);
+            } while (length == HeaderSize);
+
+            for (uint16_t position = 0; position < length; position++) {
+                frame.Data.push_back(static_cast<uint8_t>(Random(state)));
+            }
+
+            frame.LengthOut = ((Random(state) % 4) == 0 ? static_cast<uint16_t>(Random(state) % OutputSize) : OutputSize);
+        }
+
+        result.push_back(std::move(frame));
+    }
+
+    return (result);
+}
+
+std::list<Frame> Recorded(const Test::Capture& capture, const uint16_t handle)
+{
+    std::list<Frame> result;
+
+    for (const Test::Capture::Notification& notification : capture.Notifications()) {
+        if ((notification.Handle == handle) && (notification.Payload.empty() == false)) {
+            result.push_back({ notification.Payload, OutputSize });
+        }
+    }
+
+    return (result);
+}
+
+// Decodes all frames, appends the samples to output, returns the number of samples.
+uint32_t Decode(Decoders::IDecoder& decoder, const std::list<Frame>& frames, std::vector<int16_t>* output)
+{
+    uint8_t decoded[OutputSize];
+    uint32_t result = 0;
+
+    decoder.Reset();
+
+    for (const Frame& frame : frames) {
+        const uint16_t length = decoder.Decode(static_cast<uint16_t>(frame.Data.size()), frame.Data.data(), frame.LengthOut, decoded);
+
+        if ((frame.Data.size() != HeaderSize) && (frame.Data.size() != 1)) {
+            result += (length / sizeof(int16_t));
+
+            if (output != nullptr) {
+                const int16_t* samples = reinterpret_cast<const int16_t*>(decoded);
+                output->insert(output->end(), samples, samples + (length / sizeof(int16_t)));
+            }
+        }
+    }
+
+    return (result);
+}
+uint32_t Decode(Reference& decoder, const std::list<Frame>& frames, std::vector<int16_t>* output)
+{
+    uint8_t decoded[OutputSize];
+    uint32_t result = 0;
+
+    for (const Frame& frame : frames) {
+        if (frame.Data.size() == HeaderSize) {
+            decoder.Header(frame.Data.data());
+        } else if (frame.Data.size() != 1) {
+            const uint16_t samples = decoder.Decode(static_cast<uint16_t>(frame.Data.size()), frame.Data.data(), frame.LengthOut, decoded);
+
+            result += samples;
+
+            if (output != nullptr) {
+                const int16_t* data = reinterpret_cast<const int16_t*>(decoded);
+                output->insert(output->end(), data, data + samples);
+            }
+        }
+    }
+
+    return (result);
+}
+
+uint32_t Mismatches(const std::vector<int16_t>& a, const std::vector<int16_t>& b)
+{
+    uint32_t result = static_cast<uint32_t>(std::max(a.size(), b.size()) - std::min(a.size(), b.size()));
+
+    for (uint32_t index = 0; index < std::min(a.size(), b.size()); index++) {
+        result += (a[index] != b[index] ? 1 : 0);
+    }
+
+    return (result);
+}
+
+// The samples the plugin recorded (16 bit PCM), behind the header of the WAV recorder.
+std::vector<int16_t> Expected(const string& fileName)
+{
+    static constexpr uint32_t WAVHeaderSize = 44;
+
+    std::ifstream file(fileName, std::ios::binary);
+    std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<int16_t> result;
+
+    for (uint32_t index = WAVHeaderSize; (index + 1) < content.size(); index += 2) {
+        result.push_back(static_cast<int16_t>((static_cast<uint8_t>(content[index + 1]) << 8) | static_cast<uint8_t>(content[index])));
+    }
+
+    return (result);
+}
+
+template <typename DECODER>
+double SamplesPerSecond(DECODER& decoder, const std::list<Frame>& frames, const uint16_t duration)
+{
+    const uint64_t start = Core::Time::Now().Ticks();
+    const uint64_t end = start + (static_cast<uint64_t>(duration) * Core::Time::TicksPerMillisecond * 1000);
+    uint64_t samples = 0;
+    uint64_t now = start;
+
+    while (now < end) {
+        samples += Decode(decoder, frames, nullptr);
+        now = Core::Time::Now().Ticks();
+    }
+
+    return ((samples * 1000000.0) / (now - start));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t count = 200000;
+    uint16_t duration = 2; // seconds, per measurement
+    uint16_t handle = 0;
+    string capture;
+    string expected;
+    uint32_t failures = 0;
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-frames") == 0) {
+            count = static_cast<uint32_t>(std::max(8, atoi(argv[index + 1])));
+        } else if (strcmp(argv[index], "-duration") == 0) {
+            duration = static_cast<uint16_t>(std::max(1, atoi(argv[index + 1])));
+        } else if (strcmp(argv[index], "-handle") == 0) {
+            handle = static_cast<uint16_t>(strtoul(argv[index + 1], nullptr, 0));
+        } else if (strcmp(argv[index], "-capture") == 0) {
+            capture = argv[index + 1];
+        } else if (strcmp(argv[index], "-expected") == 0) {
+            expected = argv[index + 1];
+        }
+    }
+
+    Decoders::IDecoder* decoder = Decoders::IDecoder::Instance(Exchange::IVoiceProducer::IProfile::codec::PCM, string());
+
+    if (decoder == nullptr) {
+        fprintf(stderr, "There is no PCM decoder\n");
+        failures++;
+    } else {
+        const std::list<Frame> randomized(Randomized(count));
+        std::vector<int16_t> actual;
+        std::vector<int16_t> reference;
+        Reference original;
+
+        printf("{\n");
+
+        if (capture.empty() == false) {
+            Test::Capture session;
+
+            if (session.Load(capture) == 0) {
+                fprintf(stderr, "No notifications in %s\n", capture.c_str());
+                failures++;
+            } else {
+                const std::list<Frame> recorded(Recorded(session, handle));
+                uint32_t mismatches;
+
+                Decode(*decoder, recorded, &actual);
+                Decode(original, recorded, &reference);
+
+                mismatches = Mismatches(actual, reference);
+                printf("  \"capture\": { \"frames\": %u, \"samples\": %u, \"mismatches\": %u", static_cast<uint32_t>(recorded.size()), static_cast<uint32_t>(actual.size()), mismatches);
+                failures += mismatches;
+
+                if (expected.empty() == false) {
+                    mismatches = Mismatches(actual, Expected(expected));
+                    printf(", \"recorded\": %u", mismatches);
+                    failures += mismatches;
+                }
+
+                printf(" },\n");
+            }
+        }
+
+        actual.clear();
+        reference.clear();
+        Decode(*decoder, randomized, &actual);
+        Decode(original, randomized, &reference);
+
+        const uint32_t mismatches = Mismatches(actual, reference);
+        failures += mismatches;
+
+        printf("  \"randomized\": { \"frames\": %u, \"samples\": %u, \"mismatches\": %u },\n", count, static_cast<uint32_t>(actual.size()), mismatches);
+        printf("  \"samplespersecond\": { \"decoder\": %.0f, \"reference\": %.0f }\n",
+            SamplesPerSecond(*decoder, randomized, duration),
+            SamplesPerSecond(original, randomized, duration));
+        printf("}\n");
+
+        delete decoder;
+    }
+
+    Core::Singleton::Dispose();
+
+    return (static_cast<int>(failures));
+}
@@ -0,0 +1,270 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Administrator.h"
+#include "../JitterBuffer.h"
+#include "Capture.h"
+
+// Replays a voice session, in real time, through the decoder and the jitter buffer the way the
+// plugin handles the notifications of a remote, e.g.:
+//
+//    BluetoothRemoteControlReplayTest -capture session.txt -data 0x0049 -command 0x004d -chunk 100 -latency 100
+//
+// Without a capture, a session of PCM (IMA ADPCM) frames is generated, arriving in bursts as they
+// do over BLE, with some frames lost on the way. Checked are: every decoded and concealed byte is
+// delivered and no voice is held back (much) longer than the latency. The statistics are printed
+// as JSON, the exit code is the number of failed checks.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+static constexpr uint16_t DataHandle = 0x0049;
+static constexpr uint16_t CommandHandle = 0x004D;
+static constexpr uint32_t SampleRate = 16000;
+static constexpr uint32_t Slack = 20000; // uS, scheduling margin on top of the latency
+
+// A session as the remote sends it: start command, per frame a header and the ADPCM data, the
+// frames bundled per connection interval, every 40th frame lost, and the stop command.
+void Generate(Test::Capture& capture, const uint32_t frames)
+{
+    static constexpr uint8_t FrameSize = 64; // bytes, 128 samples or 8 mS
+    static constexpr uint32_t Interval = 30000; // uS, 3 to 4 frames per connection event
+
+    uint32_t state = 0x9E3779B9;
+    uint64_t produced = 0;
+
+    capture.Add({ 0, CommandHandle, { 0x01 } });
+
+    for (uint32_t index = 0; index < frames; index++) {
+        // Produced every 8 mS, sent at the next connection event.
+        const uint64_t time = ((produced / Interval) + 1) * Interval;
+        produced += (FrameSize * 2 * 1000000) / SampleRate;
+
+        if ((index % 40) != 39) {
+            Test::Capture::Notification header = { time, DataHandle, { static_cast<uint8_t>(index % 32), 20, 0x00, 0x00, 0x00 } };
+            Test::Capture::Notification data = { time, DataHandle, {} };
+
+            for (uint8_t position = 0; position < FrameSize; position++) {
+                state ^= (state << 13);
+                state ^= (state >> 17);
+                state ^= (state << 5);
+                data.Payload.push_back(static_cast<uint8_t>(state));
+            }
+
+            capture.Add(header);
+            capture.Add(data);
+        }
+    }
+
+    capture.Add({ ((produced / Interval) + 1) * Interval, CommandHandle, { 0x00 } });
+}
+
+class Replay {
+public:
+    Replay() = delete;
+    Replay(const Replay&) = delete;
+    Replay& operator=(const Replay&) = delete;
+
+    Replay(Decoders::IDecoder& decoder, const uint16_t dataHandle, const uint16_t commandHandle, const uint16_t chunk, const uint16_t latency)
+        : _decoder(decoder)
+        , _dataHandle(dataHandle)
+        , _commandHandle(commandHandle)
+        , _chunkSize(static_cast<uint32_t>((static_cast<uint64_t>(SampleRate) * sizeof(int16_t) * chunk) / 1000))
+        , _latency(latency)
+        , _jitterBuffer()
+        , _dropped(0)
+        , _frameSize(0)
+        , _decoded(0)
+        , _delivered(0)
+        , _partial(0)
+        , _late(0)
+        , _limit((static_cast<uint64_t>(latency) * Core::Time::TicksPerMillisecond) + Slack)
+    {
+    }
+    ~Replay()
+    {
+    }
+
+public:
+    // Plays the notifications at the pace they were captured, the flush of a held back chunk is
+    // done at the time the flusher of the plugin would fire.
+    void Play(const Test::Capture& capture)
+    {
+        const uint64_t start = Core::Time::Now().Ticks();
+
+        for (const Test::Capture::Notification& notification : capture.Notifications()) {
+            const uint64_t due = start + notification.Time;
+            uint64_t now;
+
+            while ((now = Core::Time::Now().Ticks()) < due) {
+                const uint64_t flush = ((_jitterBuffer.IsEmpty() == false) ? (_jitterBuffer.Oldest() + (_latency * Core::Time::TicksPerMillisecond)) : due);
+
+                if (flush <= now) {
+                    Deliver(true);
+                } else {
+                    ::usleep(static_cast<uint32_t>(std::min(flush, due) - now));
+                }
+            }
+
+            Message(notification.Handle, static_cast<uint16_t>(notification.Payload.size()), notification.Payload.data(), now);
+        }
+
+        Deliver(true);
+    }
+    uint32_t Failures() const
+    {
+        const Voice::JitterBuffer::Statistics& stats(_jitterBuffer.Stats());
+        const uint64_t expected = _decoded + (_frameSize * stats.Concealed);
+
+        return ((_delivered != expected ? 1 : 0) + (_late > 0 ? 1 : 0) + (stats.Frames == 0 ? 1 : 0));
+    }
+    void Print() const
+    {
+        const Voice::JitterBuffer::Statistics& stats(_jitterBuffer.Stats());
+
+        printf("{\n  \"frames\": %u,\n  \"lost\": %u,\n  \"concealed\": %u,\n  \"chunks\": %u,\n  \"partial\": %u,\n  \"late\": %u,\n",
+            stats.Frames, stats.Lost, stats.Concealed, stats.Chunks, _partial, _late);
+        printf("  \"decoded\": %u,\n  \"delivered\": %u,\n  \"latency\": %u,\n  \"maxlatency\": %u\n}\n",
+            static_cast<uint32_t>(_decoded), static_cast<uint32_t>(_delivered), stats.AverageLatency, stats.MaximumLatency);
+    }
+
+private:
+    // As GATTRemote::Message handles the voice notifications.
+    void Message(const uint16_t handle, const uint16_t length, const uint8_t buffer[], const uint64_t received)
+    {
+        if ((handle == _dataHandle) && (length > 0)) {
+            uint8_t decoded[1024];
+            const uint16_t sendLength = _decoder.Decode(length, buffer, sizeof(decoded), decoded);
+
+            if (sendLength > 0) {
+                const uint32_t dropped = _decoder.Dropped();
+                const uint32_t lost = ((dropped != static_cast<uint32_t>(~0)) && (dropped > _dropped) ? (dropped - _dropped) : 0);
+                _dropped = (dropped != static_cast<uint32_t>(~0) ? dropped : 0);
+
+                _frameSize = sendLength;
+                _decoded += sendLength;
+                _jitterBuffer.Add(received, lost, sendLength, decoded);
+
+                Deliver(false);
+            }
+        } else if ((handle == _commandHandle) && (length > 0)) {
+            if (buffer[0] == 0) {
+                Deliver(true);
+            } else {
+                _decoder.Reset();
+                _dropped = 0;
+                _jitterBuffer.Start(_chunkSize, true);
+            }
+        }
+    }
+    void Deliver(const bool force)
+    {
+        uint32_t length;
+
+        while ((length = _jitterBuffer.Length(force)) > 0) {
+            // Held back too long, or handed over before it was complete (at the latency or the end).
+            if ((Core::Time::Now().Ticks() - _jitterBuffer.Oldest()) > _limit) {
+                _late++;
+            }
+            if (_jitterBuffer.IsComplete() == false) {
+                _partial++;
+            }
+
+            _delivered += length;
+            _jitterBuffer.Delivered(length);
+        }
+    }
+
+private:
+    Decoders::IDecoder& _decoder;
+    const uint16_t _dataHandle;
+    const uint16_t _commandHandle;
+    const uint32_t _chunkSize;
+    const uint16_t _latency;
+    Voice::JitterBuffer _jitterBuffer;
+    uint32_t _dropped;
+    uint32_t _frameSize;
+    uint64_t _decoded;
+    uint64_t _delivered;
+    uint32_t _partial;
+    uint32_t _late;
+    const uint64_t _limit;
+};
+
+}
+
+int main(int argc, char** argv)
+{
+    uint16_t dataHandle = DataHandle;
+    uint16_t commandHandle = CommandHandle;
+    uint16_t chunk = 100; // mS
+    uint16_t latency = 100; // mS
+    uint32_t frames = 500;
+    string capture;
+    uint32_t failures = 0;
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-data") == 0) {
+            dataHandle = static_cast<uint16_t>(strtoul(argv[index + 1], nullptr, 0));
+        } else if (strcmp(argv[index], "-command") == 0) {
+            commandHandle = static_cast<uint16_t>(strtoul(argv[index + 1], nullptr, 0));
+        } else if (strcmp(argv[index], "-chunk") == 0) {
+            chunk = static_cast<uint16_t>(atoi(argv[index + 1]));
+        } else if (strcmp(argv[index], "-latency") == 0) {
+            latency = static_cast<uint16_t>(atoi(argv[index + 1]));
+        } else if (strcmp(argv[index], "-frames") == 0) {
+            frames = static_cast<uint32_t>(std::max(1, atoi(argv[index + 1])));
+        } else if (strcmp(argv[index], "-capture") == 0) {
+            capture = argv[index + 1];
+        }
+    }
+
+    Decoders::IDecoder* decoder = Decoders::IDecoder::Instance(Exchange::IVoiceProducer::IProfile::codec::PCM, string());
+    Test::Capture session;
+
+    if (decoder == nullptr) {
+        fprintf(stderr, "There is no PCM decoder\n");
+        failures++;
+    } else if (capture.empty() == true) {
+        Generate(session, frames);
+    } else if (session.Load(capture) == 0) {
+        fprintf(stderr, "No notifications in %s\n", capture.c_str());
+        failures++;
+    }
+
+    if (failures == 0) {
+        Replay replay(*decoder, dataHandle, commandHandle, chunk, latency);
+
+        replay.Play(session);
+        replay.Print();
+
+        failures += replay.Failures();
+    }
+
+    if (decoder != nullptr) {
+        delete decoder;
+    }
+
+    Core::Singleton::Dispose();
+
+    return (static_cast<int>(failures));
+}
@@ -263,5 +263,413 @@ namespace Plugin {
         return (data);
     }
 
+    uint32_t Commander::Sequencer::Load(const Core::JSON::ArrayType<Command>& commandList)
+    {
+
+        _adminLock.Lock();
+
+        // Only Load data if we are NOT active !!!
+        ASSERT(IsActive() == false);
+
+        if (IsActive() == false) {
+
+            ASSERT(_commandFactory != nullptr);
+
+            if (_sequenceList.Count() > 0) {
+                _sequenceList.Clear(0, _sequenceList.Count());
+            }
+
+            _steps.clear();
+
+            std::vector<const Command*> commands;
+            bool graph = false;
+
+            Core::JSON::ArrayType<Command>::ConstIterator index(commandList.Elements());
+
+            while (index.Next() == true) {
+
+                const string& label(index.Current().Label.Value());
+                const string& className(index.Current().Item.Value());
+                const string& parameters(index.Current().Parameters.Value());
+
+                Core::ProxyType<Exchange::ICommand> newCommand(_commandFactory->Create(label, className, parameters));
+
+                if (newCommand.IsValid() == true) {
+                    _sequenceList.Add(newCommand);
+                    commands.push_back(&(index.Current()));
+                    graph = graph || (index.Current().Depends.Length() > 0);
+                }
+            }
+
+            if (graph == true) {
+                const string observer(Core::ClassNameOnly(typeid(Plugin::Command::PluginObserver).name()).Data());
+
+                for (uint32_t step = 0; step < commands.size(); step++) {
+                    _steps.push_back(Core::ProxyType<Step>::Create(this, step, _sequenceList[step]));
+
+                    if (commands[step]->Item.Value() == observer) {
+                        Plugin::Command::PluginObserver::Config config;
+                        config.FromString(commands[step]->Parameters.Value());
+
+                        _steps.back()->_observer = true;
+                        _steps.back()->_callsign = config.Callsign.Value();
+                        _steps.back()->_activated = config.Active.Value();
+                    }
+                }
+
+                for (uint32_t step = 0; step < commands.size(); step++) {
+                    Core::JSON::ArrayType<Core::JSON::String>::ConstIterator dependency(commands[step]->Depends.Elements());
+
+                    while (dependency.Next() == true) {
+                        bool found = false;
+
+                        for (uint32_t other = 0; other < commands.size(); other++) {
+                            if ((other != step) && (_sequenceList[other]->Label() == dependency.Current().Value())) {
+                                _steps[other]->_dependents.push_back(step);
+                                _steps[step]->_blocking++;
+                                found = true;
+                            }
+                        }
+
+                        if (found == false) {
+                            TRACE(Trace::Error, (_T("Sequencer %s: step %d depends on unknown label [%s]"), _name.c_str(), step, dependency.Current().Value().c_str()));
+                        }
+                    }
+                }
+
+                // Make sure all steps can be reached, a cycle in the dependencies would never complete.
+                std::vector<uint32_t> blocking;
+                std::list<uint32_t> ready;
+                uint32_t reached = 0;
+
+                for (uint32_t step = 0; step < _steps.size(); step++) {
+                    blocking.push_back(_steps[step]->_blocking);
+                    if (_steps[step]->_blocking == 0) {
+                        ready.push_back(step);
+                    }
+                }
+
+                while (ready.empty() == false) {
+                    for (const uint32_t dependent : _steps[ready.front()]->_dependents) {
+                        if (--blocking[dependent] == 0) {
+                            ready.push_back(dependent);
+                        }
+                    }
+                    ready.pop_front();
+                    reached++;
+                }
+
+                if (reached != _steps.size()) {
+                    TRACE(Trace::Error, (_T("Sequencer %s: the dependencies contain a cycle, sequence refused"), _name.c_str()));
+                    _sequenceList.Clear(0, _sequenceList.Count());
+                    _steps.clear();
+                }
+            }
+
+            if (_sequenceList.Count() > 0) {
+                _state = Commander::LOADED;
+                _currentIndex = 0;
+            }
+        }
+
+        _adminLock.Unlock();
+
+        return (_sequenceList.Count());
+    }
+
+    uint32_t Commander::Sequencer::Abort()
+    {
+        uint32_t result = Core::ERROR_ILLEGAL_STATE;
+        std::vector<uint32_t> observing;
+
+        _adminLock.Lock();
+
+        if (_state == Commander::RUNNING) {
+            result = Core::ERROR_NONE;
+            _state = Commander::ABORTING;
+
+            if (_steps.empty() == true) {
+                _sequenceList[_currentIndex]->Abort();
+            } else {
+                for (uint32_t index = 0; index < _steps.size(); index++) {
+                    if (_steps[index]->_state == Step::RUNNING) {
+                        _steps[index]->_command->Abort();
+                    } else if (_steps[index]->_state == Step::OBSERVING) {
+                        observing.push_back(index);
+                    }
+                }
+            }
+        }
+
+        _adminLock.Unlock();
+
+        // No need to wait any longer for the plugins to reach their state.
+        for (const uint32_t index : observing) {
+            Completed(index, EMPTY_STRING);
+        }
+
+        // Wait for the sequencer to reaach a safe positon..
+        return (result);
+    }
+
+    /* virtual */ void Commander::Sequencer::Dispatch()
+    {
+        if (_steps.empty() == true) {
+            Sequential();
+        } else {
+            bool observe = false;
+
+            _adminLock.Lock();
+
+            for (const Core::ProxyType<Step>& step : _steps) {
+                observe = observe || step->_observer;
+            }
+
+            if (observe == true) {
+                observe = (_observing == false);
+                _observing = true;
+            }
+
+            _adminLock.Unlock();
+
+            if (observe == true) {
+                // Stays registered for the lifetime of the sequencer, unregistering from within a
+                // notification is not possible.
+                _service->Register(&_observer);
+            }
+
+            _adminLock.Lock();
+
+            _started = Core::Time::Now().Ticks();
+            _active = 0;
+
+            if (_state == Commander::RUNNING) {
+                for (uint32_t index = 0; index < _steps.size(); index++) {
+                    if (_steps[index]->_blocking == 0) {
+                        Schedule(index, static_cast<uint32_t>(~0));
+                    }
+                }
+            }
+
+            if (_active == 0) {
+                // Aborted before we even started.
+                Report();
+                _state = IDLE;
+                _sequenceList.Clear(0, _sequenceList.Count());
+            }
+
+            _adminLock.Unlock();
+        }
+    }
+
+    void Commander::Sequencer::Sequential()
+    {
+        _adminLock.Lock();
+
+        // See if we still need to take some "next steps"
+        while ((_currentIndex < _sequenceList.Count()) && (_state == Commander::RUNNING)) {
+
+            Core::ProxyType<Exchange::ICommand> step(_sequenceList[_currentIndex]);
+
+            _adminLock.Unlock();
+
+            const string result = step->Execute(_service);
+
+            _adminLock.Lock();
+
+            if (result.empty() == true) {
+                _currentIndex++;
+            } else {
+                uint32_t index = _currentIndex + 1;
+
+                // See if we have a forward label, as mentioned from the execute
+                while ((index < _sequenceList.Count()) && (_sequenceList[index]->Label() != result)) {
+                    index++;
+                }
+
+                if (index < _sequenceList.Count()) {
+                    // Seems like we found a next step, set it..
+                    _currentIndex = index;
+                } else {
+                    // There are no steps before our current step, so no label found, just progress...
+                    _currentIndex++;
+
+                    // But let's check if there is a step before us (or we are ourselves :-), we might need to jump to..
+                    index = _currentIndex;
+
+                    // Check if we have a step with the given label prior to our current step..
+                    while ((index > 0) && (_sequenceList[index - 1]->Label() != result)) {
+                        index--;
+                    }
+
+                    if (index > 0) {
+                        _currentIndex = (index - 1);
+                    }
+                }
+            }
+        }
+
+        ASSERT((_state == Commander::RUNNING) || (_state == Commander::ABORTING));
+        _state = IDLE;
+
+        _sequenceList.Clear(0, _sequenceList.Count());
+
+        _adminLock.Unlock();
+    }
+
+    void Commander::Sequencer::Schedule(const uint32_t index, const uint32_t dependency)
+    {
+        // runs always in the context of the adminlock
+        Step& step(*(_steps[index]));
+
+        step._state = Step::SCHEDULED;
+        step._ready = Core::Time::Now().Ticks();
+        step._critical = dependency;
+        _active++;
+
+        Core::IWorkerPool::Instance().Submit(Core::proxy_cast<Core::IDispatchType<void>>(_steps[index]));
+    }
+
+    void Commander::Sequencer::Run(const uint32_t index)
+    {
+        _adminLock.Lock();
+
+        Step& step(*(_steps[index]));
+
+        step._start = Core::Time::Now().Ticks();
+
+        if (_state != Commander::RUNNING) {
+            // Aborted, do not start anything new anymore.
+            _adminLock.Unlock();
+
+            Completed(index, EMPTY_STRING);
+        } else if (step._observer == true) {
+            const string callsign(step._callsign);
+            const PluginHost::IShell::state expected(step._activated ? PluginHost::IShell::ACTIVATED : PluginHost::IShell::DEACTIVATED);
+
+            step._state = Step::OBSERVING;
+            _currentIndex = index;
+
+            _adminLock.Unlock();
+
+            // The plugin might already be in the state we are waiting for, otherwise the StateChange will complete it.
+            PluginHost::IShell* plugin = _service->QueryInterfaceByCallsign<PluginHost::IShell>(callsign);
+
+            if (plugin != nullptr) {
+                const bool reached = (plugin->State() == expected);
+
+                plugin->Release();
+
+                if (reached == true) {
+                    Completed(index, EMPTY_STRING);
+                }
+            }
+        } else {
+            Core::ProxyType<Exchange::ICommand> command(step._command);
+
+            step._state = Step::RUNNING;
+            _currentIndex = index;
+
+            _adminLock.Unlock();
+
+            const string result = command->Execute(_service);
+
+            Completed(index, result);
+        }
+    }
+
+    void Commander::Sequencer::Completed(const uint32_t index, const string& result)
+    {
+        _adminLock.Lock();
+
+        Step& step(*(_steps[index]));
+
+        if (step._state != Step::COMPLETED) {
+            step._state = Step::COMPLETED;
+            step._end = Core::Time::Now().Ticks();
+            _active--;
+
+            if (result.empty() == false) {
+                // Jumping to labels is for sequential sequences only, in a graph the outcome is just reported.
+                TRACE(Trace::Information, (_T("Sequencer %s: step [%s] reported [%s]"), _name.c_str(), step._command->Label().c_str(), result.c_str()));
+            }
+
+            if (_state == Commander::RUNNING) {
+                for (const uint32_t dependent : step._dependents) {
+                    if (--(_steps[dependent]->_blocking) == 0) {
+                        Schedule(dependent, index);
+                    }
+                }
+            }
+
+            if (_active == 0) {
+                Report();
+
+                ASSERT((_state == Commander::RUNNING) || (_state == Commander::ABORTING));
+                _state = IDLE;
+
+                _sequenceList.Clear(0, _sequenceList.Count());
+            }
+        }
+
+        _adminLock.Unlock();
+    }
+
+    void Commander::Sequencer::StateChange(PluginHost::IShell* plugin)
+    {
+        std::vector<uint32_t> reached;
+        const string callsign(plugin->Callsign());
+        const PluginHost::IShell::state current(plugin->State());
+
+        _adminLock.Lock();
+
+        for (uint32_t index = 0; index < _steps.size(); index++) {
+            const Step& step(*(_steps[index]));
+
+            if ((step._state == Step::OBSERVING) && (step._callsign == callsign) && (current == (step._activated ? PluginHost::IShell::ACTIVATED : PluginHost::IShell::DEACTIVATED))) {
+                reached.push_back(index);
+            }
+        }
+
+        _adminLock.Unlock();
+
+        for (const uint32_t index : reached) {
+            Completed(index, EMPTY_STRING);
+        }
+    }
+
+    void Commander::Sequencer::Report() const
+    {
+        // runs always in the context of the adminlock
+        uint32_t last = static_cast<uint32_t>(~0);
+
+        TRACE(Trace::Information, (_T("Sequencer %s: completed in %d mS"), _name.c_str(), static_cast<uint32_t>((Core::Time::Now().Ticks() - _started) / Core::Time::TicksPerMillisecond)));
+
+        for (uint32_t index = 0; index < _steps.size(); index++) {
+            const Step& step(*(_steps[index]));
+
+            if (step._start != 0) {
+                TRACE(Trace::Information, (_T("Sequencer %s: step [%s] ready at %d mS, waited %d mS, took %d mS"), _name.c_str(), step._command->Label().c_str(),
+                    static_cast<uint32_t>((step._ready - _started) / Core::Time::TicksPerMillisecond),
+                    static_cast<uint32_t>((step._start - step._ready) / Core::Time::TicksPerMillisecond),
+                    static_cast<uint32_t>((step._end - step._start) / Core::Time::TicksPerMillisecond)));
+
+                if ((last == static_cast<uint32_t>(~0)) || (step._end > _steps[last]->_end)) {
+                    last = index;
+                }
+            }
+        }
+
+        // The critical path is the chain of steps that unblocked each other, ending in the step that finished last.
+        string path;
+
+        while (last != static_cast<uint32_t>(~0)) {
+            path = _steps[last]->_command->Label() + (path.empty() ? string() : (_T(" -> ") + path));
+            last = _steps[last]->_critical;
+        }
+
+        TRACE(Trace::Information, (_T("Sequencer %s: critical path %s"), _name.c_str(), path.c_str()));
+    }
+
 } // Namespace Plugin.
 }
@@ -41,20 +41,24 @@ namespace Plugin {
                 , Item()
                 , Label()
                 , Parameters(false)
+                , Depends()
             {
                 Add(_T("command"), &Item);
                 Add(_T("label"), &Label);
                 Add(_T("parameters"), &Parameters);
+                Add(_T("depends"), &Depends);
             }
             Command(const Command& copy)
                 : Core::JSON::Container()
                 , Item(copy.Item)
                 , Label(copy.Label)
                 , Parameters(copy.Parameters)
+                , Depends(copy.Depends)
             {
                 Add(_T("command"), &Item);
                 Add(_T("label"), &Label);
                 Add(_T("parameters"), &Parameters);
+                Add(_T("depends"), &Depends);
             }
             ~Command()
             {
@@ -65,6 +69,7 @@ namespace Plugin {
                 Item = RHS.Item;
                 Label = RHS.Label;
                 Parameters = RHS.Parameters;
+                Depends = RHS.Depends;
 
                 return (*this);
             }
@@ -73,6 +78,10 @@ namespace Plugin {
             Core::JSON::String Item;
             Core::JSON::String Label;
             Core::JSON::String Parameters;
+            // Labels of the steps that need to be completed before this one can run. If any command
+            // in a sequence declares dependencies, the sequence runs as a graph and steps without
+            // dependencies start right away.
+            Core::JSON::ArrayType<Core::JSON::String> Depends;
         };
 
         class Data : public Core::JSON::Container {
@@ -243,7 +252,105 @@ namespace Plugin {
             Sequencer(const Sequencer& copy) = delete;
             Sequencer& operator=(const Sequencer&) = delete;
 
+            // A step of a sequence that declares dependencies. It is dispatched on the workerpool as
+            // soon as all the steps it depends on are completed, so independent steps run in parallel.
+            class Step : public Core::IDispatchType<void> {
+            private:
+                Step() = delete;
+                Step(const Step&) = delete;
+                Step& operator=(const Step&) = delete;
+
+            public:
+                enum state {
+                    WAITING,
+                    SCHEDULED,
+                    RUNNING,
+                    OBSERVING,
+                    COMPLETED
+                };
+
+            public:
+                Step(Sequencer* parent, const uint32_t index, const Core::ProxyType<Exchange::ICommand>& command)
+                    : _parent(*parent)
+                    , _index(index)
+                    , _command(command)
+                    , _state(WAITING)
+                    , _blocking(0)
+                    , _dependents()
+                    , _callsign()
+                    , _activated(false)
+                    , _observer(false)
+                    , _ready(0)
+                    , _start(0)
+                    , _end(0)
+                    , _critical(~0)
+                {
+                    ASSERT(parent != nullptr);
+                }
+                ~Step()
+                {
+                }
+
+            public:
+                virtual void Dispatch() override
+                {
+                    _parent.Run(_index);
+                }
+
+            private:
+                friend class Sequencer;
+
+                Sequencer& _parent;
+                const uint32_t _index;
+                Core::ProxyType<Exchange::ICommand> _command;
+                state _state;
+                uint32_t _blocking;
+                std::vector<uint32_t> _dependents;
+                string _callsign;
+                bool _activated;
+                bool _observer;
+                uint64_t _ready;
+                uint64_t _start;
+                uint64_t _end;
+                uint32_t _critical;
+            };
+
+            // Waiting for a plugin to reach a state should not occupy a workerpool thread, the
+            // sequencer observes the plugins itself.
+            class Observer : public PluginHost::IPlugin::INotification {
+            private:
+                Observer() = delete;
+                Observer(const Observer&) = delete;
+                Observer& operator=(const Observer&) = delete;
+
+            public:
+                Observer(Sequencer* parent)
+                    : _parent(*parent)
+                {
+                    ASSERT(parent != nullptr);
+                }
+                ~Observer()
+                {
+                }
+
+            public:
+                virtual void StateChange(PluginHost::IShell* plugin) override
+                {
+                    _parent.StateChange(plugin);
+                }
+
+                BEGIN_INTERFACE_MAP(Observer)
+                INTERFACE_ENTRY(PluginHost::IPlugin::INotification)
+                END_INTERFACE_MAP
+
+            private:
+                Sequencer& _parent;
+            };
+
         public:
+#ifdef __WINDOWS__
+#pragma warning(disable : 4355)
+#endif
             Sequencer(const string& name, Administrator* commandFactory, PluginHost::IShell* service)
                 : _commandFactory(commandFactory)
                 , _adminLock()
@@ -252,6 +359,11 @@ namespace Plugin {
                 , _name(name)
                 , _service(service)
                 , _sequenceList(5)
+                , _steps()
+                , _active(0)
+                , _started(0)
+                , _observing(false)
+                , _observer(this)
             {
                 ASSERT(service != nullptr);
 
@@ -259,11 +371,23 @@ namespace Plugin {
                     _service->AddRef();
                 }
             }
+#ifdef __WINDOWS__
+#pragma warning(default : 4355)
+#endif
             ~Sequencer()
             {
                 // Make sure we are not executing anything if we get destructed.
                 Abort();
 
+                // Steps still in the workerpool refer to us, wait for them.
+                for (Core::ProxyType<Step>& step : _steps) {
+                    Core::IWorkerPool::Instance().Revoke(Core::proxy_cast<Core::IDispatchType<void>>(step));
+                }
+
+                if (_observing == true) {
+                    _service->Unregister(&_observer);
+                }
+
                 if (_service != nullptr) {
                     _service->Release();
                 }
@@ -314,47 +438,7 @@ namespace Plugin {
 
                 return (result);
             }
-            uint32_t Load(const Core::JSON::ArrayType<Command>& commandList)
-            {
-
-                _adminLock.Lock();
-
-                // Only Load data if we are NOT active !!!
-                ASSERT(IsActive() == false);
-
-                if (IsActive() == false) {
-
-                    ASSERT(_commandFactory != nullptr);
-
-                    if (_sequenceList.Count() > 0) {
-                        _sequenceList.Clear(0, _sequenceList.Count());
-                    }
-
-                    Core::JSON::ArrayType<Command>::ConstIterator index(commandList.Elements());
-
-                    while (index.Next() == true) {
-
-                        const string& label(index.Current().Label.Value());
-                        const string& className(index.Current().Item.Value());
-                        const string& parameters(index.Current().Parameters.Value());
-
-                        Core::ProxyType<Exchange::ICommand> newCommand(_commandFactory->Create(label, className, parameters));
-
-                        if (newCommand.IsValid() == true) {
-                            _sequenceList.Add(newCommand);
-                        }
-                    }
-
-                    if (_sequenceList.Count() > 0) {
-                        _state = Commander::LOADED;
-                        _currentIndex = 0;
-                    }
-                }
-
-                _adminLock.Unlock();
-
-                return (_sequenceList.Count());
-            }
+            uint32_t Load(const Core::JSON::ArrayType<Command>& commandList);
             uint32_t Execute()
             {
 
@@ -371,79 +455,17 @@ namespace Plugin {
 
                 return (result);
             }
-            uint32_t Abort()
-            {
-                uint32_t result = Core::ERROR_ILLEGAL_STATE;
-
-                _adminLock.Lock();
-
-                if (_state == Commander::RUNNING) {
-                    result = Core::ERROR_NONE;
-                    _state = Commander::ABORTING;
-                    _sequenceList[_currentIndex]->Abort();
-                }
-
-                _adminLock.Unlock();
-
-                // Wait for the sequencer to reaach a safe positon..
-                return (result);
-            }
+            uint32_t Abort();
 
         private:
-            virtual void Dispatch()
-            {
-                _adminLock.Lock();
+            virtual void Dispatch();
 
-                // See if we still need to take some "next steps"
-                while ((_currentIndex < _sequenceList.Count()) && (_state == Commander::RUNNING)) {
-
-                    Core::ProxyType<Exchange::ICommand> step(_sequenceList[_currentIndex]);
-
-                    _adminLock.Unlock();
-
-                    const string result = step->Execute(_service);
-
-                    _adminLock.Lock();
-
-                    if (result.empty() == true) {
-                        _currentIndex++;
-                    } else {
-                        uint32_t index = _currentIndex + 1;
-
-                        // See if we have a forward label, as mentioned from the execute
-                        while ((index < _sequenceList.Count()) && (_sequenceList[index]->Label() != result)) {
-                            index++;
-                        }
-
-                        if (index < _sequenceList.Count()) {
-                            // Seems like we found a next step, set it..
-                            _currentIndex = index;
-                        } else {
-                            // There are no steps before our current step, so no label found, just progress...
-                            _currentIndex++;
-
-                            // But let's check if there is a step before us (or we are ourselves :-), we might need to jump to..
-                            index = _currentIndex;
-
-                            // Check if we have a step with the given label prior to our current step..
-                            while ((index > 0) && (_sequenceList[index - 1]->Label() != result)) {
-                                index--;
-                            }
-
-                            if (index > 0) {
-                                _currentIndex = (index - 1);
-                            }
-                        }
-                    }
-                }
-
-                ASSERT((_state == Commander::RUNNING) || (_state == Commander::ABORTING));
-                _state = IDLE;
-
-                _sequenceList.Clear(0, _sequenceList.Count());
-
-                _adminLock.Unlock();
-            }
+            void Sequential();
+            void Run(const uint32_t index);
+            void Schedule(const uint32_t index, const uint32_t dependency);
+            void Completed(const uint32_t index, const string& result);
+            void StateChange(PluginHost::IShell* plugin);
+            void Report() const;
 
         private:
             Administrator* _commandFactory;
@@ -453,6 +475,11 @@ namespace Plugin {
             string _name;
             PluginHost::IShell* _service;
             Core::ProxyList<Exchange::ICommand> _sequenceList;
+            std::vector<Core::ProxyType<Step>> _steps;
+            uint32_t _active;
+            uint64_t _started;
+            bool _observing;
+            Core::Sink<Observer> _observer;
         };
 
         Commander(const Commander&) = delete;
@@ -152,6 +152,7 @@ namespace Plugin {
                 PluginObserver& _parent;
             };
 
+        public:
             class Config : public Core::JSON::Container {
             private:
                 Config(const Config&) = delete;
@@ -175,7 +176,6 @@ namespace Plugin {
                 Core::JSON::Boolean Active;
             };
 
-        public:
 #ifdef __WINDOWS__
 #pragma warning(disable : 4355)
 #endif
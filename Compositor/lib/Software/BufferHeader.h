@@ -0,0 +1,81 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+namespace WPEFramework {
+namespace Plugin {
+namespace Software {
+
+    static constexpr uint32_t BufferMagic = 0x42474152; // 'RAGB'
+
+    // Layout of a shared buffer, the pixels follow the header. Next to the compositor, the buffers
+    // are read by other processes, e.g. the FrameBuffer capture device of Snapshot, so this is the
+    // one definition they all include.
+    //
+    // The sequence doubles as a sequence lock: it is odd while the pixels are being written and even
+    // once the frame is complete. A reader copies the pixels only if it reads the same, even, sequence
+    // before and after the copy. The compositor itself only looks for a change of the sequence of a
+    // client, so a client that just increments it once a frame is complete works as well.
+    struct BufferHeader {
+        uint32_t Magic;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t Stride; // in pixels
+        std::atomic<uint32_t> Sequence;
+        uint32_t DamageX;
+        uint32_t DamageY;
+        uint32_t DamageWidth;
+        uint32_t DamageHeight;
+
+        // Writer side, around the writing of the pixels and the damage.
+        inline void BeginWrite()
+        {
+            Sequence.store(Sequence.load(std::memory_order_relaxed) | 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        inline void EndWrite()
+        {
+            Sequence.store((Sequence.load(std::memory_order_relaxed) | 1) + 1, std::memory_order_release);
+        }
+
+        // Reader side, an odd result means a frame is being written, try again later.
+        inline uint32_t BeginRead() const
+        {
+            return (Sequence.load(std::memory_order_acquire));
+        }
+        // True if nothing was written since BeginRead() returned this (even) sequence.
+        inline bool EndRead(const uint32_t sequence) const
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return (((sequence & 1) == 0) && (Sequence.load(std::memory_order_relaxed) == sequence));
+        }
+    };
+
+    // The header lives in memory shared between processes, the sequence must be a plain 32 bits
+    // lock free atomic for that.
+    static_assert(ATOMIC_INT_LOCK_FREE == 2, "The buffer sequence must be lock free");
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "The buffer sequence must be 32 bits");
+
+} // namespace Software
+} // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,258 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <interfaces/IComposition.h>
+
+namespace WPEFramework {
+namespace Plugin {
+namespace Software {
+
+    // The pixel work of the software compositor: tracks the damaged regions of the output and blends
+    // the layers (premultiplied ARGB8888), in z-order and scaled to their geometry, into them.
+    class Composition {
+    private:
+        Composition(const Composition&) = delete;
+        Composition& operator=(const Composition&) = delete;
+
+        static constexpr uint32_t Background = 0xFF000000;
+
+    public:
+        struct Layer {
+            const uint32_t* Pixels;
+            uint32_t Width;
+            uint32_t Height;
+            uint32_t Stride; // in pixels
+            Exchange::IComposition::Rectangle Geometry;
+            uint32_t ZOrder;
+        };
+
+    public:
+        Composition()
+            : _pixels(nullptr)
+            , _width(0)
+            , _height(0)
+            , _stride(0)
+            , _damage()
+        {
+        }
+        ~Composition()
+        {
+        }
+
+    public:
+        inline bool IsValid() const
+        {
+            return (_pixels != nullptr);
+        }
+        inline bool IsDamaged() const
+        {
+            return (_damage.empty() == false);
+        }
+        // Compose into these pixels from now on, nothing is damaged yet.
+        void Output(uint32_t* pixels, const uint32_t width, const uint32_t height, const uint32_t stride)
+        {
+            _pixels = pixels;
+            _width = width;
+            _height = height;
+            _stride = stride;
+            _damage.clear();
+        }
+
+        // Adds a region that needs to be composed again, overlapping regions are merged.
+        void Damage(const Exchange::IComposition::Rectangle& area)
+        {
+            Exchange::IComposition::Rectangle region(area);
+
+            if ((_pixels != nullptr) && (Clip(region) == true)) {
+                std::list<Exchange::IComposition::Rectangle>::iterator index(_damage.begin());
+
+                while (index != _damage.end()) {
+                    if (Overlaps(*index, region) == true) {
+                        // Merge them and start over, the merged one might overlap others now.
+                        region = Union(*index, region);
+                        _damage.erase(index);
+                        index = _damage.begin();
+                    } else {
+                        index++;
+                    }
+                }
+
+                _damage.push_back(region);
+            }
+        }
+
+        // Composes all damaged regions from the layers, the bottom one (highest z-order) first.
+        // Returns the bounding box of what was composed, pixels is the number of pixels composed.
+        Exchange::IComposition::Rectangle Render(std::list<Layer>& layers, uint64_t& pixels)
+        {
+            layers.sort([](const Layer& a, const Layer& b) { return (a.ZOrder > b.ZOrder); });
+
+            Exchange::IComposition::Rectangle total(_damage.empty() == true ? Exchange::IComposition::Rectangle() : _damage.front());
+
+            pixels = 0;
+
+            for (const Exchange::IComposition::Rectangle& region : _damage) {
+                uint32_t* line = &(_pixels[(region.y * _stride) + region.x]);
+
+                for (uint32_t y = 0; y < region.height; y++) {
+                    std::fill(line, line + region.width, Background);
+                    line += _stride;
+                }
+
+                for (const Layer& layer : layers) {
+                    Compose(layer, region);
+                }
+
+                total = Union(total, region);
+                pixels += (region.width * region.height);
+            }
+
+            _damage.clear();
+
+            return (total);
+        }
+
+        static bool Overlaps(const Exchange::IComposition::Rectangle& a, const Exchange::IComposition::Rectangle& b)
+        {
+            return ((static_cast<int32_t>(a.x) < static_cast<int32_t>(b.x + b.width)) && (static_cast<int32_t>(b.x) < static_cast<int32_t>(a.x + a.width)) && (static_cast<int32_t>(a.y) < static_cast<int32_t>(b.y + b.height)) && (static_cast<int32_t>(b.y) < static_cast<int32_t>(a.y + a.height)));
+        }
+
+        static Exchange::IComposition::Rectangle Union(const Exchange::IComposition::Rectangle& a, const Exchange::IComposition::Rectangle& b)
+        {
+            Exchange::IComposition::Rectangle result;
+            const int32_t right = std::max(static_cast<int32_t>(a.x + a.width), static_cast<int32_t>(b.x + b.width));
+            const int32_t bottom = std::max(static_cast<int32_t>(a.y + a.height), static_cast<int32_t>(b.y + b.height));
+
+            result.x = std::min(static_cast<int32_t>(a.x), static_cast<int32_t>(b.x));
+            result.y = std::min(static_cast<int32_t>(a.y), static_cast<int32_t>(b.y));
+            result.width = right - result.x;
+            result.height = bottom - result.y;
+
+            return (result);
+        }
+
+        static inline bool SameRectangle(const Exchange::IComposition::Rectangle& a, const Exchange::IComposition::Rectangle& b)
+        {
+            return ((a.x == b.x) && (a.y == b.y) && (a.width == b.width) && (a.height == b.height));
+        }
+
+    private:
+        bool Clip(Exchange::IComposition::Rectangle& area) const
+        {
+            const int32_t width = static_cast<int32_t>(_width);
+            const int32_t height = static_cast<int32_t>(_height);
+            const int32_t left = std::max(static_cast<int32_t>(area.x), 0);
+            const int32_t top = std::max(static_cast<int32_t>(area.y), 0);
+            const int32_t right = std::min(static_cast<int32_t>(area.x) + static_cast<int32_t>(area.width), width);
+            const int32_t bottom = std::min(static_cast<int32_t>(area.y) + static_cast<int32_t>(area.height), height);
+
+            area.x = left;
+            area.y = top;
+            area.width = (right > left ? (right - left) : 0);
+            area.height = (bottom > top ? (bottom - top) : 0);
+
+            return ((area.width != 0) && (area.height != 0));
+        }
+
+        // Premultiplied source over destination. The red/blue and alpha/green channels are each
+        // scaled with a single multiplication (two channels per 32 bits), so the loops over a
+        // span stay branch-light and leave the compiler room to vectorize them.
+        static inline uint32_t Blend(const uint32_t source, const uint32_t destination)
+        {
+            const uint32_t alpha = (source >> 24);
+            uint32_t result = source;
+
+            if (alpha == 0) {
+                result = destination;
+            } else if (alpha != 0xFF) {
+                const uint32_t inverse = 256 - alpha;
+                const uint32_t rb = (((destination & 0x00FF00FF) * inverse) >> 8) & 0x00FF00FF;
+                const uint32_t ag = (((destination >> 8) & 0x00FF00FF) * inverse) & 0xFF00FF00;
+
+                result = source + (rb | ag);
+            }
+
+            return (result);
+        }
+
+        static void BlendSpan(uint32_t* destination, const uint32_t* source, const uint32_t length)
+        {
+            for (uint32_t index = 0; index < length; index++) {
+                destination[index] = Blend(source[index], destination[index]);
+            }
+        }
+
+        // Scaled (nearest neighbour) span, the source position advances in 16.16 fixed point.
+        static void BlendSpan(uint32_t* destination, const uint32_t* source, const uint32_t length, uint32_t position, const uint32_t step)
+        {
+            for (uint32_t index = 0; index < length; index++) {
+                destination[index] = Blend(source[position >> 16], destination[index]);
+                position += step;
+            }
+        }
+
+        // Blend the part of the layer within the region into the output.
+        void Compose(const Layer& layer, const Exchange::IComposition::Rectangle& region)
+        {
+            const Exchange::IComposition::Rectangle& geometry(layer.Geometry);
+
+            if ((geometry.width != 0) && (geometry.height != 0) && (layer.Width != 0) && (layer.Height != 0) && (Overlaps(geometry, region) == true)) {
+                const int32_t left = std::max(static_cast<int32_t>(geometry.x), static_cast<int32_t>(region.x));
+                const int32_t top = std::max(static_cast<int32_t>(geometry.y), static_cast<int32_t>(region.y));
+                const int32_t right = std::min(static_cast<int32_t>(geometry.x + geometry.width), static_cast<int32_t>(region.x + region.width));
+                const int32_t bottom = std::min(static_cast<int32_t>(geometry.y + geometry.height), static_cast<int32_t>(region.y + region.height));
+                const uint32_t length = right - left;
+
+                const uint32_t stepX = static_cast<uint32_t>((static_cast<uint64_t>(layer.Width) << 16) / geometry.width);
+                const uint32_t stepY = static_cast<uint32_t>((static_cast<uint64_t>(layer.Height) << 16) / geometry.height);
+                const bool unscaled = ((stepX == (1 << 16)) && (stepY == (1 << 16)));
+
+                uint32_t* output = &(_pixels[(top * _stride) + left]);
+
+                for (int32_t y = top; y < bottom; y++) {
+                    const uint32_t line = static_cast<uint32_t>((static_cast<uint64_t>(y - geometry.y) * stepY) >> 16);
+                    const uint32_t* source = &(layer.Pixels[line * layer.Stride]);
+                    const uint32_t position = (left - geometry.x) * stepX;
+
+                    if (unscaled == true) {
+                        BlendSpan(output, &(source[position >> 16]), length);
+                    } else {
+                        BlendSpan(output, source, length, position, stepX);
+                    }
+
+                    output += _stride;
+                }
+            }
+        }
+
+    private:
+        uint32_t* _pixels;
+        uint32_t _width;
+        uint32_t _height;
+        uint32_t _stride; // in pixels
+        std::list<Exchange::IComposition::Rectangle> _damage;
+    };
+
+} // namespace Software
+} // namespace Plugin
+} // namespace WPEFramework
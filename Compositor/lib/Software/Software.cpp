@@ -0,0 +1,765 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+#include "BufferHeader.h"
+#include "Composition.h"
+
+#include <interfaces/IComposition.h>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Compositor that does not need any graphics hardware. Clients render premultiplied ARGB8888
+    // pixels in a shared memory buffer (a file named after the client in the buffers directory),
+    // the compositor blends the damaged regions of all clients, in z-order and scaled to their
+    // geometry, into the output buffer (the file "output" in the same directory).
+    class CompositorImplementation : public Exchange::IComposition {
+    private:
+        CompositorImplementation(const CompositorImplementation&) = delete;
+        CompositorImplementation& operator=(const CompositorImplementation&) = delete;
+
+        static constexpr uint32_t ReportInterval = 5000; // mS
+
+        // A client updates the damage rectangle (in buffer coordinates) and the sequence once a
+        // frame is complete.
+        using BufferHeader = Software::BufferHeader;
+
+    private:
+        class ExternalAccess : public RPC::Communicator {
+        private:
+            ExternalAccess() = delete;
+            ExternalAccess(const ExternalAccess&) = delete;
+            ExternalAccess& operator=(const ExternalAccess&) = delete;
+
+        public:
+            ExternalAccess(
+                CompositorImplementation& parent,
+                const Core::NodeId& source,
+                const string& proxyStubPath,
+                const Core::ProxyType<RPC::InvokeServer>& handler)
+                : RPC::Communicator(source,  proxyStubPath.empty() == false ? Core::Directory::Normalize(proxyStubPath) : proxyStubPath, Core::ProxyType<Core::IIPCServer>(handler))
+                , _parent(parent)
+            {
+                uint32_t result = RPC::Communicator::Open(RPC::CommunicationTimeOut);
+
+                handler->Announcements(Announcement());
+
+                if (result != Core::ERROR_NONE) {
+                    TRACE(Trace::Error, (_T("Could not open Software Compositor RPCLink server. Error: %s"), Core::NumberType<uint32_t>(result).Text()));
+                } else {
+                    // We need to pass the communication channel NodeId via an environment variable, for process,
+                    // not being started by the rpcprocess...
+                    Core::SystemInfo::SetEnvironment(_T("COMPOSITOR"), RPC::Communicator::Connector(), true);
+                }
+            }
+
+            virtual ~ExternalAccess() override = default;
+
+        private:
+            void Offer(Core::IUnknown* element, const uint32_t interfaceID) override
+            {
+                Exchange::IComposition::IClient* result = element->QueryInterface<Exchange::IComposition::IClient>();
+
+                if (result != nullptr) {
+                    _parent.NewClientOffered(result);
+                    result->Release();
+                }
+            }
+
+            void Revoke(const Core::IUnknown* element, const uint32_t interfaceID) override
+            {
+                _parent.ClientRevoked(element);
+            }
+
+        private:
+            CompositorImplementation& _parent;
+        };
+
+        class Composer : public Core::Thread {
+        private:
+            Composer() = delete;
+            Composer(const Composer&) = delete;
+            Composer& operator=(const Composer&) = delete;
+
+        public:
+            Composer(CompositorImplementation& parent)
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("SoftwareComposer"))
+                , _parent(parent)
+            {
+            }
+            virtual ~Composer()
+            {
+            }
+
+        public:
+            uint32_t Worker() override
+            {
+                return (_parent.Compose());
+            }
+
+        private:
+            CompositorImplementation& _parent;
+        };
+
+        // A memory mapped buffer, shared with a client, or the output we compose into.
+        class Buffer {
+        private:
+            Buffer() = delete;
+            Buffer(const Buffer&) = delete;
+            Buffer& operator=(const Buffer&) = delete;
+
+        public:
+            // Map the buffer a client created.
+            // The client can change the header at any time, so the dimensions are copied and validated
+            // once here, only the copies are used from then on.
+            Buffer(const string& fileName)
+                : _file(fileName, Core::File::SHAREABLE | Core::File::USER_READ | Core::File::USER_WRITE, 0)
+                , _header(nullptr)
+                , _width(0)
+                , _height(0)
+                , _stride(0)
+            {
+                if ((_file.IsValid() == true) && (_file.Size() >= sizeof(BufferHeader))) {
+                    const BufferHeader* header = reinterpret_cast<const BufferHeader*>(_file.Buffer());
+                    const uint32_t magic = header->Magic;
+                    const uint32_t width = header->Width;
+                    const uint32_t height = header->Height;
+                    const uint32_t stride = header->Stride;
+
+                    if ((magic == Software::BufferMagic) && (width != 0) && (height != 0) && (stride >= width) && (_file.Size() >= (sizeof(BufferHeader) + (static_cast<uint64_t>(stride) * height * sizeof(uint32_t))))) {
+                        _header = reinterpret_cast<BufferHeader*>(_file.Buffer());
+                        _width = width;
+                        _height = height;
+                        _stride = stride;
+                    }
+                }
+            }
+            // Create the output buffer.
+            Buffer(const string& fileName, const uint32_t width, const uint32_t height)
+                : _file(fileName, Core::File::SHAREABLE | Core::File::USER_READ | Core::File::USER_WRITE | Core::File::GROUP_READ, sizeof(BufferHeader) + (width * height * sizeof(uint32_t)))
+                , _header(nullptr)
+                , _width(width)
+                , _height(height)
+                , _stride(width)
+            {
+                if ((_file.IsValid() == true) && (_file.Size() >= (sizeof(BufferHeader) + (width * height * sizeof(uint32_t))))) {
+                    _header = reinterpret_cast<BufferHeader*>(_file.Buffer());
+                    _header->Magic = Software::BufferMagic;
+                    _header->Width = width;
+                    _header->Height = height;
+                    _header->Stride = width;
+                    _header->Sequence.store(0, std::memory_order_relaxed);
+                    _header->DamageX = 0;
+                    _header->DamageY = 0;
+                    _header->DamageWidth = width;
+                    _header->DamageHeight = height;
+                }
+            }
+            ~Buffer()
+            {
+            }
+
+        public:
+            inline bool IsValid() const
+            {
+                return (_header != nullptr);
+            }
+            inline uint32_t Width() const
+            {
+                return (_width);
+            }
+            inline uint32_t Height() const
+            {
+                return (_height);
+            }
+            inline uint32_t Stride() const
+            {
+                return (_stride);
+            }
+            // The client changed the dimensions, the buffer needs to be mapped again.
+            inline bool IsCurrent() const
+            {
+                return ((_header->Width == _width) && (_header->Height == _height) && (_header->Stride == _stride));
+            }
+            inline uint32_t Sequence() const
+            {
+                return (_header->Sequence.load(std::memory_order_acquire));
+            }
+            // What the client reports, clamped to the buffer as it was mapped.
+            inline Exchange::IComposition::Rectangle Damage() const
+            {
+                Exchange::IComposition::Rectangle result;
+                const uint32_t x = std::min(static_cast<uint32_t>(_header->DamageX), _width);
+                const uint32_t y = std::min(static_cast<uint32_t>(_header->DamageY), _height);
+                const uint32_t width = _header->DamageWidth;
+                const uint32_t height = _header->DamageHeight;
+
+                result.x = x;
+                result.y = y;
+                result.width = std::min(width, _width - x);
+                result.height = std::min(height, _height - y);
+
+                return (result);
+            }
+            // Readers of the output do not copy the pixels while a frame is in between these two.
+            inline void Started()
+            {
+                _header->BeginWrite();
+            }
+            inline void Completed(const Exchange::IComposition::Rectangle& damage)
+            {
+                _header->DamageX = damage.x;
+                _header->DamageY = damage.y;
+                _header->DamageWidth = damage.width;
+                _header->DamageHeight = damage.height;
+                _header->EndWrite();
+            }
+            inline uint32_t* Pixels()
+            {
+                return (reinterpret_cast<uint32_t*>(&(_file.Buffer()[sizeof(BufferHeader)])));
+            }
+            inline const uint32_t* Pixels() const
+            {
+                return (reinterpret_cast<const uint32_t*>(&(_file.Buffer()[sizeof(BufferHeader)])));
+            }
+
+        private:
+            Core::DataElementFile _file;
+            BufferHeader* _header;
+            uint32_t _width;
+            uint32_t _height;
+            uint32_t _stride; // in pixels
+        };
+
+        // Stands in for the client towards the observers. The geometry and z-order are kept here when
+        // they are set, so composing a frame does not need to call out to the client.
+        class Client : public Exchange::IComposition::IClient {
+        private:
+            Client() = delete;
+            Client(const Client&) = delete;
+            Client& operator=(const Client&) = delete;
+
+        public:
+            Client(CompositorImplementation& parent, Exchange::IComposition::IClient* remote, const string& name, const Exchange::IComposition::Rectangle& rectangle, const uint16_t layer)
+                : _parent(parent)
+                , _remote(remote)
+                , _name(name)
+                , _rectangle(rectangle)
+                , _layer(layer)
+            {
+                ASSERT(_remote != nullptr);
+                _remote->AddRef();
+            }
+            ~Client() override
+            {
+                _remote->Release();
+            }
+
+        public:
+            inline const Exchange::IComposition::IClient* Remote() const
+            {
+                return (_remote);
+            }
+
+            string Name() const override
+            {
+                return (_name);
+            }
+            void Opacity(const uint32_t value) override
+            {
+                _remote->Opacity(value);
+            }
+            uint32_t Geometry(const Exchange::IComposition::Rectangle& rectangle) override
+            {
+                _parent._adminLock.Lock();
+                _rectangle = rectangle;
+                _parent._adminLock.Unlock();
+
+                // Let the client know as well, but not while holding up the composition.
+                return (_remote->Geometry(rectangle));
+            }
+            Exchange::IComposition::Rectangle Geometry() const override
+            {
+                _parent._adminLock.Lock();
+                const Exchange::IComposition::Rectangle result(_rectangle);
+                _parent._adminLock.Unlock();
+
+                return (result);
+            }
+            uint32_t ZOrder(const uint16_t index) override
+            {
+                _parent._adminLock.Lock();
+                _layer = index;
+                _parent._adminLock.Unlock();
+
+                return (_remote->ZOrder(index));
+            }
+            uint32_t ZOrder() const override
+            {
+                _parent._adminLock.Lock();
+                const uint16_t result(_layer);
+                _parent._adminLock.Unlock();
+
+                return (result);
+            }
+
+            BEGIN_INTERFACE_MAP(Client)
+            INTERFACE_ENTRY(Exchange::IComposition::IClient)
+            END_INTERFACE_MAP
+
+        private:
+            CompositorImplementation& _parent;
+            Exchange::IComposition::IClient* _remote;
+            const string _name;
+            Exchange::IComposition::Rectangle _rectangle;
+            uint16_t _layer;
+        };
+
+    public:
+        CompositorImplementation()
+            : _adminLock()
+            , _service(nullptr)
+            , _engine()
+            , _externalAccess(nullptr)
+            , _observers()
+            , _clients()
+            , _composer(*this)
+            , _bufferPath()
+            , _resolution(Exchange::IComposition::ScreenResolution_720p)
+            , _output(nullptr)
+            , _composition()
+            , _interval(0)
+            , _frames(0)
+            , _pixels(0)
+            , _composing(0)
+            , _reported(0)
+        {
+        }
+
+        ~CompositorImplementation()
+        {
+            _composer.Block();
+            _composer.Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+
+            if (_externalAccess != nullptr) {
+                delete _externalAccess;
+                _engine.Release();
+            }
+
+            if (_output != nullptr) {
+                delete _output;
+            }
+        }
+
+        BEGIN_INTERFACE_MAP(CompositorImplementation)
+        INTERFACE_ENTRY(Exchange::IComposition)
+        END_INTERFACE_MAP
+
+    private:
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+        public:
+            Config()
+                : Core::JSON::Container()
+                , Connector(_T("/tmp/compositor"))
+                , Buffers(_T("/tmp/compositorbuffers/"))
+                , Resolution(Exchange::IComposition::ScreenResolution::ScreenResolution_720p)
+                , FrameRate(60)
+            {
+                Add(_T("connector"), &Connector);
+                Add(_T("buffers"), &Buffers);
+                Add(_T("resolution"), &Resolution);
+                Add(_T("framerate"), &FrameRate);
+            }
+
+            ~Config()
+            {
+            }
+
+        public:
+            Core::JSON::String Connector;
+            Core::JSON::String Buffers;
+            Core::JSON::EnumType<Exchange::IComposition::ScreenResolution> Resolution;
+            Core::JSON::DecUInt8 FrameRate;
+        };
+
+        struct ClientData {
+            ClientData()
+                : currentRectangle()
+                , clientInterface(nullptr)
+                , buffer(nullptr)
+                , sequence(0)
+                , zorder(~0)
+            {
+            }
+            ClientData(Client* client, Exchange::IComposition::ScreenResolution resolution)
+                : currentRectangle()
+                , clientInterface(client)
+                , buffer(nullptr)
+                , sequence(0)
+                , zorder(~0)
+            {
+                clientInterface->AddRef();
+                currentRectangle.x = 0;
+                currentRectangle.y = 0;
+                currentRectangle.width = Exchange::IComposition::WidthFromResolution(resolution);
+                currentRectangle.height = Exchange::IComposition::HeightFromResolution(resolution);
+            }
+            ~ClientData() {
+                if (clientInterface != nullptr) {
+                    clientInterface->Release();
+                }
+                if (buffer != nullptr) {
+                    delete buffer;
+                }
+            }
+
+            Exchange::IComposition::Rectangle currentRectangle;
+            Client* clientInterface;
+            Buffer* buffer;
+            uint32_t sequence;
+            uint32_t zorder;
+        };
+
+    public:
+        uint32_t Configure(PluginHost::IShell* service) override
+        {
+            uint32_t result = Core::ERROR_NONE;
+            _service = service;
+
+            Config config;
+            config.FromString(service->ConfigLine());
+
+            _bufferPath = Core::Directory::Normalize(config.Buffers.Value());
+            _resolution = config.Resolution.Value();
+            _interval = 1000 / (config.FrameRate.Value() == 0 ? 1 : config.FrameRate.Value());
+
+            if (Core::Directory(_bufferPath.c_str()).CreatePath() == false) {
+                TRACE(Trace::Error, (_T("Could not create the buffer directory %s"), _bufferPath.c_str()));
+                result = Core::ERROR_OPENING_FAILED;
+            } else {
+                _output = new Buffer(_bufferPath + _T("output"), Exchange::IComposition::WidthFromResolution(_resolution), Exchange::IComposition::HeightFromResolution(_resolution));
+
+                if (_output->IsValid() == true) {
+                    _composition.Output(_output->Pixels(), _output->Width(), _output->Height(), _output->Stride());
+                }
+
+                _engine = Core::ProxyType<RPC::InvokeServer>::Create(&Core::IWorkerPool::Instance());
+                _externalAccess = new ExternalAccess(*this, Core::NodeId(config.Connector.Value().c_str()), service->ProxyStubPath(), _engine);
+
+                if (_externalAccess->IsListening() == true) {
+                    PlatformReady();
+                    _composer.Run();
+                } else {
+                    delete _externalAccess;
+                    _externalAccess = nullptr;
+                    _engine.Release();
+                    TRACE(Trace::Error, (_T("Could not report PlatformReady as there was a problem starting the Compositor RPC %s"), _T("server")));
+                    result = Core::ERROR_OPENING_FAILED;
+                }
+            }
+            return result;
+        }
+
+        void Register(Exchange::IComposition::INotification* notification) override
+        {
+            _adminLock.Lock();
+            ASSERT(std::find(_observers.begin(),
+                       _observers.end(), notification)
+                == _observers.end());
+            notification->AddRef();
+            _observers.push_back(notification);
+            auto index(_clients.begin());
+            while (index != _clients.end()) {
+                notification->Attached(index->first, index->second.clientInterface);
+                index++;
+            }
+            _adminLock.Unlock();
+        }
+
+        void Unregister(Exchange::IComposition::INotification* notification) override
+        {
+            _adminLock.Lock();
+            std::list<Exchange::IComposition::INotification*>::iterator index(
+                std::find(_observers.begin(), _observers.end(), notification));
+            ASSERT(index != _observers.end());
+            if (index != _observers.end()) {
+                _observers.erase(index);
+                notification->Release();
+            }
+            _adminLock.Unlock();
+        }
+
+    public:
+        uint32_t Resolution(const Exchange::IComposition::ScreenResolution format) override
+        {
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+            const uint32_t width = Exchange::IComposition::WidthFromResolution(format);
+            const uint32_t height = Exchange::IComposition::HeightFromResolution(format);
+
+            if ((width != 0) && (height != 0)) {
+                _adminLock.Lock();
+
+                if (_output != nullptr) {
+                    delete _output;
+                }
+
+                _output = new Buffer(_bufferPath + _T("output"), width, height);
+                _resolution = format;
+                _composition.Output(nullptr, 0, 0, 0);
+
+                if (_output->IsValid() == true) {
+                    Exchange::IComposition::Rectangle everything;
+                    everything.x = 0;
+                    everything.y = 0;
+                    everything.width = width;
+                    everything.height = height;
+
+                    // Everything needs to be composed again.
+                    _composition.Output(_output->Pixels(), width, height, width);
+                    _composition.Damage(everything);
+                    result = Core::ERROR_NONE;
+                }
+
+                _adminLock.Unlock();
+            }
+
+            return (result);
+        }
+
+        Exchange::IComposition::ScreenResolution Resolution() const override
+        {
+            return (_resolution);
+        }
+
+    private:
+        using ClientDataContainer = std::map<string, ClientData>;
+        using ConstClientDataIterator = ClientDataContainer::const_iterator;
+
+        void NewClientOffered(Exchange::IComposition::IClient* client)
+        {
+            ASSERT(client != nullptr);
+            if (client != nullptr) {
+
+                const string name(client->Name());
+                if (name.empty() == true) {
+                    ASSERT(false);
+                    TRACE(Trace::Information, (_T("Registration of a nameless client.")));
+                } else {
+                    // Ask for the geometry only once, from here on it is tracked by the Client.
+                    const Exchange::IComposition::Rectangle rectangle(client->Geometry());
+                    const uint16_t layer(client->ZOrder());
+                    Client* entry = Core::Service<Client>::Create<Client>(*this, client, name, rectangle, layer);
+
+                    _adminLock.Lock();
+
+                    ClientDataContainer::iterator element (_clients.find(name));
+
+                    if (element != _clients.end()) {
+                        // as the old one may be dangling becayse of a crash let's remove that one, this is the most logical thing to do
+                        ClientRevoked(element->second.clientInterface->Remote());
+
+                        TRACE(Trace::Information, (_T("Replace client %s."), name.c_str()));
+                    }
+                    else {
+                        TRACE(Trace::Information, (_T("Added client %s."), name.c_str()));
+
+                    }
+
+                    _clients.emplace(std::piecewise_construct,
+                                         std::forward_as_tuple(name),
+                                         std::forward_as_tuple(entry, Resolution()));
+
+                    for (auto&& index : _observers) {
+                        index->Attached(name, entry);
+                    }
+
+                    _adminLock.Unlock();
+
+                    entry->Release();
+                }
+            }
+        }
+
+        void ClientRevoked(const IUnknown* client)
+        {
+            // note do not release by looking up the name, client might live in another process and the name call might fail if the connection is gone
+            ASSERT(client != nullptr);
+
+            _adminLock.Lock();
+            auto it = _clients.begin();
+            while ( (it != _clients.end()) && (it->second.clientInterface->Remote() != client) ) { ++it; }
+
+            if (it != _clients.end()) {
+                string name (it->first);
+                TRACE(Trace::Information, (_T("Remove client %s."), name.c_str()));
+                for (auto index : _observers) {
+                    index->Detached(name.c_str());
+                }
+
+                if (it->second.buffer != nullptr) {
+                    // What was behind this client needs to be composed again.
+                    _composition.Damage(it->second.currentRectangle);
+                }
+
+                _clients.erase(it);
+            }
+
+            _adminLock.Unlock();
+
+            TRACE(Trace::Information, (_T("Client detached completed")));
+        }
+
+        void PlatformReady()
+        {
+            PluginHost::ISubSystem* subSystems(_service->SubSystems());
+            ASSERT(subSystems != nullptr);
+            if (subSystems != nullptr) {
+                subSystems->Set(PluginHost::ISubSystem::PLATFORM, nullptr);
+                subSystems->Set(PluginHost::ISubSystem::GRAPHICS, nullptr);
+                subSystems->Release();
+            }
+        }
+
+        // Runs on the composer thread, returns the time to wait for the next frame.
+        uint32_t Compose()
+        {
+            const uint64_t start = Core::Time::Now().Ticks();
+
+            _adminLock.Lock();
+
+            if ((_output != nullptr) && (_output->IsValid() == true)) {
+                std::list<Software::Composition::Layer> layers;
+
+                // Find out what changed since the previous frame.
+                for (std::pair<const string, ClientData>& entry : _clients) {
+                    ClientData& client(entry.second);
+                    const Exchange::IComposition::Rectangle geometry(client.clientInterface->Geometry());
+                    const uint32_t zorder(client.clientInterface->ZOrder());
+
+                    if ((client.buffer != nullptr) && (client.buffer->IsCurrent() == false)) {
+                        // The client resized its buffer, map it again.
+                        _composition.Damage(client.currentRectangle);
+                        delete client.buffer;
+                        client.buffer = nullptr;
+                    }
+
+                    if (client.buffer == nullptr) {
+                        client.buffer = new Buffer(_bufferPath + entry.first);
+
+                        if (client.buffer->IsValid() == false) {
+                            // Not rendered anything yet, try again next frame.
+                            delete client.buffer;
+                            client.buffer = nullptr;
+                        } else {
+                            client.sequence = client.buffer->Sequence();
+                            client.currentRectangle = geometry;
+                            client.zorder = zorder;
+                            _composition.Damage(geometry);
+                        }
+                    } else if ((Software::Composition::SameRectangle(geometry, client.currentRectangle) == false) || (zorder != client.zorder)) {
+                        _composition.Damage(client.currentRectangle);
+                        _composition.Damage(geometry);
+                        client.currentRectangle = geometry;
+                        client.zorder = zorder;
+                        client.sequence = client.buffer->Sequence();
+                    } else if (client.sequence != client.buffer->Sequence()) {
+                        // Map the damage of the client to the output.
+                        const Exchange::IComposition::Rectangle damage(client.buffer->Damage());
+                        Exchange::IComposition::Rectangle mapped;
+
+                        mapped.x = geometry.x + static_cast<int32_t>((static_cast<uint64_t>(damage.x) * geometry.width) / client.buffer->Width());
+                        mapped.y = geometry.y + static_cast<int32_t>((static_cast<uint64_t>(damage.y) * geometry.height) / client.buffer->Height());
+                        mapped.width = static_cast<uint32_t>(((static_cast<uint64_t>(damage.width) * geometry.width) + client.buffer->Width() - 1) / client.buffer->Width()) + 1;
+                        mapped.height = static_cast<uint32_t>(((static_cast<uint64_t>(damage.height) * geometry.height) + client.buffer->Height() - 1) / client.buffer->Height()) + 1;
+
+                        client.sequence = client.buffer->Sequence();
+                        _composition.Damage(mapped);
+                    }
+
+                    if (client.buffer != nullptr) {
+                        const Buffer& buffer(*client.buffer);
+                        layers.push_back({ buffer.Pixels(), buffer.Width(), buffer.Height(), buffer.Stride(), client.currentRectangle, client.zorder });
+                    }
+                }
+
+                if (_composition.IsDamaged() == true) {
+                    uint64_t pixels;
+
+                    _output->Started();
+                    _output->Completed(_composition.Render(layers, pixels));
+                    _pixels += pixels;
+                    _frames++;
+                    _composing += (Core::Time::Now().Ticks() - start);
+                }
+            }
+
+            _adminLock.Unlock();
+
+            const uint64_t now = Core::Time::Now().Ticks();
+
+            if (_reported == 0) {
+                _reported = now;
+            } else if ((now - _reported) >= (ReportInterval * Core::Time::TicksPerMillisecond)) {
+                const uint32_t elapsed = static_cast<uint32_t>((now - _reported) / Core::Time::TicksPerMillisecond);
+
+                TRACE(Trace::Information, (_T("Composed %d frames/s, %d uS per frame, %d pixels per frame"),
+                    (_frames * 1000) / elapsed,
+                    (_frames != 0 ? static_cast<uint32_t>(_composing / _frames) : 0),
+                    (_frames != 0 ? static_cast<uint32_t>(_pixels / _frames) : 0)));
+
+                _reported = now;
+                _frames = 0;
+                _pixels = 0;
+                _composing = 0;
+            }
+
+            const uint32_t spent = static_cast<uint32_t>((now - start) / Core::Time::TicksPerMillisecond);
+
+            return (spent < _interval ? (_interval - spent) : 0);
+        }
+
+        mutable Core::CriticalSection _adminLock;
+        PluginHost::IShell* _service;
+        Core::ProxyType<RPC::InvokeServer> _engine;
+        ExternalAccess* _externalAccess;
+        std::list<Exchange::IComposition::INotification*> _observers;
+        ClientDataContainer _clients;
+        Composer _composer;
+        string _bufferPath;
+        Exchange::IComposition::ScreenResolution _resolution;
+        Buffer* _output;
+        Software::Composition _composition;
+        uint32_t _interval;
+        uint32_t _frames;
+        uint64_t _pixels;
+        uint64_t _composing;
+        uint64_t _reported;
+    };
+
+    SERVICE_REGISTRATION(CompositorImplementation, 1, 0);
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,172 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Composition.h"
+
+// Frames/sec of the software compositor over the number of clients and the output resolution:
+//
+//    SoftwareCompositorBenchmark -duration 2
+//
+// All clients cover the full screen: the bottom one is opaque, the others are translucent and
+// every other one renders at half the resolution, so it is scaled up. A full frame has every
+// client damage all of its buffer, a partial frame has every client damage a 256x144 box. The
+// results are printed as JSON.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+static constexpr uint8_t Clients[] = { 1, 2, 4, 8 };
+static constexpr Exchange::IComposition::ScreenResolution Resolutions[] = {
+    Exchange::IComposition::ScreenResolution_720p,
+    Exchange::IComposition::ScreenResolution_1080p60Hz,
+    Exchange::IComposition::ScreenResolution_2160p60Hz
+};
+
+class Client {
+public:
+    Client() = delete;
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    Client(const uint32_t width, const uint32_t height, const uint32_t screenWidth, const uint32_t screenHeight, const uint8_t index)
+        : _pixels(static_cast<size_t>(width) * height)
+        , _layer()
+    {
+        // Premultiplied, the bottom one opaque, the others at 3/4 alpha.
+        const uint32_t alpha = (index == 0 ? 0xFF : 0xC0);
+
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                const uint32_t red = (((x + (index * 32)) & 0xFF) * alpha) / 0xFF;
+                const uint32_t green = ((y & 0xFF) * alpha) / 0xFF;
+                const uint32_t blue = (((x ^ y) & 0xFF) * alpha) / 0xFF;
+                _pixels[(y * width) + x] = (alpha << 24) | (red << 16) | (green << 8) | blue;
+            }
+        }
+
+        _layer.Pixels = _pixels.data();
+        _layer.Width = width;
+        _layer.Height = height;
+        _layer.Stride = width;
+        _layer.Geometry.x = 0;
+        _layer.Geometry.y = 0;
+        _layer.Geometry.width = screenWidth;
+        _layer.Geometry.height = screenHeight;
+        _layer.ZOrder = index;
+    }
+    ~Client()
+    {
+    }
+
+public:
+    const Software::Composition::Layer& Layer() const
+    {
+        return (_layer);
+    }
+
+private:
+    std::vector<uint32_t> _pixels;
+    Software::Composition::Layer _layer;
+};
+
+double FramesPerSecond(const Exchange::IComposition::ScreenResolution resolution, const uint8_t count, const bool partial, const uint16_t duration)
+{
+    const uint32_t width = Exchange::IComposition::WidthFromResolution(resolution);
+    const uint32_t height = Exchange::IComposition::HeightFromResolution(resolution);
+    std::vector<uint32_t> output(static_cast<size_t>(width) * height);
+    std::list<Client> clients;
+    Software::Composition composition;
+
+    for (uint8_t index = 0; index < count; index++) {
+        const uint8_t shift = (((index & 1) == 1) ? 1 : 0);
+        clients.emplace_back((width >> shift), (height >> shift), width, height, index);
+    }
+
+    composition.Output(output.data(), width, height, width);
+
+    const uint64_t start = Core::Time::Now().Ticks();
+    const uint64_t end = start + (static_cast<uint64_t>(duration) * Core::Time::TicksPerMillisecond * 1000);
+    uint32_t frames = 0;
+    uint64_t now = start;
+
+    while (now < end) {
+        std::list<Software::Composition::Layer> layers;
+        uint8_t index = 0;
+        uint64_t pixels;
+
+        for (const Client& client : clients) {
+            Exchange::IComposition::Rectangle damage(client.Layer().Geometry);
+
+            if (partial == true) {
+                // Every client updates its own box, wandering over the screen.
+                damage.width = 256;
+                damage.height = 144;
+                damage.x = ((frames * 8) + (index * 160)) % (width - damage.width);
+                damage.y = ((frames * 4) + (index * 90)) % (height - damage.height);
+            }
+
+            composition.Damage(damage);
+            layers.push_back(client.Layer());
+            index++;
+        }
+
+        composition.Render(layers, pixels);
+        frames++;
+        now = Core::Time::Now().Ticks();
+    }
+
+    return ((frames * 1000000.0) / (now - start));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    uint16_t duration = 2; // seconds, per measurement
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-duration") == 0) {
+            duration = static_cast<uint16_t>(std::max(1, atoi(argv[index + 1])));
+        }
+    }
+
+    printf("[\n");
+
+    for (uint8_t resolution = 0; resolution < (sizeof(Resolutions) / sizeof(Resolutions[0])); resolution++) {
+        for (uint8_t client = 0; client < sizeof(Clients); client++) {
+            const double full = FramesPerSecond(Resolutions[resolution], Clients[client], false, duration);
+            const double partial = FramesPerSecond(Resolutions[resolution], Clients[client], true, duration);
+            const bool last = (((resolution + 1) == (sizeof(Resolutions) / sizeof(Resolutions[0]))) && ((client + 1) == sizeof(Clients)));
+
+            printf("  { \"width\": %u, \"height\": %u, \"clients\": %u, \"full\": %.1f, \"partial\": %.1f }%s\n",
+                Exchange::IComposition::WidthFromResolution(Resolutions[resolution]),
+                Exchange::IComposition::HeightFromResolution(Resolutions[resolution]),
+                Clients[client], full, partial, (last == true ? "" : ","));
+        }
+    }
+
+    printf("]\n");
+
+    Core::Singleton::Dispose();
+
+    return (0);
+}
@@ -21,55 +21,442 @@
 
 #include "Module.h"
 
+#include <curl/curl.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace WPEFramework {
 
 struct INotifier {
     virtual ~INotifier() {}
     virtual void NotifyDownloadStatus(const uint32_t status) = 0;
+    virtual void NotifyDownloadProgress(const uint16_t percentage) = 0;
 };
 
 namespace PluginHost {
 
-    class DownloadEngine : public Web::ClientTransferType<Core::SocketStream, Web::SignedFileBodyType<Crypto::SHA256>> {
+    // The image is fetched in chunks with HTTP Range requests, over a number of connections in
+    // parallel. Chunks are written in place in the storage file and every completed chunk is
+    // recorded in a checkpoint file next to it, so an interrupted download resumes with the
+    // chunks still missing. The SHA256 is calculated while downloading, over the part of the image
+    // that is complete from the start, so the hash is known as soon as the last chunk is in.
+    // Optionally the image is streamed to the installer through a FIFO instead of it reading the
+    // storage file. Nothing is written to the FIFO before the hash of the full image is verified,
+    // an image that does not match ends the input of the installer without a single byte.
+    class DownloadEngine {
+    public:
+        struct Settings {
+            Settings()
+                : ChunkSize(1024 * 1024)
+                , Connections(4)
+                , Retries(3)
+                , Stream()
+            {
+            }
+
+            uint32_t ChunkSize;
+            uint8_t Connections;
+            uint8_t Retries; // per chunk
+            string Stream; // FIFO to feed the verified image to, empty if not streaming
+        };
+
     private:
-        typedef Web::ClientTransferType<Core::SocketStream, Web::SignedFileBodyType<Crypto::SHA256>> BaseClass;
+        static constexpr uint32_t Magic = 0x4C444657; // 'FWDL'
+        static constexpr uint16_t Version = 1;
+        static constexpr uint32_t SocketTimeout = 10; // seconds
+        static constexpr uint32_t BlockSize = 32 * 1024;
+        static constexpr uint64_t NoRange = ~0ULL;
+
+        enum state : uint8_t {
+            PENDING = 0,
+            DONE = 1,
+            BUSY = 2
+        };
+
+        struct Checkpoint {
+            uint32_t Magic;
+            uint16_t Version;
+            uint16_t Reserved;
+            uint64_t Size;
+            uint32_t ChunkSize;
+            uint32_t Chunks;
+            uint32_t Source; // hash of the locator and the expected image hash
+            uint32_t Padding;
+            char Tag[64]; // ETag of the image, if the server gave one
+        };
+
+        struct Response {
+            uint16_t Code;
+            uint64_t Length;
+            uint64_t Total;
+            string Tag;
+        };
+
+        // A libcurl handle for (ranged) GETs, reused so the connection is kept alive between the
+        // chunks. The body goes straight to the storage file.
+        class Connection {
+        public:
+            Connection(const Connection&) = delete;
+            Connection& operator=(const Connection&) = delete;
+
+            Connection()
+                : _handle(curl_easy_init())
+                , _aborted(false)
+                , _response(nullptr)
+                , _file(-1)
+                , _offset(0)
+                , _remaining(0)
+                , _overflow(false)
+            {
+            }
+            ~Connection()
+            {
+                if (_handle != nullptr) {
+                    curl_easy_cleanup(_handle);
+                }
+            }
+
+        public:
+            // Gets the bytes from-to of the resource, or all of it without a from, and writes the
+            // body in the file, starting at offset. The body may not be larger than length, without
+            // a file it is dropped (to learn about the resource from the headers only).
+            uint32_t Get(const string& locator, const uint64_t from, const uint64_t to, Response& response, const int file, const uint64_t offset, const uint64_t length)
+            {
+                uint32_t result = Core::ERROR_UNAVAILABLE;
+
+                if (_handle != nullptr) {
+                    curl_easy_reset(_handle);
+                    curl_easy_setopt(_handle, CURLOPT_URL, locator.c_str());
+                    curl_easy_setopt(_handle, CURLOPT_USERAGENT, _T("WPEFramework-FirmwareControl"));
+                    curl_easy_setopt(_handle, CURLOPT_FOLLOWLOCATION, 1L);
+                    curl_easy_setopt(_handle, CURLOPT_NOSIGNAL, 1L);
+                    curl_easy_setopt(_handle, CURLOPT_FAILONERROR, 1L);
+                    curl_easy_setopt(_handle, CURLOPT_CONNECTTIMEOUT, static_cast<long>(SocketTimeout));
+                    curl_easy_setopt(_handle, CURLOPT_LOW_SPEED_LIMIT, 1L);
+                    curl_easy_setopt(_handle, CURLOPT_LOW_SPEED_TIME, static_cast<long>(SocketTimeout));
+                    curl_easy_setopt(_handle, CURLOPT_HEADERFUNCTION, &Connection::Header);
+                    curl_easy_setopt(_handle, CURLOPT_HEADERDATA, this);
+                    curl_easy_setopt(_handle, CURLOPT_WRITEFUNCTION, &Connection::Write);
+                    curl_easy_setopt(_handle, CURLOPT_WRITEDATA, this);
+                    curl_easy_setopt(_handle, CURLOPT_NOPROGRESS, 0L);
+                    curl_easy_setopt(_handle, CURLOPT_XFERINFOFUNCTION, &Connection::Progress);
+                    curl_easy_setopt(_handle, CURLOPT_XFERINFODATA, this);
+
+                    string range;
+                    if (from != NoRange) {
+                        range = Core::NumberType<uint64_t>(from).Text() + '-' + Core::NumberType<uint64_t>(to).Text();
+                        curl_easy_setopt(_handle, CURLOPT_RANGE, range.c_str());
+                    }
+
+                    response.Code = 0;
+                    response.Length = NoRange;
+                    response.Total = NoRange;
+                    response.Tag.clear();
+
+                    _response = &response;
+                    _file = file;
+                    _offset = offset;
+                    _remaining = length;
+                    _overflow = false;
+
+                    const CURLcode code = curl_easy_perform(_handle);
+
+                    long status = 0;
+                    curl_easy_getinfo(_handle, CURLINFO_RESPONSE_CODE, &status);
+                    response.Code = static_cast<uint16_t>(status);
+
+                    if (code == CURLE_OK) {
+                        result = Core::ERROR_NONE;
+                    } else if ((code == CURLE_WRITE_ERROR) && (_overflow == true)) {
+                        // More body than asked for, fine if it is dropped anyway.
+                        result = (file == -1 ? Core::ERROR_NONE : Core::ERROR_INCORRECT_HASH);
+                    } else if (code == CURLE_WRITE_ERROR) {
+                        result = Core::ERROR_WRITE_ERROR;
+                    } else if (code == CURLE_ABORTED_BY_CALLBACK) {
+                        result = Core::ERROR_ASYNC_ABORTED;
+                    } else if ((code == CURLE_OPERATION_TIMEDOUT) || (code == CURLE_PARTIAL_FILE)) {
+                        result = Core::ERROR_TIMEDOUT;
+                    } else {
+                        TRACE_L1("Fetching %s failed: %s", locator.c_str(), curl_easy_strerror(code));
+                        result = Core::ERROR_ASYNC_FAILED;
+                    }
+
+                    if ((result == Core::ERROR_NONE) && (file != -1) && (_remaining != 0)) {
+                        result = Core::ERROR_INCORRECT_HASH;
+                    }
+
+                    _response = nullptr;
+                }
+
+                return (result);
+            }
+            // Can be called from another thread, to break a blocking transfer.
+            void Abort()
+            {
+                _aborted = true;
+            }
+
+        private:
+            static size_t Write(char* buffer, size_t size, size_t count, void* data)
+            {
+                Connection& connection = *static_cast<Connection*>(data);
+                const size_t length = size * count;
+                size_t result = 0;
+
+                if (length > connection._remaining) {
+                    connection._overflow = true;
+                } else if (connection._file == -1) {
+                    connection._remaining -= length;
+                    result = length;
+                } else if (::pwrite(connection._file, buffer, length, connection._offset) == static_cast<ssize_t>(length)) {
+                    connection._offset += length;
+                    connection._remaining -= length;
+                    result = length;
+                }
+
+                return (result);
+            }
+            static size_t Header(char* buffer, size_t size, size_t count, void* data)
+            {
+                Response& response = *static_cast<Connection*>(data)->_response;
+                const size_t length = size * count;
+                const string line(buffer, length);
+                const size_t colon = line.find(':');
+
+                if (line.compare(0, 5, _T("HTTP/")) == 0) {
+                    // A new response, e.g. after a redirect, forget about the previous one.
+                    response.Length = NoRange;
+                    response.Total = NoRange;
+                    response.Tag.clear();
+                } else if (colon != string::npos) {
+                    const string name(line, 0, colon);
+                    string value(line, colon + 1);
+
+                    value.erase(0, value.find_first_not_of(_T(" \t")));
+                    value.erase(value.find_last_not_of(_T(" \t\r\n")) + 1);
+
+                    if (::strcasecmp(name.c_str(), _T("Content-Length")) == 0) {
+                        response.Length = ::strtoull(value.c_str(), nullptr, 10);
+                    } else if (::strcasecmp(name.c_str(), _T("Content-Range")) == 0) {
+                        // bytes <first>-<last>/<total>
+                        const size_t slash = value.find('/');
+                        if ((slash != string::npos) && (value.compare(slash + 1, 1, _T("*")) != 0)) {
+                            response.Total = ::strtoull(&(value[slash + 1]), nullptr, 10);
+                        }
+                    } else if (::strcasecmp(name.c_str(), _T("ETag")) == 0) {
+                        response.Tag = value;
+                    }
+                }
+
+                return (length);
+            }
+            static int Progress(void* data, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+            {
+                return (static_cast<Connection*>(data)->_aborted == true ? 1 : 0);
+            }
+
+        private:
+            CURL* _handle;
+            std::atomic<bool> _aborted;
+            Response* _response;
+            int _file;
+            uint64_t _offset;
+            uint64_t _remaining;
+            bool _overflow;
+        };
+
+        class Fetcher : public Core::Thread {
+        public:
+            Fetcher() = delete;
+            Fetcher(const Fetcher&) = delete;
+            Fetcher& operator=(const Fetcher&) = delete;
+
+            Fetcher(DownloadEngine& parent)
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("FirmwareFetcher"))
+                , _parent(parent)
+                , _connection()
+            {
+            }
+            ~Fetcher() override
+            {
+                Stop();
+                _connection.Abort();
+                Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+            }
+
+        public:
+            void Abort()
+            {
+                _connection.Abort();
+            }
+
+        private:
+            uint32_t Worker() override
+            {
+                uint32_t index;
+
+                if ((IsRunning() == true) && (_parent.Next(index) == true)) {
+                    uint32_t result = Core::ERROR_NONE;
+                    uint8_t attempt = 0;
+
+                    do {
+                        if (attempt > 0) {
+                            TRACE(Trace::Information, (_T("Retrying chunk %d, attempt %d [%d]"), index, attempt, result));
+                            SleepMs(250 * attempt);
+                        }
+                        result = _parent.Fetch(_connection, index);
+                        attempt++;
+                    } while ((result != Core::ERROR_NONE) && (IsRunning() == true) && (_parent.IsAborted() == false) && (attempt <= _parent.Retries()));
+
+                    _parent.Fetched(index, result);
+
+                    return (0);
+                }
+
+                Block();
+
+                return (Core::infinite);
+            }
+
+        private:
+            DownloadEngine& _parent;
+            Connection _connection;
+        };
+
+        class Verifier : public Core::Thread {
+        public:
+            Verifier() = delete;
+            Verifier(const Verifier&) = delete;
+            Verifier& operator=(const Verifier&) = delete;
+
+            Verifier(DownloadEngine& parent)
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("FirmwareVerifier"))
+                , _parent(parent)
+            {
+            }
+            ~Verifier() override
+            {
+                Stop();
+                _parent._progress.SetEvent();
+                Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+            }
+
+        private:
+            uint32_t Worker() override
+            {
+                _parent.Verify();
+                Block();
+
+                return (Core::infinite);
+            }
+
+        private:
+            DownloadEngine& _parent;
+        };
 
         DownloadEngine() = delete;
         DownloadEngine(const DownloadEngine&) = delete;
         DownloadEngine& operator=(const DownloadEngine&) = delete;
 
     public:
-        DownloadEngine(INotifier* notifier, const string& downloadStorage)
-            : BaseClass(false, Core::NodeId(_T("0.0.0.0")), Core::NodeId(), 1024, ((64 * 1024) - 1))
+        DownloadEngine(INotifier* notifier, const string& downloadStorage, const Settings& settings = Settings())
+            : _adminLock()
             , _notifier(notifier)
-            , _storage(downloadStorage.c_str(), false)
+            , _settings(settings)
+            , _storageName(downloadStorage)
+            , _locator()
+            , _hash()
+            , _storage(-1)
+            , _checkpoint(-1)
+            , _stream(-1)
+            , _ranges(false)
+            , _size(0)
+            , _chunkSize(0)
+            , _chunks()
+            , _verified(0)
+            , _result(Core::ERROR_NONE)
+            , _aborted(false)
+            , _progress(false, true)
+            , _fetchers()
+            , _verifier(*this)
         {
+            if (_settings.ChunkSize < BlockSize) {
+                _settings.ChunkSize = BlockSize;
+            }
+            if (_settings.Connections == 0) {
+                _settings.Connections = 1;
+            }
         }
         virtual ~DownloadEngine()
         {
+            _adminLock.Lock();
+            _aborted = true;
+            for (Fetcher* fetcher : _fetchers) {
+                fetcher->Abort();
+            }
+            _adminLock.Unlock();
+
+            for (Fetcher* fetcher : _fetchers) {
+                delete fetcher;
+            }
+            _verifier.Stop();
+            _progress.SetEvent();
+            _verifier.Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+            CloseFiles();
         }
 
     public:
+        // Once per process, before the first and after the last engine.
+        static void Initialize()
+        {
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+        }
+        static void Deinitialize()
+        {
+            curl_global_cleanup();
+        }
+
         uint32_t Start(const string& locator, const string& destination, const string& hash)
         {
             Core::URL url(locator);
-            uint32_t result = (url.IsValid() == true ? Core::ERROR_INPROGRESS : Core::ERROR_INCORRECT_URL);
+            uint32_t result = (((url.IsValid() == true) && (url.Host().IsSet() == true)) ? Core::ERROR_INPROGRESS : Core::ERROR_INCORRECT_URL);
 
             if (result == Core::ERROR_INPROGRESS) {
 
                 _adminLock.Lock();
 
-                CleanupStorage();
+                if (_storage != -1) {
+                    result = Core::ERROR_INPROGRESS;
+                } else {
+                    _locator = locator;
+                    _hash = hash;
 
-                if (_storage.IsOpen() == false) {
+                    Response response;
+                    result = Probe(response);
 
-                    result = Core::ERROR_OPENING_FAILED;
+                    if (result == Core::ERROR_NONE) {
+                        result = Prepare(locator, response);
+                    }
 
-                    if (_storage.Create() == true) {
+                    if (result == Core::ERROR_NONE) {
+                        const uint32_t chunks = static_cast<uint32_t>(_chunks.size());
+                        const uint32_t missing = static_cast<uint32_t>(std::count(_chunks.begin(), _chunks.end(), PENDING));
 
-                        _hash = hash;
+                        TRACE(Trace::Information, (_T("Downloading %llu bytes in %d chunks, %d missing, over %d connections"), _size, chunks, missing, std::min(static_cast<uint32_t>(_settings.Connections), missing)));
 
-                        result = BaseClass::Download(url, _storage);
+                        for (uint32_t index = 0; index < std::min(static_cast<uint32_t>(_settings.Connections), missing); index++) {
+                            _fetchers.push_back(new Fetcher(*this));
+                            _fetchers.back()->Run();
+                        }
+
+                        _progress.SetEvent();
+                        _verifier.Run();
+                        result = Core::ERROR_INPROGRESS;
+                    } else {
+                        CloseFiles();
                     }
                 }
 
@@ -79,57 +466,349 @@ namespace PluginHost {
             return (result);
         }
 
-        inline void CleanupStorage()
+        static void CleanupStorage(const string& storageName)
         {
-            if (_storage.Exists()) {
-                _storage.Destroy();
+            Core::File storage(storageName);
+            Core::File checkpoint(storageName + _T(".progress"));
+
+            if (storage.Exists()) {
+                storage.Destroy();
+            }
+            if (checkpoint.Exists()) {
+                checkpoint.Destroy();
             }
         }
+
     private:
-        virtual void Transfered(const uint32_t result, const Web::SignedFileBodyType<Crypto::SHA256>& destination) override
-        {
-            uint32_t status = result;
-            if (status == Core::ERROR_NONE) {
-                if (_hash.empty() != true) {
-                    uint8_t hashHex[Crypto::HASH_SHA256];
-                    if (HashStringToBytes(_hash, hashHex) == true) {
-
-                        const uint8_t* downloadedHash = destination.SerializedHashValue();
-                        if (downloadedHash != nullptr) {
-                            for (uint16_t i = 0; i < Crypto::HASH_SHA256; i++) {
-                                if (downloadedHash[i] != hashHex[i]) {
-                                    status = Core::ERROR_INCORRECT_HASH;
-                                    break;
-                                }
-                            }
-                        }
+        // A single byte of the image tells the size and if ranges are supported.
+        uint32_t Probe(Response& response)
+        {
+            Connection connection;
+            uint32_t result = connection.Get(_locator, 0, 0, response, -1, 0, 1);
+
+            if (result == Core::ERROR_NONE) {
+                if (response.Code == 206) {
+                    result = (response.Total != NoRange ? Core::ERROR_NONE : Core::ERROR_NOT_SUPPORTED);
+                } else if (response.Code == 200) {
+                    // No ranges, the image comes in one go, without resume.
+                    response.Total = response.Length;
+                    result = (response.Total != NoRange ? Core::ERROR_NONE : Core::ERROR_NOT_SUPPORTED);
+                } else {
+                    TRACE(Trace::Error, (_T("Download of %s refused with %d"), _locator.c_str(), response.Code));
+                    result = Core::ERROR_UNAVAILABLE;
+                }
+            } else if (response.Code >= 400) {
+                TRACE(Trace::Error, (_T("Download of %s refused with %d"), _locator.c_str(), response.Code));
+                result = Core::ERROR_UNAVAILABLE;
+            }
+
+            return (result);
+        }
+        uint32_t Prepare(const string& locator, const Response& response)
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+
+            _ranges = (response.Code == 206);
+            _size = response.Total;
+            _chunkSize = ((_ranges == true) && (_size > 0) ? _settings.ChunkSize : std::max(_size, static_cast<uint64_t>(1)));
+            _chunks.assign(static_cast<uint32_t>((std::max(_size, static_cast<uint64_t>(1)) + _chunkSize - 1) / _chunkSize), (_size > 0 ? PENDING : DONE));
+            _verified = 0;
+            _result = Core::ERROR_NONE;
+            _aborted = false;
+
+            Checkpoint expected;
+            ::memset(&expected, 0, sizeof(expected));
+            expected.Magic = Magic;
+            expected.Version = Version;
+            expected.Size = _size;
+            expected.ChunkSize = static_cast<uint32_t>(_chunkSize);
+            expected.Chunks = static_cast<uint32_t>(_chunks.size());
+            expected.Source = Source(locator + _hash);
+            ::strncpy(expected.Tag, response.Tag.c_str(), sizeof(expected.Tag) - 1);
+
+            const string checkpointName(_storageName + _T(".progress"));
+            bool resume = false;
+
+            _storage = ::open(_storageName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            _checkpoint = ::open(checkpointName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+            if ((_storage != -1) && (_checkpoint != -1)) {
+                Checkpoint stored;
+                struct stat info;
+
+                if ((_ranges == true) && (::pread(_checkpoint, &stored, sizeof(stored), 0) == sizeof(stored)) && (::memcmp(&stored, &expected, sizeof(stored)) == 0) && (::fstat(_storage, &info) == 0) && (static_cast<uint64_t>(info.st_size) == _size) && (::pread(_checkpoint, _chunks.data(), _chunks.size(), sizeof(stored)) == static_cast<ssize_t>(_chunks.size()))) {
+                    resume = true;
+
+                    for (uint8_t& chunk : _chunks) {
+                        chunk = (chunk == DONE ? DONE : PENDING);
                     }
                 }
+
+                if (resume == true) {
+                    TRACE(Trace::Information, (_T("Resuming download of %s"), _locator.c_str()));
+                    result = Core::ERROR_NONE;
+                } else if ((::ftruncate(_storage, 0) == 0) && (::ftruncate(_storage, _size) == 0) && (::ftruncate(_checkpoint, 0) == 0) && (::pwrite(_checkpoint, &expected, sizeof(expected), 0) == sizeof(expected)) && (::pwrite(_checkpoint, _chunks.data(), _chunks.size(), sizeof(expected)) == static_cast<ssize_t>(_chunks.size()))) {
+                    result = Core::ERROR_NONE;
+                }
             }
-            if (_notifier != nullptr) {
-                _notifier->NotifyDownloadStatus(status);
+
+            return (result);
+        }
+        void CloseFiles()
+        {
+            if (_storage != -1) {
+                ::close(_storage);
+                _storage = -1;
             }
+            if (_checkpoint != -1) {
+                ::close(_checkpoint);
+                _checkpoint = -1;
+            }
+            if (_stream != -1) {
+                ::close(_stream);
+                _stream = -1;
+            }
+        }
+        static uint32_t Source(const string& text)
+        {
+            uint32_t hash = 2166136261;
+            for (const TCHAR character : text) {
+                hash = (hash ^ static_cast<uint8_t>(character)) * 16777619;
+            }
+            return (hash);
+        }
+
+        // Fetchers
+        inline bool IsAborted() const
+        {
+            return (_aborted);
+        }
+        inline uint8_t Retries() const
+        {
+            return (_settings.Retries);
+        }
+        bool Next(uint32_t& index)
+        {
+            bool result = false;
 
             _adminLock.Lock();
-            _storage.Close();
+
+            if (_aborted == false) {
+                std::vector<uint8_t>::iterator chunk(std::find(_chunks.begin(), _chunks.end(), PENDING));
+
+                if (chunk != _chunks.end()) {
+                    *chunk = BUSY;
+                    index = static_cast<uint32_t>(chunk - _chunks.begin());
+                    result = true;
+                }
+            }
+
             _adminLock.Unlock();
+
+            return (result);
         }
+        uint32_t Fetch(Connection& connection, const uint32_t index)
+        {
+            const uint64_t offset = (static_cast<uint64_t>(index) * _chunkSize);
+            const uint64_t length = std::min(_chunkSize, _size - offset);
+            Response response;
+
+            // The body is written in place while it comes in, so a response that turns out to be
+            // wrong may leave garbage in the chunk. It is not marked, so it is fetched again.
+            uint32_t result = connection.Get(_locator, (_ranges == true ? offset : NoRange), offset + length - 1, response, _storage, offset, length);
+
+            if ((result == Core::ERROR_NONE) && ((response.Code != (_ranges == true ? 206 : 200)) || ((response.Length != NoRange) && (response.Length != length)) || ((_ranges == true) && (response.Total != _size)))) {
+                TRACE(Trace::Error, (_T("Unexpected response %d for chunk %d, %llu bytes"), response.Code, index, response.Length));
+                result = Core::ERROR_INCORRECT_HASH;
+            } else if ((result != Core::ERROR_NONE) && (response.Code >= 400)) {
+                TRACE(Trace::Error, (_T("Chunk %d refused with %d"), index, response.Code));
+                result = Core::ERROR_UNAVAILABLE;
+            }
+
+            // Only mark it after the data is on disk, what is marked is not fetched again.
+            if ((result == Core::ERROR_NONE) && (::fdatasync(_storage) != 0)) {
+                result = Core::ERROR_WRITE_ERROR;
+            }
 
-        virtual bool Setup(const Core::URL& remote) override
+            return (result);
+        }
+        void Fetched(const uint32_t index, const uint32_t result)
         {
-            bool result = false;
+            _adminLock.Lock();
 
-            if (remote.Host().IsSet() == true) {
-                uint16_t portNumber(remote.Port().IsSet() ? remote.Port().Value() : 80);
+            if (result == Core::ERROR_NONE) {
+                const uint8_t done = DONE;
+                _chunks[index] = DONE;
 
-                BaseClass::Link().RemoteNode(Core::NodeId(remote.Host().Value().c_str(), portNumber));
+                if (::pwrite(_checkpoint, &done, sizeof(done), sizeof(Checkpoint) + index) != sizeof(done)) {
+                    TRACE(Trace::Error, (_T("Could not record chunk %d, it will be fetched again on resume"), index));
+                }
+            } else {
+                _chunks[index] = PENDING;
 
-                result = true;
+                if (_result == Core::ERROR_NONE) {
+                    TRACE(Trace::Error, (_T("Giving up on chunk %d [%d]"), index, result));
+                    _result = result;
+                    _aborted = true;
+                }
             }
+
+            _adminLock.Unlock();
+
+            _progress.SetEvent();
+        }
+
+        // Runs till the download is done (good or bad), or stopped.
+        void Verify()
+        {
+            Crypto::SHA256 digest;
+            std::vector<uint8_t> block(BlockSize);
+            uint16_t reported = 0;
+            uint32_t result = Core::ERROR_NONE;
+
+            while ((_verifier.IsRunning() == true) && (result == Core::ERROR_NONE) && (_verified < _chunks.size())) {
+                _progress.Lock(Core::infinite);
+                _progress.ResetEvent();
+
+                _adminLock.Lock();
+                result = _result;
+                uint32_t available = _verified;
+                while ((available < _chunks.size()) && (_chunks[available] == DONE)) {
+                    available++;
+                }
+                _adminLock.Unlock();
+
+                for (; (_verifier.IsRunning() == true) && (result == Core::ERROR_NONE) && (_verified < available); _verified++) {
+                    const uint64_t start = static_cast<uint64_t>(_verified) * _chunkSize;
+                    const uint64_t end = std::min(start + _chunkSize, _size);
+
+                    for (uint64_t offset = start; (offset < end) && (result == Core::ERROR_NONE); offset += BlockSize) {
+                        const uint32_t length = static_cast<uint32_t>(std::min(static_cast<uint64_t>(BlockSize), end - offset));
+
+                        if (::pread(_storage, block.data(), length, offset) != static_cast<ssize_t>(length)) {
+                            result = Core::ERROR_READ_ERROR;
+                        } else {
+                            digest.Input(block.data(), static_cast<uint16_t>(length));
+                        }
+                    }
+                }
+
+                const uint16_t percentage = static_cast<uint16_t>(_size > 0 ? ((std::min(static_cast<uint64_t>(_verified) * _chunkSize, _size) * 100) / _size) : 100);
+                if ((percentage != reported) && (_notifier != nullptr)) {
+                    reported = percentage;
+                    _notifier->NotifyDownloadProgress(percentage);
+                }
+            }
+
+            if (_verifier.IsRunning() == true) {
+                if (result == Core::ERROR_NONE) {
+                    result = Compare(digest.Result());
+                }
+                if ((_settings.Stream.empty() == false) && (OpenStream() == Core::ERROR_NONE)) {
+                    if (result == Core::ERROR_NONE) {
+                        // The image checks out, only now the installer gets to see it.
+                        result = FeedImage(block);
+                    }
+
+                    // Closing ends the input of the installer, on a failure before it read anything.
+                    ::close(_stream);
+                    _stream = -1;
+                }
+                if (result != Core::ERROR_NONE) {
+                    TRACE(Trace::Error, (_T("Download failed after %d of %d chunks [%d]"), _verified, static_cast<uint32_t>(_chunks.size()), result));
+                }
+                if (_notifier != nullptr) {
+                    _notifier->NotifyDownloadStatus(result);
+                }
+            }
+        }
+        uint32_t Compare(const uint8_t downloadedHash[]) const
+        {
+            uint32_t status = Core::ERROR_NONE;
+
+            if (_hash.empty() != true) {
+                uint8_t hashHex[Crypto::HASH_SHA256];
+                if (HashStringToBytes(_hash, hashHex) == true) {
+                    if ((downloadedHash != nullptr) && (::memcmp(downloadedHash, hashHex, Crypto::HASH_SHA256) != 0)) {
+                        status = Core::ERROR_INCORRECT_HASH;
+                    }
+                }
+            }
+
+            return (status);
+        }
+        uint32_t OpenStream()
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+
+            // The write side of a FIFO can only be opened once the installer opened it for reading.
+            while ((_verifier.IsRunning() == true) && (IsAborted() == false) && (_stream == -1)) {
+                _stream = ::open(_settings.Stream.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+                if (_stream != -1) {
+                    ::fcntl(_stream, F_SETFL, ::fcntl(_stream, F_GETFL) & ~O_NONBLOCK);
+                    result = Core::ERROR_NONE;
+                } else if (errno == ENXIO) {
+                    SleepMs(100);
+                } else {
+                    break;
+                }
+            }
+
+            if (_stream != -1) {
+                // A reader that goes away should fail the write, not take down the process.
+                sigset_t pipe;
+                sigemptyset(&pipe);
+                sigaddset(&pipe, SIGPIPE);
+                pthread_sigmask(SIG_BLOCK, &pipe, nullptr);
+            }
+
             return (result);
         }
+        uint32_t Feed(const uint8_t data[], const uint32_t length)
+        {
+            uint32_t written = 0;
+
+            while (written < length) {
+                const ssize_t size = ::write(_stream, &(data[written]), length - written);
+
+                if (size > 0) {
+                    written += static_cast<uint32_t>(size);
+                } else if ((size < 0) && (errno == EINTR)) {
+                    continue;
+                } else {
+                    if (errno == EPIPE) {
+                        sigset_t pipe;
+                        struct timespec now = { 0, 0 };
+                        sigemptyset(&pipe);
+                        sigaddset(&pipe, SIGPIPE);
+                        sigtimedwait(&pipe, nullptr, &now);
+                    }
+                    TRACE(Trace::Error, (_T("Installer stopped reading the image")));
+                    break;
+                }
+            }
 
-        inline bool HashStringToBytes(const std::string& hash, uint8_t (&hashHex)[Crypto::HASH_SHA256])
+            return (written == length ? Core::ERROR_NONE : Core::ERROR_WRITE_ERROR);
+        }
+        uint32_t FeedImage(std::vector<uint8_t>& block)
+        {
+            uint32_t result = Core::ERROR_NONE;
+
+            for (uint64_t offset = 0; (_verifier.IsRunning() == true) && (offset < _size) && (result == Core::ERROR_NONE); offset += BlockSize) {
+                const uint32_t length = static_cast<uint32_t>(std::min(static_cast<uint64_t>(BlockSize), _size - offset));
+
+                if (::pread(_storage, block.data(), length, offset) != static_cast<ssize_t>(length)) {
+                    result = Core::ERROR_READ_ERROR;
+                } else {
+                    result = Feed(block.data(), length);
+                }
+            }
+
+            return (result);
+        }
+
+        static inline bool HashStringToBytes(const std::string& hash, uint8_t (&hashHex)[Crypto::HASH_SHA256])
         {
             bool status = true;
 
@@ -150,10 +829,25 @@ namespace PluginHost {
 
 
     private:
-        string _hash;
         Core::CriticalSection _adminLock;
         INotifier* _notifier;
-        Core::File _storage;
+        Settings _settings;
+        const string _storageName;
+        string _locator;
+        string _hash;
+        int _storage;
+        int _checkpoint;
+        int _stream;
+        bool _ranges;
+        uint64_t _size;
+        uint64_t _chunkSize;
+        std::vector<uint8_t> _chunks;
+        uint32_t _verified; // chunks hashed so far
+        uint32_t _result;
+        std::atomic<bool> _aborted;
+        Core::Event _progress;
+        std::vector<Fetcher*> _fetchers;
+        Verifier _verifier;
     };
 }
 }
@@ -40,11 +40,20 @@ namespace Plugin {
         if (config.WaitTime.IsSet() == true) {
             _waitTime = config.WaitTime.Value();
         }
+        _settings.ChunkSize = config.ChunkSize.Value() * 1024;
+        _settings.Connections = config.Connections.Value();
+        _settings.Retries = config.Retries.Value();
+        if (config.Streaming.Value() == true) {
+            _settings.Stream = _destination + StreamName;
+        }
+
+        PluginHost::DownloadEngine::Initialize();
 
         string message;
         uint32_t status = ConvertMfrStatusToCore(mfrFWUpgradeInit());
         if (status != Core::ERROR_NONE) {
             message = _T("Error in MFR library initialization");
+            PluginHost::DownloadEngine::Deinitialize();
         }
 
         return (message);
@@ -59,6 +68,8 @@ namespace Plugin {
         if (status != Core::ERROR_NONE) {
             message = _T("Error in MFR library deinitialization");
         }
+
+        PluginHost::DownloadEngine::Deinitialize();
     }
 
     /* virtual */ string FirmwareControl::Information() const
@@ -86,13 +97,25 @@ namespace Plugin {
 
     void FirmwareControl::Upgrade() {
         TRACE(Trace::Information, (string(__FUNCTION__)));
-        uint32_t status = Download();
-        if (status == Core::ERROR_NONE && (Status() != UpgradeStatus::UPGRADE_CANCELLED)) {
-            Install();
+        Notifier notifier(this);
+
+        PluginHost::DownloadEngine downloadEngine(&notifier, _destination + Name, _settings);
+
+        _adminLock.Lock();
+        _downloadStatus = Core::ERROR_NONE;
+        _adminLock.Unlock();
+
+        if (_settings.Stream.empty() == false) {
+            Stream(downloadEngine);
+        } else {
+            uint32_t status = Download(downloadEngine);
+            if (status == Core::ERROR_NONE && (Status() != UpgradeStatus::UPGRADE_CANCELLED)) {
+                Install(Name);
+            }
         }
     }
 
-    void FirmwareControl::Install() {
+    void FirmwareControl::Install(const string& name) {
         TRACE(Trace::Information, (string(__FUNCTION__)));
         //Setup callback handler;
         mfrUpgradeStatusNotify_t mfrNotifier;
@@ -101,7 +124,7 @@ namespace Plugin {
         mfrNotifier.cb = Callback;
 
         // Initiate image install
-        mfrError_t mfrStatus = mfrWriteImage(Name, _destination.c_str(), static_cast<mfrImageType_t>(_type), mfrNotifier);
+        mfrError_t mfrStatus = mfrWriteImage(name.c_str(), _destination.c_str(), static_cast<mfrImageType_t>(_type), mfrNotifier);
         if (mfrERR_NONE != mfrStatus) {
             Status(UpgradeStatus::INSTALL_ABORTED, ConvertMfrStatusToCore(mfrStatus), 0);
         } else {
@@ -109,6 +132,9 @@ namespace Plugin {
             uint32_t status = WaitForCompletion(_waitTime); // To avoid hang situation
             if (status != Core::ERROR_NONE) {
                 Status(UpgradeStatus::INSTALL_ABORTED, Core::ERROR_TIMEDOUT, 0);
+            } else if (DownloadStatus() != Core::ERROR_NONE) {
+                // Streamed, the installer was cut off as the download failed.
+                Status(UpgradeStatus::DOWNLOAD_ABORTED, DownloadStatus(), 0);
             } else {
                 _adminLock.Lock();
                 mfrUpgradeStatus_t installStatus = _installStatus;
@@ -120,12 +146,9 @@ namespace Plugin {
         }
     }
 
-    uint32_t FirmwareControl::Download() {
+    uint32_t FirmwareControl::Download(PluginHost::DownloadEngine& downloadEngine) {
 
         TRACE(Trace::Information, (string(__FUNCTION__)));
-        Notifier notifier(this);
-
-        PluginHost::DownloadEngine downloadEngine(&notifier, _destination + Name);
 
         uint32_t status = downloadEngine.Start(_source, _destination, _hash);
         if ((status == Core::ERROR_NONE) || (status == Core::ERROR_INPROGRESS)) {
@@ -145,5 +168,28 @@ namespace Plugin {
         return status;
     }
 
+    // The installer reads the image from a FIFO instead of the storage file. The download engine
+    // only feeds it once the full image is downloaded and its hash verified, till then the
+    // installer waits for its input. A failed download closes the FIFO without feeding it.
+    void FirmwareControl::Stream(PluginHost::DownloadEngine& downloadEngine) {
+
+        TRACE(Trace::Information, (string(__FUNCTION__)));
+
+        ::unlink(_settings.Stream.c_str());
+
+        if (::mkfifo(_settings.Stream.c_str(), 0600) != 0) {
+            TRACE(Trace::Error, (_T("Could not create %s"), _settings.Stream.c_str()));
+            Status(UpgradeStatus::DOWNLOAD_ABORTED, Core::ERROR_OPENING_FAILED, 0);
+        } else {
+            uint32_t status = downloadEngine.Start(_source, _destination, _hash);
+            if ((status == Core::ERROR_NONE) || (status == Core::ERROR_INPROGRESS)) {
+                Status(UpgradeStatus::DOWNLOAD_STARTED, ErrorType::ERROR_NONE, 0);
+                Install(StreamName);
+            } else {
+                Status(UpgradeStatus::DOWNLOAD_ABORTED, status, 0);
+            }
+        }
+    }
+
 } // namespace Plugin
 } // namespace WPEFramework
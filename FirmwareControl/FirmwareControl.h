@@ -68,6 +68,7 @@ namespace Plugin {
         };
     private:
         static constexpr const TCHAR* Name = "imageTemp";
+        static constexpr const TCHAR* StreamName = "imageTemp.stream";
         static int32_t constexpr WaitTime = Core::infinite;
 
     private:
@@ -81,10 +82,18 @@ namespace Plugin {
                 , Source()
                 , Download()
                 , WaitTime()
+                , ChunkSize(1024)
+                , Connections(4)
+                , Retries(3)
+                , Streaming(false)
             {
                 Add(_T("source"), &Source);
                 Add(_T("download"), &Download);
                 Add(_T("waittime"), &WaitTime);
+                Add(_T("chunksize"), &ChunkSize);
+                Add(_T("connections"), &Connections);
+                Add(_T("retries"), &Retries);
+                Add(_T("streaming"), &Streaming);
             }
 
             ~Config() {}
@@ -93,6 +102,10 @@ namespace Plugin {
             Core::JSON::String Source;
             Core::JSON::String Download;
             Core::JSON::DecSInt32 WaitTime;
+            Core::JSON::DecUInt32 ChunkSize; // KB
+            Core::JSON::DecUInt8 Connections;
+            Core::JSON::DecUInt8 Retries;
+            Core::JSON::Boolean Streaming;
         };
 
         class Notifier : public INotifier {
@@ -114,6 +127,10 @@ namespace Plugin {
             {
                 _parent.NotifyDownloadStatus(status);
             }
+            virtual void NotifyDownloadProgress(const uint16_t percentage) override
+            {
+                _parent.NotifyProgress(DOWNLOAD_STARTED, ErrorType::ERROR_NONE, percentage);
+            }
 
         private:
             FirmwareControl& _parent;
@@ -161,6 +178,7 @@ namespace Plugin {
             , _hash()
             , _interval(0)
             , _waitTime(WaitTime)
+            , _settings()
             , _downloadStatus(Core::ERROR_NONE)
             , _upgradeStatus(UpgradeStatus::NONE)
             , _installStatus()
@@ -200,7 +218,10 @@ namespace Plugin {
             _downloadStatus = status;
             _adminLock.Unlock();
 
-            _signal.SetEvent();
+            // While streaming, it is the installer that tells when the upgrade is done.
+            if (_settings.Stream.empty() == true) {
+                _signal.SetEvent();
+            }
         }
 
         static void Callback(mfrUpgradeStatus_t mfrStatus, void *cbData)
@@ -235,7 +256,11 @@ namespace Plugin {
                 event_upgradeprogress(static_cast<JsonData::FirmwareControl::StatusType>(upgradeStatus),
                                       static_cast<JsonData::FirmwareControl::UpgradeprogressParamsData::ErrorType>(errorType), percentage);
                 ResetStatus();
-                RemoveDownloadedFile();
+
+                // Keep what was downloaded so far, the next upgrade resumes from there.
+                if ((upgradeStatus != DOWNLOAD_ABORTED) || (errorType == ErrorType::INCORRECT_HASH)) {
+                    RemoveDownloadedFile();
+                }
             } else if (_interval) { // Send intermediate staus/progress of upgrade
                 event_upgradeprogress(static_cast<JsonData::FirmwareControl::StatusType>(upgradeStatus),
                                       static_cast<JsonData::FirmwareControl::UpgradeprogressParamsData::ErrorType>(errorType), percentage);
@@ -247,8 +272,9 @@ namespace Plugin {
 
     private:
         void Upgrade();
-        void Install();
-        uint32_t Download();
+        void Install(const string& name);
+        uint32_t Download(PluginHost::DownloadEngine& downloadEngine);
+        void Stream(PluginHost::DownloadEngine& downloadEngine);
 
         void RegisterAll();
         void UnregisterAll();
@@ -266,9 +292,11 @@ namespace Plugin {
 
         inline void RemoveDownloadedFile()
         {
-            Core::File _storage(_destination + Name);
-            if (_storage.Exists()) {
-                _storage.Destroy();
+            PluginHost::DownloadEngine::CleanupStorage(_destination + Name);
+
+            Core::File stream(_destination + StreamName);
+            if (stream.Exists()) {
+                stream.Destroy();
             }
         }
         inline void ResetStatus()
@@ -409,6 +437,7 @@ namespace Plugin {
         uint16_t _interval;
 
         int32_t _waitTime;
+        PluginHost::DownloadEngine::Settings _settings;
         uint32_t _downloadStatus;
         UpgradeStatus _upgradeStatus;
         mfrUpgradeStatus_t _installStatus;
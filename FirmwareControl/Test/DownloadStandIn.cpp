@@ -0,0 +1,527 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Module.h"
+#include "../DownloadEngine.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// The download engine against an HTTP server on the loopback interface, with a stand-in for the
+// installer that reads the image from the FIFO, like mfrWriteImage does when streaming:
+//
+//    FirmwareControlDownloadTest -port 8642 -path /tmp
+//
+// - ranged: ranges over 4 connections, every 5th response is cut off halfway and has to be retried;
+// - single: a server without ranges, the image comes in one response;
+// - mismatch: the hash does not match, the installer must not get a single byte;
+// - file: not streamed, the storage file must hold the image.
+// When streamed the installer has to get the full image, and only after the server sent the last
+// of it, as nothing may be fed before the full image is verified. The results are printed as JSON,
+// the exit code is the number of failed scenarios.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+static const TCHAR Loopback[] = _T("127.0.0.1");
+static constexpr uint32_t ChunkSize = 64 * 1024;
+static constexpr uint32_t ImageSize = (7 * ChunkSize) + 12345;
+static constexpr uint32_t Timeout = 30000; // mS
+
+struct Scenario {
+    const TCHAR* Name;
+    bool Ranges;
+    uint8_t Drop; // every so many responses are cut off, 0 for none
+    bool Match;
+    bool Stream;
+};
+
+static const Scenario Scenarios[] = {
+    { _T("ranged"), true, 5, true, true },
+    { _T("single"), false, 0, true, true },
+    { _T("mismatch"), true, 0, false, true },
+    { _T("file"), true, 5, true, false }
+};
+
+class Server : public Core::Thread {
+private:
+    static constexpr uint32_t MaxRequestSize = 4096;
+
+    struct Client {
+        int Socket;
+        string Request;
+    };
+
+public:
+    Server() = delete;
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    Server(const uint16_t port, const std::vector<uint8_t>& image)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("FirmwareStandIn"))
+        , _image(image)
+        , _listener(::socket(AF_INET, SOCK_STREAM, 0))
+        , _clients()
+        , _ranges(true)
+        , _drop(0)
+        , _responses(0)
+        , _served(0)
+    {
+        struct sockaddr_in local;
+        int reuse = 1;
+
+        ::memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_port = htons(port);
+        ::inet_pton(AF_INET, Loopback, &local.sin_addr);
+
+        ::setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if ((_listener != -1) && ((::bind(_listener, reinterpret_cast<const struct sockaddr*>(&local), sizeof(local)) != 0) || (::listen(_listener, 8) != 0))) {
+            ::close(_listener);
+            _listener = -1;
+        }
+        if (_listener != -1) {
+            Run();
+        }
+    }
+    ~Server() override
+    {
+        Stop();
+        Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+        for (const Client& client : _clients) {
+            ::close(client.Socket);
+        }
+        if (_listener != -1) {
+            ::close(_listener);
+        }
+    }
+
+public:
+    bool IsValid() const
+    {
+        return (_listener != -1);
+    }
+    // Only between scenarios, when nothing is being fetched.
+    void Configure(const bool ranges, const uint8_t drop)
+    {
+        _ranges = ranges;
+        _drop = drop;
+        _responses = 0;
+        _served = 0;
+    }
+    // When the last response was sent completely, in ticks.
+    uint64_t Served() const
+    {
+        return (_served);
+    }
+
+private:
+    static string Header(const string& request, const TCHAR name[])
+    {
+        string result;
+        const string key(string(_T("\r\n")) + name + _T(":"));
+        const size_t start = request.find(key);
+
+        if (start != string::npos) {
+            const size_t begin = request.find_first_not_of(' ', start + key.length());
+            const size_t end = request.find(_T("\r\n"), begin);
+            result = request.substr(begin, end - begin);
+        }
+
+        return (result);
+    }
+    // Returns false if the connection is to be closed.
+    bool Answer(const int socket, const string& request)
+    {
+        const string range(Header(request, _T("Range")));
+        uint64_t first = 0;
+        uint64_t last = _image.size() - 1;
+        TCHAR header[256];
+
+        if ((_ranges == true) && (range.compare(0, 6, _T("bytes=")) == 0)) {
+            first = ::strtoull(&(range[6]), nullptr, 10);
+            last = std::min(static_cast<uint64_t>(::strtoull(&(range[range.find('-') + 1]), nullptr, 10)), last);
+
+            ::snprintf(header, sizeof(header), "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %llu-%llu/%u\r\nContent-Length: %llu\r\nETag: \"standin\"\r\n\r\n",
+                static_cast<unsigned long long>(first), static_cast<unsigned long long>(last), static_cast<uint32_t>(_image.size()), static_cast<unsigned long long>(last - first + 1));
+        } else {
+            ::snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Length: %u\r\nETag: \"standin\"\r\n\r\n", static_cast<uint32_t>(_image.size()));
+        }
+
+        uint64_t length = last - first + 1;
+        bool result = true;
+
+        // The probe (a single byte) is never cut off.
+        if ((length > 1) && (_drop != 0) && ((++_responses % _drop) == 0)) {
+            length /= 2;
+            result = false;
+        }
+
+        if ((::send(socket, header, ::strlen(header), MSG_NOSIGNAL) != static_cast<ssize_t>(::strlen(header))) || (::send(socket, &(_image[first]), length, MSG_NOSIGNAL) != static_cast<ssize_t>(length))) {
+            // The probe is dropped by the client once it has its byte.
+            result = false;
+        } else if (result == true) {
+            _served = Core::Time::Now().Ticks();
+        }
+
+        return (result);
+    }
+    uint32_t Worker() override
+    {
+        std::vector<struct pollfd> descriptors;
+
+        descriptors.push_back({ _listener, POLLIN, 0 });
+        for (const Client& client : _clients) {
+            descriptors.push_back({ client.Socket, POLLIN, 0 });
+        }
+
+        if (::poll(descriptors.data(), descriptors.size(), 100) > 0) {
+            std::list<Client>::iterator client(_clients.begin());
+
+            for (uint32_t index = 1; index < descriptors.size(); index++) {
+                bool open = true;
+
+                if ((descriptors[index].revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+                    char buffer[1024];
+                    const ssize_t size = ::recv(client->Socket, buffer, sizeof(buffer), 0);
+
+                    if (size <= 0) {
+                        open = false;
+                    } else {
+                        size_t end;
+
+                        client->Request.append(buffer, size);
+
+                        // Only GETs, so no bodies.
+                        while ((open == true) && ((end = client->Request.find(_T("\r\n\r\n"))) != string::npos)) {
+                            open = Answer(client->Socket, client->Request.substr(0, end + 2));
+                            client->Request.erase(0, end + 4);
+                        }
+
+                        if (client->Request.length() > MaxRequestSize) {
+                            open = false;
+                        }
+                    }
+                }
+
+                if (open == true) {
+                    client++;
+                } else {
+                    ::close(client->Socket);
+                    client = _clients.erase(client);
+                }
+            }
+
+            if ((descriptors[0].revents & POLLIN) != 0) {
+                const int socket = ::accept(_listener, nullptr, nullptr);
+
+                if (socket != -1) {
+                    _clients.push_back({ socket, string() });
+                }
+            }
+        }
+
+        return (0);
+    }
+
+private:
+    const std::vector<uint8_t>& _image;
+    int _listener;
+    std::list<Client> _clients;
+    std::atomic<bool> _ranges;
+    std::atomic<uint8_t> _drop;
+    uint32_t _responses;
+    std::atomic<uint64_t> _served;
+};
+
+// Reads the image from the FIFO, till the download engine closes it.
+class Installer : public Core::Thread {
+public:
+    Installer() = delete;
+    Installer(const Installer&) = delete;
+    Installer& operator=(const Installer&) = delete;
+
+    Installer(const string& fifo)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("InstallerStandIn"))
+        , _fifo(fifo)
+        , _image()
+        , _first(0)
+        , _done(false, true)
+    {
+        Run();
+    }
+    ~Installer() override
+    {
+        Stop();
+
+        // If nobody ever opened the FIFO for writing, the open of the read side is still waiting.
+        const int writer = ::open(_fifo.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (writer != -1) {
+            ::close(writer);
+        }
+
+        Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+    }
+
+public:
+    bool Finished(const uint32_t waitTime)
+    {
+        return (_done.Lock(waitTime) == Core::ERROR_NONE);
+    }
+    const std::vector<uint8_t>& Image() const
+    {
+        return (_image);
+    }
+    // When the first byte came in, in ticks, 0 if none did.
+    uint64_t First() const
+    {
+        return (_first);
+    }
+
+private:
+    uint32_t Worker() override
+    {
+        const int fifo = ::open(_fifo.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fifo != -1) {
+            uint8_t buffer[16 * 1024];
+            ssize_t size;
+
+            while ((size = ::read(fifo, buffer, sizeof(buffer))) > 0) {
+                if (_first == 0) {
+                    _first = Core::Time::Now().Ticks();
+                }
+                _image.insert(_image.end(), buffer, buffer + size);
+            }
+
+            ::close(fifo);
+        }
+
+        _done.SetEvent();
+        Block();
+
+        return (Core::infinite);
+    }
+
+private:
+    const string _fifo;
+    std::vector<uint8_t> _image;
+    uint64_t _first;
+    Core::Event _done;
+};
+
+class Notifier : public INotifier {
+public:
+    Notifier(const Notifier&) = delete;
+    Notifier& operator=(const Notifier&) = delete;
+
+    Notifier()
+        : _status(Core::ERROR_UNAVAILABLE)
+        , _done(false, true)
+    {
+    }
+    ~Notifier() override = default;
+
+public:
+    void NotifyDownloadStatus(const uint32_t status) override
+    {
+        _status = status;
+        _done.SetEvent();
+    }
+    void NotifyDownloadProgress(const uint16_t) override
+    {
+    }
+
+    uint32_t Wait(const uint32_t waitTime)
+    {
+        return (_done.Lock(waitTime) == Core::ERROR_NONE ? _status.load() : static_cast<uint32_t>(Core::ERROR_TIMEDOUT));
+    }
+
+private:
+    std::atomic<uint32_t> _status;
+    Core::Event _done;
+};
+
+string Hash(const std::vector<uint8_t>& image)
+{
+    static const TCHAR Digits[] = _T("0123456789abcdef");
+    Crypto::SHA256 digest;
+    string result;
+
+    for (uint32_t offset = 0; offset < image.size(); offset += 32 * 1024) {
+        digest.Input(&(image[offset]), static_cast<uint16_t>(std::min(static_cast<uint32_t>(32 * 1024), static_cast<uint32_t>(image.size() - offset))));
+    }
+
+    const uint8_t* hash = digest.Result();
+    for (uint8_t index = 0; index < Crypto::HASH_SHA256; index++) {
+        result += Digits[hash[index] >> 4];
+        result += Digits[hash[index] & 0x0F];
+    }
+
+    return (result);
+}
+
+bool Stored(const string& name, const std::vector<uint8_t>& image)
+{
+    std::vector<uint8_t> stored(image.size() + 1);
+    const int file = ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+    ssize_t size = -1;
+
+    if (file != -1) {
+        size = ::read(file, stored.data(), stored.size());
+        ::close(file);
+    }
+
+    return ((size == static_cast<ssize_t>(image.size())) && (::memcmp(stored.data(), image.data(), image.size()) == 0));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    uint16_t port = 8642;
+    string path(_T("/tmp"));
+    uint32_t failures = 0;
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-port") == 0) {
+            port = static_cast<uint16_t>(atoi(argv[index + 1]));
+        } else if (strcmp(argv[index], "-path") == 0) {
+            path = argv[index + 1];
+        }
+    }
+
+    PluginHost::DownloadEngine::Initialize();
+
+    {
+        std::vector<uint8_t> image(ImageSize);
+        uint32_t seed = 0x12345678;
+
+        for (uint8_t& byte : image) {
+            seed = (seed * 1103515245) + 12345;
+            byte = static_cast<uint8_t>(seed >> 16);
+        }
+
+        const string hash(Hash(image));
+        const string locator(_T("http://") + string(Loopback) + _T(":") + Core::NumberType<uint16_t>(port).Text() + _T("/firmware.bin"));
+        const string storage(path + _T("/FirmwareControlTest.bin"));
+        const string fifo(path + _T("/FirmwareControlTest.stream"));
+        Server server(port, image);
+
+        if (server.IsValid() == false) {
+            fprintf(stderr, "Could not listen on %s:%u\n", Loopback, port);
+            failures++;
+        } else {
+            printf("[\n");
+
+            for (uint8_t index = 0; index < (sizeof(Scenarios) / sizeof(Scenarios[0])); index++) {
+                const Scenario& scenario(Scenarios[index]);
+                PluginHost::DownloadEngine::Settings settings;
+                Notifier notifier;
+                Installer* installer = nullptr;
+                bool success = true;
+
+                settings.ChunkSize = ChunkSize;
+                settings.Connections = 4;
+                settings.Retries = 3;
+
+                PluginHost::DownloadEngine::CleanupStorage(storage);
+                server.Configure(scenario.Ranges, scenario.Drop);
+
+                if (scenario.Stream == true) {
+                    settings.Stream = fifo;
+                    ::unlink(fifo.c_str());
+                    ::mkfifo(fifo.c_str(), 0600);
+                    installer = new Installer(fifo);
+                }
+
+                const uint64_t start = Core::Time::Now().Ticks();
+                uint32_t status;
+
+                {
+                    PluginHost::DownloadEngine engine(&notifier, storage, settings);
+
+                    status = engine.Start(locator, path, (scenario.Match == true ? hash : string(Crypto::HASH_SHA256 * 2, '0')));
+
+                    if (status == Core::ERROR_INPROGRESS) {
+                        status = notifier.Wait(Timeout);
+                    }
+                }
+
+                const uint64_t duration = Core::Time::Now().Ticks() - start;
+
+                if (status != (scenario.Match == true ? Core::ERROR_NONE : Core::ERROR_INCORRECT_HASH)) {
+                    fprintf(stderr, "%s: download ended with %u\n", scenario.Name, status);
+                    success = false;
+                }
+
+                if (installer != nullptr) {
+                    if (installer->Finished(Timeout) == false) {
+                        fprintf(stderr, "%s: the installer never got the end of its input\n", scenario.Name);
+                        success = false;
+                    } else if (scenario.Match == false) {
+                        if (installer->Image().empty() == false) {
+                            fprintf(stderr, "%s: the installer got %u bytes of an image that does not match\n", scenario.Name, static_cast<uint32_t>(installer->Image().size()));
+                            success = false;
+                        }
+                    } else if (installer->Image() != image) {
+                        fprintf(stderr, "%s: the installer got %u bytes, not the image\n", scenario.Name, static_cast<uint32_t>(installer->Image().size()));
+                        success = false;
+                    } else if (installer->First() < server.Served()) {
+                        fprintf(stderr, "%s: the installer got its first byte before the image was downloaded\n", scenario.Name);
+                        success = false;
+                    }
+
+                    delete installer;
+                    ::unlink(fifo.c_str());
+                } else if ((scenario.Match == true) && (Stored(storage, image) == false)) {
+                    fprintf(stderr, "%s: the storage file does not hold the image\n", scenario.Name);
+                    success = false;
+                }
+
+                PluginHost::DownloadEngine::CleanupStorage(storage);
+
+                if (success == false) {
+                    failures++;
+                }
+
+                // In mS.
+                printf("  { \"scenario\": \"%s\", \"status\": %u, \"duration\": %.1f, \"success\": %s }%s\n",
+                    scenario.Name, status, static_cast<double>(duration) / Core::Time::TicksPerMillisecond,
+                    (success == true ? "true" : "false"), ((index + 1) == (sizeof(Scenarios) / sizeof(Scenarios[0])) ? "" : ","));
+            }
+
+            printf("]\n");
+        }
+    }
+
+    PluginHost::DownloadEngine::Deinitialize();
+
+    Core::Singleton::Dispose();
+
+    return (static_cast<int>(failures));
+}
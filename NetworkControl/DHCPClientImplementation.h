@@ -300,6 +300,7 @@ namespace Plugin {
                     , leaseTime()
                     , renewalTime()
                     , rebindingTime()
+                    , acquired()
                 {
                     Add("source", &source);
                     Add("offer", &offer);
@@ -310,6 +311,7 @@ namespace Plugin {
                     Add("leaseTime", &leaseTime);
                     Add("renewalTime", &renewalTime);
                     Add("rebindingTime", &rebindingTime);
+                    Add("acquired", &acquired);
                 }
 
                 JSON(Offer& object) 
@@ -323,6 +325,7 @@ namespace Plugin {
                     Add("leaseTime", &leaseTime);
                     Add("renewalTime", &renewalTime);
                     Add("rebindingTime", &rebindingTime);
+                    Add("acquired", &acquired);
 
                     Set(object);
                 }
@@ -337,6 +340,7 @@ namespace Plugin {
                     , leaseTime(copy.leaseTime)
                     , renewalTime(copy.renewalTime)
                     , rebindingTime(copy.rebindingTime)
+                    , acquired(copy.acquired)
                 {
                     Add("source", &source);
                     Add("offer", &offer);
@@ -347,6 +351,7 @@ namespace Plugin {
                     Add("leaseTime", &leaseTime);
                     Add("renewalTime", &renewalTime);
                     Add("rebindingTime", &rebindingTime);
+                    Add("acquired", &acquired);
                 }
 
                 void Set(Offer& object) {
@@ -365,6 +370,7 @@ namespace Plugin {
                     leaseTime = object._leaseTime;
                     renewalTime = object._renewalTime;
                     rebindingTime = object._rebindingTime;
+                    acquired = object._acquired;
                 }
 
                 Offer Get() {
@@ -383,6 +389,7 @@ namespace Plugin {
                     result._leaseTime = leaseTime.Value();
                     result._renewalTime = renewalTime.Value();
                     result._rebindingTime = rebindingTime.Value();
+                    result._acquired = acquired.Value();
 
                     return result;
                 }
@@ -398,6 +405,7 @@ namespace Plugin {
                 Core::JSON::DecUInt32 leaseTime;
                 Core::JSON::DecUInt32 renewalTime;
                 Core::JSON::DecUInt32 rebindingTime;
+                Core::JSON::DecUInt64 acquired;
             };
         public:
             Offer()
@@ -410,6 +418,7 @@ namespace Plugin {
                 , _leaseTime(0)
                 , _renewalTime(0)
                 , _rebindingTime(0)
+                , _acquired(0)
             {
                 Crypto::Random(_id);
             }
@@ -423,6 +432,7 @@ namespace Plugin {
                 , _leaseTime(0)
                 , _renewalTime(0)
                 , _rebindingTime(0)
+                , _acquired(0)
             {
                 _source = frame.siaddr;
                 _offer = frame.yiaddr;
@@ -440,6 +450,7 @@ namespace Plugin {
                 , _leaseTime(copy._leaseTime)
                 , _renewalTime(copy._renewalTime)
                 , _rebindingTime(copy._rebindingTime)
+                , _acquired(copy._acquired)
                 , _id(copy._id)
             {
             }
@@ -509,6 +520,7 @@ namespace Plugin {
                 _leaseTime = rhs._leaseTime;
                 _renewalTime = rhs._renewalTime;
                 _rebindingTime = rhs._rebindingTime;
+                _acquired = rhs._acquired;
                 _id = rhs._id;
 
                 return (*this);
@@ -559,6 +571,30 @@ namespace Plugin {
             {
                 return (_rebindingTime);
             }
+            uint64_t Acquired() const
+            {
+                return (_acquired);
+            }
+            void Acquired(const uint64_t ticks)
+            {
+                _acquired = ticks;
+            }
+            // RFC 2131 section 3.7, a client may keep using a lease that did not expire yet.
+            bool IsLeaseValid() const
+            {
+                bool result = false;
+
+                if (_leaseTime == static_cast<uint32_t>(~0)) {
+                    result = true;
+                } else if (_acquired != 0) {
+                    const uint64_t now = Core::Time::Now().Ticks();
+
+                    // If the clock is behind the moment the lease was acquired, we can not tell.
+                    result = (now >= _acquired) && (now < (_acquired + (static_cast<uint64_t>(_leaseTime) * 1000 * Core::Time::TicksPerMillisecond)));
+                }
+
+                return (result);
+            }
 
         private:
             Core::NodeId _source; /* address of DHCP server that sent this offer */
@@ -570,6 +606,7 @@ namespace Plugin {
             uint32_t _leaseTime; /* lease time in seconds */
             uint32_t _renewalTime; /* renewal time in seconds */
             uint32_t _rebindingTime; /* rebinding time in seconds */
+            uint64_t _acquired; /* moment the lease was acknowledged, in ticks */
             uint32_t _id; /* unique offer identifier */
         };
 
@@ -646,7 +683,7 @@ namespace Plugin {
             return (result);
         }
 
-        uint32_t Request(const Offer& offer) {
+        uint32_t Request(const Offer& offer, const bool reboot = false) {
 
             uint32_t result = Core::ERROR_INPROGRESS;
 
@@ -664,7 +701,10 @@ namespace Plugin {
                     // Use offer id as transaction id to pair request with correct response
                     _xid = offer.Id(); 
 
-                    if (offer.Source().IsEmpty() == false) {
+                    if (reboot == true) {
+                        // An INIT-REBOOT request MUST NOT carry the server identifier (RFC 2131 section 4.3.2)
+                        _serverIdentifier = 0;
+                    } else if (offer.Source().IsEmpty() == false) {
                         auto addr = reinterpret_cast<const sockaddr_in*>(static_cast<const struct sockaddr*>(offer.Source()));
                         
                         memcpy(&_serverIdentifier, &(addr->sin_addr), 4);
@@ -682,6 +722,11 @@ namespace Plugin {
             return (result);
         }
 
+        /* RFC 2131 section 3.2, INIT-REBOOT: verify a previously allocated address. */
+        inline uint32_t Reboot(const Offer& offer) {
+            return (Request(offer, true));
+        }
+
         inline uint32_t Decline(const Core::NodeId& acknowledged)
         {
 
@@ -793,6 +838,7 @@ namespace Plugin {
             _adminLock.Lock();
 
             _leasedOffer = offer;
+            _leasedOffer.Acquired(Core::Time::Now().Ticks());
             _unleasedOffers.remove_if([offer] (Offer& o) {return o.Id() == offer.Id();}); 
             
             _adminLock.Unlock();
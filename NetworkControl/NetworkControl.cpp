@@ -130,54 +130,25 @@ namespace Plugin
         }
 
         Core::JSON::ArrayType<Entry>::Iterator index(config.Interfaces.Elements());
+        const uint64_t requested = Core::Time::Now().Ticks();
 
         while (index.Next() == true) {
             if (index.Current().Interface.IsSet() == true) {
                 string interfaceName(index.Current().Interface.Value());
-                Core::AdapterIterator adapter;
-                uint8_t retries = (_responseTime * 2);
-
-                // Some interfaces take some time, to be available. Wait a certain amount
-                // of time in which the interface should come up.
-                do {
-                    adapter = Core::AdapterIterator(interfaceName);
-
-                    if (adapter.IsValid() == false) {
-                        Core::AdapterIterator::Flush();
-                        SleepMs(500);
-                    }
-
-                } while ((retries-- != 0) && (adapter.IsValid() == false));
+                Core::AdapterIterator adapter(interfaceName);
 
                 if (adapter.IsValid() == false) {
-                    SYSLOG(Logging::Startup, (_T("Interface [%s], not available"), interfaceName.c_str()));
-                } else {
-
-                    adapter.Up(true);
+                    // Some interfaces take some time, to be available. Do not wait for them here,
+                    // the AdapterObserver will report them once they show up.
+                    SYSLOG(Logging::Startup, (_T("Interface [%s], not available yet"), interfaceName.c_str()));
 
-                    auto dhcpInterface = _dhcpInterfaces.emplace(std::piecewise_construct,
-                        std::make_tuple(interfaceName),
-                        std::make_tuple(Core::ProxyType<DHCPEngine>::Create(this, interfaceName, _persistentStoragePath)));
-                    _interfaces.emplace(std::piecewise_construct,
+                    _adminLock.Lock();
+                    _pending.emplace(std::piecewise_construct,
                         std::make_tuple(interfaceName),
-                        std::make_tuple(index.Current()));
-
-                    JsonData::NetworkControl::NetworkData::ModeType how(index.Current().Mode);
-                    if (how == JsonData::NetworkControl::NetworkData::ModeType::MANUAL) {
-                        SYSLOG(Logging::Startup, (_T("Interface [%s] activated, no IP associated"), interfaceName.c_str()));
-                    } else {
-                        if (how == JsonData::NetworkControl::NetworkData::ModeType::DYNAMIC) {
-                            if (dhcpInterface.first->second->LoadLeases() == true) {
-                                SYSLOG(Logging::Startup, (_T("Leased list for interface [%s] loaded!"), interfaceName.c_str()));
-                            }
-
-                            SYSLOG(Logging::Startup, (_T("Interface [%s] activated, DHCP request issued"), interfaceName.c_str()));
-                            Reload(interfaceName, true);
-                        } else {
-                            SYSLOG(Logging::Startup, (_T("Interface [%s] activated, static IP assigned"), interfaceName.c_str()));
-                            Reload(interfaceName, false);
-                        }
-                    }
+                        std::make_tuple(index.Current(), requested));
+                    _adminLock.Unlock();
+                } else {
+                    Activate(interfaceName, index.Current(), requested);
                 }
             }
         }
@@ -189,7 +160,16 @@ namespace Plugin
             while (notListed.Next() == true) {
                 const string interfaceName(notListed.Name());
 
-                if (_interfaces.find(interfaceName) == _interfaces.end()) {
+                _adminLock.Lock();
+
+                std::map<const string, std::pair<Entry, uint64_t>>::iterator pending(_pending.find(interfaceName));
+
+                if (pending != _pending.end()) {
+                    // A configured interface that showed up in the mean time, do not let it be
+                    // configured a second time once its event arrives.
+                    Activate(interfaceName, pending->second.first, pending->second.second);
+                    _pending.erase(pending);
+                } else if (_interfaces.find(interfaceName) == _interfaces.end()) {
                     _dhcpInterfaces.emplace(std::piecewise_construct,
                         std::make_tuple(interfaceName),
                         std::make_tuple(Core::ProxyType<DHCPEngine>::Create(this, interfaceName, _persistentStoragePath)));
@@ -197,6 +177,8 @@ namespace Plugin
                         std::make_tuple(interfaceName),
                         std::make_tuple(StaticInfo()));
                 }
+
+                _adminLock.Unlock();
             }
         }
 
@@ -217,6 +199,20 @@ namespace Plugin
         // From now on we observer the states of the give interfaces.
         _observer->Open();
 
+        // Interfaces that appeared between our check and opening the observer would be
+        // missed, so report the ones that are available by now to the observer.
+        Core::AdapterIterator::Flush();
+
+        _adminLock.Lock();
+        std::map<const string, std::pair<Entry, uint64_t>>::const_iterator pending(_pending.begin());
+        while (pending != _pending.end()) {
+            if (Core::AdapterIterator(pending->first).IsValid() == true) {
+                _observer->Event(pending->first);
+            }
+            pending++;
+        }
+        _adminLock.Unlock();
+
         // On success return empty, to indicate there is no error text.
         return (result);
     }
@@ -237,6 +233,7 @@ namespace Plugin
         _dns.clear();
         _dhcpInterfaces.clear();
         _interfaces.clear();
+        _pending.clear();
         _service = nullptr;
     }
 
@@ -488,7 +485,9 @@ namespace Plugin
                 Core::OptionalType<Core::JSON::Error> error;
                 if (lease.IElement::FromFile(leaseFile, error) == true) {
 
+                    // Start by verifying this lease (INIT-REBOOT) instead of a full discovery.
                     _client.AddUnleasedOffer(lease.Get());
+                    _rebooting = true;
                 }
 
                 if (error.IsSet() == true) {
@@ -504,6 +503,41 @@ namespace Plugin
         return result;
     }
 
+    void NetworkControl::Activate(const string& interfaceName, const Entry& info, const uint64_t requested)
+    {
+        Core::AdapterIterator adapter(interfaceName);
+
+        ASSERT(adapter.IsValid() == true);
+
+        adapter.Up(true);
+
+        auto dhcpInterface = _dhcpInterfaces.emplace(std::piecewise_construct,
+            std::make_tuple(interfaceName),
+            std::make_tuple(Core::ProxyType<DHCPEngine>::Create(this, interfaceName, _persistentStoragePath)));
+        _interfaces.emplace(std::piecewise_construct,
+            std::make_tuple(interfaceName),
+            std::make_tuple(info));
+
+        SYSLOG(Logging::Startup, (_T("Interface [%s] available after %d mS"), interfaceName.c_str(), static_cast<uint32_t>((Core::Time::Now().Ticks() - requested) / Core::Time::TicksPerMillisecond)));
+
+        JsonData::NetworkControl::NetworkData::ModeType how(info.Mode);
+        if (how == JsonData::NetworkControl::NetworkData::ModeType::MANUAL) {
+            SYSLOG(Logging::Startup, (_T("Interface [%s] activated, no IP associated"), interfaceName.c_str()));
+        } else {
+            if (how == JsonData::NetworkControl::NetworkData::ModeType::DYNAMIC) {
+                if (dhcpInterface.first->second->LoadLeases() == true) {
+                    SYSLOG(Logging::Startup, (_T("Leased list for interface [%s] loaded!"), interfaceName.c_str()));
+                }
+
+                SYSLOG(Logging::Startup, (_T("Interface [%s] activated, DHCP request issued"), interfaceName.c_str()));
+                Reload(interfaceName, true);
+            } else {
+                SYSLOG(Logging::Startup, (_T("Interface [%s] activated, static IP assigned"), interfaceName.c_str()));
+                Reload(interfaceName, false);
+            }
+        }
+    }
+
     uint32_t NetworkControl::Reload(const string& interfaceName, const bool dynamic)
     {
 
@@ -531,7 +565,7 @@ namespace Plugin
                     uint8_t mac[6];
                     interface.MACAddress(mac, sizeof(mac));
                     entry->second->UpdateMAC(mac, sizeof(mac));
-                    entry->second->GetIP();
+                    entry->second->Acquire();
                     result = Core::ERROR_NONE;
                 }
             }
@@ -703,6 +737,9 @@ namespace Plugin
                     update = RemoveDNSEntry(_dns, servers.Current()) | update;
                 }
 
+                // Remember what we are using now, so it can be removed on the next change.
+                info->second.Offer(offer);
+
                 _adminLock.Unlock();
 
                 if (update == true) {
@@ -746,6 +783,60 @@ namespace Plugin
 
     }
 
+    void NetworkControl::RebootFailed(const string& interfaceName, const DHCPClientImplementation::Offer& offer)
+    {
+        TRACE(Trace::Information, ("DHCP INIT-REBOOT for ip %s not answered!\n", offer.Address().HostAddress().c_str()));
+
+        std::map<const string, Core::ProxyType<DHCPEngine>>::const_iterator entry(_dhcpInterfaces.find(interfaceName));
+
+        if (entry != _dhcpInterfaces.end()) {
+
+            if (offer.IsLeaseValid() == true) {
+                // No server could confirm it, but the lease did not expire yet, so we may use it (RFC 2131 section 3.7).
+                bool update = false;
+                Core::AdapterIterator adapter(interfaceName);
+
+                _adminLock.Lock();
+
+                std::map<const string, StaticInfo>::iterator info(_interfaces.find(interfaceName));
+
+                ASSERT(info != _interfaces.end());
+
+                DHCPClientImplementation::Offer::DnsIterator servers(offer.DNS());
+                while (servers.Next() == true) {
+                    update = AddDNSEntry(_dns, servers.Current()) | update;
+                }
+
+                if (info != _interfaces.end()) {
+                    // Like an accepted request, the lease in use replaces the previous one.
+                    servers = info->second.Offer().DNS();
+                    while (servers.Next() == true) {
+                        update = RemoveDNSEntry(_dns, servers.Current()) | update;
+                    }
+
+                    info->second.Offer(offer);
+                }
+
+                _adminLock.Unlock();
+
+                if (update == true) {
+                    RefreshDNS();
+                }
+
+                SetIP(adapter, Core::IPNode(offer.Address(), offer.Netmask()), offer.Gateway(), offer.Broadcast(), true);
+
+                SYSLOG(Logging::Startup, (_T("Interface [%s] using persisted lease [%s] after %d mS"), interfaceName.c_str(), offer.Address().HostAddress().c_str(), entry->second->Elapsed()));
+
+                event_connectionchange(interfaceName.c_str(), offer.Address().HostAddress().c_str(), JsonData::NetworkControl::ConnectionchangeParamsData::StatusType::CONNECTED);
+            }
+
+            // Keep on looking for a server, preferably one that hands out the same address.
+            entry->second->Discover(offer.Address());
+        } else {
+            TRACE_L1("Reboot failed for nonexisting network interface!");
+        }
+    }
+
     void NetworkControl::NoOffers(const string& interfaceName)
     {
         _adminLock.Lock();
@@ -856,7 +947,18 @@ namespace Plugin
 
             _adminLock.Lock();
 
-            if (_interfaces.find(interfaceName) == _interfaces.end()) {
+            std::map<const string, std::pair<Entry, uint64_t>>::iterator pending(_pending.find(interfaceName));
+            bool activated = (pending != _pending.end());
+
+            if (activated == true) {
+                // A configured interface finally showed up, bring it up as configured.
+                Activate(interfaceName, pending->second.first, pending->second.second);
+                _pending.erase(pending);
+
+                message += _T("Create\" }");
+
+                status = JsonData::NetworkControl::ConnectionchangeParamsData::StatusType::CREATED;
+            } else if (_interfaces.find(interfaceName) == _interfaces.end()) {
                 _dhcpInterfaces.emplace(std::piecewise_construct,
                     std::make_tuple(interfaceName),
                     std::make_tuple(Core::ProxyType<DHCPEngine>::Create(this, interfaceName, _persistentStoragePath)));
@@ -874,7 +976,9 @@ namespace Plugin
                 TRACE(Trace::Information, (_T("Updated interface: %s"), interfaceName.c_str()));
             }
 
-            if ((adapter.IsRunning() == true) && (adapter.IsUp() == true)) {
+            if (activated == true) {
+                // Nothing more to do, a newly created interface is setup by now.
+            } else if ((adapter.IsRunning() == true) && (adapter.IsUp() == true)) {
                 std::map<const string, StaticInfo>::iterator index(_interfaces.find(interfaceName));
 
                 if (index != _interfaces.end()) {
@@ -305,6 +305,10 @@ namespace Plugin {
         };
         class DHCPEngine : public Core::IDispatch {
         private:
+            // Time to wait for a server to confirm a persisted lease (INIT-REBOOT), before
+            // falling back to a full discovery.
+            static constexpr uint16_t RebootWaitTime = 1000; // mS
+
             DHCPEngine() = delete;
             DHCPEngine(const DHCPEngine&) = delete;
             DHCPEngine& operator=(const DHCPEngine&) = delete;
@@ -316,6 +320,9 @@ namespace Plugin {
             DHCPEngine(NetworkControl* parent, const string& interfaceName, const string& persistentStoragePath)
                 : _parent(*parent)
                 , _retries(0)
+                , _waitTime(0)
+                , _rebooting(false)
+                , _start(0)
                 , _client(interfaceName, std::bind(&DHCPEngine::NewOffer, this, std::placeholders::_1), 
                           std::bind(&DHCPEngine::RequestResult, this, std::placeholders::_1, std::placeholders::_2))
                 , _leaseFilePath((persistentStoragePath.empty()) ? "" :  (persistentStoragePath + _client.Interface() + ".json"))
@@ -355,6 +362,17 @@ namespace Plugin {
                 _client.UpdateMAC(buffer, size);
             }
 
+            void Acquire()
+            {
+                _start = Core::Time::Now().Ticks();
+                GetIP();
+            }
+
+            inline uint32_t Elapsed() const
+            {
+                return (static_cast<uint32_t>((Core::Time::Now().Ticks() - _start) / Core::Time::TicksPerMillisecond));
+            }
+
             void GetIP() 
             {
                 return (GetIP(Core::NodeId()));
@@ -364,7 +382,11 @@ namespace Plugin {
             {
                 auto offerIterator = _client.UnleasedOffers();
                 if (offerIterator.Next() == true) {
-                    Request(offerIterator.Current());
+                    if (_rebooting == true) {
+                        Reboot(offerIterator.Current());
+                    } else {
+                        Request(offerIterator.Current());
+                    }
                 } else {
                     Discover(preferred);
                 }
@@ -380,8 +402,11 @@ namespace Plugin {
             void RequestResult(const DHCPClientImplementation::Offer& offer, const bool result) {
                 StopWatchdog();
 
+                _rebooting = false;
+
                 JsonData::NetworkControl::ConnectionchangeParamsData::StatusType status;
                 if (result == true) {
+                    SYSLOG(Logging::Startup, (_T("Interface [%s] got address [%s] in %d mS"), _client.Interface().c_str(), offer.Address().HostAddress().c_str(), Elapsed()));
                     _parent.RequestAccepted(_client.Interface(), offer);
                     status = JsonData::NetworkControl::ConnectionchangeParamsData::StatusType::CONNECTED;
                 } else {
@@ -398,6 +423,12 @@ namespace Plugin {
                 _client.Request(offer);
             }
 
+            inline void Reboot(const DHCPClientImplementation::Offer& offer) {
+
+                SetupWatchdog(RebootWaitTime, 0);
+                _client.Reboot(offer);
+            }
+
             inline void Completed()
             {
                 _client.Completed();
@@ -411,11 +442,16 @@ namespace Plugin {
                 _client.RemoveUnleasedOffer(offer);
             }
 
-            void SetupWatchdog() 
+            inline void SetupWatchdog() 
             {
-                const uint16_t responseMS = _parent.ResponseTime() * 1000;
-                Core::Time entry(Core::Time::Now().Add(responseMS));
-                _retries = _parent.Retries();
+                SetupWatchdog(_parent.ResponseTime() * 1000, _parent.Retries());
+            }
+
+            void SetupWatchdog(const uint16_t waitTime, const uint8_t retries) 
+            {
+                Core::Time entry(Core::Time::Now().Add(waitTime));
+                _waitTime = waitTime;
+                _retries = retries;
 
                 Core::ProxyType<Core::IDispatch> job(*this);    
 
@@ -437,8 +473,7 @@ namespace Plugin {
             virtual void Dispatch() override
             {
                 if (_retries > 0) {
-                    const uint16_t responseMS = _parent.ResponseTime() * 1000;
-                    Core::Time entry(Core::Time::Now().Add(responseMS));
+                    Core::Time entry(Core::Time::Now().Add(_waitTime));
                     Core::ProxyType<Core::IDispatch> job(*this);
 
                     _retries--;
@@ -459,7 +494,13 @@ namespace Plugin {
                             // Remove unresponsive offer from potential candidates
                             DHCPClientImplementation::Offer copy = offer.Current(); 
                             _client.RemoveUnleasedOffer(offer.Current());
-                            _parent.RequestFailed(_client.Interface(), copy);
+
+                            if (_rebooting == true) {
+                                _rebooting = false;
+                                _parent.RebootFailed(_client.Interface(), copy);
+                            } else {
+                                _parent.RequestFailed(_client.Interface(), copy);
+                            }
                         }
                     }
                 }
@@ -468,6 +509,9 @@ namespace Plugin {
         private:
             NetworkControl& _parent;
             uint8_t _retries;
+            uint16_t _waitTime;
+            bool _rebooting;
+            uint64_t _start;
             DHCPClientImplementation _client;
             string _leaseFilePath;
         };
@@ -509,11 +553,13 @@ namespace Plugin {
         virtual uint32_t RemoveDNS(IIPNetwork::IDNSServers* dnsEntries) override;
 
     private:
+        void Activate(const string& interfaceName, const Entry& info, const uint64_t requested);
         uint32_t Reload(const string& interfaceName, const bool dynamic);
         uint32_t SetIP(Core::AdapterIterator& adapter, const Core::IPNode& ipAddress, const Core::NodeId& gateway, const Core::NodeId& broadcast, bool clearOld = false);
         bool NewOffer(const string& interfaceName, const DHCPClientImplementation::Offer& offer);
         void RequestAccepted(const string& interfaceName, const DHCPClientImplementation::Offer& offer);
         void RequestFailed(const string& interfaceName, const DHCPClientImplementation::Offer& offer);
+        void RebootFailed(const string& interfaceName, const DHCPClientImplementation::Offer& offer);
         void NoOffers(const string& interfaceName);
         void RefreshDNS();
         void Activity(const string& interface);
@@ -551,6 +597,9 @@ namespace Plugin {
         std::list<std::pair<uint16_t, Core::NodeId>> _dns;
         std::map<const string, StaticInfo> _interfaces;
         std::map<const string, Core::ProxyType<DHCPEngine>> _dhcpInterfaces;
+        // Configured interfaces that did not exist (yet) during Initialize, with the time
+        // they were requested. They get activated as soon as the observer reports them.
+        std::map<const string, std::pair<Entry, uint64_t>> _pending;
         Core::ProxyType<AdapterObserver> _observer;
     };
 
@@ -0,0 +1,254 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../DHCPClientImplementation.h"
+#include "../../DHCPServer/DHCPServerImplementation.h"
+
+// Time-to-address of the DHCP client, with the server of the DHCPServer plugin as the network's
+// DHCP server on the other end of a veth pair (needs CAP_NET_ADMIN/CAP_NET_RAW):
+//
+//    ip link add dhcp0 type veth peer name dhcp1
+//    ip addr add 192.168.201.1/24 dev dhcp1
+//    ip link set dhcp0 up && ip link set dhcp1 up
+//    NetworkControlDHCPTest -client dhcp0 -server dhcp1 -runs 20
+//
+// It measures a full DISCOVER/OFFER/REQUEST/ACK, an INIT-REBOOT of the lease that got, and an
+// INIT-REBOOT with the server gone, which must go unanswered while the lease stays usable. The
+// exit code is the number of checks that failed.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+static constexpr uint32_t AnswerTime = 2000; // mS
+static constexpr uint32_t RebootWaitTime = 1000; // mS, as the DHCPEngine of NetworkControl
+
+class Client {
+public:
+    Client() = delete;
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    Client(const string& interfaceName)
+        : _lock()
+        , _answered(false, true)
+        , _accepted(false)
+        , _lease()
+        , _client(interfaceName,
+              std::bind(&Client::Offered, this, std::placeholders::_1),
+              std::bind(&Client::Answered, this, std::placeholders::_1, std::placeholders::_2))
+    {
+    }
+    ~Client()
+    {
+        _client.Completed();
+    }
+
+public:
+    // Returns the mS it took to get an answer, ~0 if none came.
+    uint32_t Discover()
+    {
+        _answered.ResetEvent();
+        const uint64_t start = Core::Time::Now().Ticks();
+        _client.Discover(Core::NodeId());
+
+        return (Wait(start, AnswerTime));
+    }
+    uint32_t Reboot(const uint32_t waitTime)
+    {
+        _answered.ResetEvent();
+        _client.ClearUnleasedOffers();
+        _client.AddUnleasedOffer(_lease);
+
+        const uint64_t start = Core::Time::Now().Ticks();
+        _client.Reboot(_lease);
+
+        return (Wait(start, waitTime));
+    }
+    bool Accepted() const
+    {
+        return (_accepted);
+    }
+    const Plugin::DHCPClientImplementation::Offer& Lease() const
+    {
+        return (_lease);
+    }
+    void Completed()
+    {
+        _client.Completed();
+    }
+
+private:
+    uint32_t Wait(const uint64_t start, const uint32_t waitTime)
+    {
+        uint32_t result = static_cast<uint32_t>(~0);
+
+        if (_answered.Lock(waitTime) == Core::ERROR_NONE) {
+            result = static_cast<uint32_t>((Core::Time::Now().Ticks() - start) / Core::Time::TicksPerMillisecond);
+        }
+        _client.Completed();
+
+        return (result);
+    }
+    void Offered(Plugin::DHCPClientImplementation::Offer& offer)
+    {
+        // Like NetworkControl, take the first one.
+        if (_client.Classification() == Plugin::DHCPClientImplementation::CLASSIFICATION_DISCOVER) {
+            _client.Request(offer);
+        }
+    }
+    void Answered(Plugin::DHCPClientImplementation::Offer& offer, const bool accepted)
+    {
+        _lock.Lock();
+        _accepted = accepted;
+        if (accepted == true) {
+            _lease = offer;
+        }
+        _lock.Unlock();
+
+        _answered.SetEvent();
+    }
+
+private:
+    Core::CriticalSection _lock;
+    Core::Event _answered;
+    bool _accepted;
+    Plugin::DHCPClientImplementation::Offer _lease;
+    Plugin::DHCPClientImplementation _client;
+};
+
+class Timings {
+public:
+    Timings(const TCHAR name[])
+        : _name(name)
+        , _samples()
+        , _missed(0)
+    {
+    }
+
+public:
+    void Add(const uint32_t sample)
+    {
+        if (sample == static_cast<uint32_t>(~0)) {
+            _missed++;
+        } else {
+            _samples.push_back(sample);
+        }
+    }
+    uint32_t Missed() const
+    {
+        return (_missed);
+    }
+    void Print(const bool last) const
+    {
+        uint64_t total = 0;
+        for (const uint32_t sample : _samples) {
+            total += sample;
+        }
+
+        printf("  \"%s\": { \"runs\": %u, \"missed\": %u, \"min\": %u, \"mean\": %u, \"max\": %u }%s\n",
+            _name,
+            static_cast<uint32_t>(_samples.size() + _missed), _missed,
+            (_samples.empty() == true ? 0 : *std::min_element(_samples.begin(), _samples.end())),
+            (_samples.empty() == true ? 0 : static_cast<uint32_t>(total / _samples.size())),
+            (_samples.empty() == true ? 0 : *std::max_element(_samples.begin(), _samples.end())),
+            (last == true ? "" : ","));
+    }
+
+private:
+    const TCHAR* _name;
+    std::vector<uint32_t> _samples;
+    uint32_t _missed;
+};
+
+}
+
+int main(int argc, char** argv)
+{
+    string clientInterface(_T("dhcp0"));
+    string serverInterface(_T("dhcp1"));
+    uint16_t runs = 10;
+    uint32_t failures = 0;
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-client") == 0) {
+            clientInterface = argv[index + 1];
+        } else if (strcmp(argv[index], "-server") == 0) {
+            serverInterface = argv[index + 1];
+        } else if (strcmp(argv[index], "-runs") == 0) {
+            runs = static_cast<uint16_t>(std::max(1, atoi(argv[index + 1])));
+        }
+    }
+
+    {
+        Timings discover(_T("discover"));
+        Timings reboot(_T("reboot"));
+        Timings unreachable(_T("unreachable"));
+        bool usable = true;
+
+        Plugin::DHCPServerImplementation server(_T("standin"), serverInterface, 100, 50, 0, Core::NodeId(), [](const string&, Plugin::DHCPServerImplementation::Lease*) {});
+
+        if (server.Open() != Core::ERROR_NONE) {
+            fprintf(stderr, "Could not open the DHCP server on %s\n", serverInterface.c_str());
+            failures++;
+        } else {
+            Client client(clientInterface);
+
+            for (uint16_t run = 0; run < runs; run++) {
+                discover.Add(client.Discover());
+            }
+
+            if (client.Accepted() == false) {
+                fprintf(stderr, "No lease from the server on %s\n", serverInterface.c_str());
+                failures++;
+            } else {
+                // The persisted lease, as NetworkControl loads it after a reboot.
+                for (uint16_t run = 0; run < runs; run++) {
+                    reboot.Add(client.Reboot(AnswerTime));
+                }
+                failures += reboot.Missed();
+
+                server.Close();
+
+                for (uint16_t run = 0; run < runs; run++) {
+                    const uint32_t answer = client.Reboot(RebootWaitTime);
+                    unreachable.Add(answer);
+
+                    // Without a server nothing may answer, and the lease must still be valid to fall back on.
+                    if ((answer != static_cast<uint32_t>(~0)) || (client.Lease().IsLeaseValid() == false)) {
+                        usable = false;
+                    }
+                }
+                failures += (usable == false ? 1 : 0);
+            }
+        }
+
+        printf("{\n");
+        discover.Print(false);
+        reboot.Print(false);
+        unreachable.Print(false);
+        printf("  \"fallback\": %s\n}\n", (usable == true ? "true" : "false"));
+    }
+
+    Core::Singleton::Dispose();
+
+    return (static_cast<int>(failures));
+}
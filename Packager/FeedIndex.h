@@ -0,0 +1,217 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include "Transfer.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Keeps track of the version of the package lists of the feeds in the OPKG configuration, the
+    // ETag, Last-Modified and size the servers reported when the lists were last downloaded. A
+    // (cheap) HEAD on every list tells if the local copy is still current, so the lists are only
+    // downloaded again when a feed actually changed.
+    class FeedIndex {
+    private:
+        class Feed : public Core::JSON::Container {
+        public:
+            Feed& operator=(const Feed&) = delete;
+
+            Feed()
+                : Core::JSON::Container()
+                , Location()
+                , Tag()
+                , Modified(-1)
+                , Length(-1)
+            {
+                Init();
+            }
+            Feed(const Feed& copy)
+                : Core::JSON::Container()
+                , Location(copy.Location)
+                , Tag(copy.Tag)
+                , Modified(copy.Modified)
+                , Length(copy.Length)
+            {
+                Init();
+            }
+            ~Feed() override
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("location"), &Location);
+                Add(_T("tag"), &Tag);
+                Add(_T("modified"), &Modified);
+                Add(_T("length"), &Length);
+            }
+
+        public:
+            Core::JSON::String Location;
+            Core::JSON::String Tag;
+            Core::JSON::DecSInt64 Modified;
+            Core::JSON::DecSInt64 Length;
+        };
+
+        typedef std::map<string, Transfer::Validators> Validators;
+
+    public:
+        FeedIndex() = delete;
+        FeedIndex(const FeedIndex&) = delete;
+        FeedIndex& operator=(const FeedIndex&) = delete;
+
+        FeedIndex(const string& configFile, const string& storage)
+            : _storage(storage)
+            , _lists()
+            , _stored()
+            , _current()
+        {
+            Parse(configFile);
+            Load();
+        }
+        ~FeedIndex()
+        {
+        }
+
+    public:
+        // Asks every feed for the version of its package list. If any list changed, or a feed
+        // can not tell, the lists need to be downloaded again.
+        bool Changed()
+        {
+            bool changed = _lists.empty();
+
+            _current.clear();
+
+            for (const string& list : _lists) {
+                Transfer::Validators validators;
+
+                if (Transfer::Head(list, validators) != Core::ERROR_NONE) {
+                    TRACE_L1("Could not check %s, assuming it changed", list.c_str());
+                    changed = true;
+                } else {
+                    Validators::const_iterator stored(_stored.find(list));
+
+                    _current[list] = validators;
+
+                    if ((validators.IsSet() == false) || (stored == _stored.end()) || (stored->second != validators)) {
+                        TRACE_L1("Package list %s changed", list.c_str());
+                        changed = true;
+                    }
+                }
+            }
+
+            return (changed);
+        }
+        // The lists are downloaded, the versions seen in the last Changed() are the ones now local.
+        void Updated()
+        {
+            Core::JSON::ArrayType<Feed> feeds;
+
+            _stored = _current;
+
+            for (const std::pair<const string, Transfer::Validators>& entry : _stored) {
+                Feed& feed(feeds.Add());
+                feed.Location = entry.first;
+                feed.Tag = entry.second.Tag;
+                feed.Modified = entry.second.Modified;
+                feed.Length = entry.second.Length;
+            }
+
+            Core::File file(_storage);
+
+            if (file.Create() == true) {
+                feeds.IElement::ToFile(file);
+                file.Close();
+            } else {
+                TRACE_L1("Could not store the feed index in %s", _storage.c_str());
+            }
+        }
+        // Forget what is known, the next check always reports a change.
+        void Invalidate()
+        {
+            _stored.clear();
+
+            Core::File file(_storage);
+            if (file.Exists() == true) {
+                file.Destroy();
+            }
+        }
+
+    private:
+        void Parse(const string& configFile)
+        {
+            Core::File file(configFile);
+
+            if (file.Open(true) == true) {
+                std::vector<char> content(static_cast<size_t>(file.Size()) + 1, '\0');
+                const uint32_t length = file.Read(reinterpret_cast<uint8_t*>(content.data()), static_cast<uint32_t>(content.size() - 1));
+                std::istringstream lines(string(content.data(), length));
+                string line;
+
+                while (std::getline(lines, line)) {
+                    // src[/gz] <name> <url>
+                    std::istringstream fields(line);
+                    string type, name, location;
+
+                    if ((fields >> type >> name >> location) && ((type == _T("src")) || (type == _T("src/gz")))) {
+                        while ((location.empty() == false) && (location.back() == '/')) {
+                            location.pop_back();
+                        }
+                        _lists.push_back(location + (type == _T("src/gz") ? _T("/Packages.gz") : _T("/Packages")));
+                    }
+                }
+            }
+        }
+        void Load()
+        {
+            Core::File file(_storage);
+
+            if ((file.Exists() == true) && (file.Open(true) == true)) {
+                Core::JSON::ArrayType<Feed> feeds;
+                Core::OptionalType<Core::JSON::Error> error;
+                feeds.IElement::FromFile(file, error);
+
+                if (error.IsSet() == true) {
+                    TRACE_L1("Ignoring the feed index, parsing failed with %s", ErrorDisplayMessage(error.Value()).c_str());
+                } else {
+                    Core::JSON::ArrayType<Feed>::Iterator index(feeds.Elements());
+
+                    while (index.Next() == true) {
+                        Transfer::Validators& validators(_stored[index.Current().Location.Value()]);
+                        validators.Tag = index.Current().Tag.Value();
+                        validators.Modified = index.Current().Modified.Value();
+                        validators.Length = index.Current().Length.Value();
+                    }
+                }
+            }
+        }
+
+    private:
+        const string _storage;
+        std::vector<string> _lists;
+        Validators _stored;
+        Validators _current;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -20,7 +20,9 @@
 #include "PackagerImplementation.h"
 
 #if defined (DO_NOT_USE_DEPRECATED_API)
+#include <file_util.h>
 #include <opkg_cmd.h>
+#include <pkg_hash.h>
 #else
 #include <opkg.h>
 #endif
@@ -98,6 +100,19 @@ namespace Plugin {
              _volatileCache = config.MakeCacheVolatile.Value();
          }
 
+        Transfer::Initialize();
+        _feeds.reset(new FeedIndex(_configFile, _cachePath + _T("/feeds.json")));
+
+#if defined (DO_NOT_USE_DEPRECATED_API)
+        // A package fetched by the packager does not pass the signature check OPKG does on its own
+        // downloads, so packages are only fetched ahead when signatures are not checked anyway.
+        if (_skipSignatureChecking == true) {
+            for (uint8_t index = 0; index < config.Downloads.Value(); index++) {
+                _fetchers.emplace_back(this);
+            }
+        }
+#endif
+
         if (Core::File(_configFile).Exists() == false) {
             result = Core::ERROR_GENERAL;
         } else if (Core::Directory(_tempPath.c_str()).CreatePath() == false) {
@@ -117,7 +132,24 @@ namespace Plugin {
 
     PackagerImplementation::~PackagerImplementation()
     {
+        _worker.Stop();
+        _worker.Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+        _fetchers.clear();
+
+        for (auto& entry : _downloads) {
+            Core::File(entry.second->FileName).Destroy();
+            delete entry.second;
+        }
+        _downloads.clear();
+        _queue.clear();
+
         FreeOPKG();
+
+        if (_feeds != nullptr) {
+            _feeds.reset();
+            Transfer::Deinitialize();
+        }
     }
 
     void PackagerImplementation::Register(Exchange::IPackager::INotification* notification)
@@ -130,6 +162,9 @@ namespace Plugin {
             ASSERT(_inProgress.Package != nullptr);
             notification->StateChange(_inProgress.Package, _inProgress.Install);
         }
+        for (const InstallationData& queued : _queue) {
+            notification->StateChange(queued.Package, queued.Install);
+        }
         _adminLock.Unlock();
     }
 
@@ -159,27 +194,27 @@ namespace Plugin {
         uint32_t result = Core::ERROR_INPROGRESS;
 
         _adminLock.Lock();
-        if (_inProgress.Install == nullptr && _isSyncing == false) {
-            ASSERT(_inProgress.Package == nullptr);
-            result = Core::ERROR_NONE;
-            // OPKG bug: it marks it checked dependency for a package as cyclic dependency handling fix
-            // but since in our case it's not an process which dies when done, this info survives and makes the
-            // deps check to be skipped on subsequent calls. This is why hash_deinit() is called below
-            // and needs to be initialized here agian.
-            if (_opkgInitialized == true)  // it was initialized
-                FreeOPKG();
-            _opkgInitialized = InitOPKG();
-
-            if (_opkgInitialized) {
-                if (name && version && arch) {
-                    _inProgress.Package = Core::Service<PackageInfo>::Create<PackageInfo>(*name, *version, *arch);
-                    _inProgress.Install = Core::Service<InstallInfo>::Create<InstallInfo>();
-                } else {
-                    _isSyncing = true;
+        if (_isSyncing == false) {
+            if (name && version && arch) {
+                // Installs queue up, the same package only once.
+                bool queued = ((_inProgress.Package != nullptr) && (_inProgress.Package->Name() == *name));
+                for (auto index = _queue.cbegin(); (queued == false) && (index != _queue.cend()); index++) {
+                    queued = (index->Package->Name() == *name);
+                }
+
+                if (queued == false) {
+                    _queue.emplace_back();
+                    _queue.back().Package = Core::Service<PackageInfo>::Create<PackageInfo>(*name, *version, *arch);
+                    _queue.back().Install = Core::Service<InstallInfo>::Create<InstallInfo>();
+                    result = Core::ERROR_NONE;
                 }
+            } else if ((_inProgress.Install == nullptr) && (_queue.empty() == true)) {
+                _isSyncing = true;
+                result = Core::ERROR_NONE;
+            }
+
+            if (result == Core::ERROR_NONE) {
                 _worker.Run();
-            } else {
-                result = Core::ERROR_GENERAL;
             }
         }
         _adminLock.Unlock();
@@ -188,18 +223,171 @@ namespace Plugin {
 
     }
 
+    void PackagerImplementation::Process(bool isInstall)
+    {
+        // OPKG bug: it marks it checked dependency for a package as cyclic dependency handling fix
+        // but since in our case it's not an process which dies when done, this info survives and makes the
+        // deps check to be skipped on subsequent calls. This is why hash_deinit() is called below
+        // and needs to be initialized here agian.
+        if (_opkgInitialized == true)  // it was initialized
+            FreeOPKG();
+        _opkgInitialized = InitOPKG();
+
+        if (_opkgInitialized == false) {
+            if (isInstall == true) {
+                _inProgress.Install->SetError(Core::ERROR_GENERAL);
+                NotifyStateChange();
+            } else {
+                NotifyRepoSynced(Core::ERROR_GENERAL);
+            }
+        } else {
+            BlockingSetupLocalRepoNoLock(isInstall == true ? RepoSyncMode::SETUP : RepoSyncMode::FORCED);
+
+            if (isInstall == true) {
+                Prefetch();
+                BlockingInstallUntilCompletionNoLock();
+
+                _adminLock.Lock();
+                auto download = _downloads.find(_inProgress.Package->Name());
+                if (download != _downloads.end()) {
+                    Core::File(download->second->FileName).Destroy();
+                    delete download->second;
+                    _downloads.erase(download);
+                }
+                _adminLock.Unlock();
+            }
+        }
+    }
+
+    // Starts fetching the packages that wait for installation, so they download in parallel while
+    // OPKG installs them one at a time.
+    void PackagerImplementation::Prefetch()
+    {
+#if defined (DO_NOT_USE_DEPRECATED_API)
+        if (_fetchers.empty() == false) {
+            std::list<string> names;
+
+            _adminLock.Lock();
+            if ((_inProgress.Package->Version().empty() == true) && (_downloads.find(_inProgress.Package->Name()) == _downloads.end())) {
+                names.push_back(_inProgress.Package->Name());
+            }
+            for (const InstallationData& queued : _queue) {
+                if ((queued.Package->Version().empty() == true) && (_downloads.find(queued.Package->Name()) == _downloads.end())) {
+                    names.push_back(queued.Package->Name());
+                }
+            }
+            _adminLock.Unlock();
+
+            for (const string& name : names) {
+                // A specific version is left to OPKG, otherwise the package it would pick is fetched.
+                pkg_t* candidate = pkg_hash_fetch_best_installation_candidate_by_name(name.c_str());
+
+                if ((candidate != nullptr) && (candidate->src != nullptr) && (candidate->src->value != nullptr) && (candidate->filename != nullptr)) {
+                    const string location(string(candidate->src->value) + '/' + candidate->filename);
+                    const string fileName(_tempPath + '/' + Core::File::FileNameExtended(candidate->filename));
+                    const string md5(candidate->md5sum != nullptr ? candidate->md5sum : _T(""));
+#if defined (HAVE_SHA256)
+                    const string sha256(candidate->sha256sum != nullptr ? candidate->sha256sum : _T(""));
+#else
+                    const string sha256;
+#endif
+
+                    _adminLock.Lock();
+                    _downloads[name] = new Download(location, fileName, md5, sha256);
+                    _adminLock.Unlock();
+                }
+            }
+
+            for (DownloadThread& fetcher : _fetchers) {
+                fetcher.Run();
+            }
+        }
+#endif
+    }
+
+    // The local file of a package fetched ahead, empty if OPKG should fetch it itself.
+    string PackagerImplementation::Prefetched(const string& name)
+    {
+        string result;
+        Download* download = nullptr;
+
+        _adminLock.Lock();
+        auto index = _downloads.find(name);
+        if (index != _downloads.end()) {
+            download = index->second;
+        }
+        _adminLock.Unlock();
+
+        if (download != nullptr) {
+            if (download->Done.Lock(0) != Core::ERROR_NONE) {
+                _inProgress.Install->SetState(Exchange::IPackager::DOWNLOADING);
+                NotifyStateChange();
+                download->Done.Lock(Core::infinite);
+            }
+            if ((download->Result == Core::ERROR_NONE) && (Verify(*download) != Core::ERROR_NONE)) {
+                TRACE_L1("%s fetched ahead does not match the checksum of the feed, leaving it to OPKG", name.c_str());
+                Core::File(download->FileName).Destroy();
+                download->Result = Core::ERROR_INCORRECT_HASH;
+            }
+            if (download->Result == Core::ERROR_NONE) {
+                _inProgress.Install->SetState(Exchange::IPackager::DOWNLOADED);
+                NotifyStateChange();
+                result = download->FileName;
+            } else {
+                TRACE_L1("Fetching %s ahead failed (%d), leaving it to OPKG", name.c_str(), download->Result);
+            }
+        }
+
+        return (result);
+    }
+
+    // Checks a package fetched ahead against the checksum the feed lists for it, like OPKG checks
+    // the packages it downloads itself. Without a listed checksum there is nothing to check.
+    /* static */ uint32_t PackagerImplementation::Verify(const Download& download)
+    {
+        uint32_t result = Core::ERROR_NONE;
+
+#if defined (DO_NOT_USE_DEPRECATED_API)
+        char* sum = nullptr;
+        const string* expected = nullptr;
+
+#if defined (HAVE_SHA256)
+        if (download.SHA256.empty() == false) {
+            sum = file_sha256sum_alloc(download.FileName.c_str());
+            expected = &download.SHA256;
+        } else
+#endif
+        if (download.MD5.empty() == false) {
+            sum = file_md5sum_alloc(download.FileName.c_str());
+            expected = &download.MD5;
+        }
+
+        if ((expected != nullptr) && ((sum == nullptr) || (strcmp(sum, expected->c_str()) != 0))) {
+            result = Core::ERROR_INCORRECT_HASH;
+        }
+
+        free(sum);
+#endif
+
+        return (result);
+    }
+
     void PackagerImplementation::BlockingInstallUntilCompletionNoLock() {
         ASSERT(_inProgress.Install != nullptr && _inProgress.Package != nullptr);
 
 #if defined (DO_NOT_USE_DEPRECATED_API)
         opkg_cmd_t* command = opkg_cmd_find("install");
         if (command) {
+            string target(Prefetched(_inProgress.Package->Name()));
+            if (target.empty() == true) {
+                target = _inProgress.Package->Name();
+            }
             _inProgress.Install->SetState(Exchange::IPackager::INSTALLING);
             NotifyStateChange();
             opkg_config->pfm = command->pfm;
-            std::unique_ptr<char[]> targetCopy(new char [_inProgress.Package->Name().length() + 1]);
-            std::copy_n(_inProgress.Package->Name().begin(), _inProgress.Package->Name().length(), targetCopy.get());
-            (targetCopy.get())[_inProgress.Package->Name().length()] = 0;
+            std::unique_ptr<char[]> targetCopy(new char [target.length() + 1]);
+            std::copy_n(target.begin(), target.length(), targetCopy.get());
+            (targetCopy.get())[target.length()] = 0;
             const char* argv[1];
             argv[0] = targetCopy.get();
             if (opkg_cmd_exec(command, 1, argv) == 0) {
@@ -282,6 +470,10 @@ namespace Plugin {
     {
         _adminLock.Lock();
         TRACE_L1("State for %s changed to %d (%d %%, %d)", _inProgress.Package->Name().c_str(), _inProgress.Install->State(), _inProgress.Install->Progress(), _inProgress.Install->ErrorCode());
+        if (_inProgress.Install->IsFinished() == true) {
+            TRACE(Trace::Information, (_T("%s done in %d mS: queued %d mS, download %d mS, install %d mS"), _inProgress.Package->Name().c_str(),
+                _inProgress.Install->TotalTime(), _inProgress.Install->QueueTime(), _inProgress.Install->DownloadTime(), _inProgress.Install->InstallTime()));
+        }
         for (auto* notification : _notifications) {
             notification->StateChange(_inProgress.Package, _inProgress.Install);
         }
@@ -319,20 +511,32 @@ namespace Plugin {
 
     void PackagerImplementation::BlockingSetupLocalRepoNoLock(RepoSyncMode mode)
     {
+        ASSERT(mode == RepoSyncMode::SETUP || _isSyncing == true);
+
+        // Installs queued together share the package lists, they are set up once for all of them.
+        if ((mode == RepoSyncMode::SETUP) && (_listsReady == true)) {
+            return;
+        }
+
         string dirPath = Core::ToString(opkg_config->lists_dir);
         Core::Directory dir(dirPath.c_str());
         bool containFiles = false;
-        if (mode == RepoSyncMode::SETUP && _alwaysUpdateFirst == false) {
-            while (dir.Next() == true) {
-                if (dir.Name() != _T(".") && dir.Name() != _T("..") && dir.Name() != dirPath) {
-                    containFiles = true;
-                    break;
-                }
+        while (dir.Next() == true) {
+            if (dir.Name() != _T(".") && dir.Name() != _T("..") && dir.Name() != dirPath) {
+                containFiles = true;
+                break;
             }
         }
-        ASSERT(mode == RepoSyncMode::SETUP || _isSyncing == true);
-        if (containFiles == false) {
-            uint32_t result = Core::ERROR_NONE;
+
+        // Lists that are there are only downloaded again if the feed says they changed, unless the
+        // sync is forced. Then they are always downloaded, the check only records their versions.
+        bool update = ((containFiles == false) || (mode == RepoSyncMode::FORCED));
+        if ((containFiles == false) || (mode == RepoSyncMode::FORCED) || (_alwaysUpdateFirst == true)) {
+            update = (_feeds->Changed() == true) || (update == true);
+        }
+
+        uint32_t result = Core::ERROR_NONE;
+        if (update == true) {
 #if defined DO_NOT_USE_DEPRECATED_API
             opkg_cmd_t* command = opkg_cmd_find("update");
             if (command)
@@ -344,7 +548,17 @@ namespace Plugin {
             {
                 TRACE_L1("Failed to set up local repo. Installing might not work");
                 result = Core::ERROR_GENERAL;
+                _feeds->Invalidate();
+            } else {
+                _feeds->Updated();
             }
+        } else {
+            TRACE_L1("Package lists are up to date");
+        }
+
+        _listsReady = (result == Core::ERROR_NONE);
+
+        if ((update == true) || (mode == RepoSyncMode::FORCED)) {
             NotifyRepoSynced(result);
         }
     }
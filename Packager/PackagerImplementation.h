@@ -20,6 +20,7 @@
 #pragma once
 
 #include "Module.h"
+#include "FeedIndex.h"
 #include <interfaces/IPackager.h>
 
 #include <list>
@@ -48,6 +49,7 @@ namespace Plugin {
                 , NoDeps()
                 , NoSignatureCheck()
                 , AlwaysUpdateFirst()
+                , Downloads(3)
             {
                 Add(_T("config"), &ConfigFile);
                 Add(_T("temppath"), &TempDir);
@@ -57,6 +59,7 @@ namespace Plugin {
                 Add(_T("nodeps"), &NoDeps);
                 Add(_T("nosignaturecheck"), &NoSignatureCheck);
                 Add(_T("alwaysupdatefirst"), &AlwaysUpdateFirst);
+                Add(_T("downloads"), &Downloads);
             }
 
             ~Config() override
@@ -74,6 +77,7 @@ namespace Plugin {
             Core::JSON::Boolean NoDeps;
             Core::JSON::Boolean NoSignatureCheck;
             Core::JSON::Boolean AlwaysUpdateFirst;
+            Core::JSON::DecUInt8 Downloads; // packages fetched in parallel ahead of installation
         };
 
         PackagerImplementation()
@@ -87,6 +91,11 @@ namespace Plugin {
             , _alwaysUpdateFirst(false)
             , _volatileCache(false)
             , _opkgInitialized(false)
+            , _feeds()
+            , _listsReady(false)
+            , _queue()
+            , _downloads()
+            , _fetchers()
             , _worker(this)
             , _isUpgrade(false)
             , _isSyncing(false)
@@ -190,6 +199,18 @@ namespace Plugin {
             void SetState(Exchange::IPackager::state state)
             {
                 TRACE_L1("Setting state to %d", state);
+                const uint64_t now = Core::Time::Now().Ticks();
+
+                if ((state == Exchange::IPackager::DOWNLOADING) && (_downloading == 0)) {
+                    _downloading = now;
+                } else if ((state == Exchange::IPackager::INSTALLING) && (_installing == 0)) {
+                    _installing = now;
+                } else if (state == Exchange::IPackager::INSTALLED) {
+                    _finished = now;
+                }
+                if (_started == 0) {
+                    _started = now;
+                }
                 _state = state;
             }
 
@@ -203,12 +224,47 @@ namespace Plugin {
             {
                 TRACE_L1("Setting error to %d", err);
                 _error = err;
+                _finished = Core::Time::Now().Ticks();
+            }
+
+            bool IsFinished() const
+            {
+                return (_finished != 0);
+            }
+
+            // Where the time of an installation went, in mS.
+            uint32_t QueueTime() const
+            {
+                return (Elapsed(_queued, _started));
+            }
+            uint32_t DownloadTime() const
+            {
+                return (Elapsed(_downloading, (_installing != 0 ? _installing : _finished)));
+            }
+            uint32_t InstallTime() const
+            {
+                return (Elapsed(_installing, _finished));
+            }
+            uint32_t TotalTime() const
+            {
+                return (Elapsed(_queued, _finished));
+            }
+
+        private:
+            static uint32_t Elapsed(const uint64_t start, const uint64_t end)
+            {
+                return (((start != 0) && (end > start)) ? static_cast<uint32_t>((end - start) / Core::Time::TicksPerMillisecond) : 0);
             }
 
         private:
             Exchange::IPackager::state _state = Exchange::IPackager::IDLE;
             uint32_t _error = 0u;
             uint8_t _progress = 0u;
+            uint64_t _queued = Core::Time::Now().Ticks();
+            uint64_t _started = 0u;
+            uint64_t _downloading = 0u;
+            uint64_t _installing = 0u;
+            uint64_t _finished = 0u;
         };
 
         struct InstallationData {
@@ -237,17 +293,27 @@ namespace Plugin {
             InstallThread(const InstallThread&) = delete;
 
             uint32_t Worker() override {
-                while(IsRunning() == true) {
-                    _parent->_adminLock.Lock(); // The parent may have lock when this starts so wait for it to release.
-                    bool isInstall = _parent->_inProgress.Install != nullptr;
-                    ASSERT(isInstall != true || _parent->_inProgress.Package != nullptr);
-                    _parent->_adminLock.Unlock();
+                _parent->_adminLock.Lock(); // The parent may have lock when this starts so wait for it to release.
+                const bool isSync = _parent->_isSyncing;
+                const bool isInstall = (isSync == false) && (_parent->_queue.empty() == false);
+                if (isInstall == true) {
+                    // Queued installs run one after the other, OPKG commits one package at a time.
+                    _parent->_inProgress.Package = _parent->_queue.front().Package;
+                    _parent->_inProgress.Install = _parent->_queue.front().Install;
+                    _parent->_queue.front().Package = nullptr;
+                    _parent->_queue.front().Install = nullptr;
+                    _parent->_queue.pop_front();
+                } else if (isSync == false) {
+                    // Idle, a next batch of work checks the package lists again.
+                    _parent->_listsReady = false;
+                    Block();
+                }
+                _parent->_adminLock.Unlock();
 
+                if ((isInstall == true) || (isSync == true)) {
                     // After this point locking is not needed because API running on other threads only read if in
                     // progress is filled in.
-                    _parent->BlockingSetupLocalRepoNoLock(isInstall == true ? RepoSyncMode::SETUP : RepoSyncMode::FORCED);
-                    if (isInstall)
-                        _parent->BlockingInstallUntilCompletionNoLock();
+                    _parent->Process(isInstall);
 
                     if (isInstall) {
                         _parent->_adminLock.Lock();
@@ -257,11 +323,82 @@ namespace Plugin {
                         _parent->_inProgress.Package = nullptr;
                         _parent->_adminLock.Unlock();
                     }
+                }
+
+                return ((isInstall == true) || (isSync == true) ? 0 : Core::infinite);
+            }
+
+        private:
+            PackagerImplementation* _parent;
+        };
+
+        // A package fetched ahead of its installation, while other packages are installed.
+        struct Download {
+            Download(const Download&) = delete;
+            Download& operator=(const Download&) = delete;
+
+            Download(const string& location, const string& fileName, const string& md5, const string& sha256)
+                : Location(location)
+                , FileName(fileName)
+                , MD5(md5)
+                , SHA256(sha256)
+                , Result(Core::ERROR_INPROGRESS)
+                , Busy(false)
+                , Done(false, true)
+            {
+            }
+
+            const string Location;
+            const string FileName;
+            const string MD5; // as listed in the feed, empty if not listed
+            const string SHA256;
+            uint32_t Result;
+            bool Busy;
+            Core::Event Done;
+        };
 
+        class DownloadThread : public Core::Thread {
+        public:
+            DownloadThread(PackagerImplementation* parent)
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("PackageDownload"))
+                , _parent(parent)
+            {}
+            ~DownloadThread() override
+            {
+                Stop();
+                Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+            }
+
+            DownloadThread& operator=(const DownloadThread&) = delete;
+            DownloadThread(const DownloadThread&) = delete;
+
+            uint32_t Worker() override {
+                Download* download = nullptr;
+
+                _parent->_adminLock.Lock();
+                for (auto& entry : _parent->_downloads) {
+                    if ((entry.second->Busy == false) && (entry.second->Result == Core::ERROR_INPROGRESS)) {
+                        download = entry.second;
+                        download->Busy = true;
+                        break;
+                    }
+                }
+                if (download == nullptr) {
                     Block();
                 }
+                _parent->_adminLock.Unlock();
+
+                if (download != nullptr) {
+                    const uint32_t result = Transfer::Get(download->Location, download->FileName);
+
+                    _parent->_adminLock.Lock();
+                    download->Result = result;
+                    download->Busy = false;
+                    download->Done.SetEvent();
+                    _parent->_adminLock.Unlock();
+                }
 
-                return Core::infinite;
+                return (download != nullptr ? 0 : Core::infinite);
             }
 
         private:
@@ -280,6 +417,10 @@ namespace Plugin {
 #endif
         void NotifyStateChange();
         void NotifyRepoSynced(uint32_t status);
+        void Process(bool isInstall);
+        void Prefetch();
+        string Prefetched(const string& name);
+        static uint32_t Verify(const Download& download);
         void BlockingInstallUntilCompletionNoLock();
         void BlockingSetupLocalRepoNoLock(RepoSyncMode mode);
         bool InitOPKG();
@@ -295,8 +436,13 @@ namespace Plugin {
         bool _alwaysUpdateFirst;
         bool _volatileCache;
         bool _opkgInitialized;
+        std::unique_ptr<FeedIndex> _feeds;
+        bool _listsReady;
         std::vector<Exchange::IPackager::INotification*> _notifications;
         InstallationData _inProgress;
+        std::list<InstallationData> _queue;
+        std::map<string, Download*> _downloads;
+        std::list<DownloadThread> _fetchers;
         InstallThread _worker;
         bool _isUpgrade;
         bool _isSyncing;
@@ -0,0 +1,195 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <curl/curl.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // The transfers the packager does next to OPKG: checking if a feed changed and fetching
+    // packages ahead of their installation. Every call uses its own handle, so they can run
+    // from multiple threads, once Initialize() is called.
+    class Transfer {
+    public:
+        static constexpr uint32_t Timeout = 30; // seconds, to connect
+        static constexpr uint32_t LowSpeedTime = 30; // seconds, below 1 byte/s counts as stalled
+
+        struct Validators {
+            Validators()
+                : Tag()
+                , Modified(-1)
+                , Length(-1)
+            {
+            }
+
+            inline bool IsSet() const
+            {
+                return ((Tag.empty() == false) || (Modified != -1));
+            }
+            inline bool operator==(const Validators& other) const
+            {
+                return ((Tag == other.Tag) && (Modified == other.Modified) && (Length == other.Length));
+            }
+            inline bool operator!=(const Validators& other) const
+            {
+                return (!operator==(other));
+            }
+
+            string Tag; // ETag
+            int64_t Modified; // Last-Modified, seconds since the epoch
+            int64_t Length;
+        };
+
+    public:
+        Transfer() = delete;
+        Transfer(const Transfer&) = delete;
+        Transfer& operator=(const Transfer&) = delete;
+
+        static void Initialize()
+        {
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+        }
+        static void Deinitialize()
+        {
+            curl_global_cleanup();
+        }
+
+        // Retrieves what identifies the current version of the resource, without getting it.
+        static uint32_t Head(const string& url, Validators& validators)
+        {
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+            CURL* handle = Create(url);
+
+            if (handle != nullptr) {
+                long filetime = -1;
+#if LIBCURL_VERSION_NUM >= 0x073700
+                curl_off_t length = -1;
+#else
+                double length = -1;
+#endif
+
+                validators = Validators();
+
+                curl_easy_setopt(handle, CURLOPT_NOBODY, 1L);
+                curl_easy_setopt(handle, CURLOPT_FILETIME, 1L);
+                curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, &Transfer::Header);
+                curl_easy_setopt(handle, CURLOPT_HEADERDATA, &validators);
+
+                if ((curl_easy_perform(handle) == CURLE_OK) && (IsSuccess(handle) == true)) {
+                    curl_easy_getinfo(handle, CURLINFO_FILETIME, &filetime);
+#if LIBCURL_VERSION_NUM >= 0x073700
+                    curl_easy_getinfo(handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+#else
+                    curl_easy_getinfo(handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length);
+#endif
+
+                    validators.Modified = filetime;
+                    validators.Length = static_cast<int64_t>(length);
+                    result = Core::ERROR_NONE;
+                }
+
+                curl_easy_cleanup(handle);
+            }
+
+            return (result);
+        }
+
+        static uint32_t Get(const string& url, const string& fileName)
+        {
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+            FILE* file = fopen(fileName.c_str(), "wb");
+
+            if (file == nullptr) {
+                result = Core::ERROR_OPENING_FAILED;
+            } else {
+                CURL* handle = Create(url);
+
+                if (handle != nullptr) {
+                    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, nullptr);
+                    curl_easy_setopt(handle, CURLOPT_WRITEDATA, file);
+
+                    const CURLcode code = curl_easy_perform(handle);
+
+                    if ((code == CURLE_OK) && (IsSuccess(handle) == true)) {
+                        result = Core::ERROR_NONE;
+                    } else {
+                        TRACE_L1("Fetching %s failed: %s", url.c_str(), curl_easy_strerror(code));
+                    }
+
+                    curl_easy_cleanup(handle);
+                }
+
+                if ((fclose(file) != 0) && (result == Core::ERROR_NONE)) {
+                    result = Core::ERROR_WRITE_ERROR;
+                }
+                if (result != Core::ERROR_NONE) {
+                    Core::File(fileName).Destroy();
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        static CURL* Create(const string& url)
+        {
+            CURL* handle = curl_easy_init();
+
+            if (handle != nullptr) {
+                curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+                curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+                curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+                curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1L);
+                curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, static_cast<long>(Timeout));
+                curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, 1L);
+                curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, static_cast<long>(LowSpeedTime));
+            }
+
+            return (handle);
+        }
+        static bool IsSuccess(CURL* handle)
+        {
+            long code = 0;
+            curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &code);
+
+            // Local (file://) feeds have no response code.
+            return ((code == 0) || ((code >= 200) && (code < 300)));
+        }
+        static size_t Header(char* buffer, size_t size, size_t count, void* data)
+        {
+            const size_t length = size * count;
+            static const char tag[] = "ETag:";
+
+            if ((length > (sizeof(tag) - 1)) && (strncasecmp(buffer, tag, sizeof(tag) - 1) == 0)) {
+                string& value = static_cast<Validators*>(data)->Tag;
+                value.assign(&(buffer[sizeof(tag) - 1]), length - (sizeof(tag) - 1));
+                value.erase(0, value.find_first_not_of(" \t"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+            }
+
+            return (length);
+        }
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,230 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // The JSON mapping files stay the source of the key maps, but they are compiled once into a flat
+    // table, sorted on code, and kept in the cache directory. On activation the compiled tables are
+    // mapped and fed to the VirtualInput key maps, without parsing any JSON. A compiled table is
+    // stamped with the size and modification time of its source; if the source changed, it is
+    // compiled again and the new table replaces the old one with a rename, so a reader never sees a
+    // partially written table. The sources are not watched, a change is picked up on the next load.
+    class KeyMapCache {
+    private:
+        static constexpr uint32_t Magic = 0x50414D4B; // 'KMAP'
+        static constexpr uint16_t Version = 2;
+
+        struct Header {
+            uint32_t Magic;
+            uint16_t Version;
+            uint16_t Reserved;
+            uint64_t SourceSize;
+            uint64_t SourceTime; // modification time, in ticks
+            uint32_t Entries;
+            uint32_t Padding;
+        };
+
+        struct Entry {
+            uint32_t Code;
+            uint16_t Key;
+            uint16_t Modifiers;
+        };
+
+    public:
+        KeyMapCache() = delete;
+        KeyMapCache(const KeyMapCache&) = delete;
+        KeyMapCache& operator=(const KeyMapCache&) = delete;
+
+        KeyMapCache(const string& directory)
+            : _directory(directory)
+        {
+            if ((_directory.empty() == false) && (Core::Directory(_directory.c_str()).CreatePath() == false)) {
+                TRACE_L1(_T("Could not create the key map cache in %s, compiling in memory only"), _directory.c_str());
+                _directory.clear();
+            }
+        }
+        ~KeyMapCache()
+        {
+        }
+
+    public:
+        uint32_t Load(const string& mappingFile, PluginHost::VirtualInput::KeyMap& map) const
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+            const Core::File source(mappingFile);
+
+            if (source.Exists() == true) {
+                const string compiled(CacheFile(mappingFile));
+
+                result = Map(compiled, source, map);
+
+                if (result != Core::ERROR_NONE) {
+                    std::vector<Entry> entries;
+
+                    result = Compile(mappingFile, entries);
+
+                    if (result == Core::ERROR_NONE) {
+                        if (compiled.empty() == false) {
+                            Store(compiled, source, entries);
+                        }
+                        Fill(entries.data(), static_cast<uint32_t>(entries.size()), map);
+                    }
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        string CacheFile(const string& mappingFile) const
+        {
+            string result;
+
+            if (_directory.empty() == false) {
+                // The same file name can live in the persistent and the data path, tell them apart.
+                uint32_t hash = 2166136261;
+                for (const TCHAR character : mappingFile) {
+                    hash = (hash ^ static_cast<uint8_t>(character)) * 16777619;
+                }
+
+                TCHAR postfix[16];
+                ::snprintf(postfix, sizeof(postfix), _T("-%08X.map"), hash);
+
+                result = _directory + Core::File::FileName(mappingFile) + postfix;
+            }
+
+            return (result);
+        }
+        uint32_t Map(const string& compiled, const Core::File& source, PluginHost::VirtualInput::KeyMap& map) const
+        {
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+
+            if (compiled.empty() == false) {
+                if (Core::File(compiled).Exists() == true) {
+                    Core::DataElementFile table(compiled, Core::File::USER_READ, 0);
+
+                    if ((table.IsValid() == true) && (table.Size() >= sizeof(Header))) {
+                        const Header* header = reinterpret_cast<const Header*>(table.Buffer());
+
+                        if ((header->Magic == Magic) && (header->Version == Version) && (header->SourceSize == source.Size()) && (header->SourceTime == source.ModificationTime().Ticks()) && (table.Size() == (sizeof(Header) + (static_cast<uint64_t>(header->Entries) * sizeof(Entry))))) {
+                            Fill(reinterpret_cast<const Entry*>(&(table.Buffer()[sizeof(Header)])), header->Entries, map);
+                            result = Core::ERROR_NONE;
+                        } else {
+                            TRACE_L1(_T("Compiled key map %s is outdated"), compiled.c_str());
+                        }
+                    }
+                }
+            }
+
+            return (result);
+        }
+        uint32_t Compile(const string& mappingFile, std::vector<Entry>& entries) const
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+            Core::File file(mappingFile);
+
+            if (file.Open(true) == true) {
+                Core::JSON::ArrayType<PluginHost::VirtualInput::KeyMap::KeyMapEntry> table;
+                Core::OptionalType<Core::JSON::Error> error;
+                table.IElement::FromFile(file, error);
+
+                if (error.IsSet() == true) {
+                    TRACE(Trace::Error, (_T("Parsing %s failed with %s"), mappingFile.c_str(), ErrorDisplayMessage(error.Value()).c_str()));
+                    result = Core::ERROR_PARSE_FAILURE;
+                } else {
+                    Core::JSON::ArrayType<PluginHost::VirtualInput::KeyMap::KeyMapEntry>::Iterator index(table.Elements());
+
+                    while (index.Next() == true) {
+                        if ((index.Current().Code.IsSet() == true) && (index.Current().Key.IsSet() == true)) {
+                            Entry entry;
+                            entry.Code = index.Current().Code.Value();
+                            entry.Key = index.Current().Key.Value();
+                            entry.Modifiers = 0;
+
+                            Core::JSON::ArrayType<Core::JSON::EnumType<PluginHost::VirtualInput::KeyMap::modifier>>::Iterator flags(index.Current().Modifiers.Elements());
+
+                            while (flags.Next() == true) {
+                                entry.Modifiers |= static_cast<uint16_t>(flags.Current().Value());
+                            }
+
+                            entries.push_back(entry);
+                        }
+                    }
+
+                    std::stable_sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) { return (lhs.Code < rhs.Code); });
+
+                    // Like the JSON load, the first translation of a code is the one that counts.
+                    entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) { return (lhs.Code == rhs.Code); }), entries.end());
+
+                    result = Core::ERROR_NONE;
+                }
+            }
+
+            return (result);
+        }
+        void Store(const string& compiled, const Core::File& source, const std::vector<Entry>& entries) const
+        {
+            const string temporary(compiled + _T(".new"));
+            Core::File file(temporary);
+
+            if (file.Create() == false) {
+                TRACE_L1(_T("Could not create compiled key map %s"), temporary.c_str());
+            } else {
+                Header header;
+                ::memset(&header, 0, sizeof(header));
+                header.Magic = Magic;
+                header.Version = Version;
+                header.SourceSize = source.Size();
+                header.SourceTime = source.ModificationTime().Ticks();
+                header.Entries = static_cast<uint32_t>(entries.size());
+
+                const uint32_t length = static_cast<uint32_t>(entries.size() * sizeof(Entry));
+                bool written = (file.Write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header));
+                written = written && ((length == 0) || (file.Write(reinterpret_cast<const uint8_t*>(entries.data()), length) == length));
+
+                file.Close();
+
+                if ((written == false) || (::rename(temporary.c_str(), compiled.c_str()) != 0)) {
+                    TRACE_L1(_T("Could not store compiled key map %s"), compiled.c_str());
+                    file.Destroy();
+                }
+            }
+        }
+        static void Fill(const Entry entries[], const uint32_t count, PluginHost::VirtualInput::KeyMap& map)
+        {
+            for (uint32_t index = 0; index < count; index++) {
+                const Entry& entry(entries[index]);
+
+                if (map.Add(entry.Code, entry.Key, entry.Modifiers) == false) {
+                    map.Modify(entry.Code, entry.Key, entry.Modifiers);
+                }
+            }
+        }
+
+    private:
+        string _directory;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,151 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+namespace WPEFramework {
+namespace Remotes {
+
+    // Histogram of the time an event takes from the kernel (the evdev timestamp) to a given point in
+    // its handling. Bucket 0 holds everything below the resolution, every next bucket doubles that
+    // limit and the last bucket holds whatever did not fit in the others.
+    class Latency {
+    public:
+        static constexpr uint8_t Buckets = 12;
+        static constexpr uint32_t Resolution = 128; // uS, upper limit of the first bucket
+
+    public:
+        Latency(const Latency&) = delete;
+        Latency& operator=(const Latency&) = delete;
+
+        Latency()
+        {
+            Reset();
+        }
+        ~Latency()
+        {
+        }
+
+    public:
+        void Reset()
+        {
+            _samples = 0;
+            _total = 0;
+            _maximum = 0;
+            ::memset(_buckets, 0, sizeof(_buckets));
+        }
+        void Add(const uint32_t value)
+        {
+            uint8_t bucket = 0;
+            uint32_t limit = Resolution;
+
+            while ((bucket < (Buckets - 1)) && (value >= limit)) {
+                limit <<= 1;
+                bucket++;
+            }
+
+            _buckets[bucket]++;
+            _samples++;
+            _total += value;
+            if (value > _maximum) {
+                _maximum = value;
+            }
+        }
+        inline uint32_t Samples() const
+        {
+            return (_samples);
+        }
+        inline uint32_t Average() const
+        {
+            return (_samples == 0 ? 0 : static_cast<uint32_t>(_total / _samples));
+        }
+        inline uint32_t Maximum() const
+        {
+            return (_maximum);
+        }
+        inline uint32_t Bucket(const uint8_t index) const
+        {
+            ASSERT(index < Buckets);
+            return (_buckets[index]);
+        }
+
+    private:
+        uint32_t _samples;
+        uint64_t _total;
+        uint32_t _maximum;
+        uint32_t _buckets[Buckets];
+    };
+
+    class LatencyData : public Core::JSON::Container {
+    private:
+        LatencyData(const LatencyData&) = delete;
+        LatencyData& operator=(const LatencyData&) = delete;
+
+    public:
+        LatencyData()
+            : Core::JSON::Container()
+            , Samples()
+            , Average()
+            , Maximum()
+            , Histogram()
+        {
+            Add(_T("samples"), &Samples);
+            Add(_T("average"), &Average);
+            Add(_T("maximum"), &Maximum);
+            Add(_T("histogram"), &Histogram);
+        }
+        ~LatencyData()
+        {
+        }
+
+    public:
+        void Set(const Latency& latency)
+        {
+            Samples = latency.Samples();
+            Average = latency.Average();
+            Maximum = latency.Maximum();
+            Histogram.Clear();
+            for (uint8_t index = 0; index < Latency::Buckets; index++) {
+                Histogram.Add(Core::JSON::DecUInt32(latency.Bucket(index)));
+            }
+        }
+
+    public:
+        Core::JSON::DecUInt32 Samples;
+        Core::JSON::DecUInt32 Average; // uS
+        Core::JSON::DecUInt32 Maximum; // uS
+        Core::JSON::ArrayType<Core::JSON::DecUInt32> Histogram;
+    };
+
+    // Implemented by the producers that measure their key latencies, next to Exchange::IKeyProducer.
+    // The measurements are reported separately from the producer metadata.
+    struct ILatencies {
+        virtual ~ILatencies() {}
+
+        virtual string Name() const = 0;
+        // dispatched: kernel to the key handler of RemoteControl.
+        // handled: kernel to the return of that key handler, so including the key map lookup and the
+        // hand over to VirtualInput, not the processing by the clients.
+        virtual void Latencies(LatencyData& dispatched, LatencyData& handled) const = 0;
+    };
+
+} // namespace Remotes
+} // namespace WPEFramework
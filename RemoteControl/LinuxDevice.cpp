@@ -22,6 +22,7 @@
 #include <interfaces/IKeyHandler.h>
 #include <libudev.h>
 #include <linux/uinput.h>
+#include <sys/epoll.h>
 
 namespace WPEFramework {
 namespace Plugin {
@@ -40,21 +41,203 @@ namespace Plugin {
     private:
         static constexpr const TCHAR* InputDeviceSysFilePath = _T("/sys/class/input/");
         static constexpr const TCHAR* DeviceNamePath = _T("/device/name");
+        static constexpr uint8_t MaxEvents = 16;
 
     private:
         LinuxDevice(const LinuxDevice&) = delete;
         LinuxDevice& operator=(const LinuxDevice&) = delete;
 
+        // Creates a virtual keyboard through uinput and types a key on it at a fixed interval, so the
+        // latencies can be measured in a repeatable way without anyone pressing buttons.
+        class Generator : public Core::Thread {
+        private:
+            static constexpr const TCHAR* DeviceName = _T("WPEFramework synthetic keyboard");
+            static constexpr uint32_t SettleTime = 1000; // mS, for udev to announce the new device
+
+        public:
+            Generator(const Generator&) = delete;
+            Generator& operator=(const Generator&) = delete;
+
+            Generator()
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("LinuxInputGenerator"))
+                , _fd(-1)
+                , _code(0)
+                , _remaining(0)
+                , _interval(0)
+                , _created(false)
+            {
+            }
+            ~Generator()
+            {
+                Stop();
+                Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+                Destroy();
+            }
+
+        public:
+            bool Start(const uint16_t code, const uint32_t count, const uint16_t interval)
+            {
+                bool result = false;
+
+                // Only one run at a time, a new run replaces the running one.
+                Block();
+                Wait(Core::Thread::INITIALIZED | Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+                Destroy();
+
+                _fd = ::open(_T("/dev/uinput"), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+                if (_fd < 0) {
+                    TRACE(Trace::Error, (_T("Could not open /dev/uinput, error: %d"), errno));
+                } else {
+                    struct uinput_user_dev device;
+                    ::memset(&device, 0, sizeof(device));
+                    ::strncpy(device.name, DeviceName, UINPUT_MAX_NAME_SIZE - 1);
+                    device.id.bustype = BUS_VIRTUAL;
+                    device.id.vendor = 0x0001;
+                    device.id.product = 0x0001;
+                    device.id.version = 1;
+
+                    if ((::ioctl(_fd, UI_SET_EVBIT, EV_KEY) < 0) || (::ioctl(_fd, UI_SET_EVBIT, EV_SYN) < 0) || (::ioctl(_fd, UI_SET_KEYBIT, code) < 0) || (::write(_fd, &device, sizeof(device)) != sizeof(device)) || (::ioctl(_fd, UI_DEV_CREATE) < 0)) {
+                        TRACE(Trace::Error, (_T("Could not create the synthetic input device, error: %d"), errno));
+                        ::close(_fd);
+                        _fd = -1;
+                    } else {
+                        _code = code;
+                        _remaining = count;
+                        _interval = std::max(interval, static_cast<uint16_t>(1));
+                        _created = false;
+                        result = true;
+
+                        TRACE(Trace::Information, (_T("Generating %d presses of key %d, every %d mS"), count, code, _interval));
+
+                        Run();
+                    }
+                }
+
+                return (result);
+            }
+
+        private:
+            uint32_t Worker() override
+            {
+                uint32_t result = _interval;
+
+                if (_created == false) {
+                    // Give the reader the time to pick up the new device before typing on it.
+                    _created = true;
+                    result = SettleTime;
+                } else if (_remaining > 0) {
+                    Emit(EV_KEY, _code, 1);
+                    Emit(EV_SYN, SYN_REPORT, 0);
+                    Emit(EV_KEY, _code, 0);
+                    Emit(EV_SYN, SYN_REPORT, 0);
+                    _remaining--;
+                } else {
+                    // The last events had an interval to be read, the device can go.
+                    Destroy();
+                    Block();
+                    result = Core::infinite;
+                }
+
+                return (result);
+            }
+            void Emit(const uint16_t type, const uint16_t code, const int32_t value)
+            {
+                struct input_event event;
+                ::memset(&event, 0, sizeof(event));
+                event.type = type;
+                event.code = code;
+                event.value = value;
+
+                if (::write(_fd, &event, sizeof(event)) != sizeof(event)) {
+                    TRACE_L1("Failed to emit a synthetic event, error: %d", errno);
+                }
+            }
+            void Destroy()
+            {
+                if (_fd != -1) {
+                    ::ioctl(_fd, UI_DEV_DESTROY);
+                    ::close(_fd);
+                    _fd = -1;
+                }
+            }
+
+        private:
+            int _fd;
+            uint16_t _code;
+            uint32_t _remaining;
+            uint16_t _interval;
+            bool _created;
+        };
+
+        static uint64_t Now()
+        {
+            struct timespec now;
+            ::clock_gettime(CLOCK_MONOTONIC, &now);
+            return ((static_cast<uint64_t>(now.tv_sec) * 1000000) + (now.tv_nsec / 1000));
+        }
+
         struct IDevInputDevice {
             virtual ~IDevInputDevice() { }
             virtual type Type() const { return (type::NONE); }
             virtual bool Setup() { return true; }
             virtual bool Teardown() { return true; }
-            virtual bool HandleInput(uint16_t code, uint16_t type, int32_t value) = 0;
+            virtual bool HandleInput(uint16_t code, uint16_t type, int32_t value, const uint64_t timestamp) = 0;
             virtual void ProducerEvent(const Exchange::ProducerEvents event) { }
         };
 
-        class KeyDevice : public Exchange::IKeyProducer, public IDevInputDevice {
+        class KeyDevice : public Exchange::IKeyProducer, public Remotes::ILatencies, public IDevInputDevice {
+        private:
+            // Anything older is not a latency, the event clock is not the monotonic clock.
+            static constexpr uint64_t MaximumLatency = 10 * 1000 * 1000; // uS
+
+            class Config : public Core::JSON::Container {
+            public:
+                class GeneratorConfig : public Core::JSON::Container {
+                private:
+                    GeneratorConfig(const GeneratorConfig&) = delete;
+                    GeneratorConfig& operator=(const GeneratorConfig&) = delete;
+
+                public:
+                    GeneratorConfig()
+                        : Core::JSON::Container()
+                        , Code(KEY_ENTER)
+                        , Count(0)
+                        , Interval(100)
+                    {
+                        Add(_T("code"), &Code);
+                        Add(_T("count"), &Count);
+                        Add(_T("interval"), &Interval);
+                    }
+                    ~GeneratorConfig()
+                    {
+                    }
+
+                public:
+                    Core::JSON::DecUInt16 Code;
+                    Core::JSON::DecUInt32 Count;
+                    Core::JSON::DecUInt16 Interval; // mS
+                };
+
+            private:
+                Config(const Config&) = delete;
+                Config& operator=(const Config&) = delete;
+
+            public:
+                Config()
+                    : Core::JSON::Container()
+                    , Generator()
+                {
+                    Add(_T("generator"), &Generator);
+                }
+                ~Config()
+                {
+                }
+
+            public:
+                GeneratorConfig Generator;
+            };
+
         public:
             KeyDevice(const KeyDevice&) = delete;
             KeyDevice& operator=(const KeyDevice&) = delete;
@@ -62,21 +245,41 @@ namespace Plugin {
             KeyDevice(LinuxDevice* parent)
                 : _parent(parent)
                 , _callback(nullptr)
+                , _adminLock()
+                , _dispatched()
+                , _handled()
             {
                 ASSERT(_parent != nullptr);
-                Remotes::RemoteAdministrator::Instance().Announce(*this);
+                Remotes::RemoteAdministrator::Instance().Announce(static_cast<Exchange::IKeyProducer&>(*this));
+                Remotes::RemoteAdministrator::Instance().Announce(static_cast<Remotes::ILatencies&>(*this));
             }
             virtual ~KeyDevice()
             {
-                Remotes::RemoteAdministrator::Instance().Revoke(*this);
+                Remotes::RemoteAdministrator::Instance().Revoke(static_cast<Remotes::ILatencies&>(*this));
+                Remotes::RemoteAdministrator::Instance().Revoke(static_cast<Exchange::IKeyProducer&>(*this));
             }
             string Name() const override
             {
                 return (_T("DevInput"));
             }
-            void Configure(const string&) override
+            void Configure(const string& settings) override
             {
                 Pair();
+
+                if (settings.empty() == false) {
+                    Config config;
+                    config.FromString(settings);
+
+                    if (config.Generator.Count.Value() > 0) {
+                        // Measure the generated keys only.
+                        _adminLock.Lock();
+                        _dispatched.Reset();
+                        _handled.Reset();
+                        _adminLock.Unlock();
+
+                        _parent->Generate(config.Generator.Code.Value(), config.Generator.Count.Value(), config.Generator.Interval.Value());
+                    }
+                }
             }
             bool Pair() override
             {
@@ -118,16 +321,34 @@ namespace Plugin {
             {
                 return (Name());
             }
+            void Latencies(Remotes::LatencyData& dispatched, Remotes::LatencyData& handled) const override
+            {
+                _adminLock.Lock();
+                dispatched.Set(_dispatched);
+                handled.Set(_handled);
+                _adminLock.Unlock();
+            }
             type Type() const override
             {
                 return type::KEYBOARD;
             }
-            bool HandleInput(uint16_t code, uint16_t type, int32_t value) override
+            bool HandleInput(uint16_t code, uint16_t type, int32_t value, const uint64_t timestamp) override
             {
                 if (type == EV_KEY) {
                     if ((code < BTN_MISC) || (code >= KEY_OK)) {
                         if (value != 2) {
+                            const uint64_t dispatched = Now();
+
                             _callback->KeyEvent((value != 0), code, Name());
+
+                            const uint64_t handled = Now();
+
+                            if ((timestamp <= dispatched) && ((dispatched - timestamp) < MaximumLatency)) {
+                                _adminLock.Lock();
+                                _dispatched.Add(static_cast<uint32_t>(dispatched - timestamp));
+                                _handled.Add(static_cast<uint32_t>(handled - timestamp));
+                                _adminLock.Unlock();
+                            }
                         }
                         return true;
                     }
@@ -148,6 +369,9 @@ namespace Plugin {
         private:
             LinuxDevice* _parent;
             Exchange::IKeyHandler* _callback;
+            mutable Core::CriticalSection _adminLock;
+            Remotes::Latency _dispatched;
+            Remotes::Latency _handled;
         };
 
         class WheelDevice : public Exchange::IWheelProducer, public IDevInputDevice {
@@ -187,7 +411,7 @@ namespace Plugin {
             {
                 return (Name());
             }
-            bool HandleInput(uint16_t code, uint16_t type, int32_t value) override
+            bool HandleInput(uint16_t code, uint16_t type, int32_t value, const uint64_t /* timestamp */) override
             {
                 if (type == EV_REL) {
                     switch(code)
@@ -246,7 +470,7 @@ namespace Plugin {
             {
                 return (Name());
             }
-            bool HandleInput(uint16_t code, uint16_t type, int32_t value) override
+            bool HandleInput(uint16_t code, uint16_t type, int32_t value, const uint64_t /* timestamp */) override
             {
                 if (type == EV_REL) {
                     switch(code)
@@ -364,7 +588,7 @@ namespace Plugin {
             {
                 return (Name());
             }
-            bool HandleInput(uint16_t code, uint16_t type, int32_t value) override
+            bool HandleInput(uint16_t code, uint16_t type, int32_t value, const uint64_t /* timestamp */) override
             {
                 if (type == EV_KEY) {
                     if (code == BTN_TOUCH) {
@@ -513,10 +737,12 @@ namespace Plugin {
             , _devices()
             , _monitor(nullptr)
             , _update(-1)
+            , _epoll(::epoll_create1(EPOLL_CLOEXEC))
+            , _generator()
         {
             _pipe[0] = -1;
             _pipe[1] = -1;
-            if (::pipe(_pipe) < 0) {
+            if ((_epoll == -1) || (::pipe(_pipe) < 0)) {
                 // Pipe not successfully opened. Close, if needed;
                 if (_pipe[0] != -1) {
                     close(_pipe[0]);
@@ -538,6 +764,9 @@ namespace Plugin {
 
                 udev_unref(udev);
 
+                Observe(_pipe[0]);
+                Observe(_update);
+
                 _inputDevices.emplace_back(Core::Service<KeyDevice>::Create<KeyDevice>(this));
                 _inputDevices.emplace_back(Core::Service<WheelDevice>::Create<WheelDevice>(this));
                 _inputDevices.emplace_back(Core::Service<PointerDevice>::Create<PointerDevice>(this));
@@ -565,6 +794,10 @@ namespace Plugin {
                 udev_monitor_unref(_monitor);
             }
 
+            if (_epoll != -1) {
+                ::close(_epoll);
+            }
+
             for (auto& device : _inputDevices) {
                 device->Teardown();
             }
@@ -597,8 +830,23 @@ namespace Plugin {
 
             return (true);
         }
+        bool Generate(const uint16_t code, const uint32_t count, const uint16_t interval)
+        {
+            return (_generator.Start(code, count, interval));
+        }
 
     private:
+        void Observe(const int fd)
+        {
+            struct epoll_event event;
+            ::memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+
+            if (::epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+                TRACE(Trace::Error, (_T("Could not observe descriptor %d, error: %d"), fd, errno));
+            }
+        }
         void Refresh()
         {
             // find devices in /dev/input/
@@ -627,7 +875,18 @@ namespace Plugin {
                                 }
                             }
 
+                            // Drained till EAGAIN, so it must not block. With the monotonic clock the event
+                            // timestamps can be related to the time the event is handled.
+                            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                            int clock = CLOCK_MONOTONIC;
+                            if (::ioctl(fd, EVIOCSCLOCKID, &clock) < 0) {
+                                TRACE_L1("No monotonic event clock for %s, no latencies", entry.Name().c_str());
+                            }
+
                             _devices.insert(std::make_pair(entry.Name(), std::make_pair(fd, inputDevice)));
+                            Observe(fd);
+                        } else {
+                            ::close(fd);
                         }
                     }
                 }
@@ -655,28 +914,18 @@ namespace Plugin {
         virtual uint32_t Worker()
         {
             while (IsRunning() == true) {
-                fd_set readset;
-                FD_ZERO(&readset);
-                FD_SET(_pipe[0], &readset);
-                FD_SET(_update, &readset);
-
-                int result = std::max(_pipe[0], _update);
+                struct epoll_event events[MaxEvents];
 
-                // set up all the input devices
-                for (std::map<string, std::pair<int, IDevInputDevice*>>::const_iterator index = _devices.begin(), end = _devices.end(); index != end; ++index) {
-                    FD_SET(index->second.first, &readset);
-                    result = std::max(result, index->second.first);
-                }
+                int result = ::epoll_wait(_epoll, events, MaxEvents, -1);
 
-                result = select(result + 1, &readset, 0, 0, nullptr);
+                for (int event = 0; event < result; event++) {
+                    const int fd = events[event].data.fd;
 
-                if (result > 0) {
-                    if (FD_ISSET(_pipe[0], &readset)) {
+                    if (fd == _pipe[0]) {
                         char buff;
                         (void)read(_pipe[0], &buff, 1);
-                    }
-                    if (FD_ISSET(_update, &readset)) {
-                        // Make the call to receive the device. select() ensured that this will not block.
+                    } else if (fd == _update) {
+                        // Make the call to receive the device. epoll_wait() ensured that this will not block.
                         udev_device* dev = udev_monitor_receive_device(_monitor);
                         if (dev) {
                             const char* nodeId = udev_device_get_devnode(dev);
@@ -687,24 +936,19 @@ namespace Plugin {
                                 Refresh();
                             }
                         }
-                    }
+                    } else {
+                        // find the device to read from, it might be gone already by an earlier event in this batch.
+                        std::map<string, std::pair<int, IDevInputDevice*>>::iterator index = _devices.begin();
 
-                    // find the devices to read from
-                    std::map<string, std::pair<int, IDevInputDevice*>>::iterator index = _devices.begin();
-
-                    while (index != _devices.end()) {
-                        if (FD_ISSET(index->second.first, &readset)) {
-
-                            if (HandleInput(index->second.first) == false) {
-                                // fd closed?
-                                close(index->second.first);
-                                index = _devices.erase(index);
-                            } else {
-                                ++index;
-                            }
-                        } else {
+                        while ((index != _devices.end()) && (index->second.first != fd)) {
                             ++index;
                         }
+
+                        if ((index != _devices.end()) && (HandleInput(fd) == false)) {
+                            // fd closed? Closing it also takes it out of the epoll set.
+                            close(index->second.first);
+                            _devices.erase(index);
+                        }
                     }
                 }
             }
@@ -712,24 +956,25 @@ namespace Plugin {
         }
         bool HandleInput(const int fd)
         {
-            input_event entry[16];
-            int index = 0;
-            int result = ::read(fd, entry, sizeof(entry));
+            input_event entry[64];
+            int result;
+
+            // Drain the device, a burst of events is handled in this wake-up and not in the next ones.
+            while ((result = ::read(fd, entry, sizeof(entry))) > 0) {
+                const uint16_t count = (result / sizeof(input_event));
+
+                for (uint16_t index = 0; index < count; index++) {
+                    const uint64_t timestamp = (static_cast<uint64_t>(entry[index].time.tv_sec) * 1000000) + entry[index].time.tv_usec;
 
-            if (result > 0) {
-                while (result >= static_cast<int>(sizeof(input_event))) {
-                    ASSERT(index < static_cast<int>((sizeof(entry) / sizeof(input_event))));
                     for (auto& device : _inputDevices) {
-                        if (device->HandleInput(entry[index].code,  entry[index].type, entry[index].value) == true) {
+                        if (device->HandleInput(entry[index].code, entry[index].type, entry[index].value, timestamp) == true) {
                             break;
                         }
                     }
-                    index++;
-                    result -= sizeof(input_event);
                 }
             }
 
-            return (result >= 0);
+            return ((result == 0) || (errno == EAGAIN) || (errno == EINTR));
         }
         bool ReadDeviceName(const string& eventLocation, string& deviceName)
         {
@@ -764,6 +1009,8 @@ namespace Plugin {
         int _pipe[2];
         udev_monitor* _monitor;
         int _update;
+        int _epoll;
+        Generator _generator;
         std::vector<IDevInputDevice*> _inputDevices;
         static LinuxDevice* _singleton;
     };
@@ -22,6 +22,8 @@
 namespace WPEFramework {
 namespace Remotes {
 
+    /* static */ constexpr uint32_t Latency::Resolution;
+
     /* static */ RemoteAdministrator& RemoteAdministrator::Instance()
     {
         static RemoteAdministrator singleton;
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include "Latency.h"
 #include "Module.h"
 #include <interfaces/IKeyHandler.h>
 
@@ -39,6 +40,7 @@ namespace Remotes {
             , _wheels()
             , _pointers()
             , _touchpanels()
+            , _latencies()
         {
         }
 
@@ -226,6 +228,27 @@ namespace Remotes {
 
             return (result);
         }
+        uint32_t Latencies(const string& device, LatencyData& dispatched, LatencyData& handled)
+        {
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+
+            _adminLock.Lock();
+
+            std::list<ILatencies*>::iterator index(_latencies.begin());
+
+            while ((index != _latencies.end()) && ((*index)->Name() != device)) {
+                index++;
+            }
+
+            if (index != _latencies.end()) {
+                (*index)->Latencies(dispatched, handled);
+                result = Core::ERROR_NONE;
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
         void Announce(Exchange::IKeyProducer& remoteControl)
         {
             _adminLock.Lock();
@@ -296,6 +319,19 @@ namespace Remotes {
 
             _adminLock.Unlock();
         }
+        void Announce(ILatencies& latencies)
+        {
+            _adminLock.Lock();
+
+            auto index(std::find(_latencies.begin(), _latencies.end(), &latencies));
+            ASSERT(index == _latencies.end());
+
+            if (index == _latencies.end()) {
+                _latencies.push_back(&latencies);
+            }
+
+            _adminLock.Unlock();
+        }
         void Revoke(Exchange::IKeyProducer& remoteControl)
         {
             _adminLock.Lock();
@@ -366,6 +402,19 @@ namespace Remotes {
 
             _adminLock.Unlock();
         }
+        void Revoke(ILatencies& latencies)
+        {
+            _adminLock.Lock();
+
+            auto index(std::find(_latencies.begin(), _latencies.end(), &latencies));
+            ASSERT(index != _latencies.end());
+
+            if (index != _latencies.end()) {
+                _latencies.erase(index);
+            }
+
+            _adminLock.Unlock();
+        }
         void RevokeAll()
         {
             _adminLock.Lock();
@@ -414,6 +463,8 @@ namespace Remotes {
                 _touchpanels.clear();
             }
 
+            _latencies.clear();
+
             _adminLock.Unlock();
         }
         void Callback(Exchange::IKeyHandler* callback)
@@ -527,6 +578,7 @@ namespace Remotes {
         std::list<Exchange::IWheelProducer*> _wheels;
         std::list<Exchange::IPointerProducer*> _pointers;
         std::list<Exchange::ITouchProducer*> _touchpanels;
+        std::list<ILatencies*> _latencies;
     };
 }
 }
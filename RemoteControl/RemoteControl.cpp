@@ -19,6 +19,7 @@
 
 #include <fcntl.h>
 
+#include "KeyMapCache.h"
 #include "RemoteAdministrator.h"
 #include "RemoteControl.h"
 
@@ -167,6 +168,9 @@ namespace Plugin {
             // Keep this path for save operation
             _persistentPath = service->PersistentPath();
 
+            // The mapping files are loaded from their compiled form, compiled once for as long as they do not change.
+            KeyMapCache keyMaps(_persistentPath + _T("keymaps/"));
+
             // Seems like we have a default mapping file. Load it..
             PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(DefaultMappingTable));
 
@@ -174,7 +178,7 @@ namespace Plugin {
 
                 map.PassThrough(config.PassOn.Value());
             } else {
-                if (map.Load(mappingFile) == Core::ERROR_NONE) {
+                if (keyMaps.Load(mappingFile, map) == Core::ERROR_NONE) {
 
                     map.PassThrough(config.PassOn.Value());
                 } else {
@@ -219,7 +223,7 @@ namespace Plugin {
 
                     // Get our selves a table..
                     PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(producer.c_str()));
-                    map.Load(specific);
+                    keyMaps.Load(specific, map);
                     if (configList.IsValid() == true) {
                         map.PassThrough(configList.Current().PassOn.Value());
                     }
@@ -245,7 +249,7 @@ namespace Plugin {
 
                     // Get our selves a table..de
                     PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(configList.Current().Name.Value()));
-                    map.Load(specific);
+                    keyMaps.Load(specific, map);
                     map.PassThrough(configList.Current().PassOn.Value());
                 }
 
@@ -303,6 +307,9 @@ namespace Plugin {
         _inputHandler->ClearTable(DefaultMappingTable);
 
         // CLear the virtual devices.
+        for (const string& name : _virtualDevices) {
+            _inputHandler->ClearTable(name.c_str());
+        }
         _virtualDevices.clear();
 
         Remotes::RemoteAdministrator::Instance().RevokeAll();
@@ -188,6 +188,32 @@ namespace Plugin {
             Core::JSON::ArrayType<Core::JSON::String> Devices;
         };
 
+        class KeyLatencyData : public Core::JSON::Container {
+        private:
+            KeyLatencyData(const KeyLatencyData&) = delete;
+            KeyLatencyData& operator=(const KeyLatencyData&) = delete;
+
+        public:
+            KeyLatencyData()
+                : Core::JSON::Container()
+                , Resolution(Remotes::Latency::Resolution)
+                , Dispatched()
+                , Handled()
+            {
+                Add(_T("resolution"), &Resolution);
+                Add(_T("dispatched"), &Dispatched);
+                Add(_T("handled"), &Handled);
+            }
+            ~KeyLatencyData()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Resolution; // uS
+            Remotes::LatencyData Dispatched;
+            Remotes::LatencyData Handled;
+        };
+
     public:
         RemoteControl(const RemoteControl&) = delete;
         RemoteControl& operator=(const RemoteControl&) = delete;
@@ -376,6 +402,7 @@ namespace Plugin {
         uint32_t endpoint_unpair(const JsonData::RemoteControl::UnpairParamsData& params);
         uint32_t get_devices(Core::JSON::ArrayType<Core::JSON::String>& response) const;
         uint32_t get_device(const string& index, JsonData::RemoteControl::DeviceData& response) const;
+        uint32_t get_latency(const string& index, KeyLatencyData& response) const;
         void event_keypressed(const string& id, const bool& pressed);
 
     private:
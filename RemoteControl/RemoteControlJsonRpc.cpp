@@ -46,6 +46,7 @@ namespace Plugin {
         Register<UnpairParamsData,void>(_T("unpair"), &RemoteControl::endpoint_unpair, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("devices"), &RemoteControl::get_devices, nullptr, this);
         Property<DeviceData>(_T("device"), &RemoteControl::get_device, nullptr, this);
+        Property<KeyLatencyData>(_T("latency"), &RemoteControl::get_latency, nullptr, this);
     }
 
     void RemoteControl::UnregisterAll()
@@ -61,6 +62,7 @@ namespace Plugin {
         Unregister(_T("press"));
         Unregister(_T("send"));
         Unregister(_T("key"));
+        Unregister(_T("latency"));
         Unregister(_T("device"));
         Unregister(_T("devices"));
     }
@@ -185,6 +187,25 @@ namespace Plugin {
        return result;
    }
 
+   uint32_t RemoteControl::get_latency(const string& index, KeyLatencyData& response) const
+   {
+       uint32_t result = Core::ERROR_NONE;
+
+       if (index.empty() == false) {
+           if (IsVirtualDevice(index) == true) {
+               result = Core::ERROR_GENERAL;
+           } else if (IsPhysicalDevice(index) == true) {
+               result = Remotes::RemoteAdministrator::Instance().Latencies(index, response.Dispatched, response.Handled);
+           } else {
+               result = Core::ERROR_UNAVAILABLE;
+           }
+       } else {
+           result = Core::ERROR_BAD_REQUEST;
+       }
+
+       return result;
+   }
+
     uint32_t RemoteControl::endpoint_key(const KeyobjInfo& params, KeyResultData& response)
     {
         uint32_t result = Core::ERROR_NONE;
@@ -2,6 +2,8 @@
 #include <core/ProcessInfo.h>
 #include <interfaces/IMemory.h>
 #include <interfaces/IResourceMonitor.h>
+#include <dirent.h>
+#include <map>
 #include <sstream>
 #include <vector>
 
@@ -37,11 +39,13 @@ namespace Plugin {
              , Interval()
              , Mode()
              , ParentName()
+             , Threads(false)
          {
             Add(_T("path"), &Path);
             Add(_T("interval"), &Interval);
             Add(_T("mode"), &Mode);
             Add(_T("parent-name"), &ParentName);
+            Add(_T("threads"), &Threads);
          }
          Config(const Config& copy)
              : Core::JSON::Container()
@@ -49,11 +53,13 @@ namespace Plugin {
              , Interval(copy.Interval)
              , Mode(copy.Mode)
              , ParentName(copy.ParentName)
+             , Threads(copy.Threads)
          {
             Add(_T("path"), &Path);
             Add(_T("interval"), &Interval);
             Add(_T("mode"), &Mode);
             Add(_T("parent-name"), &ParentName);
+            Add(_T("threads"), &Threads);
          }
          ~Config()
          {
@@ -81,9 +87,20 @@ namespace Plugin {
          Core::JSON::DecUInt32 Interval;
          Core::JSON::String Mode;
          Core::JSON::String ParentName;
+         Core::JSON::Boolean Threads; // Also log CPU and run queue wait per thread name.
       };
 
       class StatCollecter {
+     private:
+         struct ThreadSample {
+            string Name;
+            uint64_t Jiffies; // User + system time.
+            uint64_t Wait;    // Nanoseconds runnable, but waiting for a CPU.
+            uint64_t Slices;  // Times it got a CPU.
+         };
+
+         typedef std::map<::ThreadId, ThreadSample> ThreadSamples; // By thread id.
+
      public:
          explicit StatCollecter(const Config& config)
              : _binFile(nullptr)
@@ -92,6 +109,9 @@ namespace Plugin {
              , _bufferEntries(0)
              , _interval(0)
              , _collectMode(Config::CollectMode::Invalid)
+             , _threads(false)
+             , _previousThreads()
+             , _currentThreads()
              , _activity(*this)
          {
             _binFile = fopen(config.Path.Value().c_str(), "w");
@@ -112,6 +132,7 @@ namespace Plugin {
             _interval = config.Interval.Value();
             _collectMode = config.GetCollectMode();
             _parentName = config.ParentName.Value();
+            _threads = config.Threads.Value();
 
             _activity.Submit();
          }
@@ -131,6 +152,13 @@ namespace Plugin {
             _namesLock.Unlock();
          }
 
+         void GetThreadNames(vector<string>& threadNames)
+         {
+            _namesLock.Lock();
+            threadNames = _threadNames;
+            _namesLock.Unlock();
+         }
+
       private:
          // TODO: combine these "Collect*" methods
          void CollectSingle()
@@ -341,9 +369,139 @@ namespace Plugin {
             fwrite(&vss, 1, sizeof(vss), _binFile);
             fwrite(&uss, 1, sizeof(uss), _binFile);
             fwrite(&jiffies, 1, sizeof(jiffies), _binFile);
+
+            LogThreads(name, info.Id());
+
             fflush(_binFile);
          }
 
+         // Per thread name, what the threads of the process used since it was logged the last time.
+         //    Threads with the same name (e.g. those of a pool) are added up. The first time a process
+         //    is seen only serves as a reference, its threads are logged with nothing used.
+         void LogThreads(const string& processName, const ::ThreadId process)
+         {
+            struct Usage {
+               uint64_t Jiffies;
+               uint64_t Wait; // Microseconds.
+               uint64_t Slices;
+            };
+
+            std::map<string, Usage> usage;
+
+            if (_threads) {
+               ThreadSamples& current = _currentThreads[process];
+               SampleThreads(process, current);
+
+               std::map<::ThreadId, ThreadSamples>::const_iterator previous = _previousThreads.find(process);
+
+               for (const std::pair<const ::ThreadId, ThreadSample>& thread : current) {
+                  Usage& entry = usage[thread.second.Name];
+
+                  if (previous != _previousThreads.cend()) {
+                     ThreadSample before = { string(), 0, 0, 0 };
+                     ThreadSamples::const_iterator known = previous->second.find(thread.first);
+
+                     // A thread id that got reused by a new thread starts again from zero.
+                     if ((known != previous->second.cend()) && (known->second.Name == thread.second.Name) && (known->second.Jiffies <= thread.second.Jiffies) && (known->second.Wait <= thread.second.Wait)) {
+                        before = known->second;
+                     }
+
+                     entry.Jiffies += thread.second.Jiffies - before.Jiffies;
+                     entry.Wait += (thread.second.Wait - before.Wait) / 1000;
+                     entry.Slices += thread.second.Slices - std::min(before.Slices, thread.second.Slices);
+                  }
+               }
+
+               _namesLock.Lock();
+               for (const std::pair<const string, Usage>& entry : usage) {
+                  const string columnName = processName + "/" + entry.first;
+                  if (find(_threadNames.begin(), _threadNames.end(), columnName) == _threadNames.end()) {
+                     _threadNames.push_back(columnName);
+                  }
+               }
+               _namesLock.Unlock();
+            }
+
+            uint32_t threadCount = usage.size();
+            fwrite(&threadCount, sizeof(threadCount), 1, _binFile);
+
+            for (const std::pair<const string, Usage>& entry : usage) {
+               uint32_t nameSize = entry.first.length();
+               fwrite(&nameSize, sizeof(nameSize), 1, _binFile);
+               fwrite(entry.first.c_str(), sizeof(entry.first[0]), entry.first.length(), _binFile);
+               fwrite(&entry.second.Jiffies, 1, sizeof(entry.second.Jiffies), _binFile);
+               fwrite(&entry.second.Wait, 1, sizeof(entry.second.Wait), _binFile);
+               fwrite(&entry.second.Slices, 1, sizeof(entry.second.Slices), _binFile);
+            }
+         }
+
+         static void SampleThreads(const ::ThreadId process, ThreadSamples& samples)
+         {
+            const string taskPath = "/proc/" + std::to_string(process) + "/task/";
+            DIR* directory = opendir(taskPath.c_str());
+
+            samples.clear();
+
+            if (directory == nullptr) {
+               return;
+            }
+
+            struct dirent* entry;
+            while ((entry = readdir(directory)) != nullptr) {
+               char* end = nullptr;
+               ::ThreadId thread = static_cast<::ThreadId>(strtoul(entry->d_name, &end, 10));
+
+               if ((end == entry->d_name) || (*end != '\0')) {
+                  continue;
+               }
+
+               ThreadSample sample = { string(), 0, 0, 0 };
+               if (ReadThreadStat(taskPath + entry->d_name, sample)) {
+                  samples[thread] = sample;
+               }
+            }
+
+            closedir(directory);
+         }
+
+         static bool ReadThreadStat(const string& threadPath, ThreadSample& sample)
+         {
+            bool result = false;
+            char buffer[1024];
+
+            FILE* statFile = fopen((threadPath + "/stat").c_str(), "r");
+            if (statFile != nullptr) {
+               if (fgets(buffer, sizeof(buffer), statFile) != nullptr) {
+                  // The name is between parentheses and may contain them itself.
+                  const char* nameStart = strchr(buffer, '(');
+                  const char* nameEnd = strrchr(buffer, ')');
+                  unsigned long userTime = 0, systemTime = 0;
+
+                  // Fields 3 (state) to 13 are skipped, 14 and 15 are the user and system time.
+                  if ((nameStart != nullptr) && (nameEnd != nullptr) && (nameEnd > nameStart) &&
+                      (sscanf(nameEnd + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &userTime, &systemTime) == 2)) {
+                     sample.Name.assign(nameStart + 1, nameEnd - nameStart - 1);
+                     sample.Jiffies = static_cast<uint64_t>(userTime) + static_cast<uint64_t>(systemTime);
+                     result = true;
+                  }
+               }
+               fclose(statFile);
+            }
+
+            // Only there if the kernel keeps scheduler statistics.
+            FILE* schedFile = fopen((threadPath + "/schedstat").c_str(), "r");
+            if (schedFile != nullptr) {
+               unsigned long long running = 0, waiting = 0, slices = 0;
+               if (fscanf(schedFile, "%llu %llu %llu", &running, &waiting, &slices) == 3) {
+                  sample.Wait = waiting;
+                  sample.Slices = slices;
+               }
+               fclose(schedFile);
+            }
+
+            return result;
+         }
+
          void StartLogLine(uint32_t processCount)
          {
             // TODO: no simple time_t alike in Thunder?
@@ -353,10 +511,15 @@ namespace Plugin {
             fwrite(&timestamp, 1, sizeof(timestamp), _binFile);
             fwrite(&processCount, 1, sizeof(processCount), _binFile);
             fwrite(&jiffies, 1, sizeof(jiffies), _binFile);
+
+            // Processes that are gone since the last line are forgotten.
+            _previousThreads.swap(_currentThreads);
+            _currentThreads.clear();
          }
 
          FILE *_binFile;
          vector<string> _processNames; // Seen process names.
+         vector<string> _threadNames; // Seen "process/thread" names.
          Core::CriticalSection _namesLock;
          uint32_t * _otherMap; // Buffer used to mark other processes pages.
          uint32_t * _ourMap;   // Buffer for pages used by our process (tree).
@@ -364,6 +527,9 @@ namespace Plugin {
          uint32_t _interval; // Seconds between measurement.
          Config::CollectMode _collectMode; // Collection style.
          string _parentName; // Process/plugin name we are looking for.
+         bool _threads; // Sample the threads of the processes as well.
+         std::map<::ThreadId, ThreadSamples> _previousThreads; // Thread samples per process, from the last line.
+         std::map<::ThreadId, ThreadSamples> _currentThreads; // Thread samples per process, of the line being logged.
          Core::WorkerPool::JobType<StatCollecter&> _activity;
 
          friend Core::ThreadPool::JobType<StatCollecter&>;
@@ -399,6 +565,7 @@ namespace Plugin {
 
          result = Core::ERROR_NONE;
 
+         _binPath = config.Path.Value();
          _processThread = new StatCollecter(config);
 
          return (result);
@@ -413,18 +580,26 @@ namespace Plugin {
          vector<string> processNames;
          _processThread->GetProcessNames(processNames);
 
+         vector<string> threadNames;
+         _processThread->GetThreadNames(threadNames);
+
          output << _T("time (s)\tJiffies");
          for (const string& processName : processNames) {
             output << _T("\t") << processName << _T(" (VSS)\t") << processName << _T(" (USS)\t") << processName << _T(" (jiffies)");
          }
+         for (const string& threadName : threadNames) {
+            output << _T("\t") << threadName << _T(" (jiffies)\t") << threadName << _T(" (wait us)\t") << threadName << _T(" (slices)");
+         }
          output << endl;
 
          vector<uint64_t> pageVector(processNames.size() * 3);
+         vector<uint64_t> threadVector(threadNames.size() * 3);
          bool seenFirstTimestamp = false;
          uint32_t firstTimestamp = 0;
 
          while (true) {
             std::fill(pageVector.begin(), pageVector.end(), 0);
+            std::fill(threadVector.begin(), threadVector.end(), 0);
 
             uint32_t timestamp = 0;
             size_t readCount = fread(&timestamp, sizeof(timestamp), 1, inFile);
@@ -460,6 +635,31 @@ namespace Plugin {
                fread(&vss, sizeof(vss), 1, inFile);
                fread(&uss, sizeof(uss), 1, inFile);
                fread(&jiffies, sizeof(jiffies), 1, inFile);
+
+               uint32_t threadCount = 0;
+               fread(&threadCount, sizeof(threadCount), 1, inFile);
+
+               for (uint32_t threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+                  uint32_t threadNameLength = 0;
+                  fread(&threadNameLength, sizeof(threadNameLength), 1, inFile);
+                  string threadName(threadNameLength, '\0');
+                  fread(&threadName[0], sizeof(char), threadNameLength, inFile);
+
+                  uint64_t threadJiffies, threadWait, threadSlices;
+                  fread(&threadJiffies, sizeof(threadJiffies), 1, inFile);
+                  fread(&threadWait, sizeof(threadWait), 1, inFile);
+                  fread(&threadSlices, sizeof(threadSlices), 1, inFile);
+
+                  vector<string>::const_iterator threadIterator = std::find(threadNames.cbegin(), threadNames.cend(), name + "/" + threadName);
+                  if (threadIterator != threadNames.cend()) {
+                     int threadColumn = threadIterator - threadNames.cbegin();
+
+                     threadVector[threadColumn * 3] = threadJiffies;
+                     threadVector[threadColumn * 3 + 1] = threadWait;
+                     threadVector[threadColumn * 3 + 2] = threadSlices;
+                  }
+               }
+
                if (nameIterator == processNames.cend()) {
                    continue;
                }
@@ -475,6 +675,9 @@ namespace Plugin {
             for (uint32_t pageEntry : pageVector) {
                output << "\t" << pageEntry;
             }
+            for (uint64_t threadEntry : threadVector) {
+               output << "\t" << threadEntry;
+            }
             output << endl;
          }
 
@@ -31,7 +31,96 @@
 namespace WPEFramework {
 namespace Plugin {
 
-    unsigned int RtspParser::_sequence = 0;
+    std::atomic<uint32_t> RtspParser::_sequence(0);
+
+    uint32_t RtspText::Find(const char text[], const uint32_t offset) const
+    {
+        const uint32_t length = static_cast<uint32_t>(::strlen(text));
+        uint32_t result = _length;
+
+        if ((length > 0) && (length <= _length)) {
+            for (uint32_t index = offset; index <= (_length - length); index++) {
+                if ((_data[index] == text[0]) && (::memcmp(&(_data[index]), text, length) == 0)) {
+                    result = index;
+                    break;
+                }
+            }
+        }
+
+        return (result);
+    }
+
+    uint32_t RtspText::Find(const char character, const uint32_t offset) const
+    {
+        uint32_t result = _length;
+
+        if (offset < _length) {
+            const char* found = static_cast<const char*>(::memchr(&(_data[offset]), character, _length - offset));
+            if (found != nullptr) {
+                result = static_cast<uint32_t>(found - _data);
+            }
+        }
+
+        return (result);
+    }
+
+    RtspText RtspText::Substring(const uint32_t offset, const uint32_t length) const
+    {
+        RtspText result;
+
+        if (offset < _length) {
+            result = RtspText(&(_data[offset]), std::min(length, _length - offset));
+        }
+
+        return (result);
+    }
+
+    RtspText RtspText::Trim() const
+    {
+        uint32_t start = 0;
+        uint32_t end = _length;
+
+        while ((start < end) && ((_data[start] == ' ') || (_data[start] == '\t'))) {
+            start++;
+        }
+        while ((end > start) && ((_data[end - 1] == ' ') || (_data[end - 1] == '\t'))) {
+            end--;
+        }
+
+        return (RtspText(&(_data[start]), end - start));
+    }
+
+    int32_t RtspText::Number() const
+    {
+        const RtspText value(Trim());
+        int32_t result = 0;
+        uint32_t index = 0;
+        bool negative = false;
+
+        if ((value._length > 0) && ((value._data[0] == '-') || (value._data[0] == '+'))) {
+            negative = (value._data[0] == '-');
+            index++;
+        }
+        while ((index < value._length) && (::isdigit(value._data[index]) != 0)) {
+            result = (result * 10) + (value._data[index] - '0');
+            index++;
+        }
+
+        return (negative ? -result : result);
+    }
+
+    float RtspText::Decimal() const
+    {
+        // The data is not terminated, so copy the (short) number to the stack for strtof.
+        char buffer[32];
+        const RtspText value(Trim());
+        const uint32_t length = std::min(value._length, static_cast<uint32_t>(sizeof(buffer) - 1));
+
+        ::memcpy(buffer, value._data, length);
+        buffer[length] = '\0';
+
+        return (::strtof(buffer, nullptr));
+    }
 
     RtspParser::RtspParser(RtspSessionInfo& info)
         : _sessionInfo(info)
@@ -50,7 +139,8 @@ namespace Plugin {
         ss << "StbId=943BB162A323&";
         ss << "CADeviceId=943BB162A323";
         ss << " RTSP/1.0" << RtspLineTerminator;
-        ss << "CSeq:" << ++_sequence << RtspLineTerminator;
+        request->sequence = ++_sequence;
+        ss << "CSeq:" << request->sequence << RtspLineTerminator;
         ss << "User-Agent: Metro" << RtspLineTerminator;
         ss << "Transport: MP2T/DVBC/QAM;unicast;" << RtspLineTerminator;
         ss << RtspLineTerminator;
@@ -77,7 +167,8 @@ namespace Plugin {
             request->bSRM = false;
         }
         ss << cmd << " * RTSP/1.0" << RtspLineTerminator;
-        ss << "CSeq:" << ++_sequence << RtspLineTerminator;
+        request->sequence = ++_sequence;
+        ss << "CSeq:" << request->sequence << RtspLineTerminator;
         ss << "Session:" << sessionId << RtspLineTerminator;
         ss << "Range: npt=" << position << RtspLineTerminator;
         ss << "Scale: " << scale << RtspLineTerminator;
@@ -108,8 +199,10 @@ namespace Plugin {
         }
 
         std::stringstream ss;
+        request->bSRM = bSRM;
+        request->sequence = ++_sequence;
         ss << "GET_PARAMETER * RTSP/1.0" << RtspLineTerminator;
-        ss << "CSeq:" << ++_sequence << RtspLineTerminator;
+        ss << "CSeq:" << request->sequence << RtspLineTerminator;
         ss << "Session:" << sessId << RtspLineTerminator;
         ss << "Content-Type: text/parameters" << RtspLineTerminator;
         ss << "Content-Length: " << strParams.length() << RtspLineTerminator;
@@ -132,8 +225,9 @@ namespace Plugin {
         std::stringstream ss;
         string strReason = "Cleint Intiated";
 
+        request->sequence = ++_sequence;
         ss << "TEARDOWN * RTSP/1.0" << RtspLineTerminator;
-        ss << "CSeq:" << ++_sequence << RtspLineTerminator;
+        ss << "CSeq:" << request->sequence << RtspLineTerminator;
         ss << "Session:" << _sessionInfo.sessionId << RtspLineTerminator;
         ss << "Reason:" << reason << " " << strReason << RtspLineTerminator;
         ss << RtspLineTerminator;
@@ -151,6 +245,7 @@ namespace Plugin {
         string sessId = (bSRM) ? _sessionInfo.sessionId : _sessionInfo.ctrlSessionId;
 
         std::stringstream ss;
+        request->bSRM = bSRM;
         ss << "RTSP/1.0 200 OK" << RtspLineTerminator;
         ss << "CSeq:" << respSeq << RtspLineTerminator;
         ss << "Session:" << _sessionInfo.sessionId << RtspLineTerminator;
@@ -166,38 +261,36 @@ namespace Plugin {
 
     void RtspParser::ProcessSetupResponse(const std::string& response)
     {
-        NAMED_ARRAY setupMap; // entire response
-        NAMED_ARRAY params; // single line
-        Parse(response, setupMap, RtspLineTerminator, ": ");
-
-        string sess = setupMap["Session"];
-        TRACE_L2("%s: session id='%s'", __FUNCTION__, sess.c_str());
-        if (sess.find(";") == string::npos) {
-            _sessionInfo.sessionId = sess;
+        const RtspText message(response);
+
+        RtspText session(Header(message, "Session"));
+        uint32_t separator = session.Find(';');
+        TRACE_L2("%s: session id='%s'", __FUNCTION__, session.Text().c_str());
+
+        _sessionInfo.sessionId = session.Substring(0, separator).Text();
+        if (separator == session.Length()) {
             _sessionInfo.sessionTimeout = SEC2MS(_sessionInfo.defaultSessionTimeout);
             TRACE_L2("%s: using default sessionTimeout %d", __FUNCTION__, _sessionInfo.defaultSessionTimeout);
         } else { // contains heartbeat
-            Parse(sess, params, ";", "=");
-            NAMED_ARRAY::iterator it = params.begin();
-            _sessionInfo.sessionId = it->first;
-
-            if (params.size() > 1)
-                _sessionInfo.sessionTimeout = SEC2MS(atoi(params["timeout"].c_str()));
+            RtspText timeout(Parameter(session.Substring(separator + 1), "timeout"));
+            if (timeout.IsEmpty() == false) {
+                _sessionInfo.sessionTimeout = SEC2MS(timeout.Number());
+            }
         }
 
-        sess = setupMap["ControlSession"];
-        if (sess.size()) {
-            if (sess.find(";") == string::npos) {
-                _sessionInfo.ctrlSessionId = sess;
+        session = Header(message, "ControlSession");
+        if (session.IsEmpty() == false) {
+            separator = session.Find(';');
+
+            _sessionInfo.ctrlSessionId = session.Substring(0, separator).Text();
+            if (separator == session.Length()) {
                 _sessionInfo.ctrlSessionTimeout = SEC2MS(_sessionInfo.defaultCtrlSessionTimeout);
                 TRACE_L2("%s: using default ctrlSessionTimeout %d", __FUNCTION__, _sessionInfo.defaultCtrlSessionTimeout);
             } else {
-                Parse(sess, params, ";", "=");
-                NAMED_ARRAY::iterator it = params.begin();
-                _sessionInfo.ctrlSessionId = it->first;
-
-                if (params.size() > 1)
-                    _sessionInfo.ctrlSessionTimeout = SEC2MS(atoi(params["timeout"].c_str()));
+                RtspText timeout(Parameter(session.Substring(separator + 1), "timeout"));
+                if (timeout.IsEmpty() == false) {
+                    _sessionInfo.ctrlSessionTimeout = SEC2MS(timeout.Number());
+                }
             }
 
             if (_sessionInfo.sessionId.compare(_sessionInfo.ctrlSessionId) == 0) // XXX: check IP Addr ???
@@ -206,46 +299,36 @@ namespace Plugin {
                 _sessionInfo.bSrmIsRtspProxy = false;
         }
 
-        string location = setupMap["Location"];
-        string chan = setupMap["Tuning"];
-        Parse(chan, params, ";", "=");
-        _sessionInfo.frequency = atoi(params["frequency"].c_str()) * 100;
-        _sessionInfo.modulation = atoi(params["modulation"].c_str());
-        _sessionInfo.symbolRate = atoi(params["symbol_rate"].c_str());
+        const RtspText tuning(Header(message, "Tuning"));
+        _sessionInfo.frequency = Parameter(tuning, "frequency").Number() * 100;
+        _sessionInfo.modulation = Parameter(tuning, "modulation").Number();
+        _sessionInfo.symbolRate = Parameter(tuning, "symbol_rate").Number();
 
-        string tune = setupMap["Channel"];
-        Parse(tune, params, ";", "=");
-        _sessionInfo.programNum = atoi(params["Svcid"].c_str());
+        _sessionInfo.programNum = Parameter(Header(message, "Channel"), "Svcid").Number();
 
-        _sessionInfo.bookmark = atof(setupMap["Bookmark"].c_str());
-        _sessionInfo.duration = atoi(setupMap["Duration"].c_str());
+        _sessionInfo.bookmark = Header(message, "Bookmark").Decimal();
+        _sessionInfo.duration = Header(message, "Duration").Number();
 
         TRACE_L2("%s: f=%d p=%d m=%d s=%d bookmark=%f duration=%d",
             __FUNCTION__, _sessionInfo.frequency, _sessionInfo.programNum, _sessionInfo.modulation, _sessionInfo.symbolRate, _sessionInfo.bookmark, _sessionInfo.duration);
     }
 
-    void RtspParser::UpdateNPT(NAMED_ARRAY& playMap)
+    void RtspParser::UpdateNPT(const RtspText& message)
     {
-        float nptStart = 0, nptEnd = 0;
+        float nptStart = 0;
         float oldScale = _sessionInfo.scale;
         float oldNPT = _sessionInfo.npt;
 
-        NAMED_ARRAY::iterator it = playMap.find("Scale");
-        if (it != playMap.end())
-            _sessionInfo.scale = atof(playMap["Scale"].c_str());
-
-        it = playMap.find("Range");
-        if (it != playMap.end()) {
-            string range = playMap["Range"];
-            size_t posEq = range.find('=');
-            size_t posHyphen = range.find('-');
-            if (posEq != string::npos) {
-                if (posHyphen != string::npos) {
-                    nptStart = atof(range.substr(posEq + 1, posHyphen - 1).c_str());
-                    nptEnd = atoi(range.substr(posHyphen + 1).c_str());
-                } else {
-                    nptStart = atof(range.substr(posEq + 1).c_str());
-                }
+        const RtspText scale(Header(message, "Scale"));
+        if (scale.IsEmpty() == false)
+            _sessionInfo.scale = scale.Decimal();
+
+        const RtspText range(Header(message, "Range"));
+        if (range.IsEmpty() == false) {
+            uint32_t posEq = range.Find('=');
+            if (posEq != range.Length()) {
+                uint32_t posHyphen = range.Find('-', posEq + 1);
+                nptStart = range.Substring(posEq + 1, posHyphen - (posEq + 1)).Decimal();
             }
 
             _sessionInfo.npt = SEC2MS(nptStart);
@@ -255,157 +338,153 @@ namespace Plugin {
 
     void RtspParser::ProcessPlayResponse(const std::string& response)
     {
-        NAMED_ARRAY playMap;
-        Parse(response, playMap, RtspLineTerminator, ": ");
-        UpdateNPT(playMap);
+        UpdateNPT(RtspText(response));
     }
 
     void RtspParser::ProcessGetParamResponse(const std::string& response)
     {
-        NAMED_ARRAY playMap;
-        Parse(response, playMap, RtspLineTerminator, ": ");
-        UpdateNPT(playMap);
+        UpdateNPT(RtspText(response));
     }
 
     void RtspParser::ProcessTeardownResponse(const std::string& response)
     {
-        NAMED_ARRAY playMap;
-        Parse(response, playMap, RtspLineTerminator, ": ");
     }
 
-    void RtspParser::Parse(const std::string& str, NAMED_ARRAY& contents, const string& sep1, const string& sep2)
+    /* static */ uint32_t RtspParser::MessageLength(const RtspText& data)
     {
-        TRACE_L4("%s: size=%d input='%s'", __FUNCTION__, str.size(), str.c_str());
-        contents.clear();
-
-        bool done = false;
-        size_t pos = 0;
-        size_t start = 0;
-        while (!done) {
-            pos = str.find(sep1, start);
-
-            //TRACE_L2("%s: pos=%u start=%u size=%u", __FUNCTION__, pos, start, str.size());
-            if ((pos == string::npos) || (pos >= str.size()))
-                done = true;
-
-            string sub = str.substr(start, pos - start);
-            size_t pos2 = sub.find(sep2);
-            if (pos2 == string::npos) {
-                string left = sub.substr(0, pos2);
-                contents[left] = "";
-            } else {
-                string left = sub.substr(0, pos2);
-                string right = sub.substr(pos2 + sep2.size());
-                TRACE_L4("%s:     left=%s right=%s pos=%u", __FUNCTION__, left.c_str(), right.c_str(), pos2);
-                contents[left] = right;
+        uint32_t result = 0;
+        const uint32_t end = data.Find(RtspMessageTerminator);
+
+        if (end != data.Length()) {
+            const uint32_t headers = end + 4;
+            const int32_t content = Header(data.Substring(0, headers), "Content-Length").Number();
+            const uint32_t length = headers + (content > 0 ? content : 0);
+
+            if (length <= data.Length()) {
+                result = length;
+            }
+        }
+
+        return (result);
+    }
+
+    /* static */ RtspText RtspParser::Header(const RtspText& message, const char name[])
+    {
+        RtspText result;
+        uint32_t start = 0;
+
+        // All lines are inspected, so parameters in a text/parameters body are found as well. Like
+        // before, the last one found wins.
+        while (start < message.Length()) {
+            const uint32_t end = message.Find(RtspLineTerminator, start);
+            const RtspText line(message.Substring(start, end - start));
+            const uint32_t colon = line.Find(':');
+
+            if ((colon != line.Length()) && (line.Substring(0, colon).Trim().Is(name) == true)) {
+                result = line.Substring(colon + 1).Trim();
+            }
+
+            start = end + 2;
+        }
+
+        return (result);
+    }
+
+    /* static */ RtspText RtspParser::Parameter(const RtspText& list, const char name[], const char separator)
+    {
+        RtspText result;
+        uint32_t start = 0;
+
+        while (start < list.Length()) {
+            const uint32_t end = list.Find(separator, start);
+            const RtspText entry(list.Substring(start, end - start));
+            const uint32_t assign = entry.Find('=');
+
+            if (entry.Substring(0, assign).Trim().Is(name) == true) {
+                result = entry.Substring(assign + 1).Trim();
+                break;
             }
 
-            start = pos + sep1.size();
-            if (start >= str.size())
-                done = true;
+            start = end + 1;
         }
 
-        TRACE_L4("%s: contents.size=%d", __FUNCTION__, contents.size());
-        for (NAMED_ARRAY::iterator it = contents.begin(); it != contents.end(); ++it)
-            TRACE_L4("%s: %s => '%s'", __FUNCTION__, it->first.c_str(), it->second.c_str());
+        return (result);
     }
 
-    RtspMessagePtr RtspParser::ParseResponse(const std::string str)
+    RtspMessagePtr RtspParser::ParseResponse(const RtspText& message)
     {
-        int rtspCode = 0;
         RtspMessagePtr response;
 
-        HexDump("Response: ", str);
+#if defined(_TRACE_LEVEL) && (_TRACE_LEVEL > 1)
+        HexDump("Response: ", message.Text());
+#endif
         // -------------------------------------------------------------------------
         // RTSP/1.0 200 OK
         // RTSP/1.0 400 Bad Request
         // ANNOUNCE rtsp://x.x.x.x:8060 RTSP/1.0
         // -------------------------------------------------------------------------
-        size_t pos = str.find(RtspLineTerminator);
-        if (pos != std::string::npos) {
-            string header = str.substr(0, pos);
-            std::vector<string> tokens;
-            Split(header, " ", tokens);
-            //TRACE_L2( "%s: header.length=%d tokens.size=%d", __FUNCTION__, header.length(), tokens.size());
-            //for (int i = 0; i < tokens.size(); i++)
-            //    TRACE_L2( "%s: %d. '%s'", __FUNCTION__, i, tokens.at(i).c_str());
+        uint32_t pos = message.Find(RtspLineTerminator);
+        if (pos != message.Length()) {
+            const RtspText header(message.Substring(0, pos));
+            const RtspText rtspBody(message.Substring(pos + 2)); // +2 CRLF
+            const uint32_t first = header.Find(' ');
 
             // Parse rest, only if the header is valid
-            if (tokens.size() >= 3) {
-                string first = tokens.at(0);
-                string rtspBody = str.substr(pos + 2); // +2 CRLR
+            if ((first != header.Length()) && (header.Find(' ', first + 1) != header.Length())) {
+                const RtspText method(header.Substring(0, first));
 
-                if (first.compare("ANNOUNCE") == 0) {
+                if (method.Is("ANNOUNCE") == true) {
                     response = ParseAnnouncement(rtspBody, 0);
-                } else if (first.compare(0, 5, "RTSP/") == 0) {
-                    rtspCode = std::stoi(tokens.at(1));
-                    response = RtspMessagePtr(new RtspResponse(rtspCode));
-                    response->message = rtspBody;
+                } else if ((method.Length() > 5) && (::strncmp(method.Data(), "RTSP/", 5) == 0)) {
+                    response = RtspMessagePtr(new RtspResponse(header.Substring(first + 1).Number()));
+                    response->message = rtspBody.Text();
+                }
+
+                if (response) {
+                    response->sequence = Header(rtspBody, "CSeq").Number();
                 }
-                //Parse(tokenStr, contents, ":", RtspLineTerminator);
             }
         }
 
         return response;
     }
 
-    RtspMessagePtr RtspParser::ParseAnnouncement(const std::string& response, bool bSRM)
+    RtspMessagePtr RtspParser::ParseAnnouncement(const RtspText& response, bool bSRM)
     {
         /*
-        contents.size=3
-        CSeq => '6'
-        Notice => '2104 "Start-of-Stream Reached" event-date=20160623T231007Z'
-        Session => '2709130937-52547519'
+        CSeq: 6
+        Notice: 2104 "Start-of-Stream Reached" event-date=20160623T231007Z
+        Session: 2709130937-52547519
     */
         int code = 0;
         string reason;
-        NAMED_ARRAY announceMap;
-        Parse(response, announceMap, RtspLineTerminator, ": ");
-        if (announceMap.size()) {
-            int respSeq = atoi(announceMap["CSeq"].c_str());
-            TRACE_L2("%s: respSeq=%d", __FUNCTION__, respSeq);
-
-            string notice = announceMap["Notice"];
-            size_t pos = notice.find(' ');
-            if (pos != string::npos) {
-                size_t pos2;
-
-                string strCode = notice.substr(0, pos);
-                code = atoi(strCode.c_str());
-
-                pos = notice.find('"');
-                if (pos != string::npos) {
-                    pos2 = notice.find('"', pos + 1);
-                    if (pos2 != string::npos) {
-                        reason = notice.substr(pos + 1, pos2 - pos);
+        const RtspText notice(Header(response, "Notice"));
+
+        if (notice.IsEmpty() == false) {
+            TRACE_L2("%s: respSeq=%d", __FUNCTION__, Header(response, "CSeq").Number());
+
+            uint32_t pos = notice.Find(' ');
+            if (pos != notice.Length()) {
+                code = notice.Substring(0, pos).Number();
+
+                pos = notice.Find('"');
+                if (pos != notice.Length()) {
+                    uint32_t pos2 = notice.Find('"', pos + 1);
+                    if (pos2 != notice.Length()) {
+                        reason = notice.Substring(pos + 1, pos2 - (pos + 1)).Text();
                     }
                 }
             }
         } else {
-            TRACE_L1("%s: ANNOUNCEMENT without body", __FUNCTION__, response.c_str());
+            TRACE_L1("%s: ANNOUNCEMENT without notice", __FUNCTION__);
         }
 
         return RtspMessagePtr(new RtspAnnounce(code, reason));
     }
 
-    int RtspParser::Split(const string& str, const string& delim, std::vector<string>& tokens)
-    {
-        size_t prev = 0, pos = 0;
-        do {
-            pos = str.find(delim, prev);
-            if (pos == string::npos)
-                pos = str.length();
-            string token = str.substr(prev, pos - prev);
-            if (!token.empty())
-                tokens.push_back(token);
-            prev = pos + delim.length();
-        } while (pos < str.length() && prev < str.length());
-
-        return tokens.size();
-    }
-
     void RtspParser::HexDump(const char* label, const std::string& msg, uint16_t charsPerLine)
     {
+#if defined(_TRACE_LEVEL) && (_TRACE_LEVEL > 1)
         std::stringstream ssHex, ss;
         for (uint32_t i = 0; i < msg.length(); i++) {
             int byte = (uint8_t)msg.at(i);
@@ -419,6 +498,7 @@ namespace Plugin {
             }
         }
         TRACE_L2("%s: %s %s", label, ssHex.str().c_str(), ss.str().c_str());
+#endif
     }
 }
 } // WPEFramework::Plugin
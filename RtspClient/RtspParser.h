@@ -20,7 +20,7 @@
 #ifndef RTSPPARSER_H
 #define RTSPPARSER_H
 
-#include <map>
+#include <atomic>
 #include <string>
 
 #include "RtspCommon.h"
@@ -29,7 +29,59 @@
 namespace WPEFramework {
 namespace Plugin {
 
-    typedef std::map<std::string, std::string> NAMED_ARRAY;
+    // A piece of a message, pointing into the buffer the message was received in, so a message can be
+    // taken apart without copying it into separate strings. Mind that it does not own the data.
+    class RtspText {
+    public:
+        RtspText()
+            : _data(nullptr)
+            , _length(0)
+        {
+        }
+        RtspText(const char data[], const uint32_t length)
+            : _data(data)
+            , _length(length)
+        {
+        }
+        explicit RtspText(const std::string& text)
+            : _data(text.data())
+            , _length(static_cast<uint32_t>(text.length()))
+        {
+        }
+
+    public:
+        inline bool IsEmpty() const
+        {
+            return (_length == 0);
+        }
+        inline const char* Data() const
+        {
+            return (_data);
+        }
+        inline uint32_t Length() const
+        {
+            return (_length);
+        }
+        inline std::string Text() const
+        {
+            return (std::string(_data, _length));
+        }
+        // Header and parameter names are case insensitive.
+        inline bool Is(const char text[]) const
+        {
+            return ((::strlen(text) == _length) && (::strncasecmp(_data, text, _length) == 0));
+        }
+        uint32_t Find(const char text[], const uint32_t offset = 0) const;
+        uint32_t Find(const char character, const uint32_t offset = 0) const;
+        RtspText Substring(const uint32_t offset, const uint32_t length = ~0) const;
+        RtspText Trim() const;
+        int32_t Number() const;
+        float Decimal() const;
+
+    private:
+        const char* _data;
+        uint32_t _length;
+    };
 
     class RtspParser {
     public:
@@ -45,22 +97,28 @@ namespace Plugin {
         void ProcessGetParamResponse(const std::string& response);
         void ProcessTeardownResponse(const std::string& response);
 
-        void Parse(const std::string& str, NAMED_ARRAY& contents, const string& sep1, const string& sep2);
-        RtspMessagePtr ParseResponse(const std::string str);
-        RtspMessagePtr ParseAnnouncement(const std::string& response, bool bSRM);
+        RtspMessagePtr ParseResponse(const RtspText& message);
+        RtspMessagePtr ParseAnnouncement(const RtspText& response, bool bSRM);
+
+        // Length of the first complete message (headers and content) in the data, 0 if it is not complete yet.
+        static uint32_t MessageLength(const RtspText& data);
+        // The (trimmed) value of a header, the headers are looked up in place.
+        static RtspText Header(const RtspText& message, const char name[]);
+        // The value of a parameter in a list like "id;timeout=60" or "frequency=5750;modulation=16".
+        static RtspText Parameter(const RtspText& list, const char name[], const char separator = ';');
 
         static void HexDump(const char* label, const std::string& msg, uint16_t charsPerLine = 32);
 
     private:
-        void UpdateNPT(NAMED_ARRAY& playMap);
-        int Split(const string& str, const string& delim, std::vector<string>& tokens);
+        void UpdateNPT(const RtspText& message);
 
     public:
         RtspSessionInfo& _sessionInfo;
 
     private:
         static constexpr const char* const RtspLineTerminator = "\r\n";
-        static unsigned int _sequence;
+        static constexpr const char* const RtspMessageTerminator = "\r\n\r\n";
+        static std::atomic<uint32_t> _sequence;
     };
 }
 } // WPEFramework::Plugin
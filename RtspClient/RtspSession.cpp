@@ -31,7 +31,8 @@ namespace Plugin {
         , _controlSocket(nullptr)
         , _parser(_sessionInfo)
         , _requestQueue(64)
-        , _responseQueue(64)
+        , _pendingLock()
+        , _pending()
         , _heartbeatTimer(Core::Thread::DefaultStackSize(), _T("RtspHeartbeatTimer"))
         , _isSessionActive(false)
         , _nextSRMHeartbeatMS(0)
@@ -42,6 +43,12 @@ namespace Plugin {
 
     RtspSession::~RtspSession()
     {
+        _pendingLock.Lock();
+        for (auto& entry : _pending) {
+            delete entry.second;
+        }
+        _pending.clear();
+        _pendingLock.Unlock();
     }
 
     RtspReturnCode RtspSession::Initialize(const string& hostname, uint16_t port)
@@ -92,10 +99,72 @@ namespace Plugin {
 
     RtspReturnCode RtspSession::Send(const RtspMessagePtr& request)
     {
-        _requestQueue.Post(request);
-        GetSocket(request->bSRM).Trigger();
+        RtspReturnCode rc = ERR_OK;
+        RtspSession::Socket* socket = GetSocket(request->bSRM);
+
+        if ((socket == nullptr) || (socket->IsOpen() == false)) {
+            TRACE_L1("%s: No connection to send CSeq %d on", __FUNCTION__, request->sequence);
+            rc = ERR_CONNECT_FAILED;
+        } else if (_requestQueue.Post(request) == false) {
+            TRACE_L1("%s: Could not queue CSeq %d", __FUNCTION__, request->sequence);
+            rc = ERR_UNKNOWN;
+        } else {
+            socket->Trigger();
+        }
 
-        return ERR_OK; // Handle return value
+        return rc;
+    }
+
+    RtspReturnCode RtspSession::Submit(const RtspMessagePtr& request)
+    {
+        RtspReturnCode rc;
+        Pending* pending = new Pending();
+
+        // Register before sending, the response might be there before we get to wait for it.
+        _pendingLock.Lock();
+        ASSERT(_pending.find(request->sequence) == _pending.end());
+        _pending.insert(std::make_pair(request->sequence, pending));
+        _pendingLock.Unlock();
+
+        rc = Send(request);
+
+        if (rc != ERR_OK) {
+            // Nothing was sent, so there is nothing to wait for.
+            _pendingLock.Lock();
+            _pending.erase(request->sequence);
+            _pendingLock.Unlock();
+
+            delete pending;
+        }
+
+        return rc;
+    }
+
+    RtspReturnCode RtspSession::Wait(const uint32_t sequence, RtspMessagePtr& response)
+    {
+        RtspReturnCode rc = ERR_TIMED_OUT;
+
+        _pendingLock.Lock();
+        std::map<uint32_t, Pending*>::iterator index(_pending.find(sequence));
+        Pending* pending = (index != _pending.end() ? index->second : nullptr);
+        _pendingLock.Unlock();
+
+        if (pending != nullptr) {
+            pending->_signal.Lock(ResponseWaitTime);
+
+            _pendingLock.Lock();
+            if (pending->_response) {
+                response = pending->_response;
+                rc = ERR_OK;
+            }
+            // Too late is never, a response that still comes in is dropped.
+            _pending.erase(sequence);
+            _pendingLock.Unlock();
+
+            delete pending;
+        }
+
+        return rc;
     }
 
     uint64_t RtspSession::Timed(const uint64_t scheduledTime)
@@ -120,18 +189,21 @@ namespace Plugin {
         RtspMessagePtr response;
 
         if (!_isSessionActive) {
+            const uint64_t start = Core::Time::Now().Ticks();
+            uint64_t setup = start;
+
             _sessionInfo.reset();
-            // new session, flush any remaining message in the queue
-            while (!_responseQueue.IsEmpty()) {
-                TRACE_L1("%s: Removing old message", __FUNCTION__);
-                _responseQueue.Extract(response, 0);
-            }
 
             _isSessionActive = true;
             RtspMessagePtr request = _parser.BuildSetupRequest(_sessionInfo.srm.name, assetId);
-            Send(request);
+            rc = Submit(request);
 
-            if (_responseQueue.Extract(response, ResponseWaitTime)) {
+            if (rc == ERR_OK) {
+                rc = Wait(request->sequence, response);
+            }
+
+            if (rc == ERR_OK) {
+                setup = Core::Time::Now().Ticks();
                 _adminLock.Lock();
                 _parser.ProcessSetupResponse(response->message);
 
@@ -152,8 +224,9 @@ namespace Plugin {
                 }
                 _adminLock.Unlock();
             } else {
-                TRACE_L1("%s: Failed to get Response", __FUNCTION__);
-                rc = ERR_TIMED_OUT;
+                TRACE_L1("%s: Failed to get Response, error %d", __FUNCTION__, rc);
+                // Without a SETUP response there is no session to close.
+                _isSessionActive = false;
             }
 
             if (rc == ERR_OK) {
@@ -161,7 +234,13 @@ namespace Plugin {
                 _nextPumpHeartbeatMS = _sessionInfo.ctrlSessionTimeout;
 
                 // implicit play
-                Play(1.0, (position == 0) ? _sessionInfo.bookmark : position);
+                rc = Play(1.0, (position == 0) ? _sessionInfo.bookmark : position);
+
+                const uint64_t now = Core::Time::Now().Ticks();
+                TRACE(Trace::Information, (_T("Tune time %d mS, SETUP %d mS, PLAY %d mS"),
+                    static_cast<uint32_t>((now - start) / Core::Time::TicksPerMillisecond),
+                    static_cast<uint32_t>((setup - start) / Core::Time::TicksPerMillisecond),
+                    static_cast<uint32_t>((now - setup) / Core::Time::TicksPerMillisecond)));
             }
         } else {
             TRACE_L1("%s: Open failed, session is active", __FUNCTION__);
@@ -178,12 +257,14 @@ namespace Plugin {
 
         if (_isSessionActive) {
             RtspMessagePtr request = _parser.BuildTeardownRequest(reason);
-            Send(request);
-            if (_responseQueue.Extract(response, ResponseWaitTime)) {
+            rc = Submit(request);
+            if (rc == ERR_OK) {
+                rc = Wait(request->sequence, response);
+            }
+            if (rc == ERR_OK) {
                 _parser.ProcessTeardownResponse(response->message);
             } else {
-                TRACE_L1("%s: Failed to get Response", __FUNCTION__);
-                rc = ERR_TIMED_OUT;
+                TRACE_L1("%s: Failed to get Response, error %d", __FUNCTION__, rc);
             }
 
             _isSessionActive = false;
@@ -204,12 +285,14 @@ namespace Plugin {
             RtspMessagePtr response;
 
             RtspMessagePtr request = _parser.BuildPlayRequest(scale, position);
-            Send(request);
-            if (_responseQueue.Extract(response, ResponseWaitTime)) {
+            rc = Submit(request);
+            if (rc == ERR_OK) {
+                rc = Wait(request->sequence, response);
+            }
+            if (rc == ERR_OK) {
                 _parser.ProcessPlayResponse(response->message);
             } else {
-                TRACE_L1("%s: Failed to get Response", __FUNCTION__);
-                rc = ERR_TIMED_OUT;
+                TRACE_L1("%s: Failed to get Response, error %d", __FUNCTION__, rc);
             }
         } else {
             rc = ERR_NO_ACTIVE_SESSION;
@@ -231,11 +314,11 @@ namespace Plugin {
         return rc;
     }
 
-    RtspReturnCode RtspSession::ProcessResponse(const string& responseStr, bool bSRM)
+    RtspReturnCode RtspSession::ProcessResponse(const RtspText& responseStr, bool bSRM)
     {
         RtspReturnCode rc = ERR_OK;
 
-        if (responseStr.length()) {
+        if (responseStr.Length()) {
             RtspMessagePtr response = _parser.ParseResponse(responseStr);
             if (dynamic_cast<RtspAnnounce*>(response.get()) != nullptr) {
                 RtspAnnounce& announcement = *dynamic_cast<RtspAnnounce*>(response.get());
@@ -248,9 +331,17 @@ namespace Plugin {
                 }
                 _announcementHandler.announce(announcement);
             } else if (dynamic_cast<RtspResponse*>(response.get()) != nullptr) {
-                _responseQueue.Post(response);
+                _pendingLock.Lock();
+                std::map<uint32_t, Pending*>::iterator index(_pending.find(response->sequence));
+                if (index != _pending.end()) {
+                    index->second->_response = response;
+                    index->second->_signal.SetEvent();
+                } else {
+                    TRACE_L1("%s: Unexpected response, CSeq %d", __FUNCTION__, response->sequence);
+                }
+                _pendingLock.Unlock();
             } else {
-                TRACE_L1("%s: UNKNOWN response '%s'", __FUNCTION__, responseStr.c_str());
+                TRACE_L1("%s: UNKNOWN response '%s'", __FUNCTION__, responseStr.Text().c_str());
             }
         }
         return rc;
@@ -258,13 +349,11 @@ namespace Plugin {
 
     RtspReturnCode RtspSession::SendResponse(int respSeq, bool bSRM)
     {
-        RtspReturnCode rc = ERR_OK;
         RtspMessagePtr request = _parser.BuildResponse(respSeq, bSRM);
 
         TRACE_L1("%s: Sending Announcement Response", __FUNCTION__);
-        Send(request);
 
-        return rc;
+        return (Send(request));
     }
 
     RtspReturnCode RtspSession::SendHeartbeat(bool bSRM)
@@ -273,13 +362,15 @@ namespace Plugin {
         RtspMessagePtr response;
 
         RtspMessagePtr request = _parser.BuildGetParamRequest(bSRM);
-        Send(request);
+        rc = Submit(request);
 
-        if (_responseQueue.Extract(response, ResponseWaitTime)) {
+        if (rc == ERR_OK) {
+            rc = Wait(request->sequence, response);
+        }
+        if (rc == ERR_OK) {
             _parser.ProcessGetParamResponse(response->message);
         } else {
-            TRACE_L1("%s: Failed to get Response", __FUNCTION__);
-            rc = ERR_TIMED_OUT;
+            TRACE_L1("%s: Failed to get Response, error %d", __FUNCTION__, rc);
         }
 
         return rc;
@@ -290,12 +381,14 @@ namespace Plugin {
         RtspReturnCode rc = ERR_OK;
         int sessionTimeoutMS = _sessionInfo.sessionTimeout;
         int ctrlSessionTimeoutMS = _sessionInfo.ctrlSessionTimeout;
+        RtspMessagePtr requests[2];
+        uint8_t count = 0;
 
         // SRM Heartbeat
         if (!_sessionInfo.sessionId.empty() && sessionTimeoutMS > 0) {
             _nextSRMHeartbeatMS -= NptUpdateInterwal;
             if (_nextSRMHeartbeatMS <= 0) {
-                rc = SendHeartbeat(true);
+                requests[count++] = _parser.BuildGetParamRequest(true);
                 _nextSRMHeartbeatMS = sessionTimeoutMS;
             }
         }
@@ -304,17 +397,42 @@ namespace Plugin {
         if (!_sessionInfo.ctrlSessionId.empty() && ctrlSessionTimeoutMS > 0) {
             _nextPumpHeartbeatMS -= NptUpdateInterwal;
             if (_nextPumpHeartbeatMS <= 0) {
-                rc = SendHeartbeat(false);
+                requests[count++] = _parser.BuildGetParamRequest(false);
                 _nextPumpHeartbeatMS = ctrlSessionTimeoutMS;
             }
         }
 
+        // The heartbeats are independent, send them all before waiting for any of the responses.
+        // One that could not be sent has failed already, there is no response to wait for.
+        for (uint8_t index = 0; index < count; index++) {
+            const RtspReturnCode result = Submit(requests[index]);
+
+            if (result != ERR_OK) {
+                TRACE_L1("%s: Failed to send heartbeat, error %d", __FUNCTION__, result);
+                requests[index].reset();
+                rc = result;
+            }
+        }
+        for (uint8_t index = 0; index < count; index++) {
+            RtspMessagePtr response;
+
+            if (requests[index]) {
+                if (Wait(requests[index]->sequence, response) == ERR_OK) {
+                    _parser.ProcessGetParamResponse(response->message);
+                } else {
+                    TRACE_L1("%s: Failed to get Response", __FUNCTION__);
+                    rc = ERR_TIMED_OUT;
+                }
+            }
+        }
+
         return rc;
     }
 
     RtspSession::Socket::Socket(const Core::NodeId& local, const Core::NodeId& remote, RtspSession& rtspSession)
         : Core::SocketStream(false, local, remote, 4096, 4096)
         , _rtspSession(rtspSession)
+        , _buffer()
     {
         Open(1000, "");
     };
@@ -343,9 +461,38 @@ namespace Plugin {
     uint16_t RtspSession::Socket::ReceiveData(uint8_t* dataFrame, const uint16_t receivedSize)
     {
         TRACE(Trace::Information, ("%s: receivedSize=%d", __FUNCTION__, receivedSize));
-        string response((char*)dataFrame, receivedSize);
         bool bSRM = (_rtspSession._srmSocket == this);
-        _rtspSession.ProcessResponse(response, bSRM);
+        uint32_t offset = 0;
+        uint32_t length;
+
+        if (_buffer.empty() == true) {
+            // Usually the messages are complete, take them apart straight from the receive buffer.
+            const RtspText received(reinterpret_cast<const char*>(dataFrame), receivedSize);
+
+            while ((length = RtspParser::MessageLength(received.Substring(offset))) != 0) {
+                _rtspSession.ProcessResponse(received.Substring(offset, length), bSRM);
+                offset += length;
+            }
+
+            _buffer.assign(reinterpret_cast<const char*>(&(dataFrame[offset])), receivedSize - offset);
+        } else {
+            _buffer.append(reinterpret_cast<const char*>(dataFrame), receivedSize);
+
+            const RtspText received(_buffer);
+
+            while ((length = RtspParser::MessageLength(received.Substring(offset))) != 0) {
+                _rtspSession.ProcessResponse(received.Substring(offset, length), bSRM);
+                offset += length;
+            }
+
+            _buffer.erase(0, offset);
+        }
+
+        if (_buffer.size() > MaxMessageSize) {
+            TRACE_L1("%s: No message end in %d bytes, dropping them", __FUNCTION__, static_cast<uint32_t>(_buffer.size()));
+            _buffer.clear();
+        }
+
         return receivedSize;
     }
 
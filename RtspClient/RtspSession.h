@@ -27,6 +27,7 @@
 #include <core/NodeId.h>
 #include <core/Queue.h>
 #include <core/SocketPort.h>
+#include <core/Sync.h>
 #include <core/Timer.h>
 
 #include "RtspCommon.h"
@@ -36,7 +37,6 @@ namespace WPEFramework {
 namespace Plugin {
 
     typedef Core::QueueType<RtspMessagePtr> RequestQueue;
-    typedef Core::QueueType<RtspMessagePtr> ResponseQueue;
 
     class RtspSession {
     public:
@@ -50,6 +50,28 @@ namespace Plugin {
 
         private:
             RtspSession& _rtspSession;
+            string _buffer; // part of a message still to be completed by the next receive
+        };
+
+        // A request waiting for its response, the response is matched on CSeq. Several requests can be
+        // outstanding at the same time, so requests that do not depend on each other are pipelined.
+        class Pending {
+        public:
+            Pending(const Pending&) = delete;
+            Pending& operator=(const Pending&) = delete;
+
+            Pending()
+                : _signal(false, true)
+                , _response()
+            {
+            }
+            ~Pending()
+            {
+            }
+
+        public:
+            Core::Event _signal;
+            RtspMessagePtr _response;
         };
 
         class AnnouncementHandler {
@@ -100,10 +122,12 @@ namespace Plugin {
         RtspReturnCode Set(const string& name, const string& value);
 
         RtspReturnCode Send(const RtspMessagePtr& request);
+        RtspReturnCode Submit(const RtspMessagePtr& request);
+        RtspReturnCode Wait(const uint32_t sequence, RtspMessagePtr& response);
         RtspReturnCode SendHeartbeat(bool bSRM);
         RtspReturnCode SendHeartbeats();
 
-        RtspReturnCode ProcessResponse(const string& response, bool bSRM);
+        RtspReturnCode ProcessResponse(const RtspText& response, bool bSRM);
         RtspReturnCode ProcessAnnouncement(const std::string& response, bool bSRM);
         RtspReturnCode SendResponse(int respSeq, bool bSRM);
         RtspReturnCode SendAnnouncement(int code, const string& reason);
@@ -111,9 +135,9 @@ namespace Plugin {
         uint64_t Timed(const uint64_t scheduledTime);
 
     private:
-        inline RtspSession::Socket& GetSocket(bool bSRM)
+        inline RtspSession::Socket* GetSocket(bool bSRM)
         {
-            return (bSRM || _sessionInfo.bSrmIsRtspProxy) ? *_srmSocket : *_controlSocket;
+            return (bSRM || _sessionInfo.bSrmIsRtspProxy) ? _srmSocket : _controlSocket;
         }
 
         inline bool IsSrmRtspProxy()
@@ -123,6 +147,7 @@ namespace Plugin {
 
     private:
         static constexpr uint16_t ResponseWaitTime = 3000;
+        static constexpr uint32_t MaxMessageSize = 64 * 1024;
         static constexpr uint16_t NptUpdateInterwal = 1000;
 
         RtspSession::AnnouncementHandler& _announcementHandler;
@@ -136,7 +161,8 @@ namespace Plugin {
         RtspSessionInfo _sessionInfo;
         Core::CriticalSection _adminLock;
         RequestQueue _requestQueue;
-        ResponseQueue _responseQueue;
+        Core::CriticalSection _pendingLock;
+        std::map<uint32_t, Pending*> _pending;
         Core::TimerType<HeartbeatTimer> _heartbeatTimer;
 
         bool _isSessionActive;
@@ -0,0 +1,364 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Module.h"
+#include "../RtspSession.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Tune latency of the RtspSession against an RTSP server on the loopback interface, that acts as
+// an SRM in RTSP proxy mode and answers every request after a configurable delay:
+//
+//    RtspClientTuneTest -port 8554 -delay 20 -runs 20
+//
+// - tune: Open(), so SETUP and the implicit PLAY, till it returns;
+// - setup: from the start of Open() till the stand-in received the PLAY;
+// - close: Close(), the TEARDOWN;
+// - unreachable: Open() on a session without a connection, it has to fail right away instead of
+//   waiting for a response that can never come.
+// The results are printed as JSON, the exit code is the number of failed runs.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+static const TCHAR Loopback[] = _T("127.0.0.1");
+static constexpr uint32_t UnreachableLimit = 1000; // mS, a response would be waited for 3000 mS
+
+// An SRM that is its own RTSP proxy: the session and the control session are the same, so the
+// PLAY comes in on the same connection as the SETUP.
+class Server : public Core::Thread {
+private:
+    static constexpr uint32_t MaxRequestSize = 4096;
+
+public:
+    Server() = delete;
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    Server(const uint16_t port, const uint32_t delay /* mS */)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("RtspStandIn"))
+        , _delay(delay)
+        , _listener(::socket(AF_INET, SOCK_STREAM, 0))
+        , _client(-1)
+        , _request()
+        , _session(0)
+        , _played(0)
+    {
+        struct sockaddr_in local;
+        int reuse = 1;
+
+        ::memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_port = htons(port);
+        ::inet_pton(AF_INET, Loopback, &local.sin_addr);
+
+        ::setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if ((_listener != -1) && ((::bind(_listener, reinterpret_cast<const struct sockaddr*>(&local), sizeof(local)) != 0) || (::listen(_listener, 4) != 0))) {
+            ::close(_listener);
+            _listener = -1;
+        }
+        if (_listener != -1) {
+            Run();
+        }
+    }
+    ~Server() override
+    {
+        Stop();
+        Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+        if (_client != -1) {
+            ::close(_client);
+        }
+        if (_listener != -1) {
+            ::close(_listener);
+        }
+    }
+
+public:
+    bool IsValid() const
+    {
+        return (_listener != -1);
+    }
+    // When the last PLAY came in, in ticks.
+    uint64_t Played() const
+    {
+        return (_played);
+    }
+
+private:
+    static string Header(const string& request, const TCHAR name[])
+    {
+        string result;
+        const string key(string(_T("\r\n")) + name + _T(":"));
+        const size_t start = request.find(key);
+
+        if (start != string::npos) {
+            const size_t begin = request.find_first_not_of(' ', start + key.length());
+            const size_t end = request.find(_T("\r\n"), begin);
+            result = request.substr(begin, end - begin);
+        }
+
+        return (result);
+    }
+    void Answer(const string& request)
+    {
+        const string method(request.substr(0, request.find(' ')));
+        const string sequence(Header(request, _T("CSeq")));
+        TCHAR session[16];
+        string response(_T("RTSP/1.0 200 OK\r\nCSeq: ") + sequence + _T("\r\n"));
+
+        if (method == _T("SETUP")) {
+            ::snprintf(session, sizeof(session), _T("%u"), ++_session);
+            response += _T("Session: ") + string(session) + _T(";timeout=60\r\n");
+            response += _T("ControlSession: ") + string(session) + _T(";timeout=60\r\n");
+            response += _T("Tuning: frequency=5570000;modulation=16;symbol_rate=5361\r\n");
+            response += _T("Channel: Svcid=1\r\n");
+            response += _T("Bookmark: 0\r\nDuration: 3600\r\n");
+        } else if ((method == _T("PLAY")) || (method == _T("PAUSE"))) {
+            _played = Core::Time::Now().Ticks();
+            response += _T("Range: npt=0.000-\r\nScale: ") + Header(request, _T("Scale")) + _T("\r\n");
+        } else if (method == _T("GET_PARAMETER")) {
+            response += _T("Content-Length: 0\r\n");
+        }
+
+        response += _T("\r\n");
+
+        if (_delay > 0) {
+            SleepMs(_delay);
+        }
+
+        ::send(_client, response.c_str(), response.length(), MSG_NOSIGNAL);
+    }
+    uint32_t Worker() override
+    {
+        // A new connection replaces the one of the previous session.
+        struct pollfd descriptors[2] = { { _listener, POLLIN, 0 }, { _client, POLLIN, 0 } };
+
+        if (::poll(descriptors, (_client == -1 ? 1 : 2), 100) > 0) {
+            if ((descriptors[0].revents & POLLIN) != 0) {
+                if (_client != -1) {
+                    ::close(_client);
+                }
+                _client = ::accept(_listener, nullptr, nullptr);
+                _request.clear();
+            } else if ((descriptors[1].revents & (POLLIN | POLLHUP)) != 0) {
+                char buffer[1024];
+                const ssize_t size = ::recv(_client, buffer, sizeof(buffer), 0);
+
+                if (size <= 0) {
+                    ::close(_client);
+                    _client = -1;
+                } else {
+                    size_t end;
+
+                    _request.append(buffer, size);
+
+                    // The requests of the client only have a body with a Content-Length, a body
+                    // is followed by an empty line that is not counted in it.
+                    while ((end = _request.find(_T("\r\n\r\n"))) != string::npos) {
+                        if (end == 0) {
+                            _request.erase(0, 2);
+                            continue;
+                        }
+
+                        const string length(Header(_request.substr(0, end + 2), _T("Content-Length")));
+                        const size_t total = end + 4 + (length.empty() == true ? 0 : atoi(length.c_str()));
+
+                        if (_request.length() < total) {
+                            break;
+                        }
+
+                        Answer(_request.substr(0, total));
+                        _request.erase(0, total);
+                    }
+
+                    if (_request.length() > MaxRequestSize) {
+                        _request.clear();
+                    }
+                }
+            }
+        }
+
+        return (0);
+    }
+
+private:
+    const uint32_t _delay;
+    int _listener;
+    int _client;
+    string _request;
+    uint32_t _session;
+    std::atomic<uint64_t> _played;
+};
+
+class Announcements : public Plugin::RtspSession::AnnouncementHandler {
+public:
+    Announcements(const Announcements&) = delete;
+    Announcements& operator=(const Announcements&) = delete;
+
+    Announcements() = default;
+    ~Announcements() = default;
+
+public:
+    void announce(const Plugin::RtspAnnounce& announcement) override
+    {
+        fprintf(stderr, "Unexpected announcement %d: %s\n", announcement.GetCode(), announcement.GetReason().c_str());
+    }
+};
+
+class Timings {
+public:
+    Timings(const TCHAR name[])
+        : _name(name)
+        , _samples()
+    {
+    }
+
+public:
+    void Add(const uint64_t ticks)
+    {
+        _samples.push_back(static_cast<uint32_t>(ticks));
+    }
+    void Print(const bool last) const
+    {
+        uint64_t total = 0;
+        for (const uint32_t sample : _samples) {
+            total += sample;
+        }
+
+        // All in uS.
+        printf("  \"%s\": { \"runs\": %u, \"min\": %u, \"mean\": %.1f, \"max\": %u }%s\n",
+            _name, static_cast<uint32_t>(_samples.size()),
+            (_samples.empty() == true ? 0 : *std::min_element(_samples.begin(), _samples.end())),
+            (_samples.empty() == true ? 0.0 : static_cast<double>(total) / _samples.size()),
+            (_samples.empty() == true ? 0 : *std::max_element(_samples.begin(), _samples.end())),
+            (last == true ? "" : ","));
+    }
+
+private:
+    const TCHAR* _name;
+    std::vector<uint32_t> _samples;
+};
+
+}
+
+int main(int argc, char** argv)
+{
+    uint16_t port = 8554;
+    uint32_t delay = 20; // mS
+    uint16_t runs = 20;
+    uint32_t failures = 0;
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-port") == 0) {
+            port = static_cast<uint16_t>(atoi(argv[index + 1]));
+        } else if (strcmp(argv[index], "-delay") == 0) {
+            delay = static_cast<uint32_t>(atoi(argv[index + 1]));
+        } else if (strcmp(argv[index], "-runs") == 0) {
+            runs = static_cast<uint16_t>(std::max(1, atoi(argv[index + 1])));
+        }
+    }
+
+    {
+        Timings tune(_T("tune"));
+        Timings setup(_T("setup"));
+        Timings close(_T("close"));
+        Timings unreachable(_T("unreachable"));
+        Announcements announcements;
+
+        {
+            Server server(port, delay);
+
+            if (server.IsValid() == false) {
+                fprintf(stderr, "Could not listen on %s:%u\n", Loopback, port);
+                failures++;
+            } else {
+                for (uint16_t run = 0; run < runs; run++) {
+                    Plugin::RtspSession session(announcements);
+
+                    if (session.Initialize(Loopback, port) != Plugin::ERR_OK) {
+                        fprintf(stderr, "Could not connect to the stand-in\n");
+                        failures++;
+                    } else {
+                        const uint64_t start = Core::Time::Now().Ticks();
+                        const Plugin::RtspReturnCode opened = session.Open(_T("benchmark"));
+                        const uint64_t tuned = Core::Time::Now().Ticks();
+
+                        if (opened != Plugin::ERR_OK) {
+                            fprintf(stderr, "Tune failed, error %d\n", opened);
+                            failures++;
+                        } else {
+                            tune.Add(tuned - start);
+                            setup.Add(server.Played() - start);
+
+                            const Plugin::RtspReturnCode closed = session.Close();
+
+                            if (closed != Plugin::ERR_OK) {
+                                fprintf(stderr, "Close failed, error %d\n", closed);
+                                failures++;
+                            } else {
+                                close.Add(Core::Time::Now().Ticks() - tuned);
+                            }
+                        }
+                    }
+
+                    session.Terminate();
+                }
+            }
+        }
+
+        // Nobody listens anymore, nothing can be sent.
+        for (uint16_t run = 0; run < runs; run++) {
+            Plugin::RtspSession session(announcements);
+
+            session.Initialize(Loopback, port);
+
+            const uint64_t start = Core::Time::Now().Ticks();
+            const Plugin::RtspReturnCode opened = session.Open(_T("benchmark"));
+            const uint64_t duration = Core::Time::Now().Ticks() - start;
+
+            if ((opened != Plugin::ERR_CONNECT_FAILED) || (duration >= (UnreachableLimit * Core::Time::TicksPerMillisecond))) {
+                fprintf(stderr, "Open without a connection returned %d after %u uS\n", opened, static_cast<uint32_t>(duration));
+                failures++;
+            } else {
+                unreachable.Add(duration);
+            }
+
+            session.Terminate();
+        }
+
+        printf("{\n  \"delay\": %u,\n", delay);
+        tune.Print(false);
+        setup.Print(false);
+        close.Print(false);
+        unreachable.Print(true);
+        printf("}\n");
+    }
+
+    Core::Singleton::Dispose();
+
+    return (static_cast<int>(failures));
+}
@@ -0,0 +1,175 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Module.h"
+#include "../../Compositor/lib/Software/BufferHeader.h"
+
+#include <interfaces/ICapture.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Captures from a memory mapped frame, e.g. the output of the software compositor in shared
+    // memory or a frame dumped to a file. No display hardware is needed, so this also works on
+    // build/test machines. The file is mapped once and the frame is copied in a buffer that is
+    // reused for all captures of the same size.
+    class FrameBuffer : public Exchange::ICapture {
+    private:
+        FrameBuffer(const FrameBuffer&) = delete;
+        FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+        static constexpr uint8_t PixelSize = 4;
+        static constexpr uint8_t Retries = 8;
+        static constexpr uint32_t RetryDelay = 2; // mS, if the producer is in the middle of a frame
+
+        // The buffers of the software compositor, the pixels follow this header.
+        using Header = Software::BufferHeader;
+
+    public:
+        FrameBuffer()
+            : _adminLock()
+            , _source()
+            , _file(nullptr)
+            , _frame()
+        {
+            if ((Core::SystemInfo::GetEnvironment(_T("SNAPSHOT_FRAMEBUFFER"), _source) == false) || (_source.empty() == true)) {
+                _source = _T("/tmp/compositorbuffers/output");
+            }
+        }
+
+        virtual ~FrameBuffer()
+        {
+            if (_file != nullptr) {
+                delete _file;
+            }
+        }
+
+        BEGIN_INTERFACE_MAP(FrameBuffer)
+        INTERFACE_ENTRY(Exchange::ICapture)
+        END_INTERFACE_MAP
+
+        virtual const TCHAR* Name() const
+        {
+            return (_T("FrameBuffer"));
+        }
+
+        virtual bool Capture(ICapture::IStore& storer)
+        {
+            bool result = false;
+
+            _adminLock.Lock();
+
+            uint32_t width;
+            uint32_t height;
+            uint32_t stride;
+            const Header* header = Map(width, height, stride);
+
+            if (header != nullptr) {
+                const uint32_t size = width * height * PixelSize;
+
+                if (_frame.size() != size) {
+                    _frame.resize(size);
+                }
+
+                const uint8_t* pixels = &(_file->Buffer()[sizeof(Header)]);
+                uint8_t retries = Retries;
+                bool consistent = false;
+
+                // The producer keeps on rendering while we copy, only a copy taken while no frame was
+                // written is used, wait for the producer to finish the frame it is working on.
+                do {
+                    const uint32_t sequence = header->BeginRead();
+
+                    if ((sequence & 1) != 0) {
+                        SleepMs(RetryDelay);
+                    } else {
+                        if (stride == width) {
+                            ::memcpy(_frame.data(), pixels, size);
+                        } else {
+                            for (uint32_t line = 0; line < height; line++) {
+                                ::memcpy(&(_frame[line * width * PixelSize]), &(pixels[line * stride * PixelSize]), width * PixelSize);
+                            }
+                        }
+
+                        consistent = header->EndRead(sequence);
+                    }
+
+                    retries--;
+
+                } while ((consistent == false) && (retries != 0));
+
+                if (consistent == true) {
+                    result = storer.R8_G8_B8_A8(_frame.data(), width, height);
+                } else {
+                    TRACE_L1(_T("The frame in %s kept changing, no consistent copy after %d attempts"), _source.c_str(), Retries);
+                }
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+    private:
+        // The producer can change the header at any time, the dimensions are read once, validated and
+        // handed out, the header itself is only used for the sequence.
+        const Header* Map(uint32_t& width, uint32_t& height, uint32_t& stride)
+        {
+            const Header* result = nullptr;
+
+            if (_file == nullptr) {
+                _file = new Core::DataElementFile(_source, Core::File::SHAREABLE | Core::File::USER_READ, 0);
+            }
+
+            if ((_file->IsValid() == true) && (_file->Size() >= sizeof(Header))) {
+                const Header* header = reinterpret_cast<const Header*>(_file->Buffer());
+                const uint32_t magic = header->Magic;
+
+                width = header->Width;
+                height = header->Height;
+                stride = header->Stride;
+
+                if ((magic == Software::BufferMagic) && (stride >= width) && (_file->Size() >= (sizeof(Header) + (static_cast<uint64_t>(stride) * height * PixelSize)))) {
+                    result = header;
+                }
+            }
+
+            if (result == nullptr) {
+                // Not there (yet) or resized, map it again on the next capture.
+                TRACE_L1(_T("No valid frame found in %s"), _source.c_str());
+                delete _file;
+                _file = nullptr;
+            }
+
+            return (result);
+        }
+
+    private:
+        Core::CriticalSection _adminLock;
+        string _source;
+        Core::DataElementFile* _file;
+        std::vector<uint8_t> _frame;
+    };
+}
+
+/* static */ Exchange::ICapture* Exchange::ICapture::Instance()
+{
+    return (Core::Service<Plugin::FrameBuffer>::Create<Exchange::ICapture>());
+}
+}
@@ -0,0 +1,316 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SNAPSHOT_ENCODER_H
+#define __SNAPSHOT_ENCODER_H
+
+#include "Snapshot.h"
+
+#include <png.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Turns a captured frame into an image, the encoded data is streamed into the target file
+    // while it is produced, so the first bytes are out long before the last row is encoded.
+    class Encoder {
+    private:
+        Encoder() = delete;
+        Encoder(const Encoder&) = delete;
+        Encoder& operator=(const Encoder&) = delete;
+
+    public:
+        // Pixels, as delivered by the capture devices, are 4 bytes: blue, green, red and an (ignored) alpha.
+        static constexpr uint8_t PixelSize = 4;
+
+    private:
+        static constexpr uint32_t ChunkSize = 64 * 1024;
+        static constexpr uint32_t StageSize = 8 * 1024;
+
+        static constexpr uint8_t QOI_OP_INDEX = 0x00;
+        static constexpr uint8_t QOI_OP_DIFF = 0x40;
+        static constexpr uint8_t QOI_OP_LUMA = 0x80;
+        static constexpr uint8_t QOI_OP_RUN = 0xC0;
+        static constexpr uint8_t QOI_OP_RGB = 0xFE;
+
+    public:
+        Encoder(Core::File& target, const Snapshot::Encoding& encoding)
+            : _target(target)
+            , _encoding(encoding)
+            , _used(0)
+            , _written(0)
+            , _firstByte(0)
+        {
+        }
+        ~Encoder()
+        {
+        }
+
+    public:
+        bool Encode(const unsigned char* buffer, const unsigned int width, const unsigned int height)
+        {
+            return (_encoding.Format == Snapshot::QOI ? EncodeQOI(buffer, width, height) : EncodePNG(buffer, width, height));
+        }
+        // Ticks of the moment the first encoded byte was written, 0 if nothing was written yet.
+        inline uint64_t FirstByte() const
+        {
+            return (_firstByte);
+        }
+        inline uint32_t Written() const
+        {
+            return (_written);
+        }
+
+        // FNV-1a over 64 bit words, only used to detect unchanged frames.
+        static uint64_t Digest(const uint8_t buffer[], const uint32_t length)
+        {
+            uint64_t result = 0xCBF29CE484222325ULL;
+            const uint32_t words = length / sizeof(uint64_t);
+            uint64_t word;
+
+            for (uint32_t index = 0; index < words; index++) {
+                ::memcpy(&word, &(buffer[index * sizeof(uint64_t)]), sizeof(word));
+                result = (result ^ word) * 0x100000001B3ULL;
+            }
+            for (uint32_t index = (words * sizeof(uint64_t)); index < length; index++) {
+                result = (result ^ buffer[index]) * 0x100000001B3ULL;
+            }
+
+            return (result);
+        }
+
+    private:
+        static void PNGWrite(png_structp pngPointer, png_bytep data, png_size_t length)
+        {
+            Encoder* encoder = static_cast<Encoder*>(png_get_io_ptr(pngPointer));
+
+            if (encoder->Write(data, static_cast<uint32_t>(length)) == false) {
+                png_error(pngPointer, "Could not write the capture file");
+            }
+        }
+        static void PNGFlush(png_structp)
+        {
+        }
+
+        bool Write(const uint8_t data[], const uint32_t length)
+        {
+            if (_firstByte == 0) {
+                _firstByte = Core::Time::Now().Ticks();
+            }
+            _written += length;
+            return (_target.Write(data, length) == length);
+        }
+
+        bool EncodePNG(const unsigned char* buffer, const unsigned int width, const unsigned int height)
+        {
+            png_structp pngPointer = nullptr;
+            bool result = false;
+
+            pngPointer = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+            if (pngPointer == nullptr) {
+
+                return result;
+            }
+
+            png_infop infoPointer = nullptr;
+            infoPointer = png_create_info_struct(pngPointer);
+            if (infoPointer == nullptr) {
+
+                png_destroy_write_struct(&pngPointer, &infoPointer);
+                return result;
+            }
+
+            // Set up error handling.
+            if (setjmp(png_jmpbuf(pngPointer))) {
+
+                png_destroy_write_struct(&pngPointer, &infoPointer);
+                return result;
+            }
+
+            // Stream the encoded data straight into the file body, in large chunks.
+            png_set_write_fn(pngPointer, this, PNGWrite, PNGFlush);
+            png_set_compression_buffer_size(pngPointer, ChunkSize);
+
+            if (_encoding.Compression >= 0) {
+                png_set_compression_level(pngPointer, _encoding.Compression);
+            }
+
+            static const int filters[] = { PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG, PNG_FILTER_PAETH, PNG_ALL_FILTERS };
+            png_set_filter(pngPointer, PNG_FILTER_TYPE_BASE, filters[_encoding.Filter]);
+
+            // Set image attributes.
+            int depth = 8;
+            png_set_IHDR(pngPointer,
+                infoPointer,
+                width,
+                height,
+                depth,
+                PNG_COLOR_TYPE_RGB,
+                PNG_INTERLACE_NONE,
+                PNG_COMPRESSION_TYPE_DEFAULT,
+                PNG_FILTER_TYPE_DEFAULT);
+
+            png_write_info(pngPointer, infoPointer);
+
+            // Let libpng reorder the channels and strip the alpha, so the rows can be
+            // handed over directly from the capture buffer, no copy needed.
+            png_set_bgr(pngPointer);
+            png_set_filler(pngPointer, 0, PNG_FILLER_AFTER);
+
+            const uint32_t stride = width * PixelSize;
+            for (unsigned int i = 0; i < height; ++i) {
+                png_write_row(pngPointer, const_cast<png_bytep>(&(buffer[i * stride])));
+            }
+
+            png_write_end(pngPointer, infoPointer);
+
+            // All went well.
+            result = true;
+
+            png_destroy_write_struct(&pngPointer, &infoPointer);
+
+            return result;
+        }
+
+        // The "Quite OK Image" format, lossless and an order of magnitude faster than PNG
+        // for a comparable size on UI content.
+        bool EncodeQOI(const unsigned char* buffer, const unsigned int width, const unsigned int height)
+        {
+            uint32_t index[64];
+            uint8_t previous[3] = { 0, 0, 0 };
+            uint8_t run = 0;
+            bool result = true;
+
+            ::memset(index, 0, sizeof(index));
+
+            Emit(reinterpret_cast<const uint8_t*>("qoif"), 4);
+            Emit32(width);
+            Emit32(height);
+            Emit(3); // RGB
+            Emit(0); // sRGB with linear alpha
+
+            // An empty image is just the header and the end marker.
+            const unsigned char* pixel = buffer;
+            const unsigned char* last = (((width == 0) || (height == 0)) ? nullptr : buffer + ((width * height) - 1) * PixelSize);
+
+            while ((result == true) && (last != nullptr) && (pixel <= last)) {
+                const uint8_t r = pixel[2];
+                const uint8_t g = pixel[1];
+                const uint8_t b = pixel[0];
+
+                if ((r == previous[0]) && (g == previous[1]) && (b == previous[2])) {
+                    run++;
+                    if ((run == 62) || (pixel == last)) {
+                        result = Emit(QOI_OP_RUN | (run - 1));
+                        run = 0;
+                    }
+                } else {
+                    if (run > 0) {
+                        Emit(QOI_OP_RUN | (run - 1));
+                        run = 0;
+                    }
+
+                    const uint32_t value = (r << 24) | (g << 16) | (b << 8) | 0xFF;
+                    const uint8_t hash = ((r * 3) + (g * 5) + (b * 7) + (255 * 11)) % 64;
+
+                    if (index[hash] == value) {
+                        result = Emit(QOI_OP_INDEX | hash);
+                    } else {
+                        index[hash] = value;
+
+                        const int8_t dr = static_cast<int8_t>(r - previous[0]);
+                        const int8_t dg = static_cast<int8_t>(g - previous[1]);
+                        const int8_t db = static_cast<int8_t>(b - previous[2]);
+                        const int8_t drdg = dr - dg;
+                        const int8_t dbdg = db - dg;
+
+                        if ((dr >= -2) && (dr <= 1) && (dg >= -2) && (dg <= 1) && (db >= -2) && (db <= 1)) {
+                            result = Emit(QOI_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                        } else if ((dg >= -32) && (dg <= 31) && (drdg >= -8) && (drdg <= 7) && (dbdg >= -8) && (dbdg <= 7)) {
+                            Emit(QOI_OP_LUMA | (dg + 32));
+                            result = Emit(((drdg + 8) << 4) | (dbdg + 8));
+                        } else {
+                            Emit(QOI_OP_RGB);
+                            Emit(r);
+                            Emit(g);
+                            result = Emit(b);
+                        }
+                    }
+
+                    previous[0] = r;
+                    previous[1] = g;
+                    previous[2] = b;
+                }
+
+                pixel += PixelSize;
+            }
+
+            if (result == true) {
+                static const uint8_t padding[] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+                Emit(padding, sizeof(padding));
+                result = Flush();
+            }
+
+            return (result);
+        }
+
+        inline bool Emit(const uint8_t value)
+        {
+            bool result = true;
+
+            if (_used == sizeof(_chunk)) {
+                result = Flush();
+            }
+            _chunk[_used++] = value;
+
+            return (result);
+        }
+        inline void Emit32(const uint32_t value)
+        {
+            Emit(static_cast<uint8_t>(value >> 24));
+            Emit(static_cast<uint8_t>(value >> 16));
+            Emit(static_cast<uint8_t>(value >> 8));
+            Emit(static_cast<uint8_t>(value));
+        }
+        inline void Emit(const uint8_t data[], const uint8_t length)
+        {
+            for (uint8_t index = 0; index < length; index++) {
+                Emit(data[index]);
+            }
+        }
+        bool Flush()
+        {
+            bool result = ((_used == 0) || (Write(_chunk, _used) == true));
+            _used = 0;
+            return (result);
+        }
+
+    private:
+        Core::File& _target;
+        const Snapshot::Encoding& _encoding;
+        uint8_t _chunk[StageSize];
+        uint32_t _used;
+        uint32_t _written;
+        uint64_t _firstByte;
+    };
+
+} // Namespace Plugin.
+}
+
+#endif // __SNAPSHOT_ENCODER_H
@@ -18,10 +18,28 @@
  */
  
 #include "Snapshot.h"
-
-#include <png.h>
+#include "Encoder.h"
 
 namespace WPEFramework {
+
+ENUM_CONVERSION_BEGIN(Plugin::Snapshot::format)
+
+    { Plugin::Snapshot::format::PNG, _TXT("png") },
+    { Plugin::Snapshot::format::QOI, _TXT("qoi") },
+
+    ENUM_CONVERSION_END(Plugin::Snapshot::format);
+
+ENUM_CONVERSION_BEGIN(Plugin::Snapshot::filter)
+
+    { Plugin::Snapshot::filter::FILTER_NONE, _TXT("none") },
+    { Plugin::Snapshot::filter::FILTER_SUB, _TXT("sub") },
+    { Plugin::Snapshot::filter::FILTER_UP, _TXT("up") },
+    { Plugin::Snapshot::filter::FILTER_AVERAGE, _TXT("average") },
+    { Plugin::Snapshot::filter::FILTER_PAETH, _TXT("paeth") },
+    { Plugin::Snapshot::filter::FILTER_ALL, _TXT("all") },
+
+    ENUM_CONVERSION_END(Plugin::Snapshot::filter);
+
 namespace Plugin {
 
     SERVICE_REGISTRATION(Snapshot, 1, 0);
@@ -33,8 +51,24 @@ namespace Plugin {
         StoreImpl& operator=(const StoreImpl&) = delete;
 
     public:
-        StoreImpl(Core::BinairySemaphore& inProgress, const string& path)
+        StoreImpl(Core::BinairySemaphore& inProgress, const string& path, const Snapshot::Encoding& encoding)
             : _file(FileBodyExtended::Instance(inProgress, path))
+            , _frame()
+            , _encoder((_file.IsValid() == true ? static_cast<Core::File&>(*_file) : _frame), encoding)
+            , _digest(nullptr)
+            , _skipped(false)
+            , _start(Core::Time::Now().Ticks())
+        {
+        }
+        // Store a frame of a stream, the file is only created if the frame differs from the
+        // previous one, identified by the digest.
+        StoreImpl(const string& path, const Snapshot::Encoding& encoding, uint64_t& digest)
+            : _file()
+            , _frame(path)
+            , _encoder(_frame, encoding)
+            , _digest(&digest)
+            , _skipped(false)
+            , _start(Core::Time::Now().Ticks())
         {
         }
 
@@ -44,83 +78,59 @@ namespace Plugin {
 
         virtual bool R8_G8_B8_A8(const unsigned char* buffer, const unsigned int width, const unsigned int height)
         {
-
-            png_structp pngPointer = nullptr;
             bool result = false;
+            uint64_t digest = 0;
 
-            pngPointer = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-            if (pngPointer == nullptr) {
+            if (_digest != nullptr) {
+                digest = Encoder::Digest(buffer, width * height * Encoder::PixelSize);
 
-                return result;
-            }
+                _skipped = (digest == *_digest);
 
-            png_infop infoPointer = nullptr;
-            infoPointer = png_create_info_struct(pngPointer);
-            if (infoPointer == nullptr) {
+                if (_skipped == true) {
+                    return (true);
+                }
 
-                png_destroy_write_struct(&pngPointer, &infoPointer);
-                return result;
+                _frame.Create();
             }
 
-            // Set up error handling.
-            if (setjmp(png_jmpbuf(pngPointer))) {
-
-                png_destroy_write_struct(&pngPointer, &infoPointer);
-                return result;
+            if (Target().IsOpen() == true) {
+                result = _encoder.Encode(buffer, width, height);
             }
 
-            // Set image attributes.
-            int depth = 8;
-            png_set_IHDR(pngPointer,
-                infoPointer,
-                width,
-                height,
-                depth,
-                PNG_COLOR_TYPE_RGB,
-                PNG_INTERLACE_NONE,
-                PNG_COMPRESSION_TYPE_DEFAULT,
-                PNG_FILTER_TYPE_DEFAULT);
-
-            // Initialize rows of PNG.
-            png_byte** rowLines = static_cast<png_byte**>(png_malloc(pngPointer, height * sizeof(png_byte*)));
-            const int pixelSize = 4; // RGBA
-            for (unsigned int i = 0; i < height; ++i) {
-
-                png_byte* rowLine = static_cast<png_byte*>(png_malloc(pngPointer, sizeof(png_byte) * width * pixelSize));
-                const uint8_t* rowSource = buffer + (sizeof(png_byte) * i * width * pixelSize);
-                rowLines[i] = rowLine;
-                for (unsigned int j = 0; j < width * pixelSize; j += pixelSize) {
-                    *rowLine++ = rowSource[j + 2]; // Red
-                    *rowLine++ = rowSource[j + 1]; // Green
-                    *rowLine++ = rowSource[j + 0]; // Blue
-                    // ignore alpha
+            if (_digest != nullptr) {
+                if (result == true) {
+                    // Only a frame that made it to a file is a reference for the next ones.
+                    *_digest = digest;
+                } else {
+                    _frame.Destroy();
                 }
             }
 
-            // Duplicate file descriptor and create File stream based on it.
-            FILE* filePointer = static_cast<FILE*>(*_file);
-            if (nullptr != filePointer) {
-                // Write the image data to "file".
-                png_init_io(pngPointer, filePointer);
-                png_set_rows(pngPointer, infoPointer, rowLines);
-                png_write_png(pngPointer, infoPointer, PNG_TRANSFORM_IDENTITY, nullptr);
-                // All went well.
-                result = true;
-            }
-
-            // Close stream to flush and release allocated buffers
-            fclose(filePointer);
+            if (result == true) {
+                const uint64_t now = Core::Time::Now().Ticks();
 
-            for (unsigned int i = 0; i < height; i++) {
-                png_free(pngPointer, rowLines[i]);
+                TRACE(Trace::Information, (_T("Encoded %dx%d frame, first byte after %d uS, completed after %d uS, %d bytes"),
+                    width, height,
+                    static_cast<uint32_t>(_encoder.FirstByte() - _start),
+                    static_cast<uint32_t>(now - _start),
+                    _encoder.Written()));
             }
 
-            png_free(pngPointer, rowLines);
-            png_destroy_write_struct(&pngPointer, &infoPointer);
+            return (result);
+        }
+
+        bool IsSkipped() const
+        {
+            return (_skipped);
+        }
 
-            return result;
+    private:
+        inline Core::File& Target()
+        {
+            return (_file.IsValid() == true ? static_cast<Core::File&>(*_file) : _frame);
         }
 
+    public:
         operator Core::ProxyType<Web::IBody>()
         {
 
@@ -180,6 +190,11 @@ namespace Plugin {
 
     private:
         Core::ProxyType<FileBodyExtended> _file;
+        Core::File _frame;
+        Encoder _encoder;
+        uint64_t* _digest;
+        bool _skipped;
+        uint64_t _start;
     };
 
     /* virtual */ const string Snapshot::Initialize(PluginHost::IShell* service)
@@ -190,16 +205,33 @@ namespace Plugin {
         ASSERT(service->PersistentPath() != _T(""));
         ASSERT(_device == nullptr);
 
+        Config config;
+        config.FromString(service->ConfigLine());
+
+        _encoding.Format = config.Format.Value();
+        _encoding.Compression = std::min(config.Compression.Value(), static_cast<int8_t>(9));
+        _encoding.Filter = config.Filter.Value();
+        _keep = std::max(config.Keep.Value(), static_cast<uint16_t>(1));
+
+        const TCHAR* name = (_encoding.Format == QOI ? _T("Capture.qoi") : _T("Capture.png"));
+
         Core::Directory directory(service->PersistentPath().c_str());
         if (directory.CreatePath()) {
-            _fileName = service->PersistentPath() + string("Capture.png");
+            _fileName = service->PersistentPath() + string(name);
         } else {
-            _fileName = string("/tmp/Capture.png");
+            _fileName = string("/tmp/") + string(name);
         }
 
+        _streamPath = service->VolatilePath() + service->Callsign() + _T("/Stream/");
+
         // Setup skip URL for right offset.
         _skipURL = service->WebPrefix().length();
 
+        if (config.Source.IsSet() == true) {
+            // Picked up by the FrameBuffer capture device.
+            Core::SystemInfo::SetEnvironment(_T("SNAPSHOT_FRAMEBUFFER"), config.Source.Value(), true);
+        }
+
         // Get producer
         _device = Exchange::ICapture::Instance();
 
@@ -217,6 +249,8 @@ namespace Plugin {
 
         ASSERT(_device != nullptr);
 
+        Stop();
+
         if (_device != nullptr) {
             _device->Release();
             _device = nullptr;
@@ -259,7 +293,7 @@ namespace Plugin {
                 response->ErrorCode = Web::STATUS_OK;
             } else if ((index.Current() == "Capture")) {
 
-                StoreImpl file(_inProgress, _fileName);
+                StoreImpl file(_inProgress, _fileName, _encoding);
 
                 // _inProgress event is signalled, capture screen
                 if (file.IsValid() == true) {
@@ -267,7 +301,7 @@ namespace Plugin {
                     if (_device->Capture(file)) {
 
                         // Attach to response.
-                        response->ContentType = Web::MIMETypes::MIME_IMAGE_PNG;
+                        response->ContentType = (_encoding.Format == QOI ? Web::MIMETypes::MIME_BINARY : Web::MIMETypes::MIME_IMAGE_PNG);
                         response->Body(static_cast<Core::ProxyType<Web::IBody>>(file));
                         response->Message = string(_device->Name());
                         response->ErrorCode = Web::STATUS_ACCEPTED;
@@ -280,9 +314,171 @@ namespace Plugin {
                     response->ErrorCode = Web::STATUS_PRECONDITION_FAILED;
                 }
             }
+        } else if ((request.Verb == Web::Request::HTTP_PUT) && (index.Next() == true) && (index.Current() == _T("Stream"))) {
+
+            // Stream/<fps>[/<frames>], without a frame count it continues until stopped.
+            uint8_t fps = 0;
+            uint32_t frames = ~0;
+
+            if (index.Next() == true) {
+                fps = Core::NumberType<uint8_t>(index.Current()).Value();
+
+                if (index.Next() == true) {
+                    frames = Core::NumberType<uint32_t>(index.Current()).Value();
+                }
+            }
+
+            if ((fps == 0) || (frames == 0)) {
+                response->Message = _T("Invalid frame rate or frame count");
+                response->ErrorCode = Web::STATUS_BAD_REQUEST;
+            } else if (Start(fps, frames) == true) {
+                response->Message = _T("Streaming to ") + _streamPath;
+                response->ErrorCode = Web::STATUS_OK;
+            } else {
+                response->Message = _T("Could not create ") + _streamPath;
+                response->ErrorCode = Web::STATUS_PRECONDITION_FAILED;
+            }
+        } else if ((request.Verb == Web::Request::HTTP_DELETE) && (index.Next() == true) && (index.Current() == _T("Stream"))) {
+
+            Stop();
+
+            response->Message = _T("Streaming stopped");
+            response->ErrorCode = Web::STATUS_OK;
         }
 
         return (response);
     }
+
+    bool Snapshot::Start(const uint8_t fps, const uint32_t frames)
+    {
+        bool result = false;
+
+        Stop();
+
+        _streamLock.Lock();
+
+        if (Core::Directory(_streamPath.c_str()).CreatePath() == true) {
+            _interval = 1000 / fps;
+            _remaining = frames;
+            _frames = 0;
+            _skipped = 0;
+            _dropped = 0;
+            _digest = 0;
+            _generation++;
+            _next = Core::Time::Now().Ticks();
+
+            Core::IWorkerPool::Instance().Submit(_recorder);
+
+            result = true;
+        }
+
+        _streamLock.Unlock();
+
+        return (result);
+    }
+
+    void Snapshot::Stop()
+    {
+        _streamLock.Lock();
+
+        if (_interval != 0) {
+            TRACE(Trace::Information, (_T("Stream stopped, stored %d frames, skipped %d unchanged frames, dropped %d frames"), _frames, _skipped, _dropped));
+            _interval = 0;
+            _remaining = 0;
+        }
+
+        _streamLock.Unlock();
+
+        // A frame that is already dequeued sees nothing remains and will not reschedule.
+        Core::IWorkerPool::Instance().Revoke(_recorder);
+    }
+
+    string Snapshot::FrameName(const uint32_t index) const
+    {
+        TCHAR name[32];
+        ::snprintf(name, sizeof(name), _T("frame-%06d.%s"), index, (_encoding.Format == QOI ? _T("qoi") : _T("png")));
+        return (_streamPath + name);
+    }
+
+    void Snapshot::Record()
+    {
+        _streamLock.Lock();
+
+        const uint32_t generation = _generation;
+        const uint32_t index = _frames;
+        const bool active = (_remaining != 0);
+        uint64_t digest = _digest;
+
+        _streamLock.Unlock();
+
+        if (active == true) {
+            enum { STORED, UNCHANGED, DROPPED, FAILED } outcome = DROPPED;
+
+            // Capturing and encoding take a while, this is done without holding the stream lock, so
+            // stopping does not have to wait for it. A single capture might be in progress, just drop
+            // this frame in that case.
+            if (_inProgress.Lock(0) == Core::ERROR_NONE) {
+                StoreImpl frame(FrameName(index), _encoding, digest);
+
+                if (_device->Capture(frame) == false) {
+                    outcome = FAILED;
+                } else {
+                    outcome = (frame.IsSkipped() == true ? UNCHANGED : STORED);
+                }
+
+                _inProgress.Unlock();
+            }
+
+            _streamLock.Lock();
+
+            // Stopped, or stopped and started again, while capturing, this frame is not part of it.
+            if ((_remaining != 0) && (generation == _generation)) {
+
+                switch (outcome) {
+                case STORED:
+                    _digest = digest;
+                    _frames++;
+
+                    // Only the most recent frames are kept.
+                    if (_frames > _keep) {
+                        Core::File(FrameName(_frames - _keep - 1)).Destroy();
+                    }
+                    break;
+                case UNCHANGED:
+                    _skipped++;
+                    break;
+                case DROPPED:
+                    _dropped++;
+                    break;
+                case FAILED:
+                    TRACE(Trace::Error, (_T("Could not capture a frame on %s"), _device->Name()));
+                    _remaining = 0;
+                    break;
+                }
+
+                if ((_remaining != 0) && (_remaining != static_cast<uint32_t>(~0))) {
+                    _remaining--;
+                }
+
+                if (_remaining != 0) {
+                    const uint64_t now = Core::Time::Now().Ticks();
+
+                    // Keep the pace, but do not try to catch up on frames we were too late for.
+                    _next += (_interval * Core::Time::TicksPerMillisecond);
+                    if (_next < now) {
+                        _next = now;
+                    }
+
+                    Core::IWorkerPool::Instance().Schedule(Core::Time(_next), _recorder);
+                } else {
+                    TRACE(Trace::Information, (_T("Stream completed, stored %d frames, skipped %d unchanged frames, dropped %d frames"), _frames, _skipped, _dropped));
+                    _interval = 0;
+                }
+            }
+
+            _streamLock.Unlock();
+        }
+    }
+}
 }
 }
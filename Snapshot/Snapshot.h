@@ -31,12 +31,105 @@ namespace Plugin {
         Snapshot(const Snapshot&) = delete;
         Snapshot& operator=(const Snapshot&) = delete;
 
+    public:
+        enum format {
+            PNG,
+            QOI
+        };
+
+        enum filter {
+            FILTER_NONE,
+            FILTER_SUB,
+            FILTER_UP,
+            FILTER_AVERAGE,
+            FILTER_PAETH,
+            FILTER_ALL
+        };
+
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+        public:
+            Config()
+                : Core::JSON::Container()
+                , Format(PNG)
+                , Compression(-1)
+                , Filter(FILTER_ALL)
+                , Source()
+                , Keep(100)
+            {
+                Add(_T("format"), &Format);
+                Add(_T("compression"), &Compression);
+                Add(_T("filter"), &Filter);
+                Add(_T("source"), &Source);
+                Add(_T("keep"), &Keep);
+            }
+            ~Config()
+            {
+            }
+
+        public:
+            Core::JSON::EnumType<format> Format;
+            Core::JSON::DecSInt8 Compression; // zlib level 0 (fastest) - 9 (smallest), -1 is the zlib default
+            Core::JSON::EnumType<filter> Filter;
+            Core::JSON::String Source; // Frame to capture from, for the FrameBuffer capture device
+            Core::JSON::DecUInt16 Keep; // Number of most recent frames of a stream that are kept
+        };
+
+        // How a captured frame is turned into an image.
+        struct Encoding {
+            format Format;
+            int8_t Compression;
+            filter Filter;
+        };
+
+    private:
+        class Recorder : public Core::IDispatch {
+        private:
+            Recorder() = delete;
+            Recorder(const Recorder&) = delete;
+            Recorder& operator=(const Recorder&) = delete;
+
+        public:
+            Recorder(Snapshot& parent)
+                : _parent(parent)
+            {
+            }
+            ~Recorder()
+            {
+            }
+
+        public:
+            virtual void Dispatch() override
+            {
+                _parent.Record();
+            }
+
+        private:
+            Snapshot& _parent;
+        };
+
     public:
         Snapshot()
             : _skipURL(0)
             , _device(nullptr)
             , _fileName()
             , _inProgress(false)
+            , _encoding({ PNG, -1, FILTER_ALL })
+            , _streamLock()
+            , _recorder(Core::ProxyType<Recorder>::Create(*this))
+            , _streamPath()
+            , _keep(100)
+            , _generation(0)
+            , _interval(0)
+            , _remaining(0)
+            , _frames(0)
+            , _skipped(0)
+            , _dropped(0)
+            , _digest(0)
+            , _next(0)
         {
         }
 
@@ -62,11 +155,32 @@ namespace Plugin {
         virtual void Inbound(Web::Request& request);
         virtual Core::ProxyType<Web::Response> Process(const Web::Request& request);
 
+    private:
+        bool Start(const uint8_t fps, const uint32_t frames);
+        void Stop();
+        void Record();
+        string FrameName(const uint32_t index) const;
+
     private:
         uint8_t _skipURL;
         Exchange::ICapture* _device;
         string _fileName;
         Core::BinairySemaphore _inProgress;
+        Encoding _encoding;
+
+        // Continuous capturing, frames are stored as separate files in the stream directory.
+        Core::CriticalSection _streamLock;
+        Core::ProxyType<Core::IDispatch> _recorder;
+        string _streamPath;
+        uint16_t _keep;
+        uint32_t _generation;
+        uint32_t _interval;
+        uint32_t _remaining;
+        uint32_t _frames;
+        uint32_t _skipped;
+        uint32_t _dropped;
+        uint64_t _digest;
+        uint64_t _next;
     };
 
 } // Namespace Plugin.
@@ -0,0 +1,330 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Encoder.h"
+#include "../../Compositor/lib/Software/BufferHeader.h"
+
+// Capture-to-first-byte of Snapshot, through the FrameBuffer capture device, from a synthetic
+// frame in the layout of the software compositor output:
+//
+//    SnapshotBenchmark -runs 10
+//
+// Every frame is encoded in all supported ways: "ui" content is flat panels with text-like
+// detail, "noise" is the worst case for any encoder. Per run, "capture" is the time until the
+// frame is handed to the encoder, "firstbyte" the time until the first encoded byte is written
+// and "total" the time until the image is complete, all in uS and counted from the Capture()
+// call. The results are printed as JSON, the exit code is the number of failed captures.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+static const TCHAR Base[] = _T("/tmp/snapshot-benchmark/");
+using Header = Plugin::Software::BufferHeader;
+
+struct Resolution {
+    uint32_t Width;
+    uint32_t Height;
+};
+
+struct Method {
+    const TCHAR* Name;
+    Plugin::Snapshot::Encoding Encoding;
+};
+
+static constexpr Resolution Resolutions[] = { { 1280, 720 }, { 1920, 1080 } };
+static const TCHAR* const Contents[] = { _T("ui"), _T("noise") };
+static const Method Methods[] = {
+    { _T("qoi"), { Plugin::Snapshot::QOI, -1, Plugin::Snapshot::FILTER_ALL } },
+    { _T("png-fast"), { Plugin::Snapshot::PNG, 1, Plugin::Snapshot::FILTER_SUB } },
+    { _T("png"), { Plugin::Snapshot::PNG, -1, Plugin::Snapshot::FILTER_ALL } },
+    { _T("png-small"), { Plugin::Snapshot::PNG, 9, Plugin::Snapshot::FILTER_ALL } }
+};
+
+// The synthetic frame source, a shared frame as the software compositor would leave it behind.
+class Source {
+public:
+    Source() = delete;
+    Source(const Source&) = delete;
+    Source& operator=(const Source&) = delete;
+
+    Source(const string& path, const uint32_t width, const uint32_t height, const bool noise)
+        : _file(path, Core::File::SHAREABLE | Core::File::USER_READ | Core::File::USER_WRITE, sizeof(Header) + (width * height * sizeof(uint32_t)))
+    {
+        if ((_file.IsValid() == true) && (_file.Size() >= (sizeof(Header) + (width * height * sizeof(uint32_t))))) {
+            Header* header = reinterpret_cast<Header*>(_file.Buffer());
+            uint32_t* pixels = reinterpret_cast<uint32_t*>(&(_file.Buffer()[sizeof(Header)]));
+
+            if (noise == true) {
+                Noise(pixels, width, height);
+            } else {
+                Interface(pixels, width, height);
+            }
+
+            header->Width = width;
+            header->Height = height;
+            header->Stride = width;
+            header->Sequence.store(0, std::memory_order_relaxed);
+            header->DamageX = 0;
+            header->DamageY = 0;
+            header->DamageWidth = width;
+            header->DamageHeight = height;
+            header->Magic = Plugin::Software::BufferMagic;
+        }
+    }
+    ~Source()
+    {
+    }
+
+public:
+    bool IsValid() const
+    {
+        return (_file.IsValid());
+    }
+
+private:
+    // A gradient background, a few flat panels and rows of glyph sized, high contrast detail.
+    static void Interface(uint32_t pixels[], const uint32_t width, const uint32_t height)
+    {
+        for (uint32_t y = 0; y < height; y++) {
+            const uint32_t shade = (y * 0x60) / height;
+            const uint32_t row = (y / 24);
+            const bool panel = ((row % 6) != 0);
+
+            for (uint32_t x = 0; x < width; x++) {
+                const uint32_t column = (x / 320);
+                uint32_t color = 0xFF000000 | (shade << 16) | (shade << 8) | (0x40 + shade);
+
+                if ((panel == true) && ((x % 320) > 16) && ((x % 320) < 304)) {
+                    color = ((column + row) & 1) == 0 ? 0xFF2A2A2E : 0xFF3C3C44;
+
+                    // Text: a pseudo random, fixed pattern per 8x12 glyph cell on every other line.
+                    if (((y % 24) >= 6) && ((y % 24) < 18) && ((x % 8) != 7)) {
+                        const uint32_t glyph = ((x / 8) * 2654435761U) ^ (row * 40503U);
+                        const uint32_t bit = ((x % 8) + (((y % 24) - 6) * 7)) % 32;
+
+                        if (((glyph >> bit) & 1) != 0) {
+                            color = 0xFFE8E8E8;
+                        }
+                    }
+                }
+
+                pixels[(y * width) + x] = color;
+            }
+        }
+    }
+    static void Noise(uint32_t pixels[], const uint32_t width, const uint32_t height)
+    {
+        uint32_t state = 0x12345678;
+
+        for (uint32_t index = 0; index < (width * height); index++) {
+            // xorshift32
+            state ^= (state << 13);
+            state ^= (state >> 17);
+            state ^= (state << 5);
+            pixels[index] = 0xFF000000 | (state & 0x00FFFFFF);
+        }
+    }
+
+private:
+    Core::DataElementFile _file;
+};
+
+class Store : public Exchange::ICapture::IStore {
+public:
+    Store() = delete;
+    Store(const Store&) = delete;
+    Store& operator=(const Store&) = delete;
+
+    Store(const string& path, const Plugin::Snapshot::Encoding& encoding)
+        : _file(path)
+        , _encoder(_file, encoding)
+        , _captured(0)
+    {
+        _file.Create();
+    }
+    ~Store()
+    {
+        _file.Destroy();
+    }
+
+public:
+    bool R8_G8_B8_A8(const unsigned char* buffer, const unsigned int width, const unsigned int height) override
+    {
+        _captured = Core::Time::Now().Ticks();
+
+        return ((_file.IsOpen() == true) && (_encoder.Encode(buffer, width, height) == true));
+    }
+    uint64_t Captured() const
+    {
+        return (_captured);
+    }
+    uint64_t FirstByte() const
+    {
+        return (_encoder.FirstByte());
+    }
+    uint32_t Written() const
+    {
+        return (_encoder.Written());
+    }
+
+private:
+    Core::File _file;
+    Plugin::Encoder _encoder;
+    uint64_t _captured;
+};
+
+class Timings {
+public:
+    Timings()
+        : _capture()
+        , _firstByte()
+        , _total()
+        , _bytes(0)
+        , _failed(0)
+    {
+    }
+
+public:
+    void Add(const uint64_t start, const Store& store, const bool result)
+    {
+        const uint64_t end = Core::Time::Now().Ticks();
+
+        if ((result == false) || (store.FirstByte() == 0)) {
+            _failed++;
+        } else {
+            _capture.push_back(static_cast<uint32_t>(store.Captured() - start));
+            _firstByte.push_back(static_cast<uint32_t>(store.FirstByte() - start));
+            _total.push_back(static_cast<uint32_t>(end - start));
+            _bytes = store.Written();
+        }
+    }
+    uint32_t Failed() const
+    {
+        return (_failed);
+    }
+    void Print(const TCHAR name[], const bool last) const
+    {
+        printf("      \"%s\": { \"failed\": %u, \"bytes\": %u, \"capture\": %s, \"firstbyte\": %s, \"total\": %s }%s\n",
+            name, _failed, _bytes,
+            Statistics(_capture).c_str(), Statistics(_firstByte).c_str(), Statistics(_total).c_str(),
+            (last == true ? "" : ","));
+    }
+
+private:
+    // All in uS.
+    static string Statistics(const std::vector<uint32_t>& samples)
+    {
+        TCHAR buffer[96];
+        uint64_t total = 0;
+
+        for (const uint32_t sample : samples) {
+            total += sample;
+        }
+
+        ::snprintf(buffer, sizeof(buffer), _T("{ \"min\": %u, \"mean\": %.1f, \"max\": %u }"),
+            (samples.empty() == true ? 0 : *std::min_element(samples.begin(), samples.end())),
+            (samples.empty() == true ? 0.0 : static_cast<double>(total) / samples.size()),
+            (samples.empty() == true ? 0 : *std::max_element(samples.begin(), samples.end())));
+
+        return (string(buffer));
+    }
+
+private:
+    std::vector<uint32_t> _capture;
+    std::vector<uint32_t> _firstByte;
+    std::vector<uint32_t> _total;
+    uint32_t _bytes;
+    uint32_t _failed;
+};
+
+}
+
+int main(int argc, char** argv)
+{
+    uint16_t runs = 5;
+    uint32_t failures = 0;
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-runs") == 0) {
+            runs = static_cast<uint16_t>(std::max(1, atoi(argv[index + 1])));
+        }
+    }
+
+    Core::Directory(Base).CreatePath();
+
+    const uint8_t resolutions = (sizeof(Resolutions) / sizeof(Resolutions[0]));
+    const uint8_t contents = (sizeof(Contents) / sizeof(Contents[0]));
+    const uint8_t methods = (sizeof(Methods) / sizeof(Methods[0]));
+    const string image(string(Base) + _T("capture"));
+
+    printf("[\n");
+
+    for (uint8_t resolution = 0; resolution < resolutions; resolution++) {
+        for (uint8_t content = 0; content < contents; content++) {
+            const string frame(string(Base) + Contents[content] + _T("-") + Core::NumberType<uint32_t>(Resolutions[resolution].Height).Text());
+            const bool last = (((resolution + 1) == resolutions) && ((content + 1) == contents));
+
+            printf("  { \"width\": %u, \"height\": %u, \"content\": \"%s\",\n    \"methods\": {\n",
+                Resolutions[resolution].Width, Resolutions[resolution].Height, Contents[content]);
+
+            {
+                Source source(frame, Resolutions[resolution].Width, Resolutions[resolution].Height, (content == 1));
+
+                // The device picks up the frame to capture from the environment, once.
+                Core::SystemInfo::SetEnvironment(_T("SNAPSHOT_FRAMEBUFFER"), frame, true);
+                Exchange::ICapture* device = Exchange::ICapture::Instance();
+
+                if (source.IsValid() == false) {
+                    fprintf(stderr, "Could not create the frame at %s\n", frame.c_str());
+                    failures++;
+                }
+
+                for (uint8_t method = 0; method < methods; method++) {
+                    Timings timings;
+
+                    for (uint16_t run = 0; (run < runs) && (source.IsValid() == true); run++) {
+                        Store store(image, Methods[method].Encoding);
+                        const uint64_t start = Core::Time::Now().Ticks();
+                        const bool result = device->Capture(store);
+
+                        timings.Add(start, store, result);
+                    }
+
+                    timings.Print(Methods[method].Name, ((method + 1) == methods));
+                    failures += timings.Failed();
+                }
+
+                device->Release();
+            }
+
+            Core::File(frame).Destroy();
+
+            printf("    }\n  }%s\n", (last == true ? "" : ","));
+        }
+    }
+
+    printf("]\n");
+
+    Core::Singleton::Dispose();
+
+    return (static_cast<int>(failures));
+}
@@ -18,6 +18,7 @@
  */
 
 #include "NTPClient.h"
+#include <math.h>
 #include <stdio.h>
 
 namespace WPEFramework {
@@ -25,6 +26,8 @@ namespace Plugin {
 
     constexpr uint32_t WaitForResponse = 2000;
 
+    /* static */ constexpr double NTPClient::Server::MinimumDistance;
+
 #ifdef __WINDOWS__
 #pragma warning(disable : 4355)
 #endif
@@ -34,9 +37,13 @@ namespace Plugin {
         , _packet()
         , _syncedTimestamp()
         , _state(INITIAL)
-        , _fired(true)
         , _WaitForNetwork(2000) // Wait for 2 Seconds for a new attempt
         , _retryAttempts(5)
+        , _currentAttempt(0)
+        , _samples(DefaultSamples)
+        , _servers()
+        , _source()
+        , _offset(0)
         , _activity(Core::ProxyType<Activity>::Create(this))
         , _clients()
     {
@@ -61,11 +68,13 @@ namespace Plugin {
         Close(Core::infinite);
     }
 
-    void NTPClient::Initialize(SourceIterator& sources, const uint16_t retries, const uint16_t delay)
+    void NTPClient::Initialize(SourceIterator& sources, const uint16_t retries, const uint16_t delay, const uint8_t samples)
     {
         _retryAttempts = retries;
         _WaitForNetwork = (delay * 1000); /* in ms */
+        _samples = (samples == 0 ? 1 : samples);
         _servers.clear();
+        _source.clear();
 
         while (sources.Next() == true) {
             Core::URL url(sources.Current().Value());
@@ -82,11 +91,9 @@ namespace Plugin {
                     hostname += ':' + Core::NumberType<uint16_t>(Core::URL::Port(url.Type())).Text();
                 }
 
-                _servers.push_back(hostname);
+                _servers.emplace_back(hostname);
             }
         }
-
-        _serverIndex = ServerIterator(_servers);
     }
 
     /* virtual */ uint32_t NTPClient::Synchronize()
@@ -97,7 +104,9 @@ namespace Plugin {
 
         _adminLock.Lock();
 
-        if ((_state == INITIAL) || (_state == SUCCESS) || ((_state == FAILED) && (_serverIndex.IsValid() == false))) {
+        if (_servers.empty() == true) {
+            TRACE(Trace::Error, (_T("TimeSync: No NTP servers configured")));
+        } else if ((_state == INITIAL) || (_state == SUCCESS) || (_state == FAILED)) {
             result = Core::ERROR_NONE;
             _state = SENDREQUEST;
             Core::IWorkerPool::Instance().Submit(_activity);
@@ -136,7 +145,32 @@ namespace Plugin {
 
     /* virtual */ string NTPClient::Source() const
     {
-        return (_serverIndex.IsValid() == true ? string(_T("NTP://")) + (*_serverIndex) + '/' : _T("NTP:///"));
+        _adminLock.Lock();
+        string result(string(_T("NTP://")) + _source + '/');
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    int64_t NTPClient::Offset() const
+    {
+        _adminLock.Lock();
+        int64_t result(static_cast<int64_t>(_offset * MicroSeconds));
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    void NTPClient::Servers(std::list<ServerInfo>& servers) const
+    {
+        _adminLock.Lock();
+
+        for (const Server& server : _servers) {
+            servers.emplace_back();
+            server.Info(servers.back());
+        }
+
+        _adminLock.Unlock();
     }
 
     /* virtual */ void NTPClient::Register(Exchange::ITimeSync::INotification* notification)
@@ -174,17 +208,26 @@ namespace Plugin {
 
         _adminLock.Lock();
 
-        if (_fired == false) {
+        // All servers are queried at the same time, pick the next one that is due for a sample.
+        ServerList::iterator index(_servers.begin());
 
-            _fired = true;
+        while ((index != _servers.end()) && (index->IsSending() == false)) {
+            index++;
+        }
+
+        if (index != _servers.end()) {
+
+            RemoteNode(index->Remote());
 
             DataFrame newFrame(dataFrame, maxSendSize);
             DataFrame::Writer writer(newFrame, 0);
-            _packet.TransmitTimestamp(NTPPacket::Timestamp(Core::Time::Now()));
+            NTPPacket::Timestamp originate(Core::Time::Now());
+            _packet.TransmitTimestamp(originate);
             _packet.Serialize(writer);
+            index->Sent(originate);
 
             result = newFrame.Size();
-            TRACE_L1("Timesync: Send data: %d bytes", result);
+            TRACE_L1("Timesync: Send data: %d bytes to %s", result, index->Hostname().c_str());
         }
 
         _adminLock.Unlock();
@@ -192,14 +235,9 @@ namespace Plugin {
         return result;
     }
 
-    inline static uint64_t SecondsToTicks(double seconds)
-    {
-        return static_cast<uint64_t>(seconds * NTPClient::MicroSeconds);
-    }
-
     /* virtual */ uint16_t NTPClient::ReceiveData(uint8_t* dataFrame, const uint16_t receivedSize)
     {
-        double received = static_cast<double>(Core::Time::Now().Ticks() / MicroSeconds);
+        double received = static_cast<double>(Core::Time::Now().Ticks()) / MicroSeconds;
 
         TRACE_L1("Timesync: Received data: %d bytes", receivedSize);
 
@@ -215,49 +253,52 @@ namespace Plugin {
 // packet.DisplayPacket();
 #endif
 
-            double receivedServerTS = packet.ReceiveTimestamp().TimeSeconds();
-            double sentServerTS = packet.TransmitTimestamp().TimeSeconds();
-            double sentTS = packet.OriginalTimestamp().TimeSeconds();
-
-            double diffRequest = receivedServerTS - sentTS;
-            double diffResponse = sentServerTS - received;
-            double offset = (diffRequest + diffResponse) / 2;
+            // The answer should come from a server we are waiting on, and echo the timestamp of our request.
+            const Core::NodeId& sender(ReceivedNode());
+            const NTPPacket::Timestamp originate(packet.OriginalTimestamp());
+            ServerList::iterator index(_servers.begin());
 
-#ifdef __DEBUG__
-            double elapsedServer = sentServerTS - receivedServerTS;
-            double elapsedTotal = received - sentTS;
-            double roundTrip = elapsedTotal - elapsedServer;
-#endif
+            while ((index != _servers.end()) && ((index->IsAwaiting(originate) == false) || (!(index->Remote() == sender)))) {
+                index++;
+            }
 
-            TRACE_L1("Request time diff  = %lf", diffRequest);
-            TRACE_L1("Response time diff = %lf", diffResponse);
-            TRACE_L1("Offset time        = %lf", offset);
+            if (index == _servers.end()) {
+                TRACE(Trace::Warning, (_T("TimeSync: Dropped an unsolicited response from %s"), sender.HostAddress().c_str()));
+            } else if ((packet.NTPMode() != 0x04) || (packet.Stratum() == 0) || (packet.Stratum() > 15) || (packet.LeapIndicator() == 0x03)) {
+                // Not a server response, a kiss-o'-death or an unsynchronized server, do not use it.
+                TRACE(Trace::Warning, (_T("TimeSync: Server [%s] is not usable (mode %d, stratum %d, leap %d)"), index->Hostname().c_str(), packet.NTPMode(), packet.Stratum(), packet.LeapIndicator()));
+                index->Reject();
+            } else {
+                double receivedServerTS = packet.ReceiveTimestamp().TimeSeconds();
+                double sentServerTS = packet.TransmitTimestamp().TimeSeconds();
+                double sentTS = originate.TimeSeconds();
 
-#ifdef __DEBUG__
-            TRACE_L1("Server elapsed time = %lf", elapsedServer);
-            TRACE_L1("Total elapsed time  = %lf", elapsedTotal);
-            TRACE_L1("Round trip time     = %lf", roundTrip);
-#endif
-            TRACE(Trace::Information, (_T("TimeSync: Request time diff   = %lf s"), diffRequest));
-            TRACE(Trace::Information, (_T("TimeSync: Response time diff  = %lf s"), diffResponse));
-            TRACE(Trace::Information, (_T("TimeSync: Offset time         = %lf s"), offset));
+                double diffRequest = receivedServerTS - sentTS;
+                double diffResponse = sentServerTS - received;
+                double offset = (diffRequest + diffResponse) / 2;
+                double roundTrip = (received - sentTS) - (sentServerTS - receivedServerTS);
 
-            uint64_t receivedTicks = SecondsToTicks(received);
-            TRACE(Trace::Information, (_T("TimeSync: Current time: %s"), Core::Time(receivedTicks).ToRFC1123(false).c_str()));
-            _syncedTimestamp = Core::Time(receivedTicks + SecondsToTicks(offset));
-            TRACE(Trace::Information, (_T("TimeSync: New time:     %s"), _syncedTimestamp.ToRFC1123(false).c_str()));
+                // Root delay and dispersion are in 16.16 fixed point seconds.
+                double rootDistance = ((packet.RootDelay() / 2.0) + packet.RootDispersion()) / 65536.0;
 
-            _state = SUCCESS;
+                TRACE_L1("Server %s: offset = %lf s, round trip = %lf s", index->Hostname().c_str(), offset, roundTrip);
 
-            // We don't need the socket anymore, so close it
-            TRACE_L1("TimeSync: %s", "Closing socket, no longer needed");
-            Close(0);
+                if (index->Received(offset, std::max(roundTrip, 0.0), rootDistance) == true) {
+                    // Take the next sample from this server.
+                    Trigger();
+                }
+            }
 
-            // Lets remove the watchdog subject, we do not want to wait anymore, we got an answer.
-            Core::IWorkerPool::Instance().Revoke(_activity);
+            index = _servers.begin();
+            while ((index != _servers.end()) && (index->IsPending() == false)) {
+                index++;
+            }
 
-            // Schedule it again to broadcast the successfull update of the time.
-            Core::IWorkerPool::Instance().Submit(_activity);
+            if ((index == _servers.end()) && (_state == INPROGRESS)) {
+                // Got all samples we asked for, lets not wait for the watchdog, evaluate them right away.
+                Core::IWorkerPool::Instance().Revoke(_activity);
+                Core::IWorkerPool::Instance().Submit(_activity);
+            }
         }
 
         _adminLock.Unlock();
@@ -286,52 +327,139 @@ namespace Plugin {
             Close(1000);
         }
 
-        if (true == IsClosed() && (_serverIndex.Count() > 0)) {
+        if (true == IsClosed()) {
+
+            // Query all servers we can resolve at once, they all get their samples through the same socket.
+            for (Server& server : _servers) {
 
-            uint32_t lastonetried = _serverIndex.Index();
+                TRACE(Trace::Information, (_T("Trying NTP Server: [%s]"), server.Hostname().c_str()));
 
-            do {
+                if (server.Resolve() == false) {
+                    TRACE(Trace::Warning, (_T("Could not resolve NTP Server [%s]"), server.Hostname().c_str()));
+                    server.Start(0);
+                } else {
+                    if (activated == false) {
+                        // Set the local endpoint for the socket, the remote is set per request
+                        RemoteNode(server.Remote());
+                        LocalNode(server.Remote().AnyInterface());
+
+                        // UDP should open by definition directly...
+                        uint32_t status = Open(100);
+
+                        if ((status == Core::ERROR_NONE) || (status == Core::ERROR_INPROGRESS)) {
+                            activated = true;
+                        } else {
+                            TRACE(Trace::Warning, (_T("Could not open connection to NTP Server [%s]"), server.Hostname().c_str()));
+                        }
+                    }
 
-                // next server
-                if( _serverIndex.Index() >= _serverIndex.Count() ) {
-                    _serverIndex.Reset(0);
+                    server.Start(activated == true ? _samples : 0);
                 }
-                _serverIndex.Next();
-                ASSERT(_serverIndex.IsValid());
+            }
 
-                TRACE(Trace::Information, (_T("Trying NTP Server: [%s]"), (*_serverIndex).c_str()));
+            if (activated == true) {
+                Trigger();
+            }
+        }
 
-                // Set the socket to send to the remote
-                Core::NodeId remote((*_serverIndex).c_str(), Core::NodeId::TYPE_IPV4);
+        return (activated);
+    }
 
-                if (remote.IsValid() == true) {
-                    // Set the remote endpoint for the socket to the selected NTP server
-                    RemoteNode(remote);
-                    LocalNode(remote.AnyInterface());
+    // Selects the servers that agree on the time (the intersection algorithm of Marzullo) and combines
+    // their offsets weighted by their distance. Servers not agreeing with the majority are falsetickers.
+    bool NTPClient::Select()
+    {
+        // runs always in the context of the adminlock
 
-                    // UDP should open by definition directly...
-                    uint32_t status = Open(100);
+        std::vector<std::pair<double, int8_t>> edges;
+        uint8_t candidates = 0;
 
-                    if ((status == Core::ERROR_NONE) || (status == Core::ERROR_INPROGRESS)) {
+        for (Server& server : _servers) {
+            server.Stop();
+            server.Filter();
 
-                        activated = true;
-                        _fired = false;
-                        Trigger();
-                    }
-                    else {
-                        TRACE(Trace::Warning, (_T("Could not open connection to NTP Server [%s]"), (*_serverIndex).c_str()));
-                    }
+            if (server.IsReachable() == true) {
+                candidates++;
+                // Start of an interval sorts before the end of an interval at the same position.
+                edges.emplace_back(server.Offset() - server.Distance(), -1);
+                edges.emplace_back(server.Offset() + server.Distance(), +1);
+            }
+        }
+
+        std::sort(edges.begin(), edges.end());
+
+        uint8_t count = 0;
+        uint8_t best = 0;
+        double low = 0;
+        double high = 0;
+
+        for (uint16_t index = 0; index < edges.size(); index++) {
+            if (edges[index].second < 0) {
+                count++;
+                if (count > best) {
+                    best = count;
+                    low = edges[index].first;
+                    high = edges[index + 1].first;
                 }
-                else {
-                    TRACE(Trace::Warning, (_T("Could not resolve NTP Server [%s]"), (*_serverIndex).c_str()));
+            } else {
+                count--;
+            }
+        }
+
+        bool result = false;
+
+        if ((candidates > 0) && (best > (candidates / 2))) {
+            double weights = 0;
+            double offset = 0;
+            double closest = 0;
+
+            for (Server& server : _servers) {
+                if ((server.IsReachable() == true) && ((server.Offset() - server.Distance()) <= low) && ((server.Offset() + server.Distance()) >= high)) {
+                    double weight = 1.0 / server.Distance();
+
+                    server.Selected(true);
+                    offset += server.Offset() * weight;
+                    weights += weight;
+
+                    if (weight > closest) {
+                        closest = weight;
+                        _source = server.Hostname();
+                    }
                 }
             }
-            while ((activated == false) && ( ((lastonetried != 0) && (lastonetried != _serverIndex.Index())) ||
-                                             ((lastonetried == 0) && (_serverIndex.Index() != _serverIndex.Count())) 
-                                           ) );
+
+            _offset = offset / weights;
+            result = true;
+
+            TRACE(Trace::Information, (_T("TimeSync: %d of %d NTP servers agree, offset = %lf s"), best, candidates, _offset));
+        } else if (candidates > 0) {
+            TRACE(Trace::Warning, (_T("TimeSync: No majority of the %d NTP servers agree on the time"), candidates));
         }
 
-        return (activated);
+        return (result);
+    }
+
+    void NTPClient::Server::Filter()
+    {
+        if (_samples.empty() == false) {
+            std::list<std::pair<double, double>>::const_iterator best(_samples.begin());
+
+            for (std::list<std::pair<double, double>>::const_iterator index(_samples.begin()); index != _samples.end(); index++) {
+                if (index->second < best->second) {
+                    best = index;
+                }
+            }
+
+            double spread = 0;
+
+            for (const std::pair<double, double>& sample : _samples) {
+                spread += (sample.first - best->first) * (sample.first - best->first);
+            }
+
+            _offset = best->first;
+            _delay = best->second;
+            _jitter = (_samples.size() > 1 ? sqrt(spread / (_samples.size() - 1)) : 0);
+        }
     }
 
     void NTPClient::Update()
@@ -360,17 +488,28 @@ namespace Plugin {
 
         switch (_state) {
         case SENDREQUEST: {
-            // This case means that nothing has started yet, let reset the list of servers and start at the beginning...
-            _serverIndex.Reset(0);
+            // This case means that nothing has started yet, no samples to evaluate
             _state = INPROGRESS;
             _currentAttempt = _retryAttempts;
+            for (Server& server : _servers) {
+                server.Start(0);
+            }
         }
         case INPROGRESS: {
-            // If we end up here in this state, it means that the package was send but no response was received,
-            // or a response was received but is was not properly formatted...
-            // Lets move to the next server in the list, see if that one responds correctly, if we tried all servers let's
-            // start at the first one again, this time it might work
-            if (FireRequest() == true) {
+            // If we end up here in this state, either all samples are in, or we waited long enough for them.
+            // See if the servers that did respond agree on the time, if not, query them all again.
+            if (Select() == true) {
+                _syncedTimestamp = Core::Time(static_cast<uint64_t>(Core::Time::Now().Ticks() + (_offset * MicroSeconds)));
+                TRACE(Trace::Information, (_T("TimeSync: New time:     %s"), _syncedTimestamp.ToRFC1123(false).c_str()));
+
+                _state = SUCCESS;
+
+                // We don't need the socket anymore, so close it
+                TRACE_L1("TimeSync: %s", "Closing socket, no longer needed");
+                Close(0);
+
+                Update();
+            } else if (FireRequest() == true) {
               result = WaitForResponse;
             } else {
                 if (_currentAttempt-- != 0) {
@@ -32,11 +32,22 @@ namespace Plugin {
         static constexpr uint32_t MicroSeconds = 1000 * MilliSeconds;
         static constexpr uint32_t NanoSeconds = 1000 * MicroSeconds;
 
+        // Number of samples taken from each server during a synchronization round.
+        static constexpr uint8_t DefaultSamples = 4;
+
         using SourceIterator = Core::JSON::ArrayType<Core::JSON::String>::Iterator;
 
+        // Outcome of the last synchronization round for a single server, all times in microseconds.
+        struct ServerInfo {
+            string Source;
+            uint8_t Samples;
+            int64_t Offset;
+            uint64_t Delay;
+            uint64_t Jitter;
+            bool Selected;
+        };
+
     private:
-        using ServerList = std::vector<string>;
-        using ServerIterator = Core::IteratorType<const ServerList, const string&, ServerList::const_iterator>;
         using DataFrame = Core::FrameType<0>;
 
         // This enum tracks the state for actions begin performed. As the Worker() method is re-entered,
@@ -117,6 +128,10 @@ namespace Plugin {
 
                     return (*this);
                 }
+                bool operator==(const Timestamp& rhs) const
+                {
+                    return ((_source.tv_sec == rhs._source.tv_sec) && (_source.tv_nsec == rhs._source.tv_nsec));
+                }
 
             public:
                 uint32_t Seconds() const
@@ -328,6 +343,151 @@ namespace Plugin {
                 // bit (NTP time)
         };
 
+        // Keeps track of the exchanges with a single NTP server during a synchronization round, and
+        // runs the clock filter over the samples received: the sample with the lowest round trip delay
+        // is the most accurate one, the spread of the others around it is the jitter of the server.
+        class Server {
+        private:
+            // Lower bound of the synchronization distance (MINDISP, RFC 5905).
+            static constexpr double MinimumDistance = 0.01;
+
+        public:
+            Server() = delete;
+            Server(const Server&) = delete;
+            Server& operator=(const Server&) = delete;
+
+            Server(const string& hostname)
+                : _hostname(hostname)
+                , _remote()
+                , _samples()
+                , _originate()
+                , _outstanding(0)
+                , _send(false)
+                , _awaiting(false)
+                , _offset(0)
+                , _delay(0)
+                , _jitter(0)
+                , _rootDistance(0)
+                , _selected(false)
+            {
+            }
+            ~Server()
+            {
+            }
+
+        public:
+            inline const string& Hostname() const
+            {
+                return (_hostname);
+            }
+            inline const Core::NodeId& Remote() const
+            {
+                return (_remote);
+            }
+            inline bool Resolve()
+            {
+                _remote = Core::NodeId(_hostname.c_str(), Core::NodeId::TYPE_IPV4);
+                return (_remote.IsValid());
+            }
+            inline void Start(const uint8_t samples)
+            {
+                _samples.clear();
+                _outstanding = samples;
+                _send = (samples > 0);
+                _awaiting = false;
+                _offset = 0;
+                _delay = 0;
+                _jitter = 0;
+                _selected = false;
+            }
+            inline void Stop()
+            {
+                // Whatever did not come in by now, is considered lost.
+                _outstanding = 0;
+                _send = false;
+                _awaiting = false;
+            }
+            inline void Reject()
+            {
+                // The server told us to go away, or can not tell the time: the samples it gave before
+                // should not steer the selected time either.
+                Stop();
+                _samples.clear();
+            }
+            inline bool IsPending() const
+            {
+                return (_outstanding > 0);
+            }
+            inline bool IsSending() const
+            {
+                return (_send);
+            }
+            inline bool IsAwaiting(const NTPPacket::Timestamp& originate) const
+            {
+                return ((_awaiting == true) && (_originate == originate));
+            }
+            inline bool IsReachable() const
+            {
+                return (_samples.empty() == false);
+            }
+            inline void Sent(const NTPPacket::Timestamp& originate)
+            {
+                _originate = originate;
+                _send = false;
+                _awaiting = true;
+            }
+            // Returns true if another sample should be taken from this server.
+            inline bool Received(const double offset, const double delay, const double rootDistance)
+            {
+                _samples.emplace_back(offset, delay);
+                _rootDistance = rootDistance;
+                _awaiting = false;
+                _outstanding--;
+                _send = (_outstanding > 0);
+
+                return (_send);
+            }
+            void Filter();
+            // The maximum error of the offset of this server, it is within offset +/- distance.
+            inline double Distance() const
+            {
+                return (std::max(MinimumDistance, (_delay / 2) + _jitter + _rootDistance));
+            }
+            inline double Offset() const
+            {
+                return (_offset);
+            }
+            inline void Selected(const bool selected)
+            {
+                _selected = selected;
+            }
+            void Info(ServerInfo& info) const
+            {
+                info.Source = _hostname;
+                info.Samples = static_cast<uint8_t>(_samples.size());
+                info.Offset = static_cast<int64_t>(_offset * MicroSeconds);
+                info.Delay = static_cast<uint64_t>(_delay * MicroSeconds);
+                info.Jitter = static_cast<uint64_t>(_jitter * MicroSeconds);
+                info.Selected = _selected;
+            }
+
+        private:
+            const string _hostname;
+            Core::NodeId _remote;
+            std::list<std::pair<double, double>> _samples; // offset, delay in seconds
+            NTPPacket::Timestamp _originate;
+            uint8_t _outstanding;
+            bool _send;
+            bool _awaiting;
+            double _offset;
+            double _delay;
+            double _jitter;
+            double _rootDistance;
+            bool _selected;
+        };
+
+        using ServerList = std::list<Server>;
+
         class Activity : public Core::IDispatchType<void> {
         private:
             Activity() = delete;
@@ -363,7 +523,7 @@ namespace Plugin {
         virtual ~NTPClient();
 
     public:
-        void Initialize(SourceIterator& sources, const uint16_t retries, const uint16_t delay);
+        void Initialize(SourceIterator& sources, const uint16_t retries, const uint16_t delay, const uint8_t samples = DefaultSamples);
         virtual void Register(Exchange::ITimeSync::INotification* notification) override;
         virtual void Unregister(Exchange::ITimeSync::INotification* notification) override;
 
@@ -372,6 +532,10 @@ namespace Plugin {
         virtual string Source() const override;
         virtual uint64_t SyncTime() const override;
 
+        // Offset (in microseconds) of the local clock found during the last successful synchronization.
+        int64_t Offset() const;
+        void Servers(std::list<ServerInfo>& servers) const;
+
         // ITime methods
         virtual uint64_t TimeSync() const override
         {
@@ -394,18 +558,20 @@ namespace Plugin {
         void Update();
         void Dispatch();
         bool FireRequest();
+        bool Select();
 
     private:
         Core::CriticalSection _adminLock;
         NTPPacket _packet;
         Core::Time _syncedTimestamp;
         state _state;
-        bool _fired;
         uint32_t _WaitForNetwork;
         uint32_t _retryAttempts;
         uint32_t _currentAttempt;
+        uint8_t _samples;
         ServerList _servers;
-        ServerIterator _serverIndex;
+        string _source;
+        double _offset;
         Core::ProxyType<Core::IDispatchType<void>> _activity;
         std::list<Exchange::ITimeSync::INotification*> _clients;
     };
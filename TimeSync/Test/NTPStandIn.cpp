@@ -0,0 +1,375 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../NTPClient.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// The NTPClient against NTP servers on the loopback interface (127.0.0.2 and up, all on the
+// same port as real servers would be), that answer with a configurable clock offset, reply delay
+// or a kiss-o'-death:
+//
+//    TimeSyncNTPTest -port 12300
+//
+// - agree: all servers agree, the offset is theirs;
+// - falseticker: one server is far off, it may not be selected nor move the offset;
+// - delay: one server answers slowly, its asymmetric delay may not move the offset;
+// - kiss: one server sends a kiss-o'-death, it may not be selected;
+// - nomajority: the servers disagree, no time may be set.
+// The time to sync and the outcome are printed as JSON, the exit code is the number of failed
+// scenarios. The system clock is not touched, that is up to the plugin.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+static constexpr uint32_t SyncWaitTime = 10000; // mS
+static constexpr uint32_t NoMajorityWaitTime = 3000; // mS
+static constexpr int64_t Tolerance = 5000; // uS
+
+class WorkerPoolImplementation : public Core::WorkerPool {
+private:
+    class Dispatcher : public Core::ThreadPool::IDispatcher {
+    public:
+        Dispatcher(const Dispatcher&) = delete;
+        Dispatcher& operator=(const Dispatcher&) = delete;
+
+        Dispatcher() = default;
+        ~Dispatcher() override = default;
+
+    private:
+        void Initialize() override
+        {
+        }
+        void Deinitialize() override
+        {
+        }
+        void Dispatch(Core::IDispatch* job) override
+        {
+            job->Dispatch();
+        }
+    };
+
+public:
+    WorkerPoolImplementation() = delete;
+    WorkerPoolImplementation(const WorkerPoolImplementation&) = delete;
+    WorkerPoolImplementation& operator=(const WorkerPoolImplementation&) = delete;
+
+    WorkerPoolImplementation(const uint8_t threads, const uint32_t stackSize, const uint32_t queueSize)
+        : Core::WorkerPool(threads, stackSize, queueSize, &_dispatcher)
+        , _dispatcher()
+    {
+    }
+    ~WorkerPoolImplementation() override = default;
+
+private:
+    Dispatcher _dispatcher;
+};
+
+// An NTP server whose clock is offset from ours, answering each request after a delay.
+class Server : public Core::Thread {
+private:
+    static constexpr uint8_t PacketSize = 48;
+    static constexpr uint32_t NTPToUNIXSeconds = 2208988800UL;
+
+    struct Pending {
+        uint64_t Due;
+        struct sockaddr_in Address;
+        uint8_t Originate[8];
+        uint64_t Received;
+    };
+
+public:
+    Server() = delete;
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    Server(const string& address, const uint16_t port, const double offset /* S */, const uint32_t delay /* mS */, const bool kiss)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("NTPStandIn"))
+        , _offset(static_cast<int64_t>(offset * Plugin::NTPClient::MicroSeconds))
+        , _delay(static_cast<uint64_t>(delay) * Core::Time::TicksPerMillisecond)
+        , _kiss(kiss)
+        , _socket(::socket(AF_INET, SOCK_DGRAM, 0))
+        , _pending()
+    {
+        struct sockaddr_in local;
+        int reuse = 1;
+
+        ::memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_port = htons(port);
+        ::inet_pton(AF_INET, address.c_str(), &local.sin_addr);
+
+        // The client binds the port of its servers on any interface.
+        ::setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if ((_socket != -1) && (::bind(_socket, reinterpret_cast<const struct sockaddr*>(&local), sizeof(local)) != 0)) {
+            ::close(_socket);
+            _socket = -1;
+        }
+        if (_socket != -1) {
+            Run();
+        }
+    }
+    ~Server() override
+    {
+        Stop();
+        Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+        if (_socket != -1) {
+            ::close(_socket);
+        }
+    }
+
+public:
+    bool IsValid() const
+    {
+        return (_socket != -1);
+    }
+
+private:
+    uint64_t Now() const
+    {
+        return (static_cast<uint64_t>(static_cast<int64_t>(Core::Time::Now().Ticks()) + _offset));
+    }
+    static void Timestamp(uint8_t buffer[], const uint64_t ticks)
+    {
+        const uint32_t seconds = static_cast<uint32_t>((ticks / Core::Time::TicksPerMillisecond / 1000) + NTPToUNIXSeconds);
+        const uint32_t fraction = static_cast<uint32_t>(((ticks % (Core::Time::TicksPerMillisecond * 1000)) << 32) / (Core::Time::TicksPerMillisecond * 1000));
+
+        buffer[0] = static_cast<uint8_t>(seconds >> 24);
+        buffer[1] = static_cast<uint8_t>(seconds >> 16);
+        buffer[2] = static_cast<uint8_t>(seconds >> 8);
+        buffer[3] = static_cast<uint8_t>(seconds);
+        buffer[4] = static_cast<uint8_t>(fraction >> 24);
+        buffer[5] = static_cast<uint8_t>(fraction >> 16);
+        buffer[6] = static_cast<uint8_t>(fraction >> 8);
+        buffer[7] = static_cast<uint8_t>(fraction);
+    }
+    void Reply(const Pending& request)
+    {
+        uint8_t packet[PacketSize];
+
+        ::memset(packet, 0, sizeof(packet));
+
+        packet[0] = (0 << 6) | (4 << 3) | 4; // No leap warning, version 4, server
+        packet[1] = (_kiss == true ? 0 : 2); // Stratum, 0 is a kiss-o'-death
+        packet[2] = 3; // Poll
+        packet[3] = static_cast<uint8_t>(-20); // Precision, about a microsecond
+        packet[9] = 0x01; // Root dispersion (16.16), about 4 mS
+        if (_kiss == true) {
+            ::memcpy(&packet[12], "RATE", 4);
+        } else {
+            packet[12] = 127;
+            packet[15] = 1;
+        }
+        Timestamp(&packet[16], request.Received); // Reference
+        ::memcpy(&packet[24], request.Originate, sizeof(request.Originate));
+        Timestamp(&packet[32], request.Received);
+        Timestamp(&packet[40], Now());
+
+        ::sendto(_socket, packet, sizeof(packet), 0, reinterpret_cast<const struct sockaddr*>(&request.Address), sizeof(request.Address));
+    }
+    uint32_t Worker() override
+    {
+        uint32_t waitTime = 100;
+        const uint64_t now = Core::Time::Now().Ticks();
+
+        while ((_pending.empty() == false) && (_pending.front().Due <= now)) {
+            Reply(_pending.front());
+            _pending.pop_front();
+        }
+        if (_pending.empty() == false) {
+            waitTime = static_cast<uint32_t>(((_pending.front().Due - now) + 999) / 1000);
+        }
+
+        struct pollfd descriptor = { _socket, POLLIN, 0 };
+
+        if ((::poll(&descriptor, 1, static_cast<int>(waitTime)) > 0) && ((descriptor.revents & POLLIN) != 0)) {
+            uint8_t packet[PacketSize];
+            Pending request;
+            socklen_t length = sizeof(request.Address);
+
+            const ssize_t size = ::recvfrom(_socket, packet, sizeof(packet), 0, reinterpret_cast<struct sockaddr*>(&request.Address), &length);
+
+            // Only client requests, the replies go out in order.
+            if ((size == PacketSize) && ((packet[0] & 0x07) == 3)) {
+                request.Received = Now();
+                request.Due = Core::Time::Now().Ticks() + _delay;
+                ::memcpy(request.Originate, &packet[40], sizeof(request.Originate));
+                _pending.push_back(request);
+            }
+        }
+
+        return (0);
+    }
+
+private:
+    const int64_t _offset; // uS
+    const uint64_t _delay; // uS
+    const bool _kiss;
+    int _socket;
+    std::list<Pending> _pending;
+};
+
+class Sink : public Exchange::ITimeSync::INotification {
+public:
+    Sink(const Sink&) = delete;
+    Sink& operator=(const Sink&) = delete;
+
+    Sink()
+        : _completed(false, true)
+    {
+    }
+    ~Sink() override
+    {
+    }
+
+public:
+    bool Wait(const uint32_t waitTime)
+    {
+        return (_completed.Lock(waitTime) == Core::ERROR_NONE);
+    }
+    void Completed() override
+    {
+        _completed.SetEvent();
+    }
+
+    BEGIN_INTERFACE_MAP(Sink)
+    INTERFACE_ENTRY(Exchange::ITimeSync::INotification)
+    END_INTERFACE_MAP
+
+private:
+    Core::Event _completed;
+};
+
+struct Setup {
+    double Offset; // S
+    uint32_t Delay; // mS
+    bool Kiss;
+};
+
+// Returns true if the outcome was as expected: a sync at the expected offset by the expected
+// servers, or no sync at all if nothing was expected.
+bool Scenario(const TCHAR name[], const uint16_t port, const std::vector<Setup>& setups, const bool expected, const double offset, const bool last)
+{
+    std::list<Server> servers;
+    Core::JSON::ArrayType<Core::JSON::String> sources;
+    bool valid = true;
+
+    for (uint8_t index = 0; index < setups.size(); index++) {
+        const string address(_T("127.0.0.") + Core::NumberType<uint8_t>(index + 2).Text());
+
+        servers.emplace_back(address, port, setups[index].Offset, setups[index].Delay, setups[index].Kiss);
+        valid = valid && servers.back().IsValid();
+
+        Core::JSON::String& source(sources.Add());
+        source = _T("ntp://") + address + ':' + Core::NumberType<uint16_t>(port).Text();
+    }
+
+    Plugin::NTPClient* client = Core::Service<Plugin::NTPClient>::Create<Plugin::NTPClient>();
+    Core::Sink<Sink> sink;
+    Plugin::NTPClient::SourceIterator index(sources.Elements());
+    std::list<Plugin::NTPClient::ServerInfo> info;
+
+    client->Initialize(index, 1, 1);
+    client->Register(&sink);
+
+    const uint64_t start = Core::Time::Now().Ticks();
+    const bool completed = (valid == true) && (client->Synchronize() == Core::ERROR_NONE) && (sink.Wait(expected == true ? SyncWaitTime : NoMajorityWaitTime) == true);
+    const uint32_t elapsed = static_cast<uint32_t>((Core::Time::Now().Ticks() - start) / Core::Time::TicksPerMillisecond);
+
+    if (completed == false) {
+        client->Cancel();
+        sink.Wait(SyncWaitTime);
+    }
+
+    const bool synced = (client->SyncTime() != 0);
+    const int64_t measured = client->Offset();
+    client->Servers(info);
+
+    bool result = (synced == expected);
+
+    if ((result == true) && (synced == true)) {
+        uint8_t position = 0;
+
+        result = (std::abs(measured - static_cast<int64_t>(offset * Plugin::NTPClient::MicroSeconds)) <= Tolerance);
+
+        // Only the servers that tell the expected time may be selected.
+        for (const Plugin::NTPClient::ServerInfo& server : info) {
+            const bool good = (setups[position].Kiss == false) && (std::abs(setups[position].Offset - offset) < 1.0);
+            result = result && ((good == true) || (server.Selected == false));
+            position++;
+        }
+    }
+
+    printf("  \"%s\": { \"valid\": %s, \"synced\": %s, \"time\": %u, \"offset\": %lld, \"expected\": %lld, \"selected\": [",
+        name, (valid == true ? "true" : "false"), (synced == true ? "true" : "false"), (synced == true ? elapsed : 0),
+        static_cast<long long>(measured), static_cast<long long>(offset * Plugin::NTPClient::MicroSeconds));
+    for (std::list<Plugin::NTPClient::ServerInfo>::const_iterator server(info.begin()); server != info.end(); server++) {
+        printf("%s%s", (server == info.begin() ? "" : ", "), (server->Selected == true ? "true" : "false"));
+    }
+    printf("], \"passed\": %s }%s\n", (result == true ? "true" : "false"), (last == true ? "" : ","));
+
+    client->Unregister(&sink);
+    client->Release();
+
+    return (result);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    uint16_t port = 12300;
+    uint32_t failures = 0;
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-port") == 0) {
+            port = static_cast<uint16_t>(atoi(argv[index + 1]));
+        }
+    }
+
+    {
+        WorkerPoolImplementation workerPool(2, Core::Thread::DefaultStackSize(), 16);
+
+        Core::IWorkerPool::Assign(&workerPool);
+        workerPool.Run();
+
+        printf("{\n");
+        failures += (Scenario(_T("agree"), port, { { 0.250, 0, false }, { 0.251, 0, false }, { 0.249, 0, false } }, true, 0.250, false) ? 0 : 1);
+        failures += (Scenario(_T("falseticker"), port, { { 0.250, 0, false }, { 0.250, 0, false }, { 0.250, 0, false }, { 30.0, 0, false } }, true, 0.250, false) ? 0 : 1);
+        failures += (Scenario(_T("delay"), port, { { 0.250, 0, false }, { 0.250, 0, false }, { 0.250, 300, false } }, true, 0.250, false) ? 0 : 1);
+        failures += (Scenario(_T("kiss"), port, { { 0.250, 0, false }, { 0.250, 0, false }, { 0.250, 0, false }, { 0.250, 0, true } }, true, 0.250, false) ? 0 : 1);
+        failures += (Scenario(_T("nomajority"), port, { { 0.0, 0, false }, { 10.0, 0, false } }, false, 0.0, true) ? 0 : 1);
+        printf("}\n");
+
+        workerPool.Stop();
+        Core::IWorkerPool::Assign(nullptr);
+    }
+
+    Core::Singleton::Dispose();
+
+    return (static_cast<int>(failures));
+}
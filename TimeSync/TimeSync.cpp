@@ -37,6 +37,7 @@ namespace Plugin {
     TimeSync::TimeSync()
         : _skipURL(0)
         , _periodicity(0)
+        , _slew(0)
         , _client(Core::Service<NTPClient>::Create<Exchange::ITimeSync>())
         , _activity(Core::ProxyType<PeriodicSync>::Create(_client))
         , _sink(this)
@@ -61,11 +62,12 @@ namespace Plugin {
         string version = service->Version();
         _skipURL = static_cast<uint16_t>(service->WebPrefix().length());
         _periodicity = config.Periodicity.Value() * 60 /* minutes */ * 60 /* seconds */ * 1000 /* milliSeconds */;
+        _slew = config.Slew.Value() * 1000 /* microSeconds */;
         bool start = (((config.Deferred.IsSet() == true) && (config.Deferred.Value() == true)) == false);
 
         NTPClient::SourceIterator index(config.Sources.Elements());
 
-        static_cast<NTPClient*>(_client)->Initialize(index, config.Retries.Value(), config.Interval.Value());
+        static_cast<NTPClient*>(_client)->Initialize(index, config.Retries.Value(), config.Interval.Value(), config.Samples.Value());
 
         ASSERT(service != nullptr);
         ASSERT(_service == nullptr);
@@ -174,9 +176,12 @@ namespace Plugin {
     {
         Core::Time newTime(time);
 
-        TRACE(Trace::Information, (_T("Syncing time to %s."), newTime.ToRFC1123(false).c_str()));
+        // Small offsets are slewed away, so the time never jumps (backwards), larger ones are stepped.
+        if (Slew(static_cast<const NTPClient*>(_client)->Offset()) == false) {
+            TRACE(Trace::Information, (_T("Syncing time to %s."), newTime.ToRFC1123(false).c_str()));
 
-        Core::SystemInfo::Instance().SetTime(newTime);
+            Core::SystemInfo::Instance().SetTime(newTime);
+        }
 
         if (_periodicity != 0) {
             Core::Time newSyncTime(Core::Time::Now());
@@ -191,6 +196,29 @@ namespace Plugin {
         }
     }
 
+    bool TimeSync::Slew(const int64_t offset)
+    {
+        bool result = false;
+
+#ifndef __WINDOWS__
+        if ((_slew != 0) && (static_cast<uint64_t>(offset < 0 ? -offset : offset) < _slew)) {
+            struct timeval delta;
+
+            delta.tv_sec = static_cast<time_t>(offset / static_cast<int64_t>(NTPClient::MicroSeconds));
+            delta.tv_usec = static_cast<suseconds_t>(offset % static_cast<int64_t>(NTPClient::MicroSeconds));
+
+            if (::adjtime(&delta, nullptr) == 0) {
+                TRACE(Trace::Information, (_T("Slewing time by %lld us."), static_cast<long long>(offset)));
+                result = true;
+            } else {
+                TRACE(Trace::Warning, (_T("Could not slew the time, error %d."), errno));
+            }
+        }
+#endif
+
+        return (result);
+    }
+
     void TimeSync::EnsureSubsystemIsActive()
     {
         ASSERT(_service != nullptr);
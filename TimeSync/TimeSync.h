@@ -74,6 +74,65 @@ namespace Plugin {
             TimeRep Time;
         };
 
+        class ServerData : public Core::JSON::Container {
+        public:
+            ServerData()
+                : Core::JSON::Container()
+                , Source()
+                , Samples()
+                , Offset()
+                , Delay()
+                , Jitter()
+                , Selected()
+            {
+                Init();
+            }
+            ServerData(const ServerData& copy)
+                : Core::JSON::Container()
+                , Source(copy.Source)
+                , Samples(copy.Samples)
+                , Offset(copy.Offset)
+                , Delay(copy.Delay)
+                , Jitter(copy.Jitter)
+                , Selected(copy.Selected)
+            {
+                Init();
+            }
+            ServerData& operator=(const ServerData& rhs)
+            {
+                Source = rhs.Source;
+                Samples = rhs.Samples;
+                Offset = rhs.Offset;
+                Delay = rhs.Delay;
+                Jitter = rhs.Jitter;
+                Selected = rhs.Selected;
+
+                return (*this);
+            }
+            virtual ~ServerData()
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("source"), &Source);
+                Add(_T("samples"), &Samples);
+                Add(_T("offset"), &Offset);
+                Add(_T("delay"), &Delay);
+                Add(_T("jitter"), &Jitter);
+                Add(_T("selected"), &Selected);
+            }
+
+        public:
+            Core::JSON::String Source;
+            Core::JSON::DecUInt8 Samples;
+            Core::JSON::DecSInt64 Offset; // in microseconds
+            Core::JSON::DecUInt64 Delay; // in microseconds
+            Core::JSON::DecUInt64 Jitter; // in microseconds
+            Core::JSON::Boolean Selected;
+        };
+
     private:
         class Notification : protected Exchange::ITimeSync::INotification {
         private:
@@ -155,12 +214,16 @@ namespace Plugin {
                 , Retries(8)
                 , Sources()
                 , Periodicity(0)
+                , Samples(4)
+                , Slew(128)
             {
                 Add(_T("deferred"), &Deferred);
                 Add(_T("interval"), &Interval);
                 Add(_T("retries"), &Retries);
                 Add(_T("sources"), &Sources);
                 Add(_T("periodicity"), &Periodicity);
+                Add(_T("samples"), &Samples);
+                Add(_T("slew"), &Slew);
             }
             ~Config()
             {
@@ -172,6 +235,8 @@ namespace Plugin {
             Core::JSON::DecUInt8 Retries;
             Core::JSON::ArrayType<Core::JSON::String> Sources;
             Core::JSON::DecUInt16 Periodicity;
+            Core::JSON::DecUInt8 Samples;
+            Core::JSON::DecUInt16 Slew;
         };
 
         class PeriodicSync : public Core::IDispatch {
@@ -234,6 +299,7 @@ namespace Plugin {
 
     private:
         void SyncedTime(const uint64_t timeTicks);
+        bool Slew(const int64_t offset);
         void EnsureSubsystemIsActive();
 
         // JSON RPC
@@ -242,12 +308,14 @@ namespace Plugin {
         uint32_t endpoint_synchronize();
         uint32_t get_synctime(JsonData::TimeSync::SynctimeData& response) const;
         uint32_t get_time(Core::JSON::String& response) const;
+        uint32_t get_servers(Core::JSON::ArrayType<ServerData>& response) const;
         uint32_t set_time(const Core::JSON::String& param);
         void event_timechange();
 
     private:
         uint16_t _skipURL;
         uint32_t _periodicity;
+        uint32_t _slew;
         Exchange::ITimeSync* _client;
         Core::ProxyType<Core::IDispatch> _activity;
         Core::Sink<Notification> _sink;
@@ -19,6 +19,7 @@
 
 #include <interfaces/json/JsonData_TimeSync.h>
 #include "TimeSync.h"
+#include "NTPClient.h"
 #include "Module.h"
 
 namespace WPEFramework {
@@ -35,6 +36,7 @@ namespace Plugin {
         Register<void,void>(_T("synchronize"), &TimeSync::endpoint_synchronize, this);
         Property<SynctimeData>(_T("synctime"), &TimeSync::get_synctime, nullptr, this);
         Property<Core::JSON::String>(_T("time"), &TimeSync::get_time, &TimeSync::set_time, this);
+        Property<Core::JSON::ArrayType<ServerData>>(_T("servers"), &TimeSync::get_servers, nullptr, this);
     }
 
     void TimeSync::UnregisterAll()
@@ -42,6 +44,7 @@ namespace Plugin {
         Unregister(_T("synchronize"));
         Unregister(_T("time"));
         Unregister(_T("synctime"));
+        Unregister(_T("servers"));
     }
 
     // API implementation
@@ -86,6 +89,29 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    // Property: servers - Delay, offset and jitter measured for each NTP server during the last synchronization
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t TimeSync::get_servers(Core::JSON::ArrayType<ServerData>& response) const
+    {
+        std::list<NTPClient::ServerInfo> servers;
+
+        static_cast<const NTPClient*>(_client)->Servers(servers);
+
+        for (const NTPClient::ServerInfo& server : servers) {
+            ServerData& entry(response.Add());
+
+            entry.Source = server.Source;
+            entry.Samples = server.Samples;
+            entry.Offset = server.Offset;
+            entry.Delay = server.Delay;
+            entry.Jitter = server.Jitter;
+            entry.Selected = server.Selected;
+        }
+
+        return Core::ERROR_NONE;
+    }
+
     // Property: time - Current system time
     // Return codes:
     //  - ERROR_NONE: Success
@@ -0,0 +1,228 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <atomic>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // The implementation usually runs out of process and the plugin can only reach it through the
+    // IBrowser and IStateControl interfaces. Measurements that do not fit those interfaces are kept
+    // in a small memory mapped file in the volatile path: the implementation creates it and is the
+    // only one updating it, the plugin maps it to report the numbers.
+    class BrowserStatistics {
+    private:
+        // Both processes work on the same atomics in the mapping, a lock would be local to one of them.
+        static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The statistics need lock free 64 bit atomics");
+
+    public:
+        enum mode {
+            OPEN,
+            CREATE
+        };
+
+        enum transition : uint8_t {
+            SUSPEND,
+            RESUME,
+            HIDE,
+            SHOW,
+            TRANSITIONS
+        };
+
+        static constexpr uint32_t Magic = 0x53424B57; // 'WKBS'
+        static constexpr uint16_t Version = 2;
+
+        static constexpr uint32_t LongFrame = 16700; // uS, a frame missed at 60 FPS
+        static constexpr uint32_t VeryLongFrame = 33300; // uS, a frame missed at 30 FPS
+        static constexpr uint32_t IdleFrame = 250000; // uS, nothing was drawn in between, not a slow frame
+
+        // Messages from page JavaScript (wpe.NotifyWPEFramework), delivered by the injected bundle in batches.
+        struct Messages {
+            std::atomic<uint64_t> Received;
+            std::atomic<uint64_t> Batches;
+            std::atomic<uint64_t> Dropped; // never left the bundle, its queue was full
+            std::atomic<uint64_t> LatencyTotal; // uS, from the JavaScript call to the dispatch
+            std::atomic<uint64_t> LatencyMax; // uS
+        };
+
+        // The moments the last Slots frames were displayed, in a ring the writer never waits for. Long
+        // and VeryLong cover all frames displayed, except those after more than IdleFrame.
+        struct Frames {
+            static constexpr uint32_t Slots = 512;
+
+            std::atomic<uint64_t> Sequence; // frames displayed, frame N is in slot N % Slots
+            std::atomic<uint64_t> Long;
+            std::atomic<uint64_t> VeryLong;
+            std::atomic<uint64_t> Displayed[Slots]; // uS, monotonic
+        };
+
+        // Time from the request of a state or visibility change until the view applied it.
+        struct Transition {
+            std::atomic<uint64_t> Count;
+            std::atomic<uint64_t> Total; // uS
+            std::atomic<uint64_t> Last; // uS
+            std::atomic<uint64_t> Max; // uS
+        };
+
+        struct Layout {
+            uint32_t Magic;
+            uint16_t Version;
+            uint16_t Reserved;
+            Messages JavaScript;
+            Frames Rendering;
+            Transition Transitions[TRANSITIONS];
+        };
+
+    public:
+        BrowserStatistics() = delete;
+        BrowserStatistics(const BrowserStatistics&) = delete;
+        BrowserStatistics& operator=(const BrowserStatistics&) = delete;
+
+        BrowserStatistics(const string& fileName, const mode how)
+            : _file(fileName, Core::File::SHAREABLE | Core::File::USER_READ | Core::File::USER_WRITE | Core::File::GROUP_READ, (how == CREATE ? sizeof(Layout) : 0))
+            , _layout(nullptr)
+        {
+            if ((_file.IsValid() == true) && (_file.Size() >= sizeof(Layout))) {
+                if (how == CREATE) {
+                    _layout = new (_file.Buffer()) Layout();
+                    _layout->Magic = Magic;
+                    _layout->Version = Version;
+                } else {
+                    Layout* layout = reinterpret_cast<Layout*>(_file.Buffer());
+
+                    if ((layout->Magic == Magic) && (layout->Version == Version)) {
+                        _layout = layout;
+                    }
+                }
+            }
+        }
+        ~BrowserStatistics()
+        {
+        }
+
+        static string FileName(const PluginHost::IShell* service)
+        {
+            return (service->VolatilePath() + service->Callsign() + _T(".statistics"));
+        }
+
+    public:
+        inline bool IsValid() const
+        {
+            return (_layout != nullptr);
+        }
+        inline Messages& JavaScript()
+        {
+            ASSERT(IsValid() == true);
+            return (_layout->JavaScript);
+        }
+        inline const Messages& JavaScript() const
+        {
+            ASSERT(IsValid() == true);
+            return (_layout->JavaScript);
+        }
+        inline const Frames& Rendering() const
+        {
+            ASSERT(IsValid() == true);
+            return (_layout->Rendering);
+        }
+        inline const Transition& Transitions(const transition which) const
+        {
+            ASSERT((IsValid() == true) && (which < TRANSITIONS));
+            return (_layout->Transitions[which]);
+        }
+
+        // Writer side, only to be called from the thread displaying the frames.
+        void FrameDisplayed(const uint64_t now)
+        {
+            ASSERT(IsValid() == true);
+
+            Frames& frames(_layout->Rendering);
+            const uint64_t sequence = frames.Sequence.load(std::memory_order_relaxed);
+
+            if (sequence != 0) {
+                const uint64_t interval = now - frames.Displayed[(sequence - 1) % Frames::Slots].load(std::memory_order_relaxed);
+
+                if ((interval > LongFrame) && (interval <= IdleFrame)) {
+                    frames.Long.fetch_add(1, std::memory_order_relaxed);
+
+                    if (interval > VeryLongFrame) {
+                        frames.VeryLong.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // A reader that sees this slot overwritten must also see the Sequence published before it.
+            std::atomic_thread_fence(std::memory_order_release);
+            frames.Displayed[sequence % Frames::Slots].store(now, std::memory_order_relaxed);
+            frames.Sequence.store(sequence + 1, std::memory_order_release);
+        }
+        // Writer side, only to be called from the thread applying the transitions.
+        void Transitioned(const transition which, const uint64_t duration)
+        {
+            ASSERT((IsValid() == true) && (which < TRANSITIONS));
+
+            Transition& entry(_layout->Transitions[which]);
+
+            entry.Count.fetch_add(1, std::memory_order_relaxed);
+            entry.Total.fetch_add(duration, std::memory_order_relaxed);
+            entry.Last.store(duration, std::memory_order_relaxed);
+
+            if (duration > entry.Max.load(std::memory_order_relaxed)) {
+                entry.Max.store(duration, std::memory_order_relaxed);
+            }
+        }
+
+        // Reader side: the moments the most recent frames were displayed, oldest first.
+        void Displayed(std::vector<uint64_t>& moments) const
+        {
+            ASSERT(IsValid() == true);
+
+            const Frames& frames(_layout->Rendering);
+            const uint64_t last = frames.Sequence.load(std::memory_order_acquire);
+            const uint64_t first = (last > Frames::Slots ? last - Frames::Slots : 0);
+
+            moments.clear();
+            moments.reserve(static_cast<size_t>(last - first));
+
+            for (uint64_t index = first; index < last; index++) {
+                moments.push_back(frames.Displayed[index % Frames::Slots].load(std::memory_order_relaxed));
+            }
+
+            // The writer might have reused slots while they were copied, these are no longer the frames
+            // we were after. The writer can be busy in the slot after the last one it published.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t valid = frames.Sequence.load(std::memory_order_relaxed) + 1;
+
+            if (valid > (first + Frames::Slots)) {
+                const size_t stale = static_cast<size_t>(std::min(valid - (first + Frames::Slots), static_cast<uint64_t>(moments.size())));
+                moments.erase(moments.begin(), moments.begin() + stale);
+            }
+        }
+
+    private:
+        Core::DataElementFile _file;
+        Layout* _layout;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -21,6 +21,8 @@
 
 #include "Utils.h"
 
+#include <WPE/WebKit/WKNumber.h>
+
 // Global handle to this bundle.
 extern WKBundleRef g_Bundle;
 
@@ -31,39 +33,103 @@ namespace JavaScript {
     namespace Functions {
 
         NotifyWPEFramework::NotifyWPEFramework()
+            : _batch(nullptr)
+            , _pending(0)
+            , _dropped(0)
+            , _timer(0)
         {
         }
 
-        // Implementation of JS function: loops over arguments and passes all strings to WPEFramework.
+        NotifyWPEFramework::~NotifyWPEFramework()
+        {
+            // Whatever is still queued goes out now, the timer would fire on a dead object.
+            if (_timer != 0) {
+                g_source_remove(_timer);
+                _timer = 0;
+            }
+            if (_batch != nullptr) {
+                if (g_Bundle != nullptr) {
+                    Flush(this);
+                } else {
+                    WKRelease(_batch);
+                }
+            }
+        }
+
+        // Implementation of JS function: queues all string arguments as one message to WPEFramework.
         JSValueRef NotifyWPEFramework::HandleMessage(JSContextRef context, JSObjectRef,
             JSObjectRef, size_t argumentCount, const JSValueRef arguments[], JSValueRef*)
         {
-            WKStringRef messageName = WKStringCreateWithUTF8CString(GetMessageName().c_str());
+            if (_pending >= MaxPending) {
+                _dropped++;
+            } else {
+                // Build message body.
+                WKMutableArrayRef messageBody = WKMutableArrayCreate();
+                for (unsigned int index = 0; index < argumentCount; index++) {
+                    const JSValueRef& argument = arguments[index];
 
-            // Build message body.
-            WKMutableArrayRef messageBody = WKMutableArrayCreate();
-            for (unsigned int index = 0; index < argumentCount; index++) {
-                const JSValueRef& argument = arguments[index];
+                    // For now only pass along strings.
+                    if (!JSValueIsString(context, argument))
+                        continue;
+
+                    JSStringRef jsString = JSValueToStringCopy(context, argument, nullptr);
+
+                    WKStringRef messageLine = WKStringCreateWithJSString(jsString);
+                    WKArrayAppendItem(messageBody, messageLine);
 
-                // For now only pass along strings.
-                if (!JSValueIsString(context, argument))
-                    continue;
+                    WKRelease(messageLine);
+                    JSStringRelease(jsString);
+                }
 
-                JSStringRef jsString = JSValueToStringCopy(context, argument, nullptr);
+                if (_batch == nullptr) {
+                    _batch = WKMutableArrayCreate();
+                }
 
-                WKStringRef messageLine = WKStringCreateWithJSString(jsString);
-                WKArrayAppendItem(messageBody, messageLine);
+                // Every message is preceded by the time it was queued, so the receiving side can tell the latency.
+                WKUInt64Ref queued = WKUInt64Create(g_get_monotonic_time());
+                WKArrayAppendItem(_batch, queued);
+                WKArrayAppendItem(_batch, messageBody);
 
-                WKRelease(messageLine);
-                JSStringRelease(jsString);
+                WKRelease(queued);
+                WKRelease(messageBody);
+
+                _pending++;
             }
 
-            WKBundlePostSynchronousMessage(g_Bundle, messageName, messageBody, nullptr);
+            if (_timer == 0) {
+                _timer = g_timeout_add(Interval, Flush, this);
+            }
 
+            return JSValueMakeNull(context);
+        }
+
+        /* static */ gboolean NotifyWPEFramework::Flush(gpointer data)
+        {
+            NotifyWPEFramework* queue = static_cast<NotifyWPEFramework*>(data);
+
+            ASSERT(queue->_batch != nullptr);
+
+            // [ dropped, [ queued, [ line, ... ], queued, [ line, ... ], ... ] ]
+            WKStringRef messageName = WKStringCreateWithUTF8CString(GetMessageName().c_str());
+            WKMutableArrayRef messageBody = WKMutableArrayCreate();
+            WKUInt64Ref dropped = WKUInt64Create(queue->_dropped);
+
+            WKArrayAppendItem(messageBody, dropped);
+            WKArrayAppendItem(messageBody, queue->_batch);
+
+            WKBundlePostMessage(g_Bundle, messageName, messageBody);
+
+            WKRelease(dropped);
             WKRelease(messageBody);
             WKRelease(messageName);
+            WKRelease(queue->_batch);
 
-            return JSValueMakeNull(context);
+            queue->_batch = nullptr;
+            queue->_pending = 0;
+            queue->_dropped = 0;
+            queue->_timer = 0;
+
+            return G_SOURCE_REMOVE;
         }
 
         static JavaScriptFunctionType<NotifyWPEFramework> _instance(_T("wpe"));
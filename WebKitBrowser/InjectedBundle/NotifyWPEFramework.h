@@ -23,21 +23,40 @@
 #include "JavaScriptFunctionType.h"
 #include "Tags.h"
 
+#include <glib.h>
+
 namespace WPEFramework {
 namespace JavaScript {
     namespace Functions {
 
+        // Messages are not posted one by one, that would block the page on a round trip to the UI
+        // process for every call. They are queued, in order, and posted asynchronously as one batch
+        // per Interval. At most MaxPending messages wait for the next batch, beyond that messages
+        // are dropped and the number dropped is reported with the batch.
         class NotifyWPEFramework {
         public:
+            static constexpr guint Interval = 16; // mS, about once per frame
+            static constexpr uint32_t MaxPending = 1024;
+
             NotifyWPEFramework();
+            ~NotifyWPEFramework();
 
             JSValueRef HandleMessage(JSContextRef context, JSObjectRef,
                 JSObjectRef, size_t argumentCount, const JSValueRef arguments[], JSValueRef*);
 
             static inline string GetMessageName()
             {
-                return Tags::Notification;
+                return Tags::NotificationBatch;
             }
+
+        private:
+            static gboolean Flush(gpointer data);
+
+        private:
+            WKMutableArrayRef _batch;
+            uint32_t _pending;
+            uint32_t _dropped;
+            guint _timer;
         };
     }
 }
@@ -25,6 +25,7 @@ namespace Tags {
 
 const char* const Config = "Config.";
 const char* const Notification = "Notification";
+const char* const NotificationBatch = "NotificationBatch";
 const char* const URL = "URL";
 
 } } ;
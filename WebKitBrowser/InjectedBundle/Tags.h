@@ -25,6 +25,7 @@ namespace Tags {
 
 extern const char* const Config;
 extern const char* const Notification;
+extern const char* const NotificationBatch;
 extern const char* const URL;
 
 } } ;
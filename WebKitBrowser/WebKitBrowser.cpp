@@ -80,6 +80,9 @@ namespace Plugin {
                 stateControl->Configure(_service);
                 stateControl->Register(&_notification);
                 stateControl->Release();
+
+                // Configure created the statistics, if the implementation could.
+                _statistics = new BrowserStatistics(BrowserStatistics::FileName(_service), BrowserStatistics::OPEN);
             }
         }
 
@@ -103,6 +106,10 @@ namespace Plugin {
         _browser->Unregister(&_notification);
         _memory->Release();
 
+        if (_statistics != nullptr) {
+            delete _statistics;
+        }
+
         PluginHost::IStateControl* stateControl(_browser->QueryInterface<PluginHost::IStateControl>());
 
         // In case WPE rpcprocess crashed, there is no access to the statecontrol interface, check it !!
@@ -130,6 +137,7 @@ namespace Plugin {
         _service = nullptr;
         _browser = nullptr;
         _memory = nullptr;
+        _statistics = nullptr;
     }
 
     /* virtual */ string WebKitBrowser::Information() const
@@ -21,6 +21,7 @@
 #define __BROWSER_H
 
 #include "Module.h"
+#include "BrowserStatistics.h"
 #include <interfaces/IBrowser.h>
 #include <interfaces/IComposition.h>
 #include <interfaces/IMemory.h>
@@ -146,6 +147,164 @@ namespace Plugin {
             Core::JSON::Boolean Hidden;
         };
 
+        class MessageStatistics : public Core::JSON::Container {
+        private:
+            MessageStatistics(const MessageStatistics&) = delete;
+            MessageStatistics& operator=(const MessageStatistics&) = delete;
+
+        public:
+            MessageStatistics()
+                : Core::JSON::Container()
+                , Received()
+                , Batches()
+                , Dropped()
+                , AverageLatency()
+                , MaxLatency()
+            {
+                Add(_T("received"), &Received);
+                Add(_T("batches"), &Batches);
+                Add(_T("dropped"), &Dropped);
+                Add(_T("averagelatency"), &AverageLatency);
+                Add(_T("maxlatency"), &MaxLatency);
+            }
+            ~MessageStatistics()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt64 Received;
+            Core::JSON::DecUInt64 Batches;
+            Core::JSON::DecUInt64 Dropped;
+            Core::JSON::DecUInt64 AverageLatency; // uS
+            Core::JSON::DecUInt64 MaxLatency; // uS
+        };
+
+        class FrameStatistics : public Core::JSON::Container {
+        public:
+            class Bucket : public Core::JSON::Container {
+            public:
+                Bucket& operator=(const Bucket&) = delete;
+
+                Bucket()
+                    : Core::JSON::Container()
+                    , Limit()
+                    , Frames()
+                {
+                    Init();
+                }
+                Bucket(const Bucket& copy)
+                    : Core::JSON::Container()
+                    , Limit(copy.Limit)
+                    , Frames(copy.Frames)
+                {
+                    Init();
+                }
+                ~Bucket()
+                {
+                }
+
+            private:
+                void Init()
+                {
+                    Add(_T("limit"), &Limit);
+                    Add(_T("frames"), &Frames);
+                }
+
+            public:
+                Core::JSON::DecUInt32 Limit; // uS
+                Core::JSON::DecUInt32 Frames;
+            };
+
+        private:
+            FrameStatistics(const FrameStatistics&) = delete;
+            FrameStatistics& operator=(const FrameStatistics&) = delete;
+
+        public:
+            FrameStatistics()
+                : Core::JSON::Container()
+                , Displayed()
+                , LongFrames()
+                , VeryLongFrames()
+                , Recent()
+                , Histogram()
+            {
+                Add(_T("displayed"), &Displayed);
+                Add(_T("longframes"), &LongFrames);
+                Add(_T("verylongframes"), &VeryLongFrames);
+                Add(_T("recent"), &Recent);
+                Add(_T("histogram"), &Histogram);
+            }
+            ~FrameStatistics()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt64 Displayed;
+            Core::JSON::DecUInt64 LongFrames;
+            Core::JSON::DecUInt64 VeryLongFrames;
+            Core::JSON::DecUInt32 Recent;
+            Core::JSON::ArrayType<Bucket> Histogram;
+        };
+
+        class TransitionStatistics : public Core::JSON::Container {
+        public:
+            class Transition : public Core::JSON::Container {
+            private:
+                Transition(const Transition&) = delete;
+                Transition& operator=(const Transition&) = delete;
+
+            public:
+                Transition()
+                    : Core::JSON::Container()
+                    , Count()
+                    , Average()
+                    , Last()
+                    , Max()
+                {
+                    Add(_T("count"), &Count);
+                    Add(_T("average"), &Average);
+                    Add(_T("last"), &Last);
+                    Add(_T("max"), &Max);
+                }
+                ~Transition()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt64 Count;
+                Core::JSON::DecUInt64 Average; // uS
+                Core::JSON::DecUInt64 Last; // uS
+                Core::JSON::DecUInt64 Max; // uS
+            };
+
+        private:
+            TransitionStatistics(const TransitionStatistics&) = delete;
+            TransitionStatistics& operator=(const TransitionStatistics&) = delete;
+
+        public:
+            TransitionStatistics()
+                : Core::JSON::Container()
+                , Suspend()
+                , Resume()
+                , Hide()
+                , Show()
+            {
+                Add(_T("suspend"), &Suspend);
+                Add(_T("resume"), &Resume);
+                Add(_T("hide"), &Hide);
+                Add(_T("show"), &Show);
+            }
+            ~TransitionStatistics()
+            {
+            }
+
+        public:
+            Transition Suspend;
+            Transition Resume;
+            Transition Hide;
+            Transition Show;
+        };
+
     public:
         WebKitBrowser()
             : _skipURL(0)
@@ -153,6 +312,7 @@ namespace Plugin {
             , _service(nullptr)
             , _browser(nullptr)
             , _memory(nullptr)
+            , _statistics(nullptr)
             , _notification(this)
             , _jsonBodyDataFactory(2)
         {
@@ -230,6 +390,9 @@ namespace Plugin {
         uint32_t get_visibility(Core::JSON::EnumType<JsonData::Browser::VisibilityType>& response) const; // Browser
         uint32_t set_visibility(const Core::JSON::EnumType<JsonData::Browser::VisibilityType>& param); // Browser
         uint32_t get_fps(Core::JSON::DecUInt32& response) const; // Browser
+        uint32_t get_messages(MessageStatistics& response) const;
+        uint32_t get_frames(FrameStatistics& response) const;
+        uint32_t get_transitions(TransitionStatistics& response) const;
         uint32_t get_state(Core::JSON::EnumType<JsonData::StateControl::StateType>& response) const; // StateControl
         uint32_t set_state(const Core::JSON::EnumType<JsonData::StateControl::StateType>& param); // StateControl
         void event_urlchange(const string& url, const bool& loaded); // Browser
@@ -244,6 +407,7 @@ namespace Plugin {
         PluginHost::IShell* _service;
         Exchange::IBrowser* _browser;
         Exchange::IMemory* _memory;
+        BrowserStatistics* _statistics;
         Core::Sink<Notification> _notification;
         Core::ProxyPoolType<Web::JSONBodyType<WebKitBrowser::Data>> _jsonBodyDataFactory;
     };
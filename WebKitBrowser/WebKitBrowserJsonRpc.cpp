@@ -39,11 +39,17 @@ namespace Plugin {
         Property<Core::JSON::EnumType<VisibilityType>>(_T("visibility"), &WebKitBrowser::get_visibility, &WebKitBrowser::set_visibility, this); /* Browser */
         Property<Core::JSON::DecUInt32>(_T("fps"), &WebKitBrowser::get_fps, nullptr, this); /* Browser */
         Property<Core::JSON::EnumType<StateType>>(_T("state"), &WebKitBrowser::get_state, &WebKitBrowser::set_state, this); /* StateControl */
+        Property<MessageStatistics>(_T("messages"), &WebKitBrowser::get_messages, nullptr, this);
+        Property<FrameStatistics>(_T("frames"), &WebKitBrowser::get_frames, nullptr, this);
+        Property<TransitionStatistics>(_T("transitions"), &WebKitBrowser::get_transitions, nullptr, this);
 
     }
 
     void WebKitBrowser::UnregisterAll()
     {
+        Unregister(_T("transitions"));
+        Unregister(_T("frames"));
+        Unregister(_T("messages"));
         Unregister(_T("state"));
         Unregister(_T("fps"));
         Unregister(_T("visibility"));
@@ -128,6 +134,107 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    // Property: messages - Delivery of the messages page JavaScript sends with wpe.NotifyWPEFramework()
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: The browser does not report statistics
+    uint32_t WebKitBrowser::get_messages(MessageStatistics& response) const
+    {
+        uint32_t result = Core::ERROR_UNAVAILABLE;
+
+        if ((_statistics != nullptr) && (_statistics->IsValid() == true)) {
+            const BrowserStatistics::Messages& counters(_statistics->JavaScript());
+            const uint64_t received = counters.Received.load(std::memory_order_relaxed);
+
+            response.Received = received;
+            response.Batches = counters.Batches.load(std::memory_order_relaxed);
+            response.Dropped = counters.Dropped.load(std::memory_order_relaxed);
+            response.AverageLatency = (received != 0 ? counters.LatencyTotal.load(std::memory_order_relaxed) / received : 0);
+            response.MaxLatency = counters.LatencyMax.load(std::memory_order_relaxed);
+
+            result = Core::ERROR_NONE;
+        }
+
+        return result;
+    }
+
+    // Property: frames - Intervals between the frames the browser displayed
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: The browser does not report statistics
+    uint32_t WebKitBrowser::get_frames(FrameStatistics& response) const
+    {
+        static constexpr uint32_t limits[] = { BrowserStatistics::LongFrame, BrowserStatistics::VeryLongFrame, 50000, 100000, BrowserStatistics::IdleFrame };
+        static constexpr uint8_t buckets = sizeof(limits) / sizeof(limits[0]);
+
+        uint32_t result = Core::ERROR_UNAVAILABLE;
+
+        if ((_statistics != nullptr) && (_statistics->IsValid() == true)) {
+            const BrowserStatistics::Frames& frames(_statistics->Rendering());
+            std::vector<uint64_t> displayed;
+            uint32_t counts[buckets] = {};
+
+            _statistics->Displayed(displayed);
+
+            for (uint32_t index = 1; index < displayed.size(); index++) {
+                const uint64_t interval = displayed[index] - displayed[index - 1];
+                const uint32_t* bucket = std::lower_bound(&(limits[0]), &(limits[buckets]), interval);
+
+                // Nothing to display for a while is not a slow frame.
+                if (bucket != &(limits[buckets])) {
+                    counts[bucket - limits]++;
+                }
+            }
+
+            response.Displayed = frames.Sequence.load(std::memory_order_relaxed);
+            response.LongFrames = frames.Long.load(std::memory_order_relaxed);
+            response.VeryLongFrames = frames.VeryLong.load(std::memory_order_relaxed);
+            response.Recent = static_cast<uint32_t>(displayed.size());
+
+            for (uint8_t index = 0; index < buckets; index++) {
+                FrameStatistics::Bucket& entry(response.Histogram.Add());
+                entry.Limit = limits[index];
+                entry.Frames = counts[index];
+            }
+
+            result = Core::ERROR_NONE;
+        }
+
+        return result;
+    }
+
+    // Property: transitions - Time the browser took to change its state or visibility
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: The browser does not report statistics
+    uint32_t WebKitBrowser::get_transitions(TransitionStatistics& response) const
+    {
+        uint32_t result = Core::ERROR_UNAVAILABLE;
+
+        if ((_statistics != nullptr) && (_statistics->IsValid() == true)) {
+            const std::pair<BrowserStatistics::transition, TransitionStatistics::Transition*> entries[] = {
+                { BrowserStatistics::SUSPEND, &response.Suspend },
+                { BrowserStatistics::RESUME, &response.Resume },
+                { BrowserStatistics::HIDE, &response.Hide },
+                { BrowserStatistics::SHOW, &response.Show }
+            };
+
+            for (const std::pair<BrowserStatistics::transition, TransitionStatistics::Transition*>& entry : entries) {
+                const BrowserStatistics::Transition& transition(_statistics->Transitions(entry.first));
+                const uint64_t count = transition.Count.load(std::memory_order_relaxed);
+
+                entry.second->Count = count;
+                entry.second->Average = (count != 0 ? transition.Total.load(std::memory_order_relaxed) / count : 0);
+                entry.second->Last = transition.Last.load(std::memory_order_relaxed);
+                entry.second->Max = transition.Max.load(std::memory_order_relaxed);
+            }
+
+            result = Core::ERROR_NONE;
+        }
+
+        return result;
+    }
+
     // Property: state - Running state of the service
     // Return codes:
     //  - ERROR_NONE: Success
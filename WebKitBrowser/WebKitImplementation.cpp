@@ -33,6 +33,7 @@
 #include <WPE/WebKit/WKNotificationManager.h>
 #include <WPE/WebKit/WKNotificationPermissionRequest.h>
 #include <WPE/WebKit/WKNotificationProvider.h>
+#include <WPE/WebKit/WKNumber.h>
 #include <WPE/WebKit/WKSoupSession.h>
 #include <WPE/WebKit/WKUserMediaPermissionRequest.h>
 
@@ -45,6 +46,7 @@
 
 #include <glib.h>
 
+#include "BrowserStatistics.h"
 #include "HTML5Notification.h"
 #include "WebKitBrowser.h"
 
@@ -54,6 +56,8 @@ namespace WPEFramework {
 namespace Plugin {
 
 #ifndef WEBKIT_GLIB_API
+    static void onDidReceiveMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
+        WKTypeRef messageBodyObj, const void* clientInfo);
     static void onDidReceiveSynchronousMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
         WKTypeRef messageBodyObj, WKTypeRef* returnData, const void* clientInfo);
     static void onNotificationShow(WKPageRef page, WKNotificationRef notification, const void* clientInfo);
@@ -105,7 +109,8 @@ namespace Plugin {
 
     static WKContextInjectedBundleClientV1 _handlerInjectedBundle = {
         { 1, nullptr },
-        nullptr, // didReceiveMessageFromInjectedBundle
+        // didReceiveMessageFromInjectedBundle
+        onDidReceiveMessageFromInjectedBundle,
         // didReceiveSynchronousMessageFromInjectedBundle
         onDidReceiveSynchronousMessageFromInjectedBundle,
         nullptr, // getInjectedBundleInitializationUserData
@@ -550,6 +555,7 @@ static GSourceFuncs _handlerIntervention =
 #endif
             , _adminLock()
             , _fps(0)
+            , _statistics(nullptr)
             , _loop(nullptr)
             , _context(nullptr)
             , _state(PluginHost::IStateControl::UNINITIALIZED)
@@ -578,6 +584,10 @@ static GSourceFuncs _handlerIntervention =
             if (Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, 6000) == false)
                 TRACE_L1("Bailed out before the end of the WPE main app was reached. %d", 6000);
 
+            if (_statistics != nullptr) {
+                delete _statistics;
+            }
+
             implementation = nullptr;
         }
 
@@ -800,11 +810,36 @@ static GSourceFuncs _handlerIntervention =
                 std::cout << "  " << line << std::endl;
             }
         }
+        void OnJavaScriptBatch(const uint32_t messages, const uint64_t dropped, const uint64_t latencyTotal, const uint64_t latencyMax) const
+        {
+            if (_statistics != nullptr) {
+                BrowserStatistics::Messages& counters(_statistics->JavaScript());
+
+                counters.Received.fetch_add(messages, std::memory_order_relaxed);
+                counters.Batches.fetch_add(1, std::memory_order_relaxed);
+                counters.Dropped.fetch_add(dropped, std::memory_order_relaxed);
+                counters.LatencyTotal.fetch_add(latencyTotal, std::memory_order_relaxed);
+
+                // Only this thread updates the counters, no need to compare and swap.
+                if (latencyMax > counters.LatencyMax.load(std::memory_order_relaxed)) {
+                    counters.LatencyMax.store(latencyMax, std::memory_order_relaxed);
+                }
+            }
+        }
         virtual uint32_t Configure(PluginHost::IShell* service)
         {
             _dataPath = service->DataPath();
             _config.FromString(service->ConfigLine());
 
+            Core::Directory(service->VolatilePath().c_str()).CreatePath();
+            _statistics = new BrowserStatistics(BrowserStatistics::FileName(service), BrowserStatistics::CREATE);
+
+            if (_statistics->IsValid() == false) {
+                TRACE_L1("Could not create the statistics file %s", BrowserStatistics::FileName(service).c_str());
+                delete _statistics;
+                _statistics = nullptr;
+            }
+
             bool environmentOverride(WebKitBrowser::EnvironmentOverride(_config.EnvironmentOverride.Value()));
 
             if ((environmentOverride == false) || (Core::SystemInfo::GetEnvironment(_T("WPE_WEBKIT_URL"), _URL) == false)) {
@@ -968,6 +1003,12 @@ static GSourceFuncs _handlerIntervention =
         {
             _fps = fps;
         }
+        void FrameDisplayed(const uint64_t time)
+        {
+            if (_statistics != nullptr) {
+                _statistics->FrameDisplayed(time);
+            }
+        }
 
         string GetConfig(const string& key) const
         {
@@ -1000,6 +1041,18 @@ static GSourceFuncs _handlerIntervention =
         END_INTERFACE_MAP
 
     private:
+        void Transitioned(const BrowserStatistics::transition which)
+        {
+            static const TCHAR* const names[] = { _T("Suspend"), _T("Resume"), _T("Hide"), _T("Show") };
+
+            const uint64_t duration = Core::Time::Now().Ticks() - _time;
+
+            if (_statistics != nullptr) {
+                _statistics->Transitioned(which, duration);
+            }
+
+            TRACE_L1("Internal %s Notification took %d uS.", names[which], static_cast<uint32_t>(duration));
+        }
         void Hide()
         {
             if (_context != nullptr) {
@@ -1014,7 +1067,7 @@ static GSourceFuncs _handlerIntervention =
                         WKViewSetViewState(object->_view, (object->_state == PluginHost::IStateControl::RESUMED ? kWKViewStateIsInWindow : 0));
 #endif
                         object->Hidden(true);
-                        TRACE_L1("Internal Hide Notification took %d mS.", static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time));
+                        object->Transitioned(BrowserStatistics::HIDE);
 
                         return FALSE;
                     },
@@ -1036,7 +1089,7 @@ static GSourceFuncs _handlerIntervention =
 #endif
                         object->Hidden(false);
 
-                        TRACE_L1("Internal Show Notification took %d mS.", static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time));
+                        object->Transitioned(BrowserStatistics::SHOW);
 
                         return FALSE;
                     },
@@ -1060,7 +1113,7 @@ static GSourceFuncs _handlerIntervention =
 #endif
                         object->OnStateChange(PluginHost::IStateControl::SUSPENDED);
 
-                        TRACE_L1("Internal Suspend Notification took %d mS.", static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time));
+                        object->Transitioned(BrowserStatistics::SUSPEND);
 
                         return FALSE;
                     },
@@ -1085,7 +1138,7 @@ static GSourceFuncs _handlerIntervention =
 #endif
                         object->OnStateChange(PluginHost::IStateControl::RESUMED);
 
-                        TRACE_L1("Internal Resume Notification took %d mS.", static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time));
+                        object->Transitioned(BrowserStatistics::RESUME);
 
                         return FALSE;
                     },
@@ -1269,8 +1322,9 @@ static GSourceFuncs _handlerIntervention =
 
                     ++s_frameCount;
                     gint64 time = g_get_monotonic_time();
+                    auto* browser = static_cast<WebKitImplementation*>(userData);
+                    browser->FrameDisplayed(time);
                     if (time - lastDumpTime >= G_USEC_PER_SEC) {
-                        auto* browser = static_cast<WebKitImplementation*>(userData);
                         browser->SetFPS(s_frameCount * G_USEC_PER_SEC * 1.0 / (time - lastDumpTime));
                         s_frameCount = 0;
                         lastDumpTime = time;
@@ -1527,6 +1581,7 @@ static GSourceFuncs _handlerIntervention =
 #endif
         Core::CriticalSection _adminLock;
         uint32_t _fps;
+        BrowserStatistics* _statistics;
         GMainLoop* _loop;
         GMainContext* _context;
         std::list<Exchange::IBrowser::INotification*> _notificationClients;
@@ -1541,6 +1596,49 @@ static GSourceFuncs _handlerIntervention =
 
 #ifndef WEBKIT_GLIB_API
 
+    // Handles asynchronous messages from injected bundle.
+    /* static */ void onDidReceiveMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
+        WKTypeRef messageBodyObj, const void* clientInfo)
+    {
+        const WebKitImplementation* browser = static_cast<const WebKitImplementation*>(clientInfo);
+
+        string name = WKStringToString(messageName);
+
+        if (name == Tags::NotificationBatch) {
+            // [ dropped, [ queued, [ line, ... ], queued, [ line, ... ], ... ] ], in the order the page sent them.
+            WKArrayRef body = static_cast<WKArrayRef>(messageBodyObj);
+            ASSERT(WKArrayGetSize(body) == 2);
+
+            uint64_t dropped = WKUInt64GetValue(static_cast<WKUInt64Ref>(WKArrayGetItemAtIndex(body, 0)));
+            WKArrayRef messages = static_cast<WKArrayRef>(WKArrayGetItemAtIndex(body, 1));
+            size_t size = WKArrayGetSize(messages);
+            uint64_t latencyTotal = 0;
+            uint64_t latencyMax = 0;
+
+            for (size_t index = 0; (index + 1) < size; index += 2) {
+                // Queued in the WebProcess, on the same monotonic clock.
+                uint64_t queued = WKUInt64GetValue(static_cast<WKUInt64Ref>(WKArrayGetItemAtIndex(messages, index)));
+                WKArrayRef messageLines = static_cast<WKArrayRef>(WKArrayGetItemAtIndex(messages, index + 1));
+
+                uint64_t now = g_get_monotonic_time();
+                uint64_t latency = (now > queued ? now - queued : 0);
+                latencyTotal += latency;
+                latencyMax = std::max(latencyMax, latency);
+
+                browser->OnJavaScript(ConvertWKArrayToStringVector(messageLines));
+            }
+
+            browser->OnJavaScriptBatch(static_cast<uint32_t>(size / 2), dropped, latencyTotal, latencyMax);
+
+            if (dropped != 0) {
+                TRACE_L1("The injected bundle dropped %llu JavaScript messages", static_cast<unsigned long long>(dropped));
+            }
+        } else {
+            // Unexpected message name.
+            std::cerr << "WebBridge received asynchronous message (" << name << "), but didn't process it." << std::endl;
+        }
+    }
+
     // Handles synchronous messages from injected bundle.
     /* static */ void onDidReceiveSynchronousMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
         WKTypeRef messageBodyObj, WKTypeRef* returnData, const void* clientInfo)
@@ -1656,6 +1754,7 @@ static GSourceFuncs _handlerIntervention =
 
         ++s_frameCount;
         gint64 time = g_get_monotonic_time();
+        browser->FrameDisplayed(time);
         if (time - lastDumpTime >= G_USEC_PER_SEC) {
             browser->SetFPS(s_frameCount * G_USEC_PER_SEC * 1.0 / (time - lastDumpTime));
             s_frameCount = 0;
@@ -302,12 +302,12 @@ WebPAStatus Adapter::Helper::GetParameters(const req_struct*& reqObj, res_struct
 
     if ((status == WEBPA_SUCCESS) && (reqObj->u.getReq->paramCnt > 0)) {
         resObj->paramCnt = reqObj->u.getReq->paramCnt;
-        std::map<std::vector<Data>, WebPAStatus> parametersList;
+        std::vector<std::pair<std::vector<Data>, WebPAStatus>> parametersList;
         _parameter->Values(parameterNames, parametersList);
         if (parametersList.size() > 0) {
 
             int i = 0;
-            for (std::map<std::vector<Data>, WebPAStatus>::iterator parameters = parametersList.begin(); parameters != parametersList.end(); parameters++, i++) {
+            for (std::vector<std::pair<std::vector<Data>, WebPAStatus>>::iterator parameters = parametersList.begin(); parameters != parametersList.end(); parameters++, i++) {
                 resObj->u.getRes->paramNames[i] = strdup(parameterNames[i].c_str());
                 resObj->u.getRes->retParamCnt[i] = parameters->first.size();
                 resObj->retStatus[i] = static_cast<WDMP_STATUS>(parameters->second);
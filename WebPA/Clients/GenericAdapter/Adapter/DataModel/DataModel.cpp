@@ -19,413 +19,259 @@
  
 #include "DataModel.h"
 
+#include <tinyxml.h>
+
 namespace WPEFramework {
 
 DataModel::DataModel(Handler* handler)
-    : _dmHandle(0)
+    : _nodes()
+    , _types()
     , _handler(handler)
 {
 }
 
 DataModel::~DataModel()
 {
-    if (_dmHandle) {
-        TiXmlDocument* doc = reinterpret_cast<TiXmlDocument*>(_dmHandle);
-        delete (doc);
-    }
 }
 
 DMStatus DataModel::LoadDM(const std::string& filename)
 {
-    TiXmlDocument* doc = new TiXmlDocument(filename.c_str());
     DMStatus status = DM_FAILURE;
+    TiXmlDocument doc(filename.c_str());
 
-    if (nullptr != doc) {
-        bool loadOK = doc->LoadFile();
-        if (loadOK) {
-            _dmHandle = reinterpret_cast<int>(doc);
-            status = DM_SUCCESS;
-        } else {
-            _dmHandle = 0;
-        }
-    } else {
-        _dmHandle = 0;
-    }
-    return status;
-}
-
-int16_t DataModel::ParameterInstanceCount(const std::string& paramName) const
-{
-    int16_t instanceCount = 0;
-
-    if (paramName.empty() != true) {
-        std::size_t found = paramName.find(InstanceNumberIndicator);
-        if (found != std::string::npos) {
-
-            // Get the number of instances from Adapter
-            std::string paramType;
-
-            if (IsValidParameter (paramName, paramType)) {
-                TRACE(Trace::Information, (_T( "Valid Parameter..! ")));
-                string name(paramName, 0, found - 1 );
-                Data param(name + "NumberOfEntries", static_cast<const int>(0));
-
-                FaultCode status = (static_cast<const Handler&>(*_handler)).Parameter(param);
-                if (status != FaultCode::NoFault) {
-                    TRACE(Trace::Error, (_T("[%s:%s:%d] Error in Get Message Handler : faultCode = %d"), __FILE__, __FUNCTION__, __LINE__, status));
-                } else {
-                    TRACE(Trace::Information, (_T("[%s:%s:%d] The value for param: %s is %d"), __FILE__, __FUNCTION__, __LINE__, param.Name().c_str(), param.Value().Integer()));
-                    instanceCount = param.Value().Integer();
-                }
-
-            }
-        }
-    }
-    return instanceCount;
-}
+    _nodes.clear();
+    _types.clear();
 
+    if (doc.LoadFile() == true) {
+        _types.emplace_back();
+        _nodes.emplace_back(std::string(), true);
 
-void DataModel::ReplaceWithInstanceNumber(string& paramName, uint16_t instanceNumber) const
-{
-    if (paramName.empty() != true) {
-        std::size_t position = paramName.find(InstanceNumberIndicator);
-        if (position != std::string::npos) {
-            std::string number = std::to_string(instanceNumber);
-            paramName.replace(position, strlen(InstanceNumberIndicator) - 1, number);
+        // Goto the first object ie "Device."
+        TiXmlElement* object = doc.RootElement();
+        while ((object != nullptr) && (strcmp(object->Value(), "object") != 0)) {
+            object = object->FirstChildElement();
         }
-    }
-}
 
-bool DataModel::CheckMatchingParameter(const char* attrValue, const char* paramName, uint32_t& ret) const
-{
-    bool status = false;
+        for (; object != nullptr; object = object->NextSiblingElement("object")) {
+            const char* base = object->Attribute("base");
+            if (base == nullptr) {
+                continue;
+            }
 
-    int i = 10;
-    int inst = 0;
+            // "Device.IP.Interface.{i}.Stats." each segment is a level in the trie
+            uint32_t node = 0;
+            const std::string objectName(base);
+            std::size_t start = 0;
+            std::size_t end;
+            while ((end = objectName.find('.', start)) != std::string::npos) {
+                node = Insert(node, objectName.substr(start, end - start), true);
+                start = end + 1;
+            }
 
-    while (true) {
-        if (!(*attrValue && *paramName && (*attrValue == *paramName))) {
+            for (TiXmlElement* parameter = object->FirstChildElement("parameter"); parameter != nullptr; parameter = parameter->NextSiblingElement("parameter")) {
+                const char* name = parameter->Attribute("base");
+                if (name != nullptr) {
+                    const uint32_t index = Insert(node, name, false);
 
-            ret = 0;
-            if (*attrValue == '{' && *paramName >= 48 && *paramName <= 56) {
-                attrValue += 3;
-                while(*paramName &&* paramName != '.') {
-                    ret = ret*i + (*paramName - 48);
-                    paramName++;
-                    inst = ret;
-                }
-            } else {
+                    const char* getIdx = parameter->Attribute("getIdx");
+                    _nodes[index].Readable = ((getIdx != nullptr) && (strtol(getIdx, nullptr, 10) >= 1));
 
-                ret = 0;
-                if (!*paramName) {
-                    if (!*attrValue && (*(attrValue - 2) == '}')) {
-                        ret = inst;
+                    const TiXmlElement* syntax = parameter->FirstChildElement("syntax");
+                    if ((syntax != nullptr) && (syntax->FirstChildElement() != nullptr)) {
+                        _nodes[index].Type = TypeIndex(syntax->FirstChildElement()->Value());
                     }
-                    status = true;
                 }
-                break;
             }
         }
-        attrValue++;
-        paramName++;
+
+        for (Node& entry : _nodes) {
+            entry.Index = entry.Children;
+            std::sort(entry.Index.begin(), entry.Index.end(), [this](const uint32_t lhs, const uint32_t rhs) { return (_nodes[lhs].Name < _nodes[rhs].Name); });
+        }
+
+        _nodes.shrink_to_fit();
+
+        TRACE(Trace::Information, (_T("Data model %s compiled into %d nodes"), filename.c_str(), static_cast<uint32_t>(_nodes.size())));
+        status = DM_SUCCESS;
+    } else {
+        TRACE(Trace::Error, (_T("Loading data model %s failed: %s"), filename.c_str(), doc.ErrorDesc()));
     }
     return status;
 }
 
-TiXmlNode* DataModel::Parameters(TiXmlNode* parent, const std::string& paramName, std::string& currentParam, std::map<uint32_t, std::pair<std::string, std::string>>& paramList) const
+uint32_t DataModel::Insert(const uint32_t parent, const std::string& name, const bool object)
 {
-    // If parent is Null Return
-    if (!parent) {
-        return nullptr;
-    }
-
-    int isReccursiveCall = 0;
-    // Identify whether the call is recursive or initial call
-    if (currentParam.empty() != true) {
-        isReccursiveCall = 1;
-    }
-
-    TiXmlNode* child;
-    // Goto actual Object node ie "Device."
-    if (parent->Type() != TiXmlNode::TINYXML_ELEMENT) {
-        for (child = parent->FirstChild(); child != 0;) {
-            if (child->Type() != TiXmlNode::TINYXML_ELEMENT) {
-                child = child->NextSibling();
-            } else {
-                if (!strcmp (child->Value(), "object"))
-                    break;
-                child = child->FirstChild();
-            }
+    uint32_t index = 0;
+
+    if (name == InstanceNumberIndicator) {
+        index = _nodes[parent].Instance;
+        if (index == 0) {
+            index = static_cast<uint32_t>(_nodes.size());
+            _nodes.emplace_back(name, true);
+            _nodes[parent].Instance = index;
         }
     } else {
-        child = parent;
-    }
-
-    std::string zeroInstance;
-    while (child) {
-        TiXmlElement* pElement =  child->ToElement();
-        TiXmlAttribute* pAttrib = pElement->FirstAttribute();
-        uint32_t inst = 0;
-        int status = 0;
-
-        // Check if node is an Object
-        if (!strcmp(child->Value(),"object")) {
-            if (strstr(pAttrib->Value(), paramName.c_str()) || (status = CheckMatchingParameter(pAttrib->Value(), paramName.c_str(), inst))) {
-                // If the number of instances are 0 then skip this object and go to next sibling
-                if ((zeroInstance.empty() != true) && strstr(pAttrib->Value(), zeroInstance.c_str())) {
-                    child = child->NextSibling();
-                    continue;
-                } else if (zeroInstance.empty() != true) {
-                    zeroInstance = "";
-                }
-                // If matching found update the current parameter with wild card input std::string
-                if (status && !isReccursiveCall) {
-                    currentParam = paramName;
-                }
-                currentParam = pAttrib->Value();
-                TiXmlNode* bChild, *sChild;
-                bChild = child;
-                // Goto the parameters
-                child = child->FirstChild();
-
-                // Object not having any parameter thus go to next Sibling
-                if (nullptr == child) {
-                    child = bChild->NextSibling();
-                }
-
-                char* endPtr = nullptr;
-                const std::string maxEntries = pElement->Attribute("maxEntries");
-                // Seems like a {i} instance
-                if (maxEntries.empty() != true && ((!strcmp(maxEntries.c_str(),"unbounded")) || (strtol(maxEntries.c_str(), &endPtr, 10) > 1))) {
-                    // Make Sure that its ends with {i}
-                    if (IsParamEndsWithInstance(pAttrib->Value()) == true ) {
-                        uint16_t instanceNumber = 0;
-                        uint16_t i = 1;
-                        // Get the Number of instances for that attribute
-                        uint16_t actualInstance = ParameterInstanceCount(pAttrib->Value());
-                        if (inst) {
-                            // Check if valid instance count is given in input wild card if not make it as zero, this will skip current branch
-                            if (actualInstance >= inst)
-                                i = instanceNumber = inst;
-                            else
-                                instanceNumber = 0;
-                        } else {
-                            instanceNumber = actualInstance;
-
-                        }
-                        sChild = child;
-                        // Number of instances are > 0 go through each and populate data for each instance
-                        std::string tempParamName;
-                        while (i <= instanceNumber) {
-                            tempParamName = child->Parent()->ToElement()->FirstAttribute()->Value();
-                            currentParam = tempParamName;
-
-                            // Replace {i} with current instance number and call recursively
-                            ReplaceWithInstanceNumber(currentParam, i);
-
-                            sChild = Parameters(child, tempParamName, currentParam, paramList);
-                            i++;
-                        }
-                        child = sChild;
-                        // Seems like instance count is empty
-                        if (!instanceNumber) {
-                            zeroInstance = pAttrib->Value();
-                            child = child->Parent();
-                        }
-                    }
-                }
-            }
-            else if (isReccursiveCall) { // Tree found once and processed and going to another branch so break
-                return child;
-            }
-            else { // Tree not found yet goto next sibling and get it
-                child = child->NextSibling();
+        // Still loading, the index is not sorted yet.
+        for (const uint32_t child : _nodes[parent].Children) {
+            if ((_nodes[child].Name == name) && (_nodes[child].Object == object)) {
+                index = child;
+                break;
             }
         }
-        // Found the Parameter
-        else if (!strcmp(child->Value(),"parameter")) {
-            TiXmlNode* bChild;
-            // Find all parameters
-            for (bChild = child ; child ; child=child->NextSibling()) {
-                if (paramList.size() <= MaxNumParameters) {
-                    if (currentParam.length() > 0) {
-                        if (child->ToElement()->Attribute("getIdx") && strtol(child->ToElement()->Attribute("getIdx"),nullptr,10) >= 1) {
-                            paramList.insert(std::make_pair(paramList.size(), std::make_pair(currentParam + child->ToElement()->FirstAttribute()->Value(), child->FirstChild()->FirstChild()->Value())));
-                        }
-                    }
-                }
-            }
-            // Go to next object
-            child = bChild->Parent();
-            child = child->NextSibling();
+        if (index == 0) {
+            index = static_cast<uint32_t>(_nodes.size());
+            _nodes.emplace_back(name, object);
+            _nodes[parent].Children.push_back(index);
         }
     }
-    return child;
+    return index;
 }
 
-DMStatus DataModel::Parameters(const std::string& paramName, std::map<uint32_t, std::pair<std::string, std::string>>& paramList) const
+uint16_t DataModel::TypeIndex(const std::string& dataType)
 {
-    std::string currentParam;
-    std::string parameterName = paramName;
-
-    ASSERT(_dmHandle != 0);
-    DMStatus status = DM_SUCCESS;
-    if (Utils::IsWildCardParam(parameterName)) {
-        Parameters(reinterpret_cast<TiXmlDocument*>(_dmHandle), parameterName, currentParam, paramList);
-        if (paramList.size() == 0) {
-            status = DM_ERR_INVALID_PARAMETER;
-        }
-    } else {
-        status = DM_ERR_WILDCARD_NOT_SUPPORTED;
+    uint16_t index = 1;
+    while ((index < _types.size()) && (_types[index] != dataType)) {
+        index++;
     }
-    return status;
+    if (index == _types.size()) {
+        _types.push_back(dataType);
+    }
+    return index;
 }
 
-void DataModel::CheckforParameterMatch(TiXmlNode* parent, const std::string& paramName, bool& match, std::string& dataType) const
+bool DataModel::IsInstanceNumber(const char name[], const std::size_t length)
 {
-    if (!parent)
-        return;
-
-    static bool isObject = false;
-    static bool isMatched = false;
+    std::size_t index = 0;
+    while ((index < length) && (isdigit(name[index]) != 0)) {
+        index++;
+    }
+    return ((length > 0) && (index == length));
+}
 
-    if (parent->Type() == TiXmlNode::TINYXML_ELEMENT) {
-        TiXmlElement* pElement = parent->ToElement();
-        TiXmlAttribute* pAttrib = pElement->FirstAttribute();
-        if (!strcmp(parent->Value(), "object")) {
-            isObject = true;
-        }
+uint32_t DataModel::Child(const uint32_t parent, const char name[], const std::size_t length) const
+{
+    const std::vector<uint32_t>& children = _nodes[parent].Index;
 
-        if (pAttrib) {
-            // Construct Object without parameter from input ParamName
-            std::size_t found = paramName.find_last_of(".");
+    std::vector<uint32_t>::const_iterator index = std::lower_bound(children.begin(), children.end(), 0, [&](const uint32_t child, const int) {
+        return (_nodes[child].Name.compare(0, std::string::npos, name, length) < 0);
+    });
 
-            std::string tempObject;
-            if (found != std::string::npos) {
-                tempObject.assign(paramName, 0, found + 1);
-            } else {
-                tempObject = paramName;
-            }
+    return (((index != children.end()) && (_nodes[*index].Name.compare(0, std::string::npos, name, length) == 0)) ? *index : 0);
+}
 
-            static std::string objectName;
-            if (!strcmp(pAttrib->Value(), tempObject.c_str())) {
-                objectName = pAttrib->Value();
-                isMatched = true;
-            }
+uint16_t DataModel::ParameterInstanceCount(const std::string& objectName) const
+{
+    uint16_t instanceCount = 0;
 
-            if (isMatched || !isObject) {
-                if (objectName == paramName) {
-                    match = true;
-                    return;
-                } else {
-                    isObject = 0;
-                    if (!strcmp(parent->Value(), "parameter")) {
-                        std::string nameFromParamater = objectName + pAttrib->Value();
-
-                        if ((objectName + pAttrib->Value()) == paramName) {
-                            dataType = parent->FirstChild()->FirstChild()->Value();
-                            match = true;
-                            return;
-                        }
-                    }
-                }
-            }
-        }
-    }
+    // "Device.IP.Interface." holds its count in "Device.IP.InterfaceNumberOfEntries"
+    if (objectName.length() > 1) {
+        Data param(objectName.substr(0, objectName.length() - 1) + "NumberOfEntries", static_cast<const int>(0));
 
-    for (TiXmlNode* child = parent->FirstChild(); child != 0; child = child->NextSibling()) {
-        CheckforParameterMatch(child, paramName, match, dataType);
-        if (match == true) {
-            break;
+        FaultCode status = (static_cast<const Handler&>(*_handler)).Parameter(param);
+        if (status != FaultCode::NoFault) {
+            TRACE(Trace::Error, (_T("[%s:%s:%d] Error in Get Message Handler : faultCode = %d"), __FILE__, __FUNCTION__, __LINE__, status));
+        } else {
+            TRACE(Trace::Information, (_T("[%s:%s:%d] The value for param: %s is %d"), __FILE__, __FUNCTION__, __LINE__, param.Name().c_str(), param.Value().Integer()));
+            instanceCount = param.Value().Integer();
         }
     }
-    isMatched = 0;
+    return instanceCount;
 }
 
-uint8_t DataModel::FindInstanceOccurance(const std::string& paramName, std::map<uint8_t, std::pair<std::size_t, std::size_t>>& positions) const
+uint32_t DataModel::Find(const std::string& paramName, const bool checkInstances) const
 {
-    uint8_t count = 0;
-    std::string name = paramName;
-    std::size_t separator = 0;
-    while (true) {
-        std::size_t position =  name.find_first_of("0123456789", separator);
-        if (position != std::string::npos) {
-            separator = name.find(".", position);
-            if (separator != std::string::npos) {
-                positions.insert(std::make_pair(count, std::make_pair(position, separator)));
-                count++;
+    uint32_t node = 0;
+    std::size_t start = 0;
+
+    do {
+        std::size_t end = paramName.find('.', start);
+        if (end == std::string::npos) {
+            end = paramName.length();
+        }
+        const char* name = &(paramName[start]);
+        const std::size_t length = end - start;
+
+        uint32_t child = Child(node, name, length);
+        if ((child == 0) && (_nodes[node].Instance != 0) && (IsInstanceNumber(name, length) == true)) {
+            // Only when expanding, an instance that does not exist yields nothing
+            if (checkInstances == true) {
+                const uint32_t number = strtoul(name, nullptr, 10);
+                if ((number != 0) && (number <= ParameterInstanceCount(paramName.substr(0, start)))) {
+                    child = _nodes[node].Instance;
+                }
             } else {
-                break;
+                child = _nodes[node].Instance;
             }
-        } else {
-            break;
         }
-    }
+        node = child;
+        start = end + 1;
+    } while ((node != 0) && (start < paramName.length()));
 
-    return count;
+    return node;
 }
 
-bool DataModel::ValidateParameterInstance(const std::string& paramName, std::string& dataType) const
+void DataModel::Expand(const uint32_t parent, std::string& path, std::vector<std::pair<std::string, std::string>>& paramList) const
 {
-    bool valid = false;
+    const std::size_t length = path.length();
 
-    std::map<uint8_t, std::pair<std::size_t, std::size_t>> positions;
-    uint8_t occurrences = FindInstanceOccurance(paramName, positions);
-
-    for (uint8_t i = occurrences; (i > 0) && (valid != true); --i) {
-        uint8_t index = occurrences - i;
-
-        std::string tempName = paramName;
-        std::map<uint8_t, std::pair<std::size_t, std::size_t>>::iterator position = positions.find(index);
-        if (positions.end() != position) {
-            tempName.replace(position->second.first, ((position->second.second + 1) - position->second.first), InstanceNumberIndicator);
-            uint16_t maxCombinations = pow(2, i - 1);
-            for (uint16_t j = 0; j < maxCombinations; ++j) {
-                std::string name = tempName;
-                int8_t newPosition = 0;
-                for (uint8_t k = 0; k < i; ++k) {
-                    if ((j & (1 << k))) {
-
-                        index = (occurrences - 1) - k;
-                        std::map<uint8_t, std::pair<std::size_t, std::size_t>>::iterator position = positions.find(index);
-                        if (positions.end() != position) {
-
-                            newPosition = strlen(InstanceNumberIndicator) - ((position->second.second + 1) - position->second.first);
-                            name.replace(position->second.first + newPosition, ((position->second.second + 1) - position->second.first), InstanceNumberIndicator);
-                        }
-                    }
-                }
-                CheckforParameterMatch(reinterpret_cast<TiXmlDocument*>(_dmHandle), name, valid, dataType);
-                if (valid == true) {
-                    break;
-                }
-            }
+    for (const uint32_t child : _nodes[parent].Children) {
+        const Node& node = _nodes[child];
+
+        if (node.Object == true) {
+            path.append(node.Name).append(1, '.');
+            Expand(child, path, paramList);
+            path.resize(length);
+        } else if ((node.Readable == true) && (paramList.size() < MaxNumParameters)) {
+            paramList.emplace_back(path + node.Name, _types[node.Type]);
+        }
+    }
+
+    if (_nodes[parent].Instance != 0) {
+        const uint16_t instanceCount = ParameterInstanceCount(path);
+        for (uint16_t i = 1; i <= instanceCount; i++) {
+            path.append(std::to_string(i)).append(1, '.');
+            Expand(_nodes[parent].Instance, path, paramList);
+            path.resize(length);
         }
     }
-    return valid;
 }
 
-bool DataModel::IsValidParameter(const std::string& paramName, std::string& dataType) const
+DMStatus DataModel::Parameters(const std::string& paramName, std::vector<std::pair<std::string, std::string>>& paramList) const
 {
-    bool valid = false;
-    ASSERT(_dmHandle != 0);
-    CheckforParameterMatch(reinterpret_cast<TiXmlDocument*>(_dmHandle), paramName, valid, dataType);
-    if (valid != true) {
-        valid = ValidateParameterInstance(paramName, dataType);
+    ASSERT(IsLoaded() == true);
+    DMStatus status = DM_SUCCESS;
+    if (Utils::IsWildCardParam(paramName)) {
+        const uint32_t node = Find(paramName, true);
+        if ((node != 0) && (_nodes[node].Object == true)) {
+            std::string path(paramName);
+            Expand(node, path, paramList);
+        }
+        if (paramList.size() == 0) {
+            status = DM_ERR_INVALID_PARAMETER;
+        }
+    } else {
+        status = DM_ERR_WILDCARD_NOT_SUPPORTED;
     }
-    return valid;
+    return status;
 }
 
-bool DataModel::IsParamEndsWithInstance(const std::string& paramName) const
+bool DataModel::IsValidParameter(const std::string& paramName, std::string& dataType) const
 {
-    bool isInstance = false;
+    bool valid = false;
+    ASSERT(IsLoaded() == true);
 
     if (paramName.empty() != true) {
-        std::size_t position = paramName.find(string(InstanceNumberIndicator));
-        if ((position != std::string::npos) && ((position + strlen(InstanceNumberIndicator)) != std::string::npos)) {
-            isInstance = true;
+        const uint32_t node = Find(paramName, false);
+        if (node != 0) {
+            // An object is only requested with a trailing separator, a parameter without
+            if (_nodes[node].Object == true) {
+                valid = Utils::IsWildCardParam(paramName);
+            } else if (Utils::IsWildCardParam(paramName) != true) {
+                dataType = _types[_nodes[node].Type];
+                valid = true;
+            }
         }
     }
-    return isInstance;
+    return valid;
 }
 }
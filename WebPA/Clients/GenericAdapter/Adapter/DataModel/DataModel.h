@@ -22,8 +22,6 @@
 #include "Handler.h"
 #include "Utils.h"
 
-#include <tinyxml.h>
-
 namespace WPEFramework {
 
 typedef enum
@@ -37,10 +35,35 @@ typedef enum
 }
 DMStatus;
 
+// The XML data model is only read at LoadDM, it is compiled into a trie with a node per path
+// segment and the document is released. Multi instance objects get a single "{i}" child, which
+// matches any instance number. Validating a parameter and expanding a wildcard are walks along
+// the segments of the requested path, instead of walks over the whole document.
 class DataModel {
 private:
     static constexpr const uint32_t  MaxNumParameters = 2048;
-    static constexpr const TCHAR* InstanceNumberIndicator = "{i}.";
+    static constexpr const TCHAR* InstanceNumberIndicator = "{i}";
+
+    struct Node {
+        Node(const std::string& name, const bool object)
+            : Name(name)
+            , Object(object)
+            , Readable(false)
+            , Type(0)
+            , Instance(0)
+            , Children()
+            , Index()
+        {
+        }
+
+        std::string Name; // Path segment, without the separator
+        bool Object;
+        bool Readable; // Parameter is part of a wildcard GET (getIdx)
+        uint16_t Type; // Parameter data type, index in _types
+        uint32_t Instance; // The "{i}" child, 0 if this is not a multi instance object
+        std::vector<uint32_t> Children; // Named children, in document order
+        std::vector<uint32_t> Index; // Named children, sorted on name
+    };
 
 public:
     DataModel() = delete;
@@ -51,22 +74,22 @@ public:
     ~DataModel();
 
     DMStatus LoadDM(const std::string& filename);
-    DMStatus Parameters(const std::string& paramName, std::map<uint32_t, std::pair<std::string, std::string>>& paramList) const;
+    DMStatus Parameters(const std::string& paramName, std::vector<std::pair<std::string, std::string>>& paramList) const;
     bool IsValidParameter(const std::string& paramName, std::string& dataType) const;
-    int DMHandle() { return _dmHandle; }
+    bool IsLoaded() const { return (_nodes.empty() != true); }
 
 private:
-    TiXmlNode* Parameters(TiXmlNode* pParent, const std::string& paramName, std::string& currentParam, std::map<uint32_t, std::pair<std::string, std::string>>& paramList) const;
-    void CheckforParameterMatch(TiXmlNode *pParent, const std::string& paramName, bool& pMatch, std::string& dataType) const;
-    bool IsParamEndsWithInstance(const std::string& paramName) const;
-    void ReplaceWithInstanceNumber(string& paramName, uint16_t instanceNumber) const;
-    bool CheckMatchingParameter(const char* attrValue, const char* paramName, uint32_t& ret) const;
-    bool ValidateParameterInstance(const std::string& paramName, std::string& dataType) const;
-    uint8_t FindInstanceOccurance(const std::string& paramName, std::map<uint8_t, std::pair<std::size_t, std::size_t>>& positions) const;
-    int16_t ParameterInstanceCount(const std::string& paramName) const;
+    uint32_t Insert(const uint32_t parent, const std::string& name, const bool object);
+    uint16_t TypeIndex(const std::string& dataType);
+    uint32_t Child(const uint32_t parent, const char name[], const std::size_t length) const;
+    uint32_t Find(const std::string& paramName, const bool checkInstances) const;
+    void Expand(const uint32_t parent, std::string& path, std::vector<std::pair<std::string, std::string>>& paramList) const;
+    uint16_t ParameterInstanceCount(const std::string& objectName) const;
+    static bool IsInstanceNumber(const char name[], const std::size_t length);
 
 private:
-    int _dmHandle;
+    std::vector<Node> _nodes; // _nodes[0] is the root, it is never a child
+    std::vector<std::string> _types;
     Handler* _handler;
 };
 }
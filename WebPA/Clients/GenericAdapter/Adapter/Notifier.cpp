@@ -135,7 +135,7 @@ std::string Notifier::Source()
     if ((notificationSource.empty() == true) || (notificationSource == UnknownParamValue)) {
 
         std::vector<std::string> parameterName = { DeviceMACParam };
-        std::map<std::vector<Data>, WebPAStatus> paramaters;
+        std::vector<std::pair<std::vector<Data>, WebPAStatus>> paramaters;
         notificationSource = UnknownParamValue;
 
         _parameter->Values(parameterName, paramaters);
@@ -32,17 +32,70 @@ Parameter::Parameter(Handler* handler, DataModel* dataModel)
 Parameter::~Parameter()
 {
 }
-const void Parameter::Values(const std::vector<std::string>& parameterNames, std::map<std::vector<Data>, WebPAStatus>& parametersList) const
+const void Parameter::Values(const std::vector<std::string>& parameterNames, std::vector<std::pair<std::vector<Data>, WebPAStatus>>& parametersList) const
 {
-    for (auto& name: parameterNames) {
-        std::vector<Data> parameters;
+    // Resolve all names first, so the handler gets the complete set of parameters in one go and
+    // can fetch them per profile, concurrently.
+    std::vector<Handler::Request> requests;
+    std::vector<uint32_t> owners;
 
-        WebPAStatus ret = Values(name, parameters);
-        parametersList.insert(std::make_pair(parameters, ret));
-        if ((ret == WEBPA_SUCCESS) && (parameters.size() > 0)) {
-            TRACE(Trace::Information, (_T( "Parameter Name: %s return: %d"), name.c_str(), parameters.size()));
+    parametersList.assign(parameterNames.size(), std::make_pair(std::vector<Data>(), WEBPA_FAILURE));
+
+    for (uint32_t i = 0; i < parameterNames.size(); i++) {
+        const std::string& name = parameterNames[i];
+
+        if (_dataModel->IsLoaded() != true) {
+            TRACE(Trace::Error, (_T( "Data base Handle is not Initialized %s"), name.c_str()));
+        } else if (Utils::IsWildCardParam(name)) { // It is a wildcard Param
+            /* Translate wildcard to list of parameters */
+            std::vector<std::pair<std::string, std::string>> dmParamters;
+            DMStatus dmRet = _dataModel->Parameters(name, dmParamters);
+            if (dmRet == DM_SUCCESS && dmParamters.size() > 0) {
+                for (auto& dmParamter: dmParamters) {
+                    Variant value(Utils::ConvertToParamType(dmParamter.second));
+                    requests.emplace_back(Data(dmParamter.first, value));
+                    owners.push_back(i);
+                }
+            } else {
+                TRACE(Trace::Error, (_T( " Wild card Param list is empty")));
+            }
+        } else {
+            std::string dataType;
+
+            if (_dataModel->IsValidParameter(name, dataType)) {
+                Variant value(Utils::ConvertToParamType(dataType));
+                requests.emplace_back(Data(name, value));
+                owners.push_back(i);
+            } else {
+                TRACE(Trace::Error, (_T( "Invalid Parameter Name  :-  %s"), name.c_str()));
+                parametersList[i].second = WEBPA_ERR_INVALID_PARAMETER_NAME;
+            }
+        }
+    }
+
+    if (requests.empty() != true) {
+        (static_cast<const Handler&>(*_handler)).Parameters(requests);
+
+        for (uint32_t j = 0; j < requests.size(); j++) {
+            const uint32_t i = owners[j];
+            const bool wildcard = Utils::IsWildCardParam(parameterNames[i]);
+            WebPAStatus status = (requests[j].Completed == true ? Utils::ConvertFaultCodeToWPAStatus(requests[j].Status) : WEBPA_ERR_TIMEOUT);
+
+            if (WEBPA_SUCCESS == status) {
+                parametersList[i].first.push_back(requests[j].Value);
+                parametersList[i].second = WEBPA_SUCCESS; // For a wildcard, there is at least one parameter
+            } else if ((wildcard != true) || ((status == WEBPA_ERR_TIMEOUT) && (parametersList[i].second != WEBPA_SUCCESS))) {
+                // A wildcard only fails on the parameters that did not make the deadline
+                parametersList[i].second = status;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < parameterNames.size(); i++) {
+        if ((parametersList[i].second == WEBPA_SUCCESS) && (parametersList[i].first.size() > 0)) {
+            TRACE(Trace::Information, (_T( "Parameter Name: %s return: %d"), parameterNames[i].c_str(), parametersList[i].first.size()));
         } else {
-            TRACE(Trace::Information, (_T( "Parameter Name: %s return no value, so keeping empty values to get the status")));
+            TRACE(Trace::Information, (_T( "Parameter Name: %s return no value, so keeping empty values to get the status"), parameterNames[i].c_str()));
         }
     }
 }
@@ -59,75 +112,11 @@ WebPAStatus Parameter::Values(const std::vector<Data>& parameters, std::vector<W
     return ret;
 }
 
-const WebPAStatus Parameter::Values(const std::string& parameterName, std::vector<Data>& parameters) const
-{
-    WebPAStatus status = WEBPA_FAILURE; // Overall get status
-
-    int32_t dmHandle = _dataModel->DMHandle();
-
-    if (dmHandle) {
-        if (Utils::IsWildCardParam(parameterName)) { // It is a wildcard Param
-            /* Translate wildcard to list of parameters */
-            std::map<uint32_t, std::pair<std::string, std::string>> dmParamters;
-            DMStatus dmRet = _dataModel->Parameters(parameterName, dmParamters);
-            if (dmRet == DM_SUCCESS && dmParamters.size() > 0) {
-                for (auto&  dmParamter:  dmParamters) {
-                    Variant value(Utils::ConvertToParamType(dmParamter.second.second));
-                    Data param(dmParamter.second.first, value);
-
-                    _adminLock.Lock();
-                    WebPAStatus ret = Utils::ConvertFaultCodeToWPAStatus((static_cast<const Handler&>(*_handler)).Parameter(param));
-                    _adminLock.Unlock();
-
-                    // Fill Only if we can able to get Proper value
-                    if (WEBPA_SUCCESS == ret) {
-                        parameters.push_back(param);
-                        status = WEBPA_SUCCESS; //Set status as success, if there is atleast one parameter
-                    }
-                } // End of Wild card for loop
-            } else {
-                TRACE(Trace::Error, (_T( " Wild card Param list is empty")));
-                status = WEBPA_FAILURE;
-            }
-            dmParamters.clear();
-
-        } else { // Not a wildcard Parameter Lets fill it
-            TRACE(Trace::Information, (_T( "Get Request for a Non-WildCard Parameter")));
-            std::string dataType;
-
-            if (_dataModel->IsValidParameter (parameterName, dataType)) {
-                TRACE(Trace::Information, (_T( "Valid Parameter..! ")));
-                Variant value(Utils::ConvertToParamType(dataType));
-                Data param(parameterName, value);
-
-                // Convert param.paramType to ParamVal.type
-                TRACE(Trace::Information, (_T( " Values parameterType is %d"), dataType));
-                _adminLock.Lock();
-                status = Utils::ConvertFaultCodeToWPAStatus((static_cast<const Handler&>(*_handler)).Parameter(param));
-                _adminLock.Unlock();
-                if (WEBPA_SUCCESS == status) {
-                    parameters.push_back(param);
-                } else {
-                    TRACE(Trace::Error, (_T( "Failed Get Param Values From Handler: for Param Name :-  %s"), parameterName));
-                }
-            } else {
-                TRACE(Trace::Error, (_T( "Invalid Parameter Name  :-  %s"), parameterName));
-                status = WEBPA_ERR_INVALID_PARAMETER_NAME;
-            }
-        }
-    } else {
-        TRACE(Trace::Error, (_T( "Data base Handle is not Initialized %s"), parameterName));
-    }
-    return status;
-}
-
 WebPAStatus Parameter::Values(const Data& parameter)
 {
     WebPAStatus ret = WEBPA_FAILURE;
 
-    int32_t dmHandle = _dataModel->DMHandle();
-
-    if (dmHandle) {
+    if (_dataModel->IsLoaded() == true) {
 
         std::string dataType;
         if (_dataModel->IsValidParameter(parameter.Name(), dataType)) {
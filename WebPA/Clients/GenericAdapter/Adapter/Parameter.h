@@ -45,11 +45,10 @@ public:
     Parameter(Handler* handler, DataModel* dataModel);
     virtual ~Parameter();
 
-    const void Values(const std::vector<std::string>& parameterNames, std::map<std::vector<Data>, WebPAStatus>& parametersList) const;
+    const void Values(const std::vector<std::string>& parameterNames, std::vector<std::pair<std::vector<Data>, WebPAStatus>>& parametersList) const;
     WebPAStatus Values(const std::vector<Data>& parameters, std::vector<WebPAStatus>& status);
 
 private:
-    const WebPAStatus Values(const std::string& parameterName, std::vector<Data>& parameters) const;
     WebPAStatus Values(const Data& parameter);
 
 private:
@@ -49,6 +49,9 @@ Handler::Handler()
     : _systemLibraries()
     , _signaled(false, true)
     , _adminLock()
+    , _fetchTimeout(DefaultFetchTimeout)
+    , _abandoned()
+    , _jobLock()
 {
     TRACE(Trace::Information, (string(__FUNCTION__)));
     _notificationCallback = new NotificationCallback(this);
@@ -66,11 +69,23 @@ Handler::~Handler()
         Wait(Thread::STOPPED, Core::infinite);
     }
 
+    _jobLock.Lock();
+    std::list<Core::ProxyType<Job>> abandoned(std::move(_abandoned));
+    _jobLock.Unlock();
+
+    // Waits for the ones that are still running.
+    for (const Core::ProxyType<Job>& job : abandoned) {
+        Core::IWorkerPool::Instance().Revoke(Core::ProxyType<Core::IDispatch>(job));
+    }
+
     if (_notificationCallback) {
         delete _notificationCallback;
     }
     for (auto& profileController: _systemProfileControllers) {
         profileController.second.control->Deinitialize();
+        delete profileController.second.lock;
+        delete profileController.second.statistics;
+        delete profileController.second.stalled;
     }
     _systemLibraries.clear();
 }
@@ -107,6 +122,9 @@ uint32_t Handler::Configure(PluginHost::IShell* service)
             systemProfileController.control = WebPAProfileInstance(name.c_str());
             if (systemProfileController.control) {
                 systemProfileController.control->Initialize();
+                systemProfileController.lock = new Core::CriticalSection();
+                systemProfileController.statistics = new Statistics();
+                systemProfileController.stalled = new std::atomic<uint32_t>(0);
                 _systemProfileControllers.insert(std::pair<const std::string, SystemProfileController>(index.Current().ProfileName.Value(), systemProfileController));
             }
         } else {
@@ -117,6 +135,9 @@ uint32_t Handler::Configure(PluginHost::IShell* service)
     if (_systemProfileControllers.size() == 0) {
         TRACE(Trace::Information, (_T("No adapter provided")));
     }
+
+    _fetchTimeout = config.FetchTimeout.Value();
+
     return Core::ERROR_NONE;
 }
 
@@ -126,7 +147,9 @@ uint32_t Handler::Worker()
     if (IsRunning() == true) {
 
         for (auto& profileController: _systemProfileControllers) {
+            profileController.second.lock->Lock();
             profileController.second.control->CheckForUpdates();
+            profileController.second.lock->Unlock();
         }
 
         _signaled.Lock(MaxWaitTime);
@@ -140,10 +163,12 @@ const FaultCode Handler::Parameter(Data& parameter) const
     FaultCode ret = FaultCode::NoFault;
 
     /* Find the respective manager and forward the request*/
-    const IProfileControl* control = GetProfileController(parameter.Name());
+    const SystemProfileController* controller = GetSystemProfileController(parameter.Name());
 
-    if (control) {
-        ret = control->Parameter(parameter);
+    if (controller) {
+        controller->lock->Lock();
+        ret = static_cast<const IProfileControl*>(controller->control)->Parameter(parameter);
+        controller->lock->Unlock();
     }
 
     return ret;
@@ -155,10 +180,12 @@ FaultCode Handler::Parameter(const Data& parameter)
     FaultCode ret = FaultCode::NoFault;
 
     /* Find the respective manager and forward the request*/
-    IProfileControl* control = GetProfileController(parameter.Name());
+    const SystemProfileController* controller = GetSystemProfileController(parameter.Name());
 
-    if (control) {
-        ret = control->Parameter(parameter);
+    if (controller) {
+        controller->lock->Lock();
+        ret = controller->control->Parameter(parameter);
+        controller->lock->Unlock();
     }
 
     return ret;
@@ -170,10 +197,12 @@ const FaultCode Handler::Attribute(Data& parameter) const
     FaultCode ret = FaultCode::NoFault;
 
     /* Find the respective manager and forward the request*/
-    const IProfileControl* control = GetProfileController(parameter.Name());
+    const SystemProfileController* controller = GetSystemProfileController(parameter.Name());
 
-    if (control) {
-        ret = control->Attribute(parameter);
+    if (controller) {
+        controller->lock->Lock();
+        ret = static_cast<const IProfileControl*>(controller->control)->Attribute(parameter);
+        controller->lock->Unlock();
     }
     return ret;
 }
@@ -184,9 +213,11 @@ FaultCode Handler::Attribute(const Data& parameter)
     FaultCode ret = FaultCode::NoFault;
 
     /* Find the respective manager and forward the request*/
-    IProfileControl* control = GetProfileController(parameter.Name());
-    if (control) {
-        ret = control->Attribute(parameter);
+    const SystemProfileController* controller = GetSystemProfileController(parameter.Name());
+    if (controller) {
+        controller->lock->Lock();
+        ret = controller->control->Attribute(parameter);
+        controller->lock->Unlock();
     }
 
     return ret;
@@ -219,16 +250,16 @@ void Handler::ConfigureProfileControllers()
     }
 }
 
-IProfileControl* Handler::GetProfileController(const std::string& name)
+const Handler::SystemProfileController* Handler::GetSystemProfileController(const std::string& name) const
 {
     TRACE(Trace::Information, (string(__FUNCTION__)));
-    IProfileControl* pRet = nullptr;
+    const SystemProfileController* pRet = nullptr;
 
     std::vector<std::string> paramComponents = SplitParam(name, '.');
     if (paramComponents.size() > 1) {
-        std::map<const std::string, SystemProfileController>::iterator index(_systemProfileControllers.find(paramComponents[1]));
+        std::map<const std::string, SystemProfileController>::const_iterator index(_systemProfileControllers.find(paramComponents[1]));
         if (_systemProfileControllers.end() != index) {
-            pRet = index->second.control;
+            pRet = &(index->second);
         } else {
             TRACE(Trace::Information, (_T("Could not able to find Profile controller for %s"), name.c_str()));
         }
@@ -237,22 +268,162 @@ IProfileControl* Handler::GetProfileController(const std::string& name)
     return pRet;
 }
 
-const IProfileControl* Handler::GetProfileController(const std::string& name) const
+void Handler::Parameters(std::vector<Request>& requests) const
 {
     TRACE(Trace::Information, (string(__FUNCTION__)));
-    const IProfileControl* pRet = nullptr;
 
-    std::vector<std::string> paramComponents = SplitParam(name, '.');
-    if (paramComponents.size() > 1) {
-        std::map<const std::string, SystemProfileController>::const_iterator index(_systemProfileControllers.find(paramComponents[1]));
-        if (_systemProfileControllers.end() != index) {
-            pRet = index->second.control;
+    Core::ProxyType<Batch> batch(Core::ProxyType<Batch>::Create(requests));
+
+    for (uint32_t index = 0; index < requests.size(); index++) {
+        const SystemProfileController* controller = GetSystemProfileController(requests[index].Value.Name());
+
+        if ((controller != nullptr) && (controller->stalled->load() != 0)) {
+            // Still busy with a fetch nobody waits for anymore, failed right away instead of
+            // taking a worker from the pool to wait for it.
+            TRACE(Trace::Error, (_T("Profile %s is stalled, failing %s"), controller->name.c_str(), requests[index].Value.Name().c_str()));
+        } else if (controller) {
+            batch->Add(controller, index);
         } else {
-            TRACE(Trace::Information, (_T("Could not able to find Profile controller for %s"), name.c_str()));
+            // Like a single get, a parameter without a profile is not a fault
+            requests[index].Status = FaultCode::NoFault;
+            requests[index].Completed = true;
         }
     }
 
-    return pRet;
+    // Fetching is always done on the worker pool, also for a single profile, so the requester is
+    // never held up longer than the deadline.
+    std::vector<Core::ProxyType<Job>> jobs;
+    for (uint32_t group = 0; group < batch->Groups(); group++) {
+        jobs.push_back(Core::ProxyType<Job>::Create(batch, group));
+        Core::IWorkerPool::Instance().Submit(Core::ProxyType<Core::IDispatch>(jobs.back()));
+    }
+
+    if (batch->Wait(_fetchTimeout) == false) {
+        TRACE(Trace::Error, (_T("Deadline of %d ms passed, returning a partial result"), _fetchTimeout));
+    }
+    batch->Collect(requests);
+
+    // What is still busy has to be revoked before the profiles go away.
+    _jobLock.Lock();
+    _abandoned.remove_if([](const Core::ProxyType<Job>& job) { return (job->IsCompleted() == true); });
+    for (const Core::ProxyType<Job>& job : jobs) {
+        if (job->IsCompleted() == false) {
+            _abandoned.push_back(job);
+        }
+    }
+    _jobLock.Unlock();
+}
+
+void Handler::Batch::Add(const SystemProfileController* controller, const uint32_t index)
+{
+    std::vector<Group>::iterator group(_groups.begin());
+    while ((group != _groups.end()) && (group->Controller != controller)) {
+        group++;
+    }
+    if (group == _groups.end()) {
+        group = _groups.emplace(_groups.end(), controller);
+        _pending++;
+    }
+    group->Indexes.push_back(index);
+}
+
+void Handler::Batch::Fetch(const uint32_t group)
+{
+    const SystemProfileController* controller = _groups[group].Controller;
+    const uint64_t start = Core::Time::Now().Ticks();
+    uint32_t count = 0;
+
+    _adminLock.Lock();
+    const bool late = _abandoned;
+    _adminLock.Unlock();
+
+    // Nobody waits for it anymore, the profile is not even called.
+    if (late == false) {
+        controller->lock->Lock();
+
+        for (const uint32_t index : _groups[group].Indexes) {
+            _adminLock.Lock();
+            Data value(_requests[index].Value);
+            bool abandoned = _abandoned;
+            _adminLock.Unlock();
+
+            if (abandoned == true) {
+                break;
+            }
+
+            FaultCode status = static_cast<const IProfileControl*>(controller->control)->Parameter(value);
+            count++;
+
+            _adminLock.Lock();
+            _requests[index].Value = value;
+            _requests[index].Status = status;
+            _requests[index].Completed = true;
+            _adminLock.Unlock();
+        }
+
+        controller->lock->Unlock();
+    }
+
+    const uint64_t duration = Core::Time::Now().Ticks() - start;
+    controller->statistics->Measured(count, duration);
+
+    _adminLock.Lock();
+    if (_abandoned == true) {
+        // Collect counted it as stalled.
+        (*controller->stalled)--;
+    }
+    _groups[group].Completed = true;
+    _groups[group].Duration = duration;
+    _pending--;
+    if (_pending == 0) {
+        _done.SetEvent();
+    }
+    _adminLock.Unlock();
+}
+
+bool Handler::Batch::IsCompleted(const uint32_t group)
+{
+    _adminLock.Lock();
+    const bool completed = _groups[group].Completed;
+    _adminLock.Unlock();
+
+    return completed;
+}
+
+bool Handler::Batch::Wait(const uint32_t waitTime)
+{
+    bool completed = true;
+
+    _adminLock.Lock();
+    if (_pending != 0) {
+        _adminLock.Unlock();
+        completed = (_done.Lock(waitTime) == Core::ERROR_NONE);
+    } else {
+        _adminLock.Unlock();
+    }
+    return completed;
+}
+
+void Handler::Batch::Collect(std::vector<Request>& requests)
+{
+    _adminLock.Lock();
+
+    _abandoned = true;
+
+    for (const Group& group : _groups) {
+        for (const uint32_t index : group.Indexes) {
+            if (_requests[index].Completed == true) {
+                requests[index] = _requests[index];
+            }
+        }
+        if (group.Completed == false) {
+            group.Controller->statistics->TimedOut();
+            (*group.Controller->stalled)++;
+        }
+        group.Controller->statistics->Report(group.Controller->name, (group.Completed == false), group.Duration);
+    }
+
+    _adminLock.Unlock();
 }
 
 NotificationHandler* NotificationHandler::_instance = nullptr;
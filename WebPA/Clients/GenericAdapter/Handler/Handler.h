@@ -52,6 +52,7 @@ private:
 class Handler : public Core::Thread {
 private:
     static constexpr uint32_t MaxWaitTime = 60000;
+    static constexpr uint32_t DefaultFetchTimeout = 10000; // mS
 
 public:
     class Config : public Core::JSON::Container {
@@ -90,9 +91,11 @@ public:
             : Core::JSON::Container()
             , Location()
             , Profiles()
+            , FetchTimeout(DefaultFetchTimeout)
         {
             Add(_T("location"), &Location);
             Add(_T("profiles"), &Profiles);
+            Add(_T("fetchtimeout"), &FetchTimeout);
         }
         ~Config()
         {
@@ -101,6 +104,7 @@ public:
     public:
         Core::JSON::String Location;
         Core::JSON::ArrayType<Link> Profiles;
+        Core::JSON::DecUInt32 FetchTimeout;
     };
 
     class NotificationCallback : public IProfileControl::ICallback {
@@ -125,9 +129,179 @@ public:
     };
 
 public:
+    // Latency of the calls into a profile, to find the ones that slow down a GET.
+    class Statistics {
+    private:
+        static constexpr uint64_t SlowFetch = 1000000; // uS, for all parameters of a profile in a single GET
+
+    public:
+        Statistics(const Statistics&) = delete;
+        Statistics& operator=(const Statistics&) = delete;
+
+        Statistics()
+            : _adminLock()
+            , _parameters(0)
+            , _total(0)
+            , _max(0)
+            , _timeouts(0)
+        {
+        }
+        ~Statistics()
+        {
+        }
+
+    public:
+        void Measured(const uint32_t parameters, const uint64_t duration)
+        {
+            _adminLock.Lock();
+            _parameters += parameters;
+            _total += duration;
+            if (duration > _max) {
+                _max = duration;
+            }
+            _adminLock.Unlock();
+        }
+        void TimedOut()
+        {
+            _adminLock.Lock();
+            _timeouts++;
+            _adminLock.Unlock();
+        }
+        // Only a profile that timed out or was slow in this GET is worth a trace.
+        void Report(const std::string& profile, const bool timedOut, const uint64_t duration) const
+        {
+            if ((timedOut == true) || (duration >= SlowFetch)) {
+                _adminLock.Lock();
+                if (timedOut == true) {
+                    TRACE_GLOBAL(Trace::Information, (_T("Profile %s timed out: %llu parameters, %llu us per parameter, slowest batch %llu us, %u timeouts"),
+                        profile.c_str(), _parameters, (_parameters != 0 ? (_total / _parameters) : 0), _max, _timeouts));
+                } else {
+                    TRACE_GLOBAL(Trace::Information, (_T("Profile %s took %llu us: %llu parameters, %llu us per parameter, slowest batch %llu us, %u timeouts"),
+                        profile.c_str(), duration, _parameters, (_parameters != 0 ? (_total / _parameters) : 0), _max, _timeouts));
+                }
+                _adminLock.Unlock();
+            }
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        uint64_t _parameters;
+        uint64_t _total; // uS
+        uint64_t _max; // uS, for all parameters of a profile in a single GET
+        uint32_t _timeouts;
+    };
+
     struct SystemProfileController {
         std::string name;
         IProfileControl* control;
+        Core::CriticalSection* lock; // A profile is called by one thread at a time
+        Statistics* statistics;
+        std::atomic<uint32_t>* stalled; // Fetches that were abandoned and did not return yet
+    };
+
+    // One parameter of a batched GET. Status and Value are only what the profile reported if the
+    // request is Completed, otherwise the deadline passed before the profile got to it.
+    struct Request {
+        Request(const Data& value)
+            : Value(value)
+            , Status(FaultCode::Error)
+            , Completed(false)
+        {
+        }
+
+        Data Value;
+        FaultCode Status;
+        bool Completed;
+    };
+
+private:
+    // The parameters of a batched GET, grouped per profile. The groups are fetched concurrently on
+    // the worker pool, a group that is still busy when the requester stops waiting keeps this alive
+    // and its results are dropped.
+    class Batch {
+    private:
+        struct Group {
+            Group(const SystemProfileController* controller)
+                : Controller(controller)
+                , Indexes()
+                , Completed(false)
+                , Duration(0)
+            {
+            }
+
+            const SystemProfileController* Controller;
+            std::vector<uint32_t> Indexes;
+            bool Completed;
+            uint64_t Duration; // uS
+        };
+
+    public:
+        Batch() = delete;
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+        Batch(const std::vector<Request>& requests)
+            : _adminLock()
+            , _requests(requests)
+            , _groups()
+            , _pending(0)
+            , _done(false, true)
+            , _abandoned(false)
+        {
+        }
+        ~Batch()
+        {
+        }
+
+    public:
+        void Add(const SystemProfileController* controller, const uint32_t index);
+        uint32_t Groups() const
+        {
+            return (static_cast<uint32_t>(_groups.size()));
+        }
+        void Fetch(const uint32_t group);
+        bool IsCompleted(const uint32_t group);
+        bool Wait(const uint32_t waitTime);
+        void Collect(std::vector<Request>& requests);
+
+    private:
+        Core::CriticalSection _adminLock;
+        std::vector<Request> _requests;
+        std::vector<Group> _groups;
+        uint32_t _pending;
+        Core::Event _done;
+        bool _abandoned;
+    };
+
+    // Fetches one group of a batch, on the worker pool.
+    class Job : public Core::IDispatch {
+    public:
+        Job() = delete;
+        Job(const Job&) = delete;
+        Job& operator=(const Job&) = delete;
+
+        Job(const Core::ProxyType<Batch>& batch, const uint32_t group)
+            : _batch(batch)
+            , _group(group)
+        {
+        }
+        ~Job() override
+        {
+        }
+
+    public:
+        void Dispatch() override
+        {
+            _batch->Fetch(_group);
+        }
+        bool IsCompleted() const
+        {
+            return (_batch->IsCompleted(_group));
+        }
+
+    private:
+        Core::ProxyType<Batch> _batch;
+        const uint32_t _group;
     };
 
 public:
@@ -140,6 +314,7 @@ public:
 
     const FaultCode Parameter(Data& value) const;
     FaultCode Parameter(const Data& value);
+    void Parameters(std::vector<Request>& requests) const;
 
     const FaultCode Attribute(Data& value) const;
     FaultCode Attribute(const Data& value);
@@ -150,8 +325,7 @@ public:
 
 private:
     virtual uint32_t Worker();
-    IProfileControl* GetProfileController(const std::string& value);
-    const IProfileControl* GetProfileController(const std::string& value) const;
+    const SystemProfileController* GetSystemProfileController(const std::string& value) const;
     std::vector<std::string> SplitParam(std::string parameter, char delimeter) const;
 
 private:
@@ -164,6 +338,10 @@ private:
 
     Core::Event _signaled;
     Core::CriticalSection _adminLock;
+
+    uint32_t _fetchTimeout;
+    mutable std::list<Core::ProxyType<Job>> _abandoned; // Jobs still busy after their deadline
+    mutable Core::CriticalSection _jobLock;
 };
 
 }
@@ -26,6 +26,79 @@
 namespace WPEFramework {
 
 DeviceInfo::Process::ProcessList DeviceInfo::Process::_processList;
+DeviceInfo::ProcessTable DeviceInfo::_processTable;
+
+DeviceInfo::ProcessTable::ProcessTable()
+    : _adminLock()
+    , _entries()
+    , _expiry(0)
+{
+}
+
+DeviceInfo::ProcessTable::~ProcessTable()
+{
+}
+
+void DeviceInfo::ProcessTable::Refresh()
+{
+    uint64_t now = Core::Time::Now().Ticks();
+
+    if (now >= _expiry) {
+        PROCTAB* procTab = nullptr;
+
+        _entries.clear();
+
+        if ((procTab = openproc(PROC_FILLSTAT | PROC_FILLMEM)) != nullptr) {
+            proc_t procTask;
+            memset(&procTask, 0, sizeof(procTask));
+
+            while (readproc(procTab, &procTask) != nullptr) {
+                Entry entry;
+                entry.Pid = static_cast<unsigned int>(procTask.tid);
+                entry.Priority = static_cast<unsigned int>(procTask.priority * 4);
+                entry.CPUTime = static_cast<unsigned int>(procTask.utime + procTask.stime);
+                entry.Size = static_cast<unsigned int>(procTask.size * 4);
+                entry.Command.assign(procTask.cmd, strlen(procTask.cmd));
+                entry.State = procTask.state;
+                _entries.push_back(entry);
+
+                memset(&procTask, 0, sizeof(procTask));
+            }
+            closeproc(procTab);
+        } else {
+            TRACE_GLOBAL(Trace::Error, (_T("[%s:%d] Failed in openproc(), returned NULL. \n"), __func__, __LINE__));
+        }
+
+        // Take the time after the read, on a loaded system the read itself takes a while.
+        _expiry = Core::Time::Now().Add(TimeToLive).Ticks();
+    }
+}
+
+uint32_t DeviceInfo::ProcessTable::Count()
+{
+    _adminLock.Lock();
+    Refresh();
+    uint32_t count = static_cast<uint32_t>(_entries.size());
+    _adminLock.Unlock();
+
+    return count;
+}
+
+bool DeviceInfo::ProcessTable::Get(const uint32_t instance, Entry& entry)
+{
+    bool status = false;
+
+    _adminLock.Lock();
+    Refresh();
+    // Instances are numbered from 1
+    if ((instance > 0) && (instance <= _entries.size())) {
+        entry = _entries[instance - 1];
+        status = true;
+    }
+    _adminLock.Unlock();
+
+    return status;
+}
 
 DeviceInfo::Process::Process(uint32_t id)
     : _id(id)
@@ -93,29 +166,13 @@ void DeviceInfo::Process::CloseInstances()
     _processList.clear();
 }
 
-bool DeviceInfo::Process::ProcessFields(proc_t& procTask) const
+bool DeviceInfo::Process::ProcessFields(ProcessTable::Entry& entry) const
 {
-    PROCTAB* procTab = nullptr;
-    uint32_t procEntry = 0;
-    bool status = false;
-
-    if ((procTab = openproc(PROC_FILLSTAT | PROC_FILLMEM)) != nullptr) {
-        for (procEntry = 0; procEntry < _id; procEntry++) {
-            memset(&procTask, 0, sizeof(procTask));
+    bool status = _processTable.Get(_id, entry);
 
-            if (!procTab->finder(procTab, &procTask)) {
-                TRACE(Trace::Error, (_T("ProcessInstance: %d : No Entry Found In Process Profile Table\n"), procEntry));
-                break;
-            }
-        }
-        if (procTab->reader(procTab, &procTask) != nullptr) {
-            status = true;
-        }
-    } else {
-        TRACE(Trace::Error, (_T("[%s:%d] Failed in openproc(), returned NULL. \n"), __func__, __LINE__));
+    if (status == false) {
+        TRACE(Trace::Error, (_T("ProcessInstance: %d : No Entry Found In Process Profile Table\n"), _id));
     }
-
-    closeproc(procTab);
     return status;
 }
 
@@ -123,14 +180,13 @@ FaultCode DeviceInfo::Process::Pid(Data& parameter, bool& changed) const
 {
     FaultCode status = NoFault;
 
-    proc_t procTask;
-    if (ProcessFields(procTask) == true) {
-        unsigned int pid = static_cast<unsigned int>(procTask.tid);
-        if (pid != _pid) {
+    ProcessTable::Entry entry;
+    if (ProcessFields(entry) == true) {
+        if (entry.Pid != _pid) {
             changed = true;
-            _pid = pid;
+            _pid = entry.Pid;
         }
-        parameter.Value(pid);
+        parameter.Value(entry.Pid);
     } else {
         status = Error;
     }
@@ -142,14 +198,13 @@ FaultCode DeviceInfo::Process::Command(Data& parameter, bool& changed) const
 {
     FaultCode status = NoFault;
 
-    proc_t procTask;
-    if (ProcessFields(procTask) == true) {
-        std::string command(procTask.cmd, strlen(procTask.cmd));
-        if (command != _command) {
+    ProcessTable::Entry entry;
+    if (ProcessFields(entry) == true) {
+        if (entry.Command != _command) {
             changed = true;
-            _command = command;
+            _command = entry.Command;
         }
-        parameter.Value(command);
+        parameter.Value(entry.Command);
     } else {
         status = Error;
     }
@@ -161,14 +216,13 @@ FaultCode DeviceInfo::Process::Size(Data& parameter, bool& changed) const
 {
     FaultCode status = NoFault;
 
-    proc_t procTask;
-    if (ProcessFields(procTask) == true) {
-        unsigned int size = static_cast<unsigned int>(procTask.size * 4);
-        if (size != _size) {
+    ProcessTable::Entry entry;
+    if (ProcessFields(entry) == true) {
+        if (entry.Size != _size) {
             changed = true;
-            _size = size;
+            _size = entry.Size;
         }
-        parameter.Value(size);
+        parameter.Value(entry.Size);
     } else {
         status = Error;
     }
@@ -180,14 +234,13 @@ FaultCode DeviceInfo::Process::Priority(Data& parameter, bool& changed) const
 {
     FaultCode status = NoFault;
 
-    proc_t procTask;
-    if (ProcessFields(procTask) == true) {
-        unsigned int priority = static_cast<unsigned int>(procTask.priority * 4);
-        if (priority != _priority) {
+    ProcessTable::Entry entry;
+    if (ProcessFields(entry) == true) {
+        if (entry.Priority != _priority) {
             changed = true;
-            _priority = priority;
+            _priority = entry.Priority;
         }
-        parameter.Value(priority);
+        parameter.Value(entry.Priority);
     } else {
         status = Error;
     }
@@ -199,14 +252,13 @@ FaultCode DeviceInfo::Process::CPUTime(Data& parameter, bool& changed) const
 {
     FaultCode status = NoFault;
 
-    proc_t procTask;
-    if (ProcessFields(procTask) == true) {
-        unsigned int cpuTime = static_cast<unsigned int>(procTask.utime + procTask.stime);
-        if (cpuTime != _cpuTime) {
+    ProcessTable::Entry entry;
+    if (ProcessFields(entry) == true) {
+        if (entry.CPUTime != _cpuTime) {
             changed = true;
-            _cpuTime = cpuTime;
+            _cpuTime = entry.CPUTime;
         }
-        parameter.Value(cpuTime);
+        parameter.Value(entry.CPUTime);
     } else {
         status = Error;
     }
@@ -218,10 +270,10 @@ FaultCode DeviceInfo::Process::State(Data& parameter, bool& changed) const
 {
     FaultCode status = NoFault;
 
-    proc_t procTask;
-    if (ProcessFields(procTask) == true) {
+    ProcessTable::Entry entry;
+    if (ProcessFields(entry) == true) {
         std::string state;
-        switch (procTask.state) {
+        switch (entry.State) {
         case 'R':
             state = StateRunning;
             break;
@@ -499,19 +551,7 @@ FaultCode DeviceInfo::ProcessNumberOfEntries(Data& parameter, bool& changed) con
     TRACE(Trace::Information, (string(__FUNCTION__)));
     FaultCode status = NoFault;
 
-    PROCTAB* procTab = nullptr;
-    proc_t* process = nullptr;
-    int numberOfEntries = 0;
-
-    if ((procTab = openproc(PROC_FILLMEM)) != nullptr) {
-        while ((process = readproc(procTab, nullptr)) != nullptr) {
-            numberOfEntries++;
-        }
-    } else {
-        TRACE(Trace::Error, (_T("[%s:%d] Failed in openproc(), returned NULL. \n"), __func__, __LINE__));
-    }
-
-    closeproc(procTab);
+    int numberOfEntries = static_cast<int>(_processTable.Count());
 
     parameter.Value(numberOfEntries);
 
@@ -45,6 +45,41 @@ private:
     typedef std::map<std::string, std::pair<FuncPtr<DeviceInfo>::GetFunc, FuncPtr<DeviceInfo>::SetFunc>> FunctionMap;
 
 private:
+    // One read of /proc serves all fields of all process instances of a request, the table is
+    // only read again once it is older than TimeToLive. This keeps the fields of a GET on the
+    // process table consistent with each other and with ProcessNumberOfEntries.
+    class ProcessTable {
+    public:
+        static constexpr const uint32_t TimeToLive = 2000; // mS
+
+        struct Entry {
+            unsigned int Pid;
+            unsigned int Priority;
+            unsigned int CPUTime;
+            unsigned int Size;
+            std::string Command;
+            char State;
+        };
+
+    public:
+        ProcessTable(const ProcessTable&) = delete;
+        ProcessTable& operator=(const ProcessTable&) = delete;
+    public:
+        ProcessTable();
+        ~ProcessTable();
+
+        uint32_t Count();
+        bool Get(const uint32_t instance, Entry& entry);
+
+    private:
+        void Refresh();
+
+    private:
+        Core::CriticalSection _adminLock;
+        std::vector<Entry> _entries;
+        uint64_t _expiry;
+    };
+
     class Process {
     public:
     typedef std::map<uint32_t, Process*> ProcessList;
@@ -74,7 +109,7 @@ private:
         FaultCode CPUTime(Data& parameter, bool& changed) const;
         FaultCode State(Data& parameter, bool& changed) const;
 
-        bool ProcessFields(proc_t& procTask) const;
+        bool ProcessFields(ProcessTable::Entry& entry) const;
 
     private:
         uint32_t _id;
@@ -129,6 +164,8 @@ private:
     FunctionMap _functionMap;
 
     JsonData::DeviceInfo::SysteminfoData _systemInfoData;
+
+    static ProcessTable _processTable;
 };
 
 }
@@ -0,0 +1,220 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Module.h"
+#include "../Adapter/DataModel/DataModel.h"
+
+#include <chrono>
+#include <tinyxml.h>
+
+// Replays a mix of WebPA requests against the data model, as the GenericAdapter handles them
+// before anything is asked from a profile:
+//
+//    WebPADataModelBenchmark -model /usr/share/WPEFramework/WebPA/data-model.xml -requests 100000
+//
+// The requests are drawn from the model itself, instance numbers 1 to 3 for multi instance
+// objects:
+// - get (70%): a single parameter that exists, IsValidParameter();
+// - invalid (10%): a parameter that does not exist, IsValidParameter();
+// - wildcard (20%): an object, Parameters(). No profiles are loaded, so the instance counts are 0
+//   and the expansion stops at multi instance objects.
+// The results are printed as JSON, in nS per request. The exit code is the number of requests
+// that were not validated as they should.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+enum kind : uint8_t {
+    GET = 0,
+    INVALID = 1,
+    WILDCARD = 2
+};
+
+static const TCHAR* Kinds[] = { _T("get"), _T("invalid"), _T("wildcard") };
+static const TCHAR InstanceIndicator[] = _T("{i}");
+
+// The parameter names and (non instance) objects of the model.
+void Collect(const string& fileName, std::vector<string>& parameters, std::vector<string>& objects)
+{
+    TiXmlDocument document(fileName.c_str());
+
+    if (document.LoadFile() == true) {
+        TiXmlElement* object = document.RootElement();
+        while ((object != nullptr) && (strcmp(object->Value(), "object") != 0)) {
+            object = object->FirstChildElement();
+        }
+
+        for (; object != nullptr; object = object->NextSiblingElement("object")) {
+            const char* base = object->Attribute("base");
+
+            if (base != nullptr) {
+                const string name(base);
+
+                if (name.find(InstanceIndicator) == string::npos) {
+                    objects.push_back(name);
+                }
+
+                for (TiXmlElement* parameter = object->FirstChildElement("parameter"); parameter != nullptr; parameter = parameter->NextSiblingElement("parameter")) {
+                    if (parameter->Attribute("base") != nullptr) {
+                        string full(name + parameter->Attribute("base"));
+                        size_t position;
+                        uint8_t instance = 1;
+
+                        while ((position = full.find(InstanceIndicator)) != string::npos) {
+                            full.replace(position, sizeof(InstanceIndicator) - 1, Core::NumberType<uint8_t>(instance).Text());
+                            instance = (instance % 3) + 1;
+                        }
+
+                        parameters.push_back(full);
+                    }
+                }
+            }
+        }
+    }
+}
+
+class Timings {
+public:
+    Timings(const TCHAR name[])
+        : _name(name)
+        , _samples()
+    {
+    }
+
+public:
+    void Add(const uint32_t nanoseconds)
+    {
+        _samples.push_back(nanoseconds);
+    }
+    void Print(const bool last)
+    {
+        uint64_t total = 0;
+        for (const uint32_t sample : _samples) {
+            total += sample;
+        }
+
+        std::sort(_samples.begin(), _samples.end());
+
+        printf("  \"%s\": { \"requests\": %u, \"mean\": %.1f, \"p50\": %u, \"p99\": %u, \"max\": %u }%s\n",
+            _name, static_cast<uint32_t>(_samples.size()),
+            (_samples.empty() == true ? 0.0 : static_cast<double>(total) / _samples.size()),
+            (_samples.empty() == true ? 0 : _samples[_samples.size() / 2]),
+            (_samples.empty() == true ? 0 : _samples[(_samples.size() * 99) / 100]),
+            (_samples.empty() == true ? 0 : _samples.back()),
+            (last == true ? "" : ","));
+    }
+
+private:
+    const TCHAR* _name;
+    std::vector<uint32_t> _samples;
+};
+
+}
+
+int main(int argc, char** argv)
+{
+    string model(_T("data-model.xml"));
+    uint32_t requests = 100000;
+    uint32_t failures = 0;
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-model") == 0) {
+            model = argv[index + 1];
+        } else if (strcmp(argv[index], "-requests") == 0) {
+            requests = static_cast<uint32_t>(std::max(1, atoi(argv[index + 1])));
+        }
+    }
+
+    {
+        std::vector<string> parameters;
+        std::vector<string> objects;
+        Handler handler;
+        DataModel dataModel(&handler);
+
+        Collect(model, parameters, objects);
+
+        const uint64_t start = Core::Time::Now().Ticks();
+        const DMStatus loaded = dataModel.LoadDM(model);
+        const uint64_t load = Core::Time::Now().Ticks() - start;
+
+        if ((loaded != DM_SUCCESS) || (parameters.empty() == true) || (objects.empty() == true)) {
+            fprintf(stderr, "Could not load the data model %s\n", model.c_str());
+            failures++;
+        } else {
+            Timings timings[] = { Timings(Kinds[GET]), Timings(Kinds[INVALID]), Timings(Kinds[WILDCARD]) };
+            uint32_t expanded = 0;
+            uint32_t seed = 0x12345678;
+
+            for (uint32_t request = 0; request < requests; request++) {
+                seed = (seed * 1103515245) + 12345;
+
+                const uint32_t draw = (seed >> 8);
+                const kind type = ((draw % 10) < 7 ? GET : ((draw % 10) < 8 ? INVALID : WILDCARD));
+                std::vector<std::pair<string, string>> list;
+                string name;
+                string dataType;
+                bool valid = true;
+
+                if (type == WILDCARD) {
+                    name = objects[(draw / 10) % objects.size()];
+                } else {
+                    name = parameters[(draw / 10) % parameters.size()];
+
+                    if (type == INVALID) {
+                        name += _T("X");
+                    }
+                }
+
+                const std::chrono::steady_clock::time_point begin(std::chrono::steady_clock::now());
+
+                if (type == WILDCARD) {
+                    dataModel.Parameters(name, list);
+                } else {
+                    valid = dataModel.IsValidParameter(name, dataType);
+                }
+
+                const std::chrono::steady_clock::time_point end(std::chrono::steady_clock::now());
+
+                timings[type].Add(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+                expanded += static_cast<uint32_t>(list.size());
+
+                if (valid != (type != INVALID)) {
+                    fprintf(stderr, "%s was %s\n", name.c_str(), (valid == true ? "accepted" : "rejected"));
+                    failures++;
+                }
+            }
+
+            // load in mS, expanded is the number of parameters all wildcards expanded to.
+            printf("{\n  \"parameters\": %u,\n  \"objects\": %u,\n  \"load\": %.1f,\n  \"expanded\": %u,\n",
+                static_cast<uint32_t>(parameters.size()), static_cast<uint32_t>(objects.size()),
+                static_cast<double>(load) / Core::Time::TicksPerMillisecond, expanded);
+            timings[GET].Print(false);
+            timings[INVALID].Print(false);
+            timings[WILDCARD].Print(true);
+            printf("}\n");
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (static_cast<int>(failures));
+}
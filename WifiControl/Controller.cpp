@@ -177,9 +177,19 @@ namespace WPASupplicant {
     /* virtual */ uint16_t Controller::SendData(uint8_t* dataFrame, const uint16_t maxSendSize)
     {
         uint16_t result = 0;
+        uint8_t inflight = 0;
         _adminLock.Lock();
-        if ((_requests.size() > 0) && (_requests.front()->Message().empty() == false)) {
-            string& data = _requests.front()->Message();
+
+        // Requests that have been send, have an empty message. Skip those (and the slots of
+        // send requests that were revoked) to find the next one in line.
+        std::list<Request*>::iterator index(_requests.begin());
+        while ((index != _requests.end()) && (((*index) == nullptr) || ((*index)->Message().empty() == true))) {
+            inflight++;
+            index++;
+        }
+
+        if ((index != _requests.end()) && (inflight < MaxPipelineDepth)) {
+            string& data = (*index)->Message();
             TRACE(Communication, (_T("Send: [%s]"), data.c_str()));
             result = (data.length() > maxSendSize ? maxSendSize : data.length());
             memcpy(dataFrame, data.c_str(), result);
@@ -191,9 +201,10 @@ namespace WPASupplicant {
     /* virtual */ uint16_t Controller::ReceiveData(uint8_t* dataFrame, const uint16_t receivedSize)
     {
 
-        string response = string(reinterpret_cast<const char*>(dataFrame), (dataFrame[receivedSize - 1] == '\n' ? receivedSize - 1 : receivedSize));
+        // An empty reply is still the reply to the request in line.
+        string response = (receivedSize == 0 ? string() : string(reinterpret_cast<const char*>(dataFrame), (dataFrame[receivedSize - 1] == '\n' ? receivedSize - 1 : receivedSize)));
 
-        if (response[0] == '<') {
+        if ((response.empty() == false) && (response[0] == '<')) {
 
             uint32_t number = 0;
             uint16_t index = 1;
@@ -259,29 +270,32 @@ namespace WPASupplicant {
                 else if ((event == CTRL_EVENT_CONNECTED) || (event == WPS_AP_AVAILABLE)) {
                     _statusRequest.Event(event.Value());
                     Submit(&_statusRequest);
+                } else if ((event.Value() == CTRL_EVENT_SCAN_STARTED)) {
+                    // Collect the BSS additions of this scan, to request their details in one go.
+                    _adminLock.Lock();
+                    _collecting = true;
+                    _adminLock.Unlock();
                 } else if ((event.Value() == CTRL_EVENT_SCAN_RESULTS)) {
                     _adminLock.Lock();
-                    if (_scanRequest.Set() == true) {
-                        _scanRequest.Event(event.Value());
-                        _adminLock.Unlock();
-                        Submit(&_scanRequest);
-                    } else {
-                        _adminLock.Unlock();
-                    }
+                    _collecting = false;
+                    _refresh = true;
+                    _scanRequest.Event(event.Value());
+                    Reevaluate();
+                    _adminLock.Unlock();
                 } else if ((event == CTRL_EVENT_BSS_ADDED) || (event == CTRL_EVENT_BSS_REMOVED)) {
 
                     ASSERT(position != string::npos);
 
                     Core::TextFragment infoLine(message, position, message.length() - position);
 
-                    // extract the Network ID from the list
+                    // extract the BSS ID from the list
                     uint16_t index = infoLine.ForwardSkip(_T(" \t"), 0);
+                    uint16_t end = infoLine.ForwardFind(_T(" \t"), index);
 
-                    // Skip over the Network ID
-                    index = infoLine.ForwardFind(_T(" \t"), index);
+                    uint32_t id = Core::NumberType<uint32_t>(Core::TextFragment(infoLine, index, end - index));
 
                     // Skip this white space then we are at the BSSID
-                    index = infoLine.ForwardSkip(_T(" \t"), index);
+                    index = infoLine.ForwardSkip(_T(" \t"), end);
 
                     // now take out the BSSID
                     uint64_t bssid = BSSID(Core::TextFragment(infoLine, index, infoLine.Length() - index).Text());
@@ -289,13 +303,21 @@ namespace WPASupplicant {
                     _adminLock.Lock();
 
                     // Let see what we need to do with this BSSID, add or remove :-)
-                    if ((event == CTRL_EVENT_BSS_ADDED) && (_detailRequest.Set(bssid) == true)) {
-                        // send out a request for detail.
-                        _adminLock.Unlock();
-                        Submit(&_detailRequest);
-                        _adminLock.Lock();
+                    if (event == CTRL_EVENT_BSS_ADDED) {
+                        if (_networks.find(bssid) == _networks.end()) {
+                            _networks[bssid].Seen(_generation, 0);
+                        }
+
+                        // The details are requested lazily, in batches.
+                        _pendingDetails.insert(id);
+
+                        if (_collecting == false) {
+                            Reevaluate();
+                        }
                     } else if (event == CTRL_EVENT_BSS_REMOVED) {
 
+                        _pendingDetails.erase(id);
+
                         NetworkInfoContainer::iterator network(_networks.find(bssid));
 
                         if (network != _networks.end()) {
@@ -323,8 +345,12 @@ namespace WPASupplicant {
                 _adminLock.Lock();
                 Request* current = _requests.front();
                 _requests.pop_front();
-                current->Processing(false);
-                current->Completed(response, false);
+
+                // A nullptr is the slot of a revoked request, its response can be dropped.
+                if (current != nullptr) {
+                    current->Processing(false);
+                    current->Completed(response, false);
+                }
 
                 _adminLock.Unlock();
 
@@ -338,12 +364,6 @@ namespace WPASupplicant {
     }
     // These methods (add/add/update) are assumed to be running in a locked context.
     // Completion of requests are running in a locked context, so oke to update maps/lists
-    void Controller::Add(const uint64_t& bssid, const NetworkInfo& entry)
-    {
-        TRACE(Communication, (_T("Added SSID: %llX - %s"), bssid, entry.SSID().c_str()));
-        _networks[bssid] = entry;
-        Reevaluate();
-    }
     void Controller::Add(const string& ssid, const bool current, const uint64_t& bssid)
     {
         TRACE(Communication, (_T("Added Network: %s"), ssid.c_str()));
@@ -365,28 +385,64 @@ namespace WPASupplicant {
     }
     void Controller::Update(const uint64_t& bssid, const string& ssid, const uint32_t id, uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys, const uint32_t throughput)
     {
-
-        bool scanInProgress = false;
-
         NetworkInfoContainer::iterator index(_networks.find(bssid));
 
         if (index != _networks.end()) {
 
-            scanInProgress = (index->second.Id() == static_cast<uint32_t>(~0));
-
             TRACE(Communication, (_T("Updated BSSID: %llX, %d"), bssid, id));
 
             index->second.Set(id, ssid, frequency, signal, pairs, keys, throughput);
         } else {
-            _networks[bssid] = NetworkInfo(id, ssid, frequency, signal, pairs, keys, throughput);
+            index = _networks.emplace(std::piecewise_construct,
+                std::forward_as_tuple(bssid),
+                std::forward_as_tuple(id, ssid, frequency, signal, pairs, keys, throughput)).first;
         }
 
-        if (scanInProgress == true) {
-            Reevaluate();
-        } else if (_callback != nullptr) {
-            _callback->Dispatch(CTRL_EVENT_NETWORK_CHANGED);
+        index->second.Seen(_generation, signal);
+        _pendingDetails.erase(id);
+    }
+    void Controller::Refresh(const uint64_t& bssid, const uint32_t id, const int32_t signal, const uint32_t age)
+    {
+        // Anything that was not seen by the supplicant for this long, is aged out. Same age
+        // as the bss_expiration_age we configure.
+        static constexpr uint32_t MaxBSSAge = 180;
+
+        NetworkInfoContainer::iterator index(_networks.find(bssid));
+
+        if (age > MaxBSSAge) {
+            if (index != _networks.end()) {
+                _networks.erase(index);
+            }
+            _pendingDetails.erase(id);
+        } else if (index != _networks.end()) {
+            index->second.Seen(_generation, signal);
+        } else {
+            // Apparently we missed its addition, get the details.
+            _networks[bssid].Seen(_generation, signal);
+            _pendingDetails.insert(id);
         }
     }
+    void Controller::Details(const bool refresh, const uint32_t last, const bool aborted)
+    {
+        if ((refresh == true) && (aborted == false)) {
+            // Everything the supplicant still knows has been seen in this generation, the rest is gone.
+            NetworkInfoContainer::iterator index(_networks.begin());
+
+            while (index != _networks.end()) {
+                if (index->second.Seen() != _generation) {
+                    TRACE(Communication, (_T("Aged out BSSID: %llX"), index->first));
+                    index = _networks.erase(index);
+                } else {
+                    index++;
+                }
+            }
+        } else if (refresh == false) {
+            // Whatever was requested and not reported, does not exist anymore.
+            _pendingDetails.erase(_pendingDetails.begin(), _pendingDetails.upper_bound(last));
+        }
+
+        Reevaluate();
+    }
 
     void Controller::Update(const string& ssid, const uint32_t id, const bool succeeded)
     {
@@ -410,25 +466,30 @@ namespace WPASupplicant {
     }
     void Controller::Reevaluate()
     {
-
-        NetworkInfoContainer::iterator index(_networks.begin());
-
-        while ((index != _networks.end()) && (index->second.HasDetail() == true)) {
-            index++;
-        }
-        if (index != _networks.end()) {
-            if (_detailRequest.Set(index->first) == true) {
-                // send out a request for detail.
-                Submit(&_detailRequest);
-            }
-        } else if (_enabled.size() == 0) {
-            // send out a request for the network list
-            if (_networkRequest.Set() == true) {
-                // send out a request for detail.
-                Submit(&_networkRequest);
-            }
+        if (_detailRequest.InProgress() == true) {
+            // Once the details are in, we will be back.
+        } else if ((_refresh == true) && (_detailRequest.Set(0, ~0, true) == true)) {
+            // Refresh the signal level and age of all entries in one go.
+            _refresh = false;
+            _generation++;
+            Submit(&_detailRequest);
+        } else if ((_pendingDetails.empty() == false) && (_collecting == false) && (_detailRequest.Set(*(_pendingDetails.begin()), *(_pendingDetails.rbegin()), false) == true)) {
+            // send out a request for the details of all new entries.
+            Submit(&_detailRequest);
         } else {
-            _callback->Dispatch(CTRL_EVENT_NETWORK_CHANGED);
+            // All details are in, the scan is done, whatever the state of the network list. An
+            // empty network list does not bring us back here.
+            _scanRequest.Completed();
+
+            if (_enabled.size() == 0) {
+                // send out a request for the network list
+                if (_networkRequest.Set() == true) {
+                    // send out a request for detail.
+                    Submit(&_networkRequest);
+                }
+            } else if (_callback != nullptr) {
+                _callback->Dispatch(CTRL_EVENT_NETWORK_CHANGED);
+            }
         }
     }
 }
@@ -36,6 +36,12 @@ namespace WPASupplicant {
         static uint64_t BSSID(const string& bssid);
 
     public:
+        // Cost of the last BSS refresh or details round, continuations of truncated ranges included.
+        struct DetailTiming {
+            uint32_t Entries;
+            uint32_t Duration; // uS, from the request to the last reply
+            uint32_t Parsing; // uS
+        };
         enum events {
             CTRL_EVENT_SCAN_STARTED,
             CTRL_EVENT_SCAN_RESULTS,
@@ -123,6 +129,10 @@ namespace WPASupplicant {
 
     private:
         static constexpr uint32_t MaxConnectionTime = 3000;
+        // Number of requests that can be send to the supplicant, before the first response
+        // is received. The supplicant answers in order, so responses are matched to the
+        // requests in the order they were send.
+        static constexpr uint8_t MaxPipelineDepth = 8;
 
         Controller() = delete;
         Controller(const Controller&) = delete;
@@ -221,9 +231,11 @@ namespace WPASupplicant {
                 , _id(~0)
                 , _throughput(0)
                 , _hidden(true)
+                , _seen(0)
             {
             }
             NetworkInfo(const uint32_t id, const string& ssid, const uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys, const uint32_t throughput)
+                : _seen(0)
             {
                 Set(id, ssid, frequency, signal, pairs, keys, throughput);
             }
@@ -236,6 +248,7 @@ namespace WPASupplicant {
                 , _id(copy._id)
                 , _throughput(copy._throughput)
                 , _hidden(copy._hidden)
+                , _seen(copy._seen)
             {
             }
             ~NetworkInfo()
@@ -252,6 +265,7 @@ namespace WPASupplicant {
                 _id = rhs._id;
                 _throughput = rhs._throughput;
                 _hidden = rhs._hidden;
+                _seen = rhs._seen;
 
                 return (*this);
             }
@@ -267,7 +281,13 @@ namespace WPASupplicant {
             uint32_t Key() const { return _key; }
             uint32_t Throughput() const { return _throughput; }
             bool IsHidden() const { return _hidden; }
+            uint32_t Seen() const { return _seen; }
 
+            void Seen(const uint32_t generation, const int32_t signal)
+            {
+                _seen = generation;
+                _signal = signal;
+            }
             void Set(const string& ssid, const uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys)
             {
                 _frequency = frequency;
@@ -307,6 +327,7 @@ namespace WPASupplicant {
             uint32_t _id;
             uint32_t _throughput;
             bool _hidden;
+            uint32_t _seen;
         };
         class Request {
         private:
@@ -376,7 +397,7 @@ namespace WPASupplicant {
 #endif // __DEBUG__
             bool _settable;
         };
-        class ScanRequest : public Request {
+        class ScanRequest {
         private:
             ScanRequest() = delete;
             ScanRequest(const ScanRequest&) = delete;
@@ -384,13 +405,12 @@ namespace WPASupplicant {
 
         public:
             ScanRequest(Controller& parent)
-                : Request()
-                , _scanning(false)
+                : _scanning(false)
                 , _parent(parent)
                 , _eventReporting(~0)
             {
             }
-            virtual ~ScanRequest()
+            ~ScanRequest()
             {
             }
 
@@ -411,67 +431,19 @@ namespace WPASupplicant {
             {
                 return (_scanning);
             }
-            bool Set()
-            {
-                return (Request::Set(string(_TXT("SCAN_RESULTS"))));
-            }
             inline void Event(const events value)
             {
                 _eventReporting = value;
             }
-            virtual void Completed(const string& response, const bool abort) override
+            // The BSS table is kept up to date through the BSS events, once all details of
+            // a scan are in, report the results.
+            void Completed()
             {
-                if (abort == false) {
-                    Core::TextFragment data(response.c_str(), response.length());
-                    uint32_t marker = data.ForwardFind('\n');
-                    uint32_t markerEnd = data.ForwardFind('\n', marker + 1);
-
-                    while (marker != markerEnd) {
-
-                        Core::TextFragment element(data, marker + 1, (markerEnd - marker - 1));
-                        marker = markerEnd;
-                        markerEnd = data.ForwardFind('\n', marker + 1);
-                        NetworkInfo newEntry;
-                        _parent.Add(Transform(element, newEntry), newEntry);
-                    }
-                }
                 if (_eventReporting != static_cast<uint32_t>(~0)) {
                     _parent.Notify(static_cast<events>(_eventReporting));
                     _eventReporting = static_cast<uint32_t>(~0);
+                    _scanning = false;
                 }
-                _scanning = false;
-            }
-
-        private:
-            uint64_t Transform(const Core::TextFragment& infoLine, NetworkInfo& source)
-            {
-                // First thing we find will be 6 bytes...
-                uint64_t bssid = BSSID(infoLine.Text());
-
-                // Next is the frequency
-                uint16_t index = infoLine.ForwardSkip(_T(" \t"), 18);
-                uint16_t end = infoLine.ForwardFind(_T(" \t"), index);
-
-                uint32_t frequency = Core::NumberType<uint32_t>(Core::TextFragment(infoLine, index, end - index));
-
-                // Next we will find the Signal Strength
-                index = infoLine.ForwardSkip(_T(" \t"), end);
-                end = infoLine.ForwardFind(_T(" \t"), index);
-
-                int32_t signal = Core::NumberType<int32_t>(Core::TextFragment(infoLine, index, end - index));
-
-                // Extract the flags from the information
-                index = infoLine.ForwardSkip(_T(" \t"), end);
-                end = infoLine.ForwardFind(_T(" \t"), index);
-
-                uint32_t keys = 0;
-                uint16_t pairs = KeyPair(Core::TextFragment(infoLine, index, end - index), keys);
-
-                // And last but not least, we will find the SSID
-                index = infoLine.ForwardSkip(_T(" \t"), end);
-                source.Set(Core::TextFragment(infoLine, index, infoLine.Length() - index).Text(), frequency, signal, pairs, keys);
-
-                return (bssid);
             }
 
         private:
@@ -614,63 +586,141 @@ namespace WPASupplicant {
             DetailRequest(const DetailRequest&) = delete;
             DetailRequest& operator=(const DetailRequest&) = delete;
 
+            // Fields to report for a BSS (WPA_BSS_MASK_* in wpa_ctrl.h). A refresh only needs the
+            // id, bssid, level and age of all entries (0x20283), new entries need the id, bssid,
+            // freq, level, flags, ssid and est_throughput (0x121887). Both with delimiters.
+            static constexpr const TCHAR* RefreshMask = _T("0x20283");
+            static constexpr const TCHAR* DetailMask = _T("0x121887");
+
         public:
             DetailRequest(Controller& parent)
                 : Request()
                 , _parent(parent)
+                , _last(0)
+                , _refresh(false)
+                , _started(0)
+                , _parsing(0)
+                , _entries(0)
+                , _timing()
             {
+                _timing[0] = { 0, 0, 0 };
+                _timing[1] = { 0, 0, 0 };
             }
             virtual ~DetailRequest()
             {
             }
 
         public:
-            bool Set(const uint64_t& bssid)
+            inline bool IsRefresh() const
+            {
+                return (_refresh);
+            }
+            inline const DetailTiming& Timing(const bool refresh) const
             {
-                if (Request::Set(string(_TXT("BSS ")) + _parent.BSSID(bssid)) == true) {
-                    _bssid = bssid;
+                return (_timing[refresh ? 1 : 0]);
+            }
+            // Request the details of the BSS entries with an id in the range [first, last], the
+            // supplicant truncates large ranges, the remainder is requested on completion.
+            bool Set(const uint32_t first, const uint32_t last, const bool refresh)
+            {
+                string command(string(_TXT("BSS RANGE=")) + Core::NumberType<uint32_t>(first).Text() + '-');
+
+                if (last != static_cast<uint32_t>(~0)) {
+                    command += Core::NumberType<uint32_t>(last).Text();
+                }
+                command += _T(" MASK=");
+                if (refresh == true) {
+                    command += RefreshMask;
+                } else {
+                    command += DetailMask;
+                }
+
+                if (Request::Set(command) == true) {
+                    if (_started == 0) {
+                        // This is not a continuation of a truncated range, start measuring.
+                        _started = Core::Time::Now().Ticks();
+                        _parsing = 0;
+                        _entries = 0;
+                    }
+                    _last = last;
+                    _refresh = refresh;
                     return (true);
                 }
                 return (false);
             }
             virtual void Completed(const string& response, const bool abort) override
             {
+                bool complete = true;
+
                 if (abort == false) {
+                    const uint64_t start(Core::Time::Now().Ticks());
                     Core::TextFragment data(response);
 
+                    uint64_t bssid = 0;
                     string ssid;
-                    uint32_t id = static_cast<uint32_t>(~1);
+                    uint32_t id = static_cast<uint32_t>(~0);
+                    uint32_t lastId = static_cast<uint32_t>(~0);
                     uint32_t freq = 0;
                     int32_t signal = 0;
+                    uint32_t age = 0;
                     uint16_t pair = 0;
                     uint32_t keys = 0;
                     uint32_t throughput = 0;
                     uint32_t marker = 0;
                     uint32_t markerEnd = data.ForwardFind('\n', marker);
+                    bool end = false;
 
                     while (marker != markerEnd) {
 
-                        Core::TextSegmentIterator index(Core::TextFragment(data, marker, (markerEnd - marker)), false, '=');
-
-                        if (index.Next() == true) {
-
-                            string name(index.Current().Text());
+                        Core::TextFragment line(data, marker, (markerEnd - marker));
+
+                        if ((line == _T("====")) || (line == _T("####"))) {
+                            // End of this BSS entry, update the table. The last entry the supplicant
+                            // has, ends with #### instead.
+                            end = end || (line == _T("####"));
+                            if (bssid != 0) {
+                                if (_refresh == true) {
+                                    _parent.Refresh(bssid, id, signal, age);
+                                } else {
+                                    _parent.Update(bssid, ssid, id, freq, signal, pair, keys, throughput);
+                                }
+                                _entries++;
+                            }
+                            lastId = id;
+                            bssid = 0;
+                            ssid.clear();
+                            id = static_cast<uint32_t>(~0);
+                            freq = 0;
+                            signal = 0;
+                            age = 0;
+                            pair = 0;
+                            keys = 0;
+                            throughput = 0;
+                        } else {
+                            Core::TextSegmentIterator index(line, false, '=');
 
                             if (index.Next() == true) {
-                                if (name == _T("id")) {
-                                    id = Core::NumberType<uint32_t>(index.Current());
-                                } else if (name == _T("est_throughput")) {
-                                    throughput = Core::NumberType<uint32_t>(index.Current());
-                                } else if (name == _T("ssid")) {
-                                    ssid = index.Current().Text();
-                                } else if (name == _T("freq")) {
-                                    freq = Core::NumberType<uint32_t>(index.Current());
-                                } else if (name == _T("level")) {
-                                    signal = Core::NumberType<int32_t>(index.Current());
-                                } else if (name == _T("level")) {
-                                    signal = Core::NumberType<int32_t>(index.Current());
-                                } else if (name == _T("flags")) {
-                                    pair = KeyPair(index.Current(), keys);
+
+                                const Core::TextFragment name(index.Current());
+
+                                if (index.Next() == true) {
+                                    if (name == _T("id")) {
+                                        id = Core::NumberType<uint32_t>(index.Current());
+                                    } else if (name == _T("bssid")) {
+                                        bssid = Controller::BSSID(index.Current().Text());
+                                    } else if (name == _T("level")) {
+                                        signal = Core::NumberType<int32_t>(index.Current());
+                                    } else if (name == _T("age")) {
+                                        age = Core::NumberType<uint32_t>(index.Current());
+                                    } else if (name == _T("est_throughput")) {
+                                        throughput = Core::NumberType<uint32_t>(index.Current());
+                                    } else if (name == _T("ssid")) {
+                                        ssid = index.Current().Text();
+                                    } else if (name == _T("freq")) {
+                                        freq = Core::NumberType<uint32_t>(index.Current());
+                                    } else if (name == _T("flags")) {
+                                        pair = KeyPair(index.Current(), keys);
+                                    }
                                 }
                             }
                         }
@@ -678,13 +728,39 @@ namespace WPASupplicant {
                         markerEnd = data.ForwardFind('\n', marker);
                     }
 
-                    _parent.Update(_bssid, ssid, id, freq, signal, pair, keys, throughput);
+                    _parsing += (Core::Time::Now().Ticks() - start);
+
+                    // The supplicant drops the entries that do not fit in its reply. If the end of its
+                    // list was not reached, a refresh was cut short, and so were details if some in
+                    // the requested range are still missing. Continue after the last entry we got.
+                    const bool truncated = (end == false) && (lastId != static_cast<uint32_t>(~0)) && (lastId < _last) && ((_refresh == true) || (_parent.IsPending(lastId + 1, _last) == true));
+
+                    if ((truncated == true) && (Set(lastId + 1, _last, _refresh) == true)) {
+                        complete = false;
+                        _parent.Submit(this);
+                    }
+                }
+
+                if (complete == true) {
+                    DetailTiming& timing(_timing[_refresh ? 1 : 0]);
+                    timing.Entries = _entries;
+                    timing.Duration = static_cast<uint32_t>(Core::Time::Now().Ticks() - _started);
+                    timing.Parsing = static_cast<uint32_t>(_parsing);
+
+                    TRACE(Trace::Information, (_T("BSS %s of %d entries took %d mS, parsing %d uS"), (_refresh ? _T("refresh") : _T("details")), _entries, timing.Duration / static_cast<uint32_t>(Core::Time::TicksPerMillisecond), timing.Parsing));
+                    _started = 0;
+                    _parent.Details(_refresh, _last, abort);
                 }
             }
 
         private:
             Controller& _parent;
-            uint64_t _bssid;
+            uint32_t _last;
+            bool _refresh;
+            uint64_t _started;
+            uint64_t _parsing;
+            uint32_t _entries;
+            DetailTiming _timing[2];
         };
         class NetworkRequest : public Request {
         private:
@@ -967,6 +1043,10 @@ namespace WPASupplicant {
             , _adminLock()
             , _requests()
             , _networks()
+            , _pendingDetails()
+            , _generation(0)
+            , _collecting(false)
+            , _refresh(false)
             , _enabled()
             , _error(Core::ERROR_UNAVAILABLE)
             , _callback(nullptr)
@@ -1006,6 +1086,14 @@ namespace WPASupplicant {
                     }
                     else {
                         Submit(&_statusRequest);
+
+                        // Load the BSS table the supplicant already has, from here on it is
+                        // maintained through the BSS events.
+                        _adminLock.Lock();
+                        if (_detailRequest.Set(0, ~0, false) == true) {
+                            Submit(&_detailRequest);
+                        }
+                        _adminLock.Unlock();
                     }
 
                     Revoke(&exchange);
@@ -1077,6 +1165,13 @@ namespace WPASupplicant {
         {
             return (_error);
         }
+        inline DetailTiming LastDetails(const bool refresh) const
+        {
+            _adminLock.Lock();
+            const DetailTiming result(_detailRequest.Timing(refresh));
+            _adminLock.Unlock();
+            return (result);
+        }
         inline uint32_t Scan()
         {
 
@@ -1795,6 +1890,61 @@ namespace WPASupplicant {
 
             return (result);
         }
+        uint32_t SetKeys(const string& SSID, const Config::Settings& settings)
+        {
+            uint32_t result = Core::ERROR_UNKNOWN_KEY;
+
+            _adminLock.Lock();
+
+            EnabledContainer::iterator index(_enabled.find(SSID));
+
+            if (index != _enabled.end()) {
+                const string prefix(string(_TXT("SET_NETWORK ")) + Core::NumberType<uint32_t>(index->second.Id()).Text() + ' ');
+
+                _adminLock.Unlock();
+
+                result = Core::ERROR_NONE;
+
+                // Submit all settings at once, they are pipelined to the supplicant instead
+                // of waiting for the response of each individual SET_NETWORK.
+                std::list<CustomRequest> exchanges;
+                Config::Settings::const_iterator setting(settings.begin());
+
+                while (setting != settings.end()) {
+                    exchanges.emplace_back(prefix + setting->first + ' ' + setting->second);
+                    Submit(&(exchanges.back()));
+                    setting++;
+                }
+
+                const uint64_t deadline(Core::Time::Now().Add(MaxConnectionTime).Ticks());
+                std::list<CustomRequest>::iterator exchange(exchanges.begin());
+                setting = settings.begin();
+
+                while (exchange != exchanges.end()) {
+                    const uint64_t now(Core::Time::Now().Ticks());
+                    const uint32_t waitTime(now < deadline ? static_cast<uint32_t>((deadline - now) / Core::Time::TicksPerMillisecond) : 0);
+
+                    if ((exchange->Wait(waitTime) == false) || (exchange->Response() != _T("OK"))) {
+
+                        result = Core::ERROR_ASYNC_ABORTED;
+                    } else if ((setting->first == Config::PSK) || (setting->first == Config::PASSWORD)) {
+                        // These elements are not returned upon request, Save them ourselves.
+                        _adminLock.Lock();
+                        index->second.Secret(setting->second);
+                        _adminLock.Unlock();
+                    }
+
+                    Revoke(&(*exchange));
+
+                    exchange++;
+                    setting++;
+                }
+            } else {
+                _adminLock.Unlock();
+            }
+
+            return (result);
+        }
         inline uint32_t GetKey(const uint32_t id, const string& key, string& value) const
         {
 
@@ -1845,12 +1995,11 @@ namespace WPASupplicant {
         }
         // These methods (add/add/update) are assumed to be running in a locked context.
         // Completion of requests are running in a locked context, so oke to update maps/lists
-        void Add(const uint64_t& bssid, const NetworkInfo& entry);
         void Add(const string& ssid, const bool current, const uint64_t& bssid);
-        void Update(const string& status);
         void Update(const uint64_t& bssid, const string& ssid, const uint32_t id, uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys, const uint32_t throughput);
-        void Update(const uint64_t& bssid, const uint32_t id, const uint32_t throughput);
         void Update(const string& ssid, const uint32_t id, const bool succeeded);
+        void Refresh(const uint64_t& bssid, const uint32_t id, const int32_t signal, const uint32_t age);
+        void Details(const bool refresh, const uint32_t last, const bool aborted);
         void Reevaluate();
         virtual uint16_t SendData(uint8_t* dataFrame, const uint16_t maxSendSize);
         virtual uint16_t ReceiveData(uint8_t* dataFrame, const uint16_t receivedSize);
@@ -1862,14 +2011,18 @@ namespace WPASupplicant {
             std::list<Request*>::iterator index(std::find(_requests.begin(), _requests.end(), id));
 
             if (index != _requests.end()) {
-                bool retrigger(index == _requests.begin());
                 (*index)->Processing(false);
-                _requests.erase(index);
-                _adminLock.Unlock();
 
-                if (retrigger == true) {
-                    const_cast<Controller*>(this)->Trigger();
+                if ((*index)->Message().empty() == true) {
+                    // It has been send already, keep its slot so its response is not taken
+                    // for the response of the next request in line.
+                    (*index) = nullptr;
+                } else {
+                    _requests.erase(index);
                 }
+                _adminLock.Unlock();
+
+                const_cast<Controller*>(this)->Trigger();
             } else {
                 _adminLock.Unlock();
             }
@@ -1887,13 +2040,22 @@ namespace WPASupplicant {
             while (_requests.size() != 0) {
                 Request* current = _requests.front();
                 _requests.pop_front();
-                current->Processing(false);
-                current->Completed(EMPTY_STRING, true);
+                if (current != nullptr) {
+                    current->Processing(false);
+                    current->Completed(EMPTY_STRING, true);
+                }
             }
 
             _adminLock.Unlock();
         }
 
+        // Are there BSS entries in [first, last] of which the details are still to be requested.
+        inline bool IsPending(const uint32_t first, const uint32_t last) const
+        {
+            std::set<uint32_t>::const_iterator index(_pendingDetails.lower_bound(first));
+
+            return ((index != _pendingDetails.end()) && (*index <= last));
+        }
         void Submit(Request* data) const
         {
             _adminLock.Lock();
@@ -1903,20 +2065,22 @@ namespace WPASupplicant {
             data->Processing(true);
             _requests.push_back(data);
 
-            if (_requests.size() == 1) {
-                _adminLock.Unlock();
+            _adminLock.Unlock();
 
-                const_cast<Controller*>(this)->Trigger();
-            } else {
-                TRACE_L1("Submit does not trigger, there are %d messages pending [%s,%s]", static_cast<unsigned int>(_requests.size()), _requests.front()->Original().c_str(), _requests.front()->Message().c_str());
-                _adminLock.Unlock();
-            }
+            // Requests do not wait for the previous ones to complete, SendData decides if
+            // there is room in the pipeline to send it right away.
+            const_cast<Controller*>(this)->Trigger();
         }
 
     private:
         mutable Core::CriticalSection _adminLock;
         mutable std::list<Request*> _requests;
         NetworkInfoContainer _networks;
+        // Ids of the BSS entries (as reported by the supplicant) we still need the details for.
+        std::set<uint32_t> _pendingDetails;
+        uint32_t _generation;
+        bool _collecting;
+        bool _refresh;
         EnabledContainer _enabled;
         uint32_t _error;
         Core::IDispatchType<const events>* _callback;
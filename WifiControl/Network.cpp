@@ -96,24 +96,30 @@ namespace WPASupplicant {
         return (_comController->SetKey(_ssid, key, value) == Core::ERROR_NONE ? true : false);
     }
 
+    bool Config::SetKeys(const Settings& settings)
+    {
+
+        return (_comController->SetKeys(_ssid, settings) == Core::ERROR_NONE ? true : false);
+    }
+
     bool Config::Unsecure()
     {
-        return ((SetKey(KEY, _T("NONE"))) && (SetKey(SSIDKEY, ('\"' + _ssid + '\"'))));
+        return (SetKeys({ { KEY, _T("NONE") }, { SSIDKEY, ('\"' + _ssid + '\"') } }));
     }
 
     bool Config::Hash(const string& hash)
     {
-        return ((SetKey(KEY, _T("WPA-PSK"))) && (SetKey(PAIR, _T("CCMP TKIP"))) && (SetKey(PROTO, _T("WPA RSN"))) && (SetKey(AUTH, _T("OPEN"))) && (SetKey(SSIDKEY, ('\"' + _ssid + '\"'))) && (SetKey(PSK, hash)));
+        return (SetKeys({ { KEY, _T("WPA-PSK") }, { PAIR, _T("CCMP TKIP") }, { PROTO, _T("WPA RSN") }, { AUTH, _T("OPEN") }, { SSIDKEY, ('\"' + _ssid + '\"') }, { PSK, hash } }));
     }
 
     bool Config::PresharedKey(const string& presharedKey)
     {
-        return ((SetKey(KEY, _T("WPA-PSK"))) && (SetKey(PAIR, _T("CCMP TKIP"))) && (SetKey(PROTO, _T("WPA RSN"))) && (SetKey(AUTH, _T("OPEN"))) && (SetKey(SSIDKEY, ('\"' + _ssid + '\"'))) && (SetKey(PSK, ('\"' + presharedKey + '\"'))));
+        return (SetKeys({ { KEY, _T("WPA-PSK") }, { PAIR, _T("CCMP TKIP") }, { PROTO, _T("WPA RSN") }, { AUTH, _T("OPEN") }, { SSIDKEY, ('\"' + _ssid + '\"') }, { PSK, ('\"' + presharedKey + '\"') } }));
     }
 
     bool Config::Enterprise(const string& identity, const string& password)
     {
-        return ((SetKey(KEY, _T("IEEE8021X"))) && (SetKey(SSIDKEY, ('\"' + _ssid + '\"'))) && (SetKey(IDENTITY, identity)) && (SetKey(PASSWORD, password)) && (SetKey(_T("eap"), _T("PEAP"))) && (SetKey(_T("phase2"), _T("auth=MSCHAPV2"))));
+        return (SetKeys({ { KEY, _T("IEEE8021X") }, { SSIDKEY, ('\"' + _ssid + '\"') }, { IDENTITY, identity }, { PASSWORD, password }, { _T("eap"), _T("PEAP") }, { _T("phase2"), _T("auth=MSCHAPV2") } }));
     }
 
     bool Config::Hidden(const bool hidden)
@@ -223,6 +223,8 @@ namespace WPASupplicant {
         static constexpr const TCHAR* PROTO = _T("proto");
         static constexpr const TCHAR* AUTH = _T("auth_alg");
 
+        typedef std::list<std::pair<string, string>> Settings;
+
     public:
         class Iterator {
         private:
@@ -407,6 +409,7 @@ namespace WPASupplicant {
     protected:
         bool GetKey(const string& key, string& value) const;
         bool SetKey(const string& key, const string& value);
+        bool SetKeys(const Settings& settings);
 
         void CopyProperties(const Config& copy);
 
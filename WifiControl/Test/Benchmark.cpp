@@ -0,0 +1,229 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Controller.h"
+#include "FakeSupplicant.h"
+
+// Commands/sec of the Controller against a fake wpa_supplicant control socket, e.g.:
+//
+//    WifiControlBenchmark -latency 200 -threads 4 -duration 5
+//
+// - ping: one caller, every command waits for its reply;
+// - pipelined: concurrent callers, up to the pipeline depth in flight;
+// - configure: a network of ten fields, all SET_NETWORKs submitted in one batch;
+// - sequential: the same ten fields, one SET_NETWORK after the other.
+// The results are printed as JSON, the exit code is the number of failed commands.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+static const TCHAR Base[] = _T("/tmp/wificontrol-benchmark/");
+static const TCHAR Interface[] = _T("wlan0");
+
+struct Result {
+    uint32_t Operations;
+    uint32_t Failures;
+    uint64_t Elapsed; // uS
+};
+
+class Caller : public Core::Thread {
+public:
+    Caller() = delete;
+    Caller(const Caller&) = delete;
+    Caller& operator=(const Caller&) = delete;
+
+    Caller(WPASupplicant::Controller& controller, const uint64_t end)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("BenchmarkCaller"))
+        , _controller(controller)
+        , _end(end)
+        , _operations(0)
+        , _failures(0)
+    {
+    }
+    ~Caller() override
+    {
+        Stop();
+        Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+    }
+
+public:
+    uint32_t Operations() const
+    {
+        return (_operations);
+    }
+    uint32_t Failures() const
+    {
+        return (_failures);
+    }
+
+private:
+    uint32_t Worker() override
+    {
+        if (Core::Time::Now().Ticks() < _end) {
+            _failures += (_controller.Ping() != Core::ERROR_NONE ? 1 : 0);
+            _operations++;
+        } else {
+            Block();
+        }
+        return (0);
+    }
+
+private:
+    WPASupplicant::Controller& _controller;
+    const uint64_t _end;
+    uint32_t _operations;
+    uint32_t _failures;
+};
+
+Result Ping(WPASupplicant::Controller& controller, const uint16_t threads, const uint16_t duration)
+{
+    const uint64_t start = Core::Time::Now().Ticks();
+    const uint64_t end = start + (static_cast<uint64_t>(duration) * Core::Time::TicksPerMillisecond * 1000);
+    std::list<Caller> callers;
+    Result result = { 0, 0, 0 };
+
+    for (uint16_t index = 0; index < threads; index++) {
+        callers.emplace_back(controller, end);
+    }
+    for (Caller& caller : callers) {
+        caller.Run();
+    }
+    for (Caller& caller : callers) {
+        caller.Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+        result.Operations += caller.Operations();
+        result.Failures += caller.Failures();
+    }
+
+    result.Elapsed = Core::Time::Now().Ticks() - start;
+
+    return (result);
+}
+
+Result Configure(WPASupplicant::Controller& controller, const bool batched, const uint16_t duration)
+{
+    static const TCHAR SSID[] = _T("benchmark");
+
+    const uint64_t start = Core::Time::Now().Ticks();
+    const uint64_t end = start + (static_cast<uint64_t>(duration) * Core::Time::TicksPerMillisecond * 1000);
+    Result result = { 0, 0, 0 };
+
+    WPASupplicant::Config::Settings settings;
+    settings.emplace_back(_T("ssid"), _T("\"benchmark\""));
+    settings.emplace_back(_T("scan_ssid"), _T("1"));
+    settings.emplace_back(_T("key_mgmt"), _T("WPA-PSK"));
+    settings.emplace_back(_T("proto"), _T("RSN"));
+    settings.emplace_back(_T("pairwise"), _T("CCMP"));
+    settings.emplace_back(_T("group"), _T("CCMP"));
+    settings.emplace_back(_T("psk"), _T("\"benchmark-secret\""));
+    settings.emplace_back(_T("priority"), _T("1"));
+    settings.emplace_back(_T("ieee80211w"), _T("1"));
+    settings.emplace_back(_T("mode"), _T("0"));
+
+    if (controller.Create(SSID).IsValid() == false) {
+        result.Failures++;
+    } else {
+        while (Core::Time::Now().Ticks() < end) {
+            if (batched == true) {
+                result.Failures += (controller.SetKeys(SSID, settings) != Core::ERROR_NONE ? 1 : 0);
+            } else {
+                for (const std::pair<string, string>& setting : settings) {
+                    result.Failures += (controller.SetKey(SSID, setting.first, setting.second) != Core::ERROR_NONE ? 1 : 0);
+                }
+            }
+            result.Operations++;
+        }
+    }
+
+    result.Elapsed = Core::Time::Now().Ticks() - start;
+
+    return (result);
+}
+
+void Print(const TCHAR name[], const Result& result, const uint16_t commands, const bool last)
+{
+    const double seconds = (result.Elapsed / 1000000.0);
+
+    printf("  \"%s\": { \"operations\": %u, \"failures\": %u, \"persecond\": %.1f, \"commandspersecond\": %.1f, \"latency\": %.1f }%s\n",
+        name, result.Operations, result.Failures,
+        (seconds > 0 ? result.Operations / seconds : 0.0),
+        (seconds > 0 ? (result.Operations * commands) / seconds : 0.0),
+        (result.Operations > 0 ? static_cast<double>(result.Elapsed) / result.Operations : 0.0),
+        (last == true ? "" : ","));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t latency = 100; // uS
+    uint16_t threads = 4;
+    uint16_t duration = 3; // seconds, per scenario
+    uint32_t failures = 0;
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-latency") == 0) {
+            latency = static_cast<uint32_t>(atoi(argv[index + 1]));
+        } else if (strcmp(argv[index], "-threads") == 0) {
+            threads = static_cast<uint16_t>(std::max(1, atoi(argv[index + 1])));
+        } else if (strcmp(argv[index], "-duration") == 0) {
+            duration = static_cast<uint16_t>(std::max(1, atoi(argv[index + 1])));
+        }
+    }
+
+    Core::Directory(Base).CreatePath();
+
+    {
+        WPASupplicant::FakeSupplicant supplicant(Base, Interface, latency);
+
+        if (supplicant.IsValid() == false) {
+            fprintf(stderr, "Could not open the fake supplicant at %s%s\n", Base, Interface);
+            failures++;
+        } else {
+            Core::ProxyType<WPASupplicant::Controller> controller(WPASupplicant::Controller::Create(Base, Interface, 10));
+
+            if (controller->IsOperational() == false) {
+                fprintf(stderr, "The controller could not attach, error: %d\n", controller->Error());
+                failures++;
+            } else {
+                const Result ping(Ping(*controller, 1, duration));
+                const Result pipelined(Ping(*controller, threads, duration));
+                const Result batched(Configure(*controller, true, duration));
+                const Result sequential(Configure(*controller, false, duration));
+
+                printf("{\n  \"latency\": %u,\n  \"threads\": %u,\n", latency, threads);
+                Print(_T("ping"), ping, 1, false);
+                Print(_T("pipelined"), pipelined, 1, false);
+                Print(_T("configure"), batched, 10, false);
+                Print(_T("sequential"), sequential, 10, true);
+                printf("}\n");
+
+                failures += ping.Failures + pipelined.Failures + batched.Failures + sequential.Failures;
+            }
+
+            controller.Release();
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (static_cast<int>(failures));
+}
@@ -0,0 +1,419 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../Module.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace WPEFramework {
+namespace WPASupplicant {
+
+    // Stands in for wpa_supplicant on its control socket (<base>/<interface>), for the commands the
+    // Controller uses. Replies go out in order, each no earlier than the configured latency after
+    // its command came in, like a supplicant on a loaded box. A SCAN finds the loaded BSS table
+    // after the scan time, BSS RANGE replies are cut at the supplicant's reply size.
+    class FakeSupplicant : public Core::Thread {
+    private:
+        FakeSupplicant() = delete;
+        FakeSupplicant(const FakeSupplicant&) = delete;
+        FakeSupplicant& operator=(const FakeSupplicant&) = delete;
+
+        static constexpr uint16_t MaxCommandSize = 4096;
+        static constexpr uint16_t ReplySize = 4096;
+        static constexpr uint32_t DelimiterMask = 0x20000;
+
+        typedef std::list<std::pair<string, string>> Entry;
+
+        struct Reply {
+            uint64_t Due;
+            struct sockaddr_un Address;
+            socklen_t Length;
+            string Text;
+        };
+
+    public:
+        FakeSupplicant(const string& base, const string& interfaceName, const uint32_t latency /* uS */)
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("FakeSupplicant"))
+            , _lock()
+            , _path(Core::Directory::Normalize(base) + interfaceName)
+            , _latency(latency)
+            , _socket(-1)
+            , _replies()
+            , _attached()
+            , _bss()
+            , _known(0)
+            , _scanTime(0)
+            , _due(0)
+            , _networks(0)
+            , _commands(0)
+        {
+            struct sockaddr_un address;
+
+            ::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            ::strncpy(address.sun_path, _path.c_str(), sizeof(address.sun_path) - 1);
+
+            ::unlink(_path.c_str());
+
+            _socket = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+
+            if ((_socket != -1) && (::bind(_socket, reinterpret_cast<const struct sockaddr*>(&address), sizeof(address)) != 0)) {
+                ::close(_socket);
+                _socket = -1;
+            }
+
+            if (_socket != -1) {
+                Run();
+            }
+        }
+        ~FakeSupplicant() override
+        {
+            Stop();
+            Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+            if (_socket != -1) {
+                ::close(_socket);
+                ::unlink(_path.c_str());
+            }
+        }
+
+    public:
+        inline bool IsValid() const
+        {
+            return (_socket != -1);
+        }
+        inline uint32_t Commands() const
+        {
+            return (_commands);
+        }
+        // Send an unsolicited message to all attached controllers.
+        void Event(const string& message, const uint32_t delay = 0 /* uS */)
+        {
+            _lock.Lock();
+            const uint64_t due = Core::Time::Now().Ticks() + _latency + delay;
+            for (const Client& client : _attached) {
+                Queue(client.Address, client.Length, _T("<3>") + message, due);
+            }
+            _lock.Unlock();
+        }
+        // The BSS entries a SCAN finds, from a capture of BSS RANGE=ALL MASK=0x3fffff output or
+        // generated. The ids are taken as found, generated ones count from 0.
+        uint32_t Load(const string& capture)
+        {
+            Entry entry;
+            Core::TextSegmentIterator lines(Core::TextFragment(capture), false, '\n');
+
+            _lock.Lock();
+            _bss.clear();
+            _known = 0;
+            while (lines.Next() == true) {
+                const string line(lines.Current().Text());
+                const size_t equal = line.find('=');
+
+                if ((line == _T("====")) || (line == _T("####"))) {
+                    if (entry.empty() == false) {
+                        _bss.push_back(entry);
+                        entry.clear();
+                    }
+                } else if (equal != string::npos) {
+                    entry.emplace_back(line.substr(0, equal), line.substr(equal + 1));
+                }
+            }
+            if (entry.empty() == false) {
+                _bss.push_back(entry);
+            }
+            const uint32_t result = static_cast<uint32_t>(_bss.size());
+            _lock.Unlock();
+
+            return (result);
+        }
+        void Generate(const uint32_t count)
+        {
+            static const TCHAR* Flags[] = {
+                _T("[WPA2-PSK-CCMP][ESS]"), _T("[WPA2-PSK-CCMP][WPS][ESS]"), _T("[WPA-PSK-TKIP][WPA2-PSK-CCMP+TKIP][ESS]"),
+                _T("[WPA2-EAP-CCMP][ESS]"), _T("[ESS]"), _T("[WPA2-PSK+SAE-CCMP][ESS]")
+            };
+
+            _lock.Lock();
+            _bss.clear();
+            _known = 0;
+            for (uint32_t index = 0; index < count; index++) {
+                TCHAR bssid[18];
+                const uint32_t freq = ((index % 3) == 0 ? 5180 + ((index % 8) * 20) : 2412 + ((index % 11) * 5));
+                Entry entry;
+
+                ::snprintf(bssid, sizeof(bssid), _T("a0:b1:%02x:%02x:%02x:%02x"), (index >> 24) & 0xFF, (index >> 16) & 0xFF, (index >> 8) & 0xFF, index & 0xFF);
+
+                entry.emplace_back(_T("id"), Core::NumberType<uint32_t>(index).Text());
+                entry.emplace_back(_T("bssid"), bssid);
+                entry.emplace_back(_T("freq"), Core::NumberType<uint32_t>(freq).Text());
+                entry.emplace_back(_T("beacon_int"), _T("100"));
+                entry.emplace_back(_T("capabilities"), _T("0x1431"));
+                entry.emplace_back(_T("qual"), _T("0"));
+                entry.emplace_back(_T("noise"), _T("-89"));
+                entry.emplace_back(_T("level"), Core::NumberType<int32_t>(-35 - static_cast<int32_t>(index % 55)).Text());
+                entry.emplace_back(_T("tsf"), Core::NumberType<uint64_t>(0x0000123456789ULL + index).Text());
+                entry.emplace_back(_T("age"), Core::NumberType<uint32_t>(index % 20).Text());
+                entry.emplace_back(_T("ie"), _T("000d42656e63686d61726b2d303031010882848b960c121824030106"));
+                entry.emplace_back(_T("flags"), Flags[index % (sizeof(Flags) / sizeof(Flags[0]))]);
+                entry.emplace_back(_T("ssid"), _T("Benchmark-") + Core::NumberType<uint32_t>(index / 2).Text());
+                entry.emplace_back(_T("snr"), Core::NumberType<int32_t>(54 - static_cast<int32_t>(index % 55)).Text());
+                entry.emplace_back(_T("est_throughput"), Core::NumberType<uint32_t>((freq > 5000 ? 390000 : 65000)).Text());
+                _bss.push_back(entry);
+            }
+            _lock.Unlock();
+        }
+        // Forget the BSS table, as a BSS_FLUSH, the next SCAN finds all entries again.
+        void Flush()
+        {
+            _lock.Lock();
+            _known = 0;
+            _lock.Unlock();
+        }
+        void ScanTime(const uint32_t scanTime /* uS */)
+        {
+            _scanTime = scanTime;
+        }
+
+    protected:
+        // Handles a command, what it returns is the reply. Can be extended for more commands.
+        virtual string Handle(const string& command)
+        {
+            string result(_T("UNKNOWN COMMAND\n"));
+
+            if (command == _T("PING")) {
+                result = _T("PONG\n");
+            } else if ((command == _T("ATTACH")) || (command == _T("DETACH")) || (command == _T("SCAN")) ||
+                (command.compare(0, 4, _T("SET ")) == 0) || (command.compare(0, 6, _T("LEVEL ")) == 0) ||
+                (command.compare(0, 12, _T("SET_NETWORK ")) == 0) || (command.compare(0, 15, _T("ENABLE_NETWORK ")) == 0) ||
+                (command.compare(0, 16, _T("DISABLE_NETWORK ")) == 0) || (command.compare(0, 15, _T("SELECT_NETWORK ")) == 0) ||
+                (command.compare(0, 15, _T("REMOVE_NETWORK ")) == 0) || (command == _T("SAVE_CONFIG")) || (command == _T("DISCONNECT"))) {
+                result = _T("OK\n");
+            } else if (command == _T("ADD_NETWORK")) {
+                result = Core::NumberType<uint32_t>(_networks++).Text() + '\n';
+            } else if (command == _T("STATUS")) {
+                result = _T("wpa_state=DISCONNECTED\naddress=00:11:22:33:44:55\n");
+            } else if (command == _T("LIST_NETWORKS")) {
+                result = _T("network id / ssid / bssid / flags\n");
+            } else if (command.compare(0, 12, _T("GET_NETWORK ")) == 0) {
+                result = _T("FAIL\n");
+            } else if (command.compare(0, 10, _T("BSS RANGE=")) == 0) {
+                result = Range(command.substr(10));
+            } else if (command.compare(0, 4, _T("BSS ")) == 0) {
+                result.clear();
+            }
+
+            return (result);
+        }
+
+    private:
+        struct Client {
+            Client(const struct sockaddr_un& address, const socklen_t length)
+                : Address(address)
+                , Length(length)
+            {
+            }
+
+            struct sockaddr_un Address;
+            socklen_t Length;
+        };
+
+        // Runs with the lock taken. Whatever is due at the same time goes out in queueing order.
+        void Queue(const struct sockaddr_un& address, const socklen_t length, const string& text, const uint64_t due)
+        {
+            std::list<Reply>::iterator index(_replies.end());
+
+            while ((index != _replies.begin()) && (std::prev(index)->Due > due)) {
+                index--;
+            }
+
+            _replies.insert(index, { due, address, length, text });
+        }
+        // Runs with the lock taken. "<first>-[<last>] MASK=<mask>", as the supplicant: the entries
+        // that do not fit in the reply are dropped, the last entry of the table ends with ####.
+        string Range(const string& arguments)
+        {
+            string result;
+            const size_t dash = arguments.find('-');
+            const size_t mask = arguments.find(_T(" MASK=0x"));
+            const uint32_t first = static_cast<uint32_t>(::strtoul(arguments.c_str(), nullptr, 10));
+            const uint32_t last = (((dash == string::npos) || (dash + 1 == arguments.length()) || (arguments[dash + 1] == ' ')) ? static_cast<uint32_t>(~0) : static_cast<uint32_t>(::strtoul(arguments.c_str() + dash + 1, nullptr, 10)));
+            const uint32_t fields = (mask == string::npos ? 0x3fffff : static_cast<uint32_t>(::strtoul(arguments.c_str() + mask + 8, nullptr, 16)));
+
+            for (uint32_t index = 0; index < _known; index++) {
+                const Entry& entry(_bss[index]);
+                const uint32_t id = Id(entry);
+
+                if ((id >= first) && (id <= last)) {
+                    string text;
+
+                    for (const std::pair<string, string>& field : entry) {
+                        if ((Mask(field.first) & fields) != 0) {
+                            text += field.first + '=' + field.second + '\n';
+                        }
+                    }
+                    if ((fields & DelimiterMask) != 0) {
+                        text += ((index + 1) == _known ? _T("####\n") : _T("====\n"));
+                    }
+
+                    if ((result.length() + text.length()) >= ReplySize) {
+                        break;
+                    }
+                    result += text;
+                }
+            }
+
+            return (result);
+        }
+        // Runs with the lock taken, after the reply to the SCAN is queued. Report the results the
+        // way the supplicant does, the entries it did not know yet are added first.
+        void Scanned()
+        {
+            const uint64_t due = _due + _scanTime;
+
+            for (const Client& client : _attached) {
+                Queue(client.Address, client.Length, _T("<3>CTRL-EVENT-SCAN-STARTED "), due);
+
+                for (uint32_t index = _known; index < _bss.size(); index++) {
+                    const Entry& entry(_bss[index]);
+                    Queue(client.Address, client.Length, _T("<3>CTRL-EVENT-BSS-ADDED ") + Core::NumberType<uint32_t>(Id(entry)).Text() + ' ' + Value(entry, _T("bssid")), due);
+                }
+
+                Queue(client.Address, client.Length, _T("<3>CTRL-EVENT-SCAN-RESULTS "), due);
+            }
+
+            _known = static_cast<uint32_t>(_bss.size());
+        }
+        static string Value(const Entry& entry, const TCHAR name[])
+        {
+            Entry::const_iterator index(entry.begin());
+
+            while ((index != entry.end()) && (index->first != name)) {
+                index++;
+            }
+
+            return (index != entry.end() ? index->second : string());
+        }
+        static uint32_t Id(const Entry& entry)
+        {
+            return (static_cast<uint32_t>(::strtoul(Value(entry, _T("id")).c_str(), nullptr, 10)));
+        }
+        static uint32_t Mask(const string& name)
+        {
+            // WPA_BSS_MASK_* of wpa_ctrl.h, in the order the supplicant reports the fields.
+            static const TCHAR* Fields[] = {
+                _T("id"), _T("bssid"), _T("freq"), _T("beacon_int"), _T("capabilities"), _T("qual"),
+                _T("noise"), _T("level"), _T("tsf"), _T("age"), _T("ie"), _T("flags"), _T("ssid"),
+                _T("wps_scan"), _T("p2p_scan"), _T("internetw"), _T("wifi_display"), _T("delim"),
+                _T("mesh_scan"), _T("snr"), _T("est_throughput")
+            };
+
+            uint32_t result = 0;
+
+            for (uint8_t index = 0; (result == 0) && (index < (sizeof(Fields) / sizeof(Fields[0]))); index++) {
+                if (name == Fields[index]) {
+                    result = (1 << index);
+                }
+            }
+
+            return (result);
+        }
+        uint32_t Worker() override
+        {
+            uint32_t waitTime = 100;
+
+            _lock.Lock();
+
+            // Send what is due, in order.
+            const uint64_t now = Core::Time::Now().Ticks();
+            while ((_replies.empty() == false) && (_replies.front().Due <= now)) {
+                const Reply& reply(_replies.front());
+                ::sendto(_socket, reply.Text.c_str(), reply.Text.length(), MSG_DONTWAIT, reinterpret_cast<const struct sockaddr*>(&reply.Address), reply.Length);
+                _replies.pop_front();
+            }
+            if (_replies.empty() == false) {
+                waitTime = static_cast<uint32_t>(((_replies.front().Due - now) + 999) / 1000);
+            }
+
+            _lock.Unlock();
+
+            struct pollfd descriptor = { _socket, POLLIN, 0 };
+
+            if ((::poll(&descriptor, 1, static_cast<int>(waitTime)) > 0) && ((descriptor.revents & POLLIN) != 0)) {
+                char buffer[MaxCommandSize];
+                struct sockaddr_un address;
+                socklen_t length = sizeof(address);
+
+                const ssize_t size = ::recvfrom(_socket, buffer, sizeof(buffer), 0, reinterpret_cast<struct sockaddr*>(&address), &length);
+
+                if (size >= 0) {
+                    const string command(buffer, static_cast<size_t>(size));
+
+                    _commands++;
+
+                    _lock.Lock();
+
+                    if (command == _T("ATTACH")) {
+                        _attached.emplace_back(address, length);
+                    } else if (command == _T("DETACH")) {
+                        std::list<Client>::iterator index(_attached.begin());
+                        while ((index != _attached.end()) && (::strcmp(index->Address.sun_path, address.sun_path) != 0)) {
+                            index++;
+                        }
+                        if (index != _attached.end()) {
+                            _attached.erase(index);
+                        }
+                    }
+
+                    // Replies keep the order of the commands.
+                    _due = std::max(Core::Time::Now().Ticks() + _latency, _due);
+                    Queue(address, length, Handle(command), _due);
+
+                    if (command == _T("SCAN")) {
+                        Scanned();
+                    }
+
+                    _lock.Unlock();
+                }
+            }
+
+            return (0);
+        }
+
+    private:
+        Core::CriticalSection _lock;
+        const string _path;
+        const uint64_t _latency;
+        int _socket;
+        std::list<Reply> _replies;
+        std::list<Client> _attached;
+        std::vector<Entry> _bss;
+        uint32_t _known;
+        uint32_t _scanTime;
+        uint64_t _due;
+        uint32_t _networks;
+        std::atomic<uint32_t> _commands;
+    };
+
+} // namespace WPASupplicant
+} // namespace WPEFramework
@@ -0,0 +1,226 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Controller.h"
+#include "FakeSupplicant.h"
+
+// Scan-to-result latency and BSS parse cost of the Controller, against a fake wpa_supplicant
+// that reports a captured BSS table, e.g. taken on a box in a crowded building with:
+//
+//    wpa_cli -i wlan0 bss range=all mask=0x3fffff > capture.txt
+//    WifiControlScanBenchmark -capture capture.txt -scantime 2000 -runs 10
+//
+// Without a capture, -bss <count> entries are generated. A cold scan is the first one of a
+// controller, which requests the details of every entry, a warm scan only refreshes the signal
+// levels. The results are printed as JSON, the exit code is the number of failed scans.
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+static const TCHAR Base[] = _T("/tmp/wificontrol-benchmark/");
+static const TCHAR Interface[] = _T("wlan0");
+static constexpr uint32_t ScanWaitTime = 30000; // mS
+
+class Timings {
+public:
+    Timings(const TCHAR name[])
+        : _name(name)
+        , _latency()
+        , _duration()
+        , _parsing()
+        , _entries(0)
+        , _failed(0)
+    {
+    }
+
+public:
+    void Add(const uint32_t latency, const WPASupplicant::Controller::DetailTiming& timing)
+    {
+        if (latency == static_cast<uint32_t>(~0)) {
+            _failed++;
+        } else {
+            _latency.push_back(latency);
+            _duration.push_back(timing.Duration);
+            _parsing.push_back(timing.Parsing);
+            _entries = timing.Entries;
+        }
+    }
+    uint32_t Failed() const
+    {
+        return (_failed);
+    }
+    void Print(const bool last) const
+    {
+        printf("  \"%s\": { \"runs\": %u, \"failed\": %u, \"entries\": %u, \"latency\": %s, \"details\": %s, \"parsing\": %s, \"parsingperentry\": %.2f }%s\n",
+            _name, static_cast<uint32_t>(_latency.size() + _failed), _failed, _entries,
+            Statistics(_latency).c_str(), Statistics(_duration).c_str(), Statistics(_parsing).c_str(),
+            (_entries > 0 ? Mean(_parsing) / _entries : 0.0),
+            (last == true ? "" : ","));
+    }
+
+private:
+    static double Mean(const std::vector<uint32_t>& samples)
+    {
+        uint64_t total = 0;
+        for (const uint32_t sample : samples) {
+            total += sample;
+        }
+        return (samples.empty() == true ? 0.0 : static_cast<double>(total) / samples.size());
+    }
+    // All in uS.
+    static string Statistics(const std::vector<uint32_t>& samples)
+    {
+        TCHAR buffer[96];
+
+        ::snprintf(buffer, sizeof(buffer), _T("{ \"min\": %u, \"mean\": %.1f, \"max\": %u }"),
+            (samples.empty() == true ? 0 : *std::min_element(samples.begin(), samples.end())),
+            Mean(samples),
+            (samples.empty() == true ? 0 : *std::max_element(samples.begin(), samples.end())));
+
+        return (string(buffer));
+    }
+
+private:
+    const TCHAR* _name;
+    std::vector<uint32_t> _latency;
+    std::vector<uint32_t> _duration;
+    std::vector<uint32_t> _parsing;
+    uint32_t _entries;
+    uint32_t _failed;
+};
+
+// Returns the uS from the SCAN till the Controller has all results in, ~0 if it did not finish.
+uint32_t Scan(WPASupplicant::Controller& controller)
+{
+    uint32_t result = static_cast<uint32_t>(~0);
+    const uint64_t start = Core::Time::Now().Ticks();
+
+    if (controller.Scan() == Core::ERROR_NONE) {
+        const uint64_t end = start + (ScanWaitTime * Core::Time::TicksPerMillisecond);
+        uint64_t now = Core::Time::Now().Ticks();
+
+        while ((controller.IsScanning() == true) && (now < end)) {
+            ::usleep(100);
+            now = Core::Time::Now().Ticks();
+        }
+        if (now < end) {
+            result = static_cast<uint32_t>(now - start);
+        }
+    }
+
+    return (result);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t latency = 100; // uS
+    uint32_t scanTime = 0; // mS
+    uint32_t entries = 60;
+    uint16_t runs = 10;
+    string capture;
+    uint32_t failures = 0;
+
+    for (int index = 1; (index + 1) < argc; index += 2) {
+        if (strcmp(argv[index], "-latency") == 0) {
+            latency = static_cast<uint32_t>(atoi(argv[index + 1]));
+        } else if (strcmp(argv[index], "-scantime") == 0) {
+            scanTime = static_cast<uint32_t>(atoi(argv[index + 1]));
+        } else if (strcmp(argv[index], "-bss") == 0) {
+            entries = static_cast<uint32_t>(atoi(argv[index + 1]));
+        } else if (strcmp(argv[index], "-runs") == 0) {
+            runs = static_cast<uint16_t>(std::max(1, atoi(argv[index + 1])));
+        } else if (strcmp(argv[index], "-capture") == 0) {
+            capture = argv[index + 1];
+        }
+    }
+
+    Core::Directory(Base).CreatePath();
+
+    {
+        WPASupplicant::FakeSupplicant supplicant(Base, Interface, latency);
+        Timings cold(_T("cold"));
+        Timings warm(_T("warm"));
+
+        supplicant.ScanTime(scanTime * Core::Time::TicksPerMillisecond);
+
+        if (capture.empty() == true) {
+            supplicant.Generate(entries);
+        } else {
+            Core::File file(capture);
+            string text;
+
+            if (file.Open(true) == true) {
+                uint8_t buffer[1024];
+                uint32_t size;
+
+                while ((size = file.Read(buffer, sizeof(buffer))) > 0) {
+                    text.append(reinterpret_cast<const char*>(buffer), size);
+                }
+            }
+
+            entries = supplicant.Load(text);
+
+            if (entries == 0) {
+                fprintf(stderr, "No BSS entries in %s\n", capture.c_str());
+                failures++;
+            }
+        }
+
+        if (supplicant.IsValid() == false) {
+            fprintf(stderr, "Could not open the fake supplicant at %s%s\n", Base, Interface);
+            failures++;
+        } else if (failures == 0) {
+            for (uint16_t run = 0; run < runs; run++) {
+                // Neither the supplicant nor a new controller know any BSS yet.
+                supplicant.Flush();
+
+                Core::ProxyType<WPASupplicant::Controller> controller(WPASupplicant::Controller::Create(Base, Interface, 10));
+
+                if (controller->IsOperational() == false) {
+                    fprintf(stderr, "The controller could not attach, error: %d\n", controller->Error());
+                    failures++;
+                } else {
+                    const uint32_t first = Scan(*controller);
+                    cold.Add(first, controller->LastDetails(false));
+
+                    const uint32_t second = Scan(*controller);
+                    warm.Add(second, controller->LastDetails(true));
+                }
+
+                controller.Release();
+            }
+
+            failures += cold.Failed() + warm.Failed();
+        }
+
+        printf("{\n  \"bss\": %u,\n  \"latency\": %u,\n  \"scantime\": %u,\n", entries, latency, scanTime);
+        cold.Print(false);
+        warm.Print(true);
+        printf("}\n");
+    }
+
+    Core::Singleton::Dispose();
+
+    return (static_cast<int>(failures));
+}
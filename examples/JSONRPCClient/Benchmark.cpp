@@ -0,0 +1,609 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MODULE_NAME JSONRPC_Benchmark
+
+#include <core/core.h>
+#include <websocket/websocket.h>
+#include <interfaces/IPerformance.h>
+#include <securityagent/securityagent.h>
+
+#include "../JSONRPCPlugin/Data.h"
+
+// Non interactive counterpart of the performance menu of the JSONRPCClient. It loads the
+// IPerformance interface of the JSONRPCPlugin over COM-RPC, JSON-RPC or MessagePack from a
+// configurable number of threads, for a fixed time per payload size, and reports throughput and
+// latency percentiles as JSON on stdout so runs can be compared between framework versions, e.g.:
+//
+//    JSONRPCBenchmark -protocol jsonrpc -method exchange -sizes 16,1024,8192 -threads 4 -duration 10
+
+using namespace WPEFramework;
+
+namespace Benchmark {
+
+enum protocol {
+    COMRPC,
+    JSONRPC,
+    MESSAGEPACK
+};
+
+enum method {
+    SEND,
+    RECEIVE,
+    EXCHANGE
+};
+
+}
+
+namespace WPEFramework {
+
+ENUM_CONVERSION_BEGIN(Benchmark::protocol)
+
+    { Benchmark::COMRPC, _TXT("comrpc") },
+    { Benchmark::JSONRPC, _TXT("jsonrpc") },
+    { Benchmark::MESSAGEPACK, _TXT("messagepack") },
+
+ENUM_CONVERSION_END(Benchmark::protocol)
+
+ENUM_CONVERSION_BEGIN(Benchmark::method)
+
+    { Benchmark::SEND, _TXT("send") },
+    { Benchmark::RECEIVE, _TXT("receive") },
+    { Benchmark::EXCHANGE, _TXT("exchange") },
+
+ENUM_CONVERSION_END(Benchmark::method)
+
+}
+
+namespace Benchmark {
+
+static constexpr uint16_t MaxPayload = 1024 * 32;
+static constexpr uint32_t InvokeTimeout = 10000;
+static const uint8_t SwapPattern[] = { 0x00, 0x55, 0xAA, 0xFF };
+
+struct Options {
+    Options()
+        : Remote(_T("127.0.0.1:8899"))
+        , Access()
+        , Protocol(COMRPC)
+        , Method(EXCHANGE)
+        , Sizes({ 0, 16, 128, 256, 512, 1024, 2048, MaxPayload })
+        , Threads(1)
+        , Duration(5)
+    {
+    }
+
+    string Remote;
+    string Access;
+    protocol Protocol;
+    method Method;
+    std::vector<uint16_t> Sizes;
+    uint16_t Threads;
+    uint16_t Duration; // seconds, per payload size
+};
+
+static void ShowHelp()
+{
+    printf("JSONRPCBenchmark [options]\n"
+           "\t-remote <host:port>   COM-RPC channel of the server [127.0.0.1:8899]\n"
+           "\t-access <host:port>   JSON-RPC server, sets THUNDER_ACCESS [127.0.0.1:80]\n"
+           "\t-protocol <name>      comrpc, jsonrpc or messagepack [comrpc]\n"
+           "\t-method <name>        send, receive or exchange [exchange]\n"
+           "\t-sizes <n,n,...>      payload sizes in bytes, at most 32768 [0,16,128,256,512,1024,2048,32768]\n"
+           "\t-threads <n>          concurrent callers [1]\n"
+           "\t-duration <seconds>   time to run per payload size [5]\n");
+}
+
+static bool ParseSizes(const char text[], std::vector<uint16_t>& sizes)
+{
+    bool result = true;
+
+    sizes.clear();
+
+    while ((result == true) && (*text != '\0')) {
+        char* end;
+        const unsigned long size = ::strtoul(text, &end, 10);
+
+        if ((end == text) || (size > MaxPayload)) {
+            result = false;
+        } else {
+            sizes.push_back(static_cast<uint16_t>(size));
+            text = (*end == ',' ? end + 1 : end);
+        }
+    }
+
+    return ((result == true) && (sizes.empty() == false));
+}
+
+static bool ParseOptions(int argc, char** argv, Options& options)
+{
+    bool valid = true;
+    int index = 1;
+
+    while ((index < argc) && (valid == true)) {
+        const char* value = ((index + 1) < argc ? argv[index + 1] : nullptr);
+
+        if (strcmp(argv[index], "-h") == 0) {
+            valid = false;
+        } else if (value == nullptr) {
+            valid = false;
+        } else if (strcmp(argv[index], "-remote") == 0) {
+            options.Remote = value;
+        } else if (strcmp(argv[index], "-access") == 0) {
+            options.Access = value;
+        } else if (strcmp(argv[index], "-protocol") == 0) {
+            Core::EnumerateType<protocol> type(value, false);
+            valid = type.IsSet();
+            options.Protocol = type.Value();
+        } else if (strcmp(argv[index], "-method") == 0) {
+            Core::EnumerateType<method> type(value, false);
+            valid = type.IsSet();
+            options.Method = type.Value();
+        } else if (strcmp(argv[index], "-sizes") == 0) {
+            valid = ParseSizes(value, options.Sizes);
+        } else if (strcmp(argv[index], "-threads") == 0) {
+            options.Threads = static_cast<uint16_t>(std::max(1, atoi(value)));
+        } else if (strcmp(argv[index], "-duration") == 0) {
+            options.Duration = static_cast<uint16_t>(std::max(1, atoi(value)));
+        } else {
+            valid = false;
+        }
+        index += 2;
+    }
+
+    return (valid);
+}
+
+// A secured Thunder only accepts JSON-RPC with a token, the SecurityAgent hands it out. Without a
+// SecurityAgent there is no token and the links go without.
+static string Token()
+{
+    string result;
+    int length;
+    uint8_t payload[] = "http://localhost";
+    uint8_t buffer[8 * 1024];
+
+    ::memcpy(buffer, payload, sizeof(payload));
+
+    if ((length = ::GetToken(sizeof(buffer), sizeof(payload), buffer)) > 0) {
+        result = string(reinterpret_cast<const char*>(buffer), length);
+    } else {
+        fprintf(stderr, "Could not load a token, error: %d, continuing without\n", length);
+    }
+
+    return (result);
+}
+
+// A channel is used by one load thread only.
+struct IChannel {
+    virtual ~IChannel() {}
+    virtual uint32_t Call(const method type, const uint16_t size, uint8_t buffer[]) = 0;
+};
+
+class COMRPCChannel : public IChannel {
+public:
+    COMRPCChannel() = delete;
+    COMRPCChannel(const COMRPCChannel&) = delete;
+    COMRPCChannel& operator=(const COMRPCChannel&) = delete;
+
+    COMRPCChannel(Exchange::IPerformance* performance)
+        : _performance(performance)
+    {
+        _performance->AddRef();
+    }
+    ~COMRPCChannel() override
+    {
+        _performance->Release();
+    }
+
+public:
+    uint32_t Call(const method type, const uint16_t size, uint8_t buffer[]) override
+    {
+        uint32_t result;
+        uint16_t length = size;
+
+        switch (type) {
+        case SEND:
+            result = _performance->Send(size, buffer);
+            break;
+        case RECEIVE:
+            result = _performance->Receive(length, buffer);
+            break;
+        default:
+            result = _performance->Exchange(length, buffer, MaxPayload);
+            break;
+        }
+
+        return (result);
+    }
+
+private:
+    Exchange::IPerformance* _performance;
+};
+
+template <typename INTERFACE>
+class JSONRPCChannel : public IChannel {
+public:
+    JSONRPCChannel() = delete;
+    JSONRPCChannel(const JSONRPCChannel<INTERFACE>&) = delete;
+    JSONRPCChannel<INTERFACE>& operator=(const JSONRPCChannel<INTERFACE>&) = delete;
+
+    JSONRPCChannel(const string& localCallsign, const string& token)
+        : _remoteObject(_T("JSONRPCPlugin.2"), localCallsign.c_str(), false, (token.empty() == true ? string() : _T("token=") + token))
+    {
+    }
+    ~JSONRPCChannel() override
+    {
+    }
+
+public:
+    uint32_t Call(const method type, const uint16_t size, uint8_t buffer[]) override
+    {
+        uint32_t result;
+
+        switch (type) {
+        case SEND: {
+            Data::JSONDataBuffer message;
+            Core::JSON::DecUInt32 response;
+            Encode(size, buffer, message);
+            result = _remoteObject.template Invoke<Data::JSONDataBuffer, Core::JSON::DecUInt32>(InvokeTimeout, _T("send"), message, response);
+            break;
+        }
+        case RECEIVE: {
+            Core::JSON::DecUInt16 maxSize = size;
+            Data::JSONDataBuffer response;
+            result = _remoteObject.template Invoke<Core::JSON::DecUInt16, Data::JSONDataBuffer>(InvokeTimeout, _T("receive"), maxSize, response);
+            Decode(response, buffer);
+            break;
+        }
+        default: {
+            Data::JSONDataBuffer message;
+            Data::JSONDataBuffer response;
+            Encode(size, buffer, message);
+            result = _remoteObject.template Invoke<Data::JSONDataBuffer, Data::JSONDataBuffer>(InvokeTimeout, _T("exchange"), message, response);
+            Decode(response, buffer);
+            break;
+        }
+        }
+
+        return (result);
+    }
+
+private:
+    static void Encode(const uint16_t size, const uint8_t buffer[], Data::JSONDataBuffer& message)
+    {
+        string encoded;
+        Core::ToString(buffer, size, false, encoded);
+        message.Data = encoded;
+        message.Length = size;
+        message.Duration = static_cast<uint32_t>(encoded.size() + 1);
+    }
+    static void Decode(const Data::JSONDataBuffer& message, uint8_t buffer[])
+    {
+        // Decoding is part of what a real client pays for a call, so it is part of the measurement.
+        uint16_t length = std::min(static_cast<uint16_t>(((message.Data.Value().length() * 6) + 7) / 8), MaxPayload);
+        Core::FromString(message.Data.Value(), buffer, length);
+    }
+
+private:
+    JSONRPC::LinkType<INTERFACE> _remoteObject;
+};
+
+// Calls as fast as it can till the end time and keeps the latency (uS) of every call.
+class Load : public Core::Thread {
+public:
+    Load() = delete;
+    Load(const Load&) = delete;
+    Load& operator=(const Load&) = delete;
+
+    Load(IChannel* channel, const method type)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("BenchmarkLoad"))
+        , _channel(channel)
+        , _method(type)
+        , _size(0)
+        , _end(0)
+        , _errors(0)
+        , _buffer(MaxPayload)
+        , _latencies()
+    {
+        for (uint32_t index = 0; index < _buffer.size(); index++) {
+            _buffer[index] = SwapPattern[index % sizeof(SwapPattern)];
+        }
+    }
+    ~Load() override
+    {
+        Stop();
+        Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+        delete _channel;
+    }
+
+public:
+    void Start(const uint16_t size, const uint64_t end)
+    {
+        _size = size;
+        _end = end;
+        _errors = 0;
+        _latencies.clear();
+        Run();
+    }
+    void Completed()
+    {
+        Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+    }
+    inline uint32_t Errors() const
+    {
+        return (_errors);
+    }
+    inline const std::vector<uint32_t>& Latencies() const
+    {
+        return (_latencies);
+    }
+
+private:
+    uint32_t Worker() override
+    {
+        uint64_t now = Core::Time::Now().Ticks();
+
+        while ((IsRunning() == true) && (now < _end)) {
+            const uint64_t start = now;
+
+            if (_channel->Call(_method, _size, _buffer.data()) != Core::ERROR_NONE) {
+                _errors++;
+            }
+
+            now = Core::Time::Now().Ticks();
+            _latencies.push_back(static_cast<uint32_t>(now - start));
+        }
+
+        Block();
+
+        return (Core::infinite);
+    }
+
+private:
+    IChannel* _channel;
+    const method _method;
+    uint16_t _size;
+    uint64_t _end;
+    uint32_t _errors;
+    std::vector<uint8_t> _buffer;
+    std::vector<uint32_t> _latencies;
+};
+
+class Result : public Core::JSON::Container {
+private:
+    Result& operator=(const Result&) = delete;
+
+public:
+    Result()
+        : Core::JSON::Container()
+    {
+        Init();
+    }
+    Result(const Result& copy)
+        : Core::JSON::Container()
+        , Size(copy.Size)
+        , Calls(copy.Calls)
+        , Errors(copy.Errors)
+        , Throughput(copy.Throughput)
+        , Average(copy.Average)
+        , P50(copy.P50)
+        , P99(copy.P99)
+        , P999(copy.P999)
+        , Maximum(copy.Maximum)
+    {
+        Init();
+    }
+    ~Result()
+    {
+    }
+
+private:
+    void Init()
+    {
+        Add(_T("size"), &Size);
+        Add(_T("calls"), &Calls);
+        Add(_T("errors"), &Errors);
+        Add(_T("throughput"), &Throughput);
+        Add(_T("average"), &Average);
+        Add(_T("p50"), &P50);
+        Add(_T("p99"), &P99);
+        Add(_T("p999"), &P999);
+        Add(_T("maximum"), &Maximum);
+    }
+
+public:
+    Core::JSON::DecUInt16 Size; // bytes
+    Core::JSON::DecUInt32 Calls;
+    Core::JSON::DecUInt32 Errors;
+    Core::JSON::DecUInt32 Throughput; // calls per second
+    Core::JSON::DecUInt32 Average; // uS
+    Core::JSON::DecUInt32 P50; // uS
+    Core::JSON::DecUInt32 P99; // uS
+    Core::JSON::DecUInt32 P999; // uS
+    Core::JSON::DecUInt32 Maximum; // uS
+};
+
+class Report : public Core::JSON::Container {
+private:
+    Report(const Report&) = delete;
+    Report& operator=(const Report&) = delete;
+
+public:
+    Report()
+        : Core::JSON::Container()
+        , Protocol()
+        , Method()
+        , Threads()
+        , Duration()
+        , Results()
+    {
+        Add(_T("protocol"), &Protocol);
+        Add(_T("method"), &Method);
+        Add(_T("threads"), &Threads);
+        Add(_T("duration"), &Duration);
+        Add(_T("results"), &Results);
+    }
+    ~Report()
+    {
+    }
+
+public:
+    Core::JSON::EnumType<protocol> Protocol;
+    Core::JSON::EnumType<method> Method;
+    Core::JSON::DecUInt16 Threads;
+    Core::JSON::DecUInt16 Duration; // seconds, per size
+    Core::JSON::ArrayType<Result> Results;
+};
+
+static uint32_t Percentile(const std::vector<uint32_t>& sorted, const uint32_t perMille)
+{
+    return (sorted.empty() == true ? 0 : sorted[std::min(sorted.size() - 1, (sorted.size() * perMille) / 1000)]);
+}
+
+static void Run(const Options& options, std::vector<Load*>& loads, Report& report)
+{
+    for (const uint16_t size : options.Sizes) {
+        const uint64_t end = Core::Time::Now().Add(options.Duration * 1000).Ticks();
+        std::vector<uint32_t> latencies;
+        uint32_t errors = 0;
+
+        for (Load* load : loads) {
+            load->Start(size, end);
+        }
+        for (Load* load : loads) {
+            load->Completed();
+            latencies.insert(latencies.end(), load->Latencies().begin(), load->Latencies().end());
+            errors += load->Errors();
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+
+        uint64_t total = 0;
+        for (const uint32_t latency : latencies) {
+            total += latency;
+        }
+
+        Result& result(report.Results.Add());
+        result.Size = size;
+        result.Calls = static_cast<uint32_t>(latencies.size());
+        result.Errors = errors;
+        result.Throughput = static_cast<uint32_t>(latencies.size() / options.Duration);
+        result.Average = static_cast<uint32_t>(latencies.empty() == true ? 0 : total / latencies.size());
+        result.P50 = Percentile(latencies, 500);
+        result.P99 = Percentile(latencies, 990);
+        result.P999 = Percentile(latencies, 999);
+        result.Maximum = (latencies.empty() == true ? 0 : latencies.back());
+
+        fprintf(stderr, "size %d: %d calls, %d errors\n", size, result.Calls.Value(), errors);
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    using namespace Benchmark;
+
+    int exitCode = 0;
+
+    {
+        Options options;
+
+        if (ParseOptions(argc, argv, options) == false) {
+            ShowHelp();
+            exitCode = 1;
+        } else {
+            Report report;
+            std::vector<Load*> loads;
+            Exchange::IPerformance* performance = nullptr;
+
+            Core::ProxyType<RPC::InvokeServerType<1, 0, 4>> engine(Core::ProxyType<RPC::InvokeServerType<1, 0, 4>>::Create());
+            Core::ProxyType<RPC::CommunicatorClient> client(
+                Core::ProxyType<RPC::CommunicatorClient>::Create(
+                    Core::NodeId(options.Remote.c_str()),
+                    Core::ProxyType<Core::IIPCServer>(engine)));
+            engine->Announcements(client->Announcement());
+
+            if (options.Access.empty() == false) {
+                Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), options.Access);
+            } else {
+                string access;
+                if (Core::SystemInfo::GetEnvironment(_T("THUNDER_ACCESS"), access) == false) {
+                    Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T("127.0.0.1:80")));
+                }
+            }
+
+            if (options.Protocol == COMRPC) {
+                if (client->Open(2000) != Core::ERROR_NONE) {
+                    fprintf(stderr, "Failed to open up a COMRPC link with %s\n", options.Remote.c_str());
+                } else if ((performance = client->Aquire<Exchange::IPerformance>(2000, _T("JSONRPCPlugin"), ~0)) == nullptr) {
+                    fprintf(stderr, "The JSONRPCPlugin did not return a performance interface\n");
+                }
+            }
+
+            if ((options.Protocol != COMRPC) || (performance != nullptr)) {
+                const string token(options.Protocol != COMRPC ? Token() : string());
+
+                for (uint16_t index = 0; index < options.Threads; index++) {
+                    IChannel* channel;
+                    const string callsign(_T("client.benchmark.") + Core::NumberType<uint16_t>(index).Text());
+
+                    if (options.Protocol == COMRPC) {
+                        channel = new COMRPCChannel(performance);
+                    } else if (options.Protocol == JSONRPC) {
+                        channel = new JSONRPCChannel<Core::JSON::IElement>(callsign, token);
+                    } else {
+                        channel = new JSONRPCChannel<Core::JSON::IMessagePack>(callsign, token);
+                    }
+
+                    loads.push_back(new Load(channel, options.Method));
+                }
+
+                report.Protocol = options.Protocol;
+                report.Method = options.Method;
+                report.Threads = options.Threads;
+                report.Duration = options.Duration;
+
+                Run(options, loads, report);
+
+                string text;
+                report.ToString(text);
+                printf("%s\n", text.c_str());
+
+                for (Load* load : loads) {
+                    delete load;
+                }
+            } else {
+                exitCode = 2;
+            }
+
+            if (performance != nullptr) {
+                performance->Release();
+            }
+
+            client->Close(Core::infinite);
+            client.Release();
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (exitCode);
+}
@@ -22,6 +22,9 @@
 #include "../Module.h"
 #include "TestMetadata.h"
 
+#include <atomic>
+#include <time.h>
+
 namespace WPEFramework {
 
 class TestBase : public Exchange::ITestController::ITest {
@@ -69,10 +72,92 @@ public:
         return _description;
     }
 
+    // Runs the test and adds what the execution cost to its result. Tests of different categories
+    // can run at the same time, the peak resident set is only reset when no other test is running,
+    // so it includes whatever ran alongside.
+    string Execute(const string& params) final
+    {
+        string result;
+        TestCore::TestResult jsonResult;
+
+        if (Running().fetch_add(1) == 0) {
+            ResetPeakResident();
+        }
+
+        const uint64_t cpu = ThreadTime();
+        const uint64_t start = Core::Time::Now().Ticks();
+
+        result = Run(params);
+
+        const uint64_t duration = Core::Time::Now().Ticks() - start;
+        const uint64_t used = ThreadTime() - cpu;
+        const uint64_t peak = PeakResident();
+
+        Running().fetch_sub(1);
+
+        if (jsonResult.FromString(result) == true) {
+            jsonResult.Duration = duration;
+            jsonResult.Cpu = used;
+            jsonResult.PeakRss = peak;
+
+            result.clear();
+            jsonResult.ToString(result);
+        }
+
+        return result;
+    }
+
     BEGIN_INTERFACE_MAP(TestBase)
     INTERFACE_ENTRY(Exchange::ITestController::ITest)
     END_INTERFACE_MAP
 
+protected:
+    // The actual test, returns a TestCore::TestResult in JSON.
+    virtual string Run(const string& params) = 0;
+
+private:
+    // Tests executing right now, in this process.
+    static std::atomic<uint32_t>& Running()
+    {
+        static std::atomic<uint32_t> running(0);
+        return (running);
+    }
+    static uint64_t ThreadTime()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return ((static_cast<uint64_t>(now.tv_sec) * 1000000) + (now.tv_nsec / 1000));
+    }
+    static void ResetPeakResident()
+    {
+        FILE* file = fopen("/proc/self/clear_refs", "w");
+
+        if (file != nullptr) {
+            fputs("5", file);
+            fclose(file);
+        }
+    }
+    static uint64_t PeakResident()
+    {
+        uint64_t result = 0;
+        FILE* file = fopen("/proc/self/status", "r");
+
+        if (file != nullptr) {
+            char line[128];
+            unsigned long long value;
+
+            while (fgets(line, sizeof(line), file) != nullptr) {
+                if (sscanf(line, "VmHWM: %llu kB", &value) == 1) {
+                    result = static_cast<uint64_t>(value) * 1024;
+                    break;
+                }
+            }
+            fclose(file);
+        }
+
+        return (result);
+    }
+
 private:
     string _description;
 };
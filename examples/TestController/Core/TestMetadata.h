@@ -88,10 +88,16 @@ namespace TestCore {
             , Steps()
             , OverallStatus()
             , Name()
+            , Duration()
+            , Cpu()
+            , PeakRss()
         {
             Add(_T("test"), &Name);
             Add(_T("status"), &OverallStatus);
             Add(_T("steps"), &Steps);
+            Add(_T("duration"), &Duration);
+            Add(_T("cpu"), &Cpu);
+            Add(_T("peakrss"), &PeakRss);
         }
 
         TestResult(const TestResult& copy)
@@ -99,10 +105,16 @@ namespace TestCore {
             this->Name = copy.Name;
             this->OverallStatus = copy.OverallStatus;
             this->Steps = copy.Steps;
+            this->Duration = copy.Duration;
+            this->Cpu = copy.Cpu;
+            this->PeakRss = copy.PeakRss;
 
             Add(_T("test"), &Name);
             Add(_T("status"), &OverallStatus);
             Add(_T("steps"), &Steps);
+            Add(_T("duration"), &Duration);
+            Add(_T("cpu"), &Cpu);
+            Add(_T("peakrss"), &PeakRss);
         }
 
         TestResult& operator=(const TestResult& rhs)
@@ -110,6 +122,9 @@ namespace TestCore {
             this->Name = rhs.Name;
             this->OverallStatus = rhs.OverallStatus;
             this->Steps = rhs.Steps;
+            this->Duration = rhs.Duration;
+            this->Cpu = rhs.Cpu;
+            this->PeakRss = rhs.PeakRss;
 
             return *this;
         }
@@ -120,6 +135,10 @@ namespace TestCore {
         Core::JSON::ArrayType<TestStep> Steps;
         Core::JSON::String OverallStatus;
         Core::JSON::String Name;
+        // Filled in by TestBase for every execution.
+        Core::JSON::DecUInt64 Duration; // uS, wall clock
+        Core::JSON::DecUInt64 Cpu; // uS, user and system time of the thread executing the test
+        Core::JSON::DecUInt64 PeakRss; // bytes, peak resident set of the process running the test
     };
 } // namespace TestCore
 } // namespace WPEFramework
@@ -43,8 +43,8 @@ public:
     }
 
 public:
-    // ICommand methods
-    string Execute(const string& params) final
+    // TestBase methods
+    string Run(const string& params) final
     {
         TestCore::TestResult jsonResult;
         string result;
@@ -59,6 +59,7 @@ public:
         return result;
     }
 
+    // ICommand methods
     string Name() const final
     {
         return _name;
@@ -44,8 +44,8 @@ public:
     }
 
 public:
-    // ICommand methods
-    string Execute(const string& params) final
+    // TestBase methods
+    string Run(const string& params) final
     {
         TestCore::TestResult jsonResult;
         string result;
@@ -60,6 +60,7 @@ public:
         return result;
     }
 
+    // ICommand methods
     string Name() const final
     {
         return _name;
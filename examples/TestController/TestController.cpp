@@ -19,6 +19,8 @@
  
 #include "TestController.h"
 
+#include <cmath>
+
 namespace WPEFramework {
 namespace TestController {
 
@@ -62,6 +64,24 @@ namespace TestController {
 namespace Plugin {
     SERVICE_REGISTRATION(TestController, 1, 0);
 
+    static string Escape(const string& text)
+    {
+        string result;
+
+        for (const TCHAR character : text) {
+            switch (character) {
+            case '&': result += _T("&amp;"); break;
+            case '<': result += _T("&lt;"); break;
+            case '>': result += _T("&gt;"); break;
+            case '"': result += _T("&quot;"); break;
+            case '\'': result += _T("&apos;"); break;
+            default: result += character; break;
+            }
+        }
+
+        return (result);
+    }
+
     /* virtual */ const string TestController::Initialize(PluginHost::IShell* service)
     {
         /*Assume that everything is OK*/
@@ -75,6 +95,12 @@ namespace Plugin {
 
         _service = service;
         _skipURL = static_cast<uint8_t>(_service->WebPrefix().length());
+
+        config.FromString(_service->ConfigLine());
+        _workers = std::max(config.Workers.Value(), static_cast<uint8_t>(1));
+        _repeat = std::max(config.Repeat.Value(), static_cast<uint16_t>(1));
+        _report = (config.Report.Value().empty() == true ? EMPTY_STRING : _service->VolatilePath() + config.Report.Value());
+
         _service->Register(&_notification);
         _testControllerImp = _service->Root<Exchange::ITestController>(_connection, ImplWaitTime, _T("TestControllerImp"));
 
@@ -228,86 +254,279 @@ namespace Plugin {
 
     string /*JSON*/ TestController::RunAll(const string& body, const string& categoryName)
     {
-        string result = EMPTY_STRING;
-        OverallTestResults jsonResults;
+        Session session(body, _repeat);
 
         if (categoryName == EMPTY_STRING) {
             Exchange::ITestController::ICategory::IIterator* categories = _testControllerImp->Categories();
 
             if (categories != nullptr) {
                 while (categories->Next()) {
-                    TestPreparation(categories->Category(), categories->Category()->Name());
-
-                    auto tests = categories->Category()->Tests();
-                    while (tests->Next()) {
-                        result = tests->Test()->Execute(body);
-
-                        TestCore::TestResult ret;
-                        if (ret.FromString(result)) {
-                            jsonResults.Results.Add(ret);
-                        }
-                    }
+                    session.Add(categories->Category());
                 }
+                categories->Release();
             }
         } else {
             Exchange::ITestController::ICategory* category = _testControllerImp->Category(categoryName);
 
             if (category != nullptr) {
-                TestPreparation(category, categoryName);
+                session.Add(category);
+            }
+        }
+
+        return (Execute(session));
+    }
+
+    string /*JSON*/ TestController::RunTest(const string& body, const string& categoryName, const string& testName)
+    {
+        Session session(body, _repeat);
+
+        Exchange::ITestController::ICategory* category = _testControllerImp->Category(categoryName);
 
-                auto tests = category->Tests();
-                while (tests->Next()) {
-                    result = tests->Test()->Execute(body);
+        if ((category != nullptr) && (category->Test(testName) != nullptr)) {
+            session.Add(category, testName);
+        }
 
-                    TestCore::TestResult ret;
-                    if (ret.FromString(result)) {
-                        jsonResults.Results.Add(ret);
+        return (Execute(session));
+    }
+
+    string /*JSON*/ TestController::Execute(Session& session)
+    {
+        string response = EMPTY_STRING;
+        OverallTestResults jsonResults;
+
+        _adminLock.Lock();
+
+        const uint8_t workers = static_cast<uint8_t>(std::min(static_cast<uint32_t>(_workers), std::max(session.Categories(), 1u)));
+        const Core::Time started(Core::Time::Now());
+
+        // The requesting thread is one of the workers, it is usually a thread of the worker pool itself.
+        // A runner the pool did not get to before all categories were taken is revoked, one that is
+        // still running its last category is waited for.
+        std::list<Core::ProxyType<Runner>> runners;
+        while (runners.size() < static_cast<size_t>(workers - 1)) {
+            runners.push_back(Core::ProxyType<Runner>::Create(session));
+            Core::IWorkerPool::Instance().Submit(Core::ProxyType<Core::IDispatch>(runners.back()));
+        }
+        while (session.Process() == true) {
+        }
+        for (const Core::ProxyType<Runner>& runner : runners) {
+            Core::IWorkerPool::Instance().Revoke(Core::ProxyType<Core::IDispatch>(runner), Core::infinite);
+        }
+        runners.clear();
+
+        session.Collect(jsonResults.Results);
+        jsonResults.Started = started.ToISO8601();
+        jsonResults.Duration = Core::Time::Now().Ticks() - started.Ticks();
+        jsonResults.Workers = workers;
+        jsonResults.Repeat = _repeat;
+
+        TRACE(Trace::Information, (_T("Ran %d tests in %llu ms, %d workers, %d repeats"), jsonResults.Results.Length(), static_cast<unsigned long long>(jsonResults.Duration.Value() / 1000), workers, _repeat));
+
+        if ((_report.empty() == false) && (jsonResults.Results.Length() != 0)) {
+            Report(jsonResults);
+        }
+
+        _adminLock.Unlock();
+
+        jsonResults.ToString(response);
+        return response;
+    }
+
+    bool TestController::Session::Process()
+    {
+        bool result = false;
+        uint32_t index = 0;
+
+        _adminLock.Lock();
+        if (_next < _entries.size()) {
+            index = _next++;
+            result = true;
+        }
+        _adminLock.Unlock();
+
+        if (result == true) {
+            Entry& entry(_entries[index]);
+            const string category(entry.Category->Name());
+
+            entry.Category->Setup();
+
+            if (entry.Test.empty() == false) {
+                Exchange::ITestController::ITest* test = entry.Category->Test(entry.Test);
+
+                if (test != nullptr) {
+                    Execute(test, category, entry.Results);
+                }
+            } else {
+                Exchange::ITestController::ITest::IIterator* tests = entry.Category->Tests();
+
+                if (tests != nullptr) {
+                    while (tests->Next()) {
+                        Execute(tests->Test(), category, entry.Results);
                     }
+                    tests->Release();
                 }
             }
+
+            entry.Category->TearDown();
         }
 
-        result = EMPTY_STRING;
-        jsonResults.ToString(result);
-        return result;
+        return (result);
     }
 
-    string /*JSON*/ TestController::RunTest(const string& body, const string& categoryName, const string& testName)
+    void TestController::Session::Execute(Exchange::ITestController::ITest* test, const string& category, std::list<TestSummary>& results) const
     {
-        string response = EMPTY_STRING;
-        OverallTestResults jsonResults;
+        TestSummary summary;
+        std::vector<uint64_t> durations;
+        std::vector<uint64_t> cpu;
+        uint16_t failures = 0;
 
-        Exchange::ITestController::ICategory* category = _testControllerImp->Category(categoryName);
+        for (uint16_t run = 0; run < _repeat; run++) {
+            TestCore::TestResult result;
 
-        if (category != nullptr) {
-            TestPreparation(category, categoryName);
+            if (result.FromString(test->Execute(_body)) == true) {
+                const bool succeeded = (result.OverallStatus.Value() == _T("Success"));
 
-            auto test = category->Test(testName);
+                durations.push_back(result.Duration.Value());
+                cpu.push_back(result.Cpu.Value());
 
-            if (test != nullptr) {
-                response = test->Execute(body);
-                TestCore::TestResult ret;
-                if (ret.FromString(response)) {
-                    jsonResults.Results.Add(ret);
+                if (result.PeakRss.Value() > summary.PeakRss.Value()) {
+                    summary.PeakRss = result.PeakRss.Value();
+                }
+                if ((failures == 0) && ((succeeded == false) || (run == (_repeat - 1)))) {
+                    summary.Name = result.Name.Value();
+                    summary.OverallStatus = result.OverallStatus.Value();
+                    summary.Steps = result.Steps;
+                }
+                if (succeeded == false) {
+                    failures++;
                 }
             }
         }
 
-        response = EMPTY_STRING;
-        jsonResults.ToString(response);
-        return response;
+        if (durations.empty() == false) {
+            if (summary.Name.IsSet() == false) {
+                // The last execution did not produce a result, report the test as it was seen last.
+                summary.Name = test->Name();
+                summary.OverallStatus = _T("Success");
+            }
+            summary.Category = category;
+            summary.Runs = static_cast<uint16_t>(durations.size());
+            summary.Failures = failures;
+            summary.Duration.Set(durations);
+            summary.Cpu.Set(cpu);
+
+            results.push_back(summary);
+        }
+    }
+
+    void TestController::Session::Collect(Core::JSON::ArrayType<TestSummary>& results) const
+    {
+        for (const Entry& entry : _entries) {
+            for (const TestSummary& summary : entry.Results) {
+                results.Add(summary);
+            }
+        }
+    }
+
+    void TestController::Measurement::Set(const std::vector<uint64_t>& samples)
+    {
+        ASSERT(samples.empty() == false);
+
+        uint64_t total = 0;
+        double squares = 0;
+
+        for (const uint64_t sample : samples) {
+            total += sample;
+        }
+
+        const double mean = static_cast<double>(total) / samples.size();
+
+        for (const uint64_t sample : samples) {
+            squares += (sample - mean) * (sample - mean);
+        }
+
+        Mean = static_cast<uint64_t>(mean + 0.5);
+        Min = *std::min_element(samples.begin(), samples.end());
+        Max = *std::max_element(samples.begin(), samples.end());
+        Deviation = (samples.size() > 1 ? static_cast<uint64_t>(sqrt(squares / (samples.size() - 1)) + 0.5) : 0);
     }
 
-    void TestController::TestPreparation(Exchange::ITestController::ICategory* const category, const string& categoryName)
+    // The last run as JSON, and as JUnit XML for the tools that track test results over builds.
+    void TestController::Report(const OverallTestResults& results) const
     {
-        if (_prevCategory != categoryName) {
-            if (_prevCategory != EMPTY_STRING) {
-                Exchange::ITestController::ICategory* prevCategory = _testControllerImp->Category(_prevCategory);
-                if (prevCategory != nullptr)
-                    prevCategory->TearDown();
+        Core::Directory(Core::File::PathName(_report).c_str()).CreatePath();
+
+        Core::File json(_report + _T(".json"));
+
+        if (json.Create() == true) {
+            results.IElement::ToFile(json);
+            json.Close();
+        } else {
+            TRACE(Trace::Error, (_T("Could not write the test report %s"), json.Name().c_str()));
+        }
+
+        std::map<string, std::pair<uint32_t, uint32_t>> suites; // tests, failures per category
+        std::ostringstream xml;
+        Core::JSON::ArrayType<TestSummary>::ConstIterator index(results.Results.Elements());
+
+        while (index.Next() == true) {
+            std::pair<uint32_t, uint32_t>& suite(suites[index.Current().Category.Value()]);
+            suite.first++;
+            suite.second += (index.Current().Failures.Value() != 0 ? 1 : 0);
+        }
+
+        xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+        xml << "<testsuites timestamp=\"" << Escape(results.Started.Value()) << "\" time=\"" << (results.Duration.Value() / 1000000.0) << "\">\n";
+
+        for (const std::pair<const string, std::pair<uint32_t, uint32_t>>& suite : suites) {
+            xml << "  <testsuite name=\"" << Escape(suite.first) << "\" tests=\"" << suite.second.first << "\" failures=\"" << suite.second.second << "\">\n";
+
+            // JUnit only has properties per suite, the measurements of a test go in there under its name.
+            xml << "    <properties>\n";
+            index.Reset();
+            while (index.Next() == true) {
+                const TestSummary& test(index.Current());
+
+                if (test.Category.Value() == suite.first) {
+                    const string name(Escape(test.Name.Value()));
+
+                    xml << "      <property name=\"" << name << ".runs\" value=\"" << test.Runs.Value() << "\"/>\n";
+                    xml << "      <property name=\"" << name << ".duration.min\" value=\"" << test.Duration.Min.Value() << "\"/>\n";
+                    xml << "      <property name=\"" << name << ".duration.max\" value=\"" << test.Duration.Max.Value() << "\"/>\n";
+                    xml << "      <property name=\"" << name << ".duration.deviation\" value=\"" << test.Duration.Deviation.Value() << "\"/>\n";
+                    xml << "      <property name=\"" << name << ".cpu.mean\" value=\"" << test.Cpu.Mean.Value() << "\"/>\n";
+                    xml << "      <property name=\"" << name << ".cpu.deviation\" value=\"" << test.Cpu.Deviation.Value() << "\"/>\n";
+                    xml << "      <property name=\"" << name << ".peakrss\" value=\"" << test.PeakRss.Value() << "\"/>\n";
+                }
+            }
+            xml << "    </properties>\n";
+
+            index.Reset();
+            while (index.Next() == true) {
+                const TestSummary& test(index.Current());
+
+                if (test.Category.Value() == suite.first) {
+                    xml << "    <testcase classname=\"" << Escape(suite.first) << "\" name=\"" << Escape(test.Name.Value()) << "\" time=\"" << (test.Duration.Mean.Value() / 1000000.0) << "\">\n";
+                    if (test.Failures.Value() != 0) {
+                        xml << "      <failure message=\"" << Escape(test.OverallStatus.Value()) << "\">" << test.Failures.Value() << " of " << test.Runs.Value() << " runs failed</failure>\n";
+                    }
+                    xml << "    </testcase>\n";
+                }
             }
-            category->Setup();
-            _prevCategory = categoryName;
+
+            xml << "  </testsuite>\n";
+        }
+
+        xml << "</testsuites>\n";
+
+        const string content(xml.str());
+        Core::File junit(_report + _T(".xml"));
+
+        if (junit.Create() == true) {
+            junit.Write(reinterpret_cast<const uint8_t*>(content.c_str()), static_cast<uint32_t>(content.length()));
+            junit.Close();
+        } else {
+            TRACE(Trace::Error, (_T("Could not write the test report %s"), junit.Name().c_str()));
         }
     }
 
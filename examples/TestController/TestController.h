@@ -61,6 +61,141 @@ namespace Plugin {
             TestController& _parent;
         };
 
+        class Config : public Core::JSON::Container {
+        public:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+            Config()
+                : Core::JSON::Container()
+                , Workers(1)
+                , Repeat(1)
+                , Report(_T("report"))
+            {
+                Add(_T("workers"), &Workers);
+                Add(_T("repeat"), &Repeat);
+                Add(_T("report"), &Report);
+            }
+            ~Config() override
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt8 Workers; // categories running at the same time
+            Core::JSON::DecUInt16 Repeat; // executions of every test in a run
+            Core::JSON::String Report; // reports of the last run, <report>.json and <report>.xml, in the volatile path
+        };
+
+        // The spread of a measurement over the executions of a test, all in uS.
+        class Measurement : public Core::JSON::Container {
+        public:
+            Measurement& operator=(const Measurement&) = delete;
+
+            Measurement()
+                : Core::JSON::Container()
+                , Mean()
+                , Min()
+                , Max()
+                , Deviation()
+            {
+                Init();
+            }
+            Measurement(const Measurement& copy)
+                : Core::JSON::Container()
+                , Mean(copy.Mean)
+                , Min(copy.Min)
+                , Max(copy.Max)
+                , Deviation(copy.Deviation)
+            {
+                Init();
+            }
+            ~Measurement() override
+            {
+            }
+
+        public:
+            void Set(const std::vector<uint64_t>& samples);
+
+        private:
+            void Init()
+            {
+                Add(_T("mean"), &Mean);
+                Add(_T("min"), &Min);
+                Add(_T("max"), &Max);
+                Add(_T("deviation"), &Deviation);
+            }
+
+        public:
+            Core::JSON::DecUInt64 Mean;
+            Core::JSON::DecUInt64 Min;
+            Core::JSON::DecUInt64 Max;
+            Core::JSON::DecUInt64 Deviation; // standard deviation
+        };
+
+        // A test over all its executions in a run. The status is that of the first execution that did
+        // not succeed, the steps those of that execution, or of the last one if all succeeded.
+        class TestSummary : public Core::JSON::Container {
+        public:
+            TestSummary& operator=(const TestSummary&) = delete;
+
+            TestSummary()
+                : Core::JSON::Container()
+                , Category()
+                , Name()
+                , OverallStatus()
+                , Runs(0)
+                , Failures(0)
+                , Duration()
+                , Cpu()
+                , PeakRss(0)
+                , Steps()
+            {
+                Init();
+            }
+            TestSummary(const TestSummary& copy)
+                : Core::JSON::Container()
+                , Category(copy.Category)
+                , Name(copy.Name)
+                , OverallStatus(copy.OverallStatus)
+                , Runs(copy.Runs)
+                , Failures(copy.Failures)
+                , Duration(copy.Duration)
+                , Cpu(copy.Cpu)
+                , PeakRss(copy.PeakRss)
+                , Steps(copy.Steps)
+            {
+                Init();
+            }
+            ~TestSummary() override
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("category"), &Category);
+                Add(_T("test"), &Name);
+                Add(_T("status"), &OverallStatus);
+                Add(_T("runs"), &Runs);
+                Add(_T("failures"), &Failures);
+                Add(_T("duration"), &Duration);
+                Add(_T("cpu"), &Cpu);
+                Add(_T("peakrss"), &PeakRss);
+                Add(_T("steps"), &Steps);
+            }
+
+        public:
+            Core::JSON::String Category;
+            Core::JSON::String Name;
+            Core::JSON::String OverallStatus;
+            Core::JSON::DecUInt16 Runs;
+            Core::JSON::DecUInt16 Failures;
+            Measurement Duration; // wall clock
+            Measurement Cpu; // thread executing the test
+            Core::JSON::DecUInt64 PeakRss; // bytes, highest of all executions
+            Core::JSON::ArrayType<TestCore::TestResult::TestStep> Steps;
+        };
+
         class MetadataTest : public Core::JSON::Container {
         public:
             MetadataTest(const MetadataTest&) = delete;
@@ -87,14 +222,112 @@ namespace Plugin {
             OverallTestResults()
                 : Core::JSON::Container()
                 , Results()
+                , Started()
+                , Duration(0)
+                , Workers(0)
+                , Repeat(0)
             {
                 Add(_T("testsResults"), &Results);
+                Add(_T("started"), &Started);
+                Add(_T("duration"), &Duration);
+                Add(_T("workers"), &Workers);
+                Add(_T("repeat"), &Repeat);
             }
 
             ~OverallTestResults() = default;
 
         public:
-            Core::JSON::ArrayType<TestCore::TestResult> Results;
+            Core::JSON::ArrayType<TestSummary> Results;
+            Core::JSON::String Started; // ISO8601
+            Core::JSON::DecUInt64 Duration; // uS, the whole run
+            Core::JSON::DecUInt8 Workers;
+            Core::JSON::DecUInt16 Repeat;
+        };
+
+        // The categories (or a single test) of one run. The runners take the categories one at a time,
+        // the tests of a category run in sequence, between its Setup and TearDown.
+        class Session {
+        private:
+            struct Entry {
+                Entry(Exchange::ITestController::ICategory* category, const string& test)
+                    : Category(category)
+                    , Test(test)
+                    , Results()
+                {
+                }
+
+                Exchange::ITestController::ICategory* Category;
+                string Test; // empty for all tests of the category
+                std::list<TestSummary> Results;
+            };
+
+        public:
+            Session() = delete;
+            Session(const Session&) = delete;
+            Session& operator=(const Session&) = delete;
+
+            Session(const string& body, const uint16_t repeat)
+                : _adminLock()
+                , _body(body)
+                , _repeat(repeat)
+                , _entries()
+                , _next(0)
+            {
+            }
+            ~Session()
+            {
+            }
+
+        public:
+            // Only before the runners are started.
+            void Add(Exchange::ITestController::ICategory* category, const string& test = EMPTY_STRING)
+            {
+                _entries.emplace_back(category, test);
+            }
+            uint32_t Categories() const
+            {
+                return (static_cast<uint32_t>(_entries.size()));
+            }
+            // Runs the next category, returns false if all were taken already.
+            bool Process();
+            // Only after all runners are done, the results in the order the categories were added.
+            void Collect(Core::JSON::ArrayType<TestSummary>& results) const;
+
+        private:
+            void Execute(Exchange::ITestController::ITest* test, const string& category, std::list<TestSummary>& results) const;
+
+        private:
+            Core::CriticalSection _adminLock;
+            const string _body;
+            const uint16_t _repeat;
+            std::vector<Entry> _entries;
+            uint32_t _next;
+        };
+
+        // Job on the worker pool, takes categories from the session till none are left.
+        class Runner : public Core::IDispatch {
+        public:
+            Runner() = delete;
+            Runner(const Runner&) = delete;
+            Runner& operator=(const Runner&) = delete;
+
+            Runner(Session& session)
+                : _session(session)
+            {
+            }
+            ~Runner() override
+            {
+            }
+
+        public:
+            void Dispatch() override
+            {
+                while (_session.Process() == true) {
+                }
+            }
+
+        private:
+            Session& _session;
         };
 
     public:
@@ -105,7 +338,10 @@ namespace Plugin {
             , _testControllerImp(nullptr)
             , _skipURL(0)
             , _connection(0)
-            , _prevCategory(EMPTY_STRING)
+            , _adminLock()
+            , _workers(1)
+            , _repeat(1)
+            , _report()
         {
             RegisterAll();
         }
@@ -143,7 +379,8 @@ namespace Plugin {
 
         void ProcessTermination(uint32_t pid);
 
-        void TestPreparation(Exchange::ITestController::ICategory* const category, const string& categoryName);
+        string /*JSON*/ Execute(Session& session);
+        void Report(const OverallTestResults& results) const;
         string /*JSON*/ HandleRequest(Web::Request::type type, const string& path, const uint8_t skipUrl, const string& body /*JSON*/);
         Core::JSON::ArrayType<Core::JSON::String> /*JSON*/ TestCategories(Exchange::ITestController::ICategory::IIterator* categories) const;
         Core::JSON::ArrayType<Core::JSON::String> /*JSON*/ Tests(Exchange::ITestController::ITest::IIterator* tests) const;
@@ -164,7 +401,10 @@ namespace Plugin {
         Exchange::ITestController* _testControllerImp;
         uint8_t _skipURL;
         uint32_t _connection;
-        string _prevCategory;
+        Core::CriticalSection _adminLock; // one run at a time
+        uint8_t _workers;
+        uint16_t _repeat;
+        string _report;
     };
 
 } // namespace Plugin
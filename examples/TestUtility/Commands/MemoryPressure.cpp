@@ -0,0 +1,90 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+ 
+#include "../CommandCore/TestCommandBase.h"
+#include "../CommandCore/TestCommandController.h"
+#include "MemoryPressureCore.h"
+
+namespace WPEFramework {
+
+ENUM_CONVERSION_BEGIN(MemoryPressureCore::pattern)
+
+    { MemoryPressureCore::FRAGMENT, _TXT("fragment") },
+    { MemoryPressureCore::LEAK, _TXT("leak") },
+    { MemoryPressureCore::TOUCH, _TXT("touch") },
+    { MemoryPressureCore::MMAP, _TXT("mmap") },
+    { MemoryPressureCore::SHARED, _TXT("shared") },
+
+ENUM_CONVERSION_END(MemoryPressureCore::pattern)
+
+class MemoryPressure : public TestCommandBase {
+public:
+    MemoryPressure(const MemoryPressure&) = delete;
+    MemoryPressure& operator=(const MemoryPressure&) = delete;
+
+public:
+    using Parameter = JsonData::TestUtility::InputInfo;
+
+    MemoryPressure()
+        : TestCommandBase(TestCommandBase::DescriptionBuilder("Starts an allocation workload in the background, until MemoryPressureStop"),
+              TestCommandBase::SignatureBuilder("memory", JsonData::TestUtility::TypeType::OBJECT, "workload state and RSS/PSS timeline in kB")
+                  .InputParameter("pattern", JsonData::TestUtility::TypeType::STRING, "fragment, leak, touch, mmap or shared (default: fragment)")
+                  .InputParameter("size", JsonData::TestUtility::TypeType::NUMBER, "memory in kB the workload grows to")
+                  .InputParameter("rate", JsonData::TestUtility::TypeType::NUMBER, "growth in kB/s (default: 1024)")
+                  .InputParameter("interval", JsonData::TestUtility::TypeType::NUMBER, "mS between steps and samples (default: 100)")
+                  .InputParameter("seed", JsonData::TestUtility::TypeType::NUMBER, "seed of the sizes and order (default: 1)"))
+        , _pressureCore(MemoryPressureCore::Instance())
+    {
+        TestCore::TestCommandController::Instance().Announce(this);
+    }
+
+    virtual ~MemoryPressure()
+    {
+        TestCore::TestCommandController::Instance().Revoke(this);
+    }
+
+public:
+    // ICommand methods
+    string Execute(const string& params) final
+    {
+        MemoryPressureCore::Parameters input;
+
+        input.FromString(params);
+
+        return _pressureCore.Start(input);
+    }
+
+    string Name() const final
+    {
+        return _name;
+    }
+
+private:
+    BEGIN_INTERFACE_MAP(MemoryPressure)
+    INTERFACE_ENTRY(Exchange::ITestUtility::ICommand)
+    END_INTERFACE_MAP
+
+private:
+    MemoryPressureCore& _pressureCore;
+    const string _name = _T("MemoryPressure");
+};
+
+static MemoryPressure* _singleton(Core::Service<MemoryPressure>::Create<MemoryPressure>());
+
+} // namespace WPEFramework
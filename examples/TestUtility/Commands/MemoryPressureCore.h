@@ -0,0 +1,578 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../Module.h"
+
+#include "../CommandCore/TraceCategories.h"
+
+#include <fcntl.h>
+#include <fstream>
+#include <malloc.h>
+#include <random>
+#include <sys/mman.h>
+
+namespace WPEFramework {
+
+// Runs an allocation workload on a thread of its own, until it is stopped, and samples the resident
+// (RSS) and proportional (PSS) set size of the process while doing so. The workload only depends on
+// its parameters and the seed, so a run can be repeated to reproduce a memory related issue.
+//   - fragment: a mix of small, medium and large blocks, freed at random once the size is reached
+//   - leak:     small blocks, never freed
+//   - touch:    one reservation of the size, its pages touched at the rate
+//   - mmap:     anonymous mappings
+//   - shared:   a shared memory file, growing
+class MemoryPressureCore {
+public:
+    MemoryPressureCore(const MemoryPressureCore&) = delete;
+    MemoryPressureCore& operator=(const MemoryPressureCore&) = delete;
+
+public:
+    enum pattern {
+        FRAGMENT,
+        LEAK,
+        TOUCH,
+        MMAP,
+        SHARED
+    };
+
+    static constexpr uint32_t DefaultRate = 1024; // kB/s
+    static constexpr uint16_t DefaultInterval = 100; // mS
+    static constexpr uint32_t DefaultSeed = 1;
+    static constexpr uint16_t MaxSamples = 512;
+
+    class Parameters : public Core::JSON::Container {
+    public:
+        Parameters(const Parameters&) = delete;
+        Parameters& operator=(const Parameters&) = delete;
+
+    public:
+        Parameters()
+            : Core::JSON::Container()
+            , Pattern(FRAGMENT)
+            , Size(0)
+            , Rate(DefaultRate)
+            , Interval(DefaultInterval)
+            , Seed(DefaultSeed)
+        {
+            Add(_T("pattern"), &Pattern);
+            Add(_T("size"), &Size);
+            Add(_T("rate"), &Rate);
+            Add(_T("interval"), &Interval);
+            Add(_T("seed"), &Seed);
+        }
+
+        ~Parameters() = default;
+
+    public:
+        Core::JSON::EnumType<pattern> Pattern;
+        Core::JSON::DecUInt32 Size; // kB
+        Core::JSON::DecUInt32 Rate; // kB/s
+        Core::JSON::DecUInt16 Interval; // mS
+        Core::JSON::DecUInt32 Seed;
+    };
+
+    class Report : public Core::JSON::Container {
+    public:
+        class Sample : public Core::JSON::Container {
+        public:
+            Sample& operator=(const Sample&) = delete;
+
+        public:
+            Sample()
+                : Core::JSON::Container()
+                , Time()
+                , Allocated()
+                , Rss()
+                , Pss()
+            {
+                Init();
+            }
+            Sample(const Sample& copy)
+                : Core::JSON::Container()
+                , Time(copy.Time)
+                , Allocated(copy.Allocated)
+                , Rss(copy.Rss)
+                , Pss(copy.Pss)
+            {
+                Init();
+            }
+
+            ~Sample() = default;
+
+        private:
+            void Init()
+            {
+                Add(_T("time"), &Time);
+                Add(_T("allocated"), &Allocated);
+                Add(_T("rss"), &Rss);
+                Add(_T("pss"), &Pss);
+            }
+
+        public:
+            Core::JSON::DecUInt32 Time; // mS since the start
+            Core::JSON::DecUInt32 Allocated; // kB
+            Core::JSON::DecUInt32 Rss; // kB
+            Core::JSON::DecUInt32 Pss; // kB
+        };
+
+    public:
+        Report(const Report&) = delete;
+        Report& operator=(const Report&) = delete;
+
+    public:
+        Report()
+            : Core::JSON::Container()
+            , Pattern()
+            , Running()
+            , Allocated()
+            , Samples()
+            , ErrorMsg()
+        {
+            Add(_T("pattern"), &Pattern);
+            Add(_T("running"), &Running);
+            Add(_T("allocated"), &Allocated);
+            Add(_T("samples"), &Samples);
+            Add(_T("errorMsg"), &ErrorMsg);
+        }
+
+        ~Report() = default;
+
+    public:
+        Core::JSON::EnumType<pattern> Pattern;
+        Core::JSON::Boolean Running;
+        Core::JSON::DecUInt32 Allocated; // kB
+        Core::JSON::ArrayType<Sample> Samples;
+        Core::JSON::String ErrorMsg;
+    };
+
+private:
+    struct Measurement {
+        uint32_t Time;
+        uint32_t Allocated;
+        uint32_t Rss;
+        uint32_t Pss;
+    };
+
+    struct Mapping {
+        uint8_t* Address;
+        size_t Length;
+    };
+
+    class Generator : public Core::Thread {
+    public:
+        Generator() = delete;
+        Generator(const Generator&) = delete;
+        Generator& operator=(const Generator&) = delete;
+
+        explicit Generator(MemoryPressureCore& parent)
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("MemoryPressure"))
+            , _parent(parent)
+        {
+        }
+        ~Generator() override
+        {
+            Stop();
+            Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+        }
+
+    private:
+        uint32_t Worker() override
+        {
+            return (_parent.Step());
+        }
+
+    private:
+        MemoryPressureCore& _parent;
+    };
+
+public:
+    MemoryPressureCore()
+        : _lock()
+        , _worker(*this)
+        , _running(false)
+        , _pattern(FRAGMENT)
+        , _size(0)
+        , _budget(0)
+        , _interval(DefaultInterval)
+        , _random()
+        , _start(0)
+        , _ticks(0)
+        , _stride(1)
+        , _allocated(0)
+        , _blocks()
+        , _mappings()
+        , _reserved()
+        , _shared(-1)
+        , _samples()
+    {
+    }
+
+    ~MemoryPressureCore()
+    {
+        Stop();
+    }
+
+    static MemoryPressureCore& Instance()
+    {
+        static MemoryPressureCore _singleton;
+        return (_singleton);
+    }
+
+public:
+    string Start(const Parameters& parameters)
+    {
+        string message;
+
+        _lock.Lock();
+
+        if (_running == true) {
+            message = _T("Memory pressure already running, stop it first");
+        } else if ((parameters.Size.Value() == 0) || (parameters.Rate.Value() == 0) || (parameters.Interval.Value() == 0)) {
+            message = _T("size, rate and interval must be greater than 0");
+        } else {
+            Release();
+
+            _pattern = parameters.Pattern.Value();
+            _size = static_cast<uint64_t>(parameters.Size.Value()) << 10;
+            _interval = parameters.Interval.Value();
+            // Whole pages per step, the mappings grow at page aligned offsets.
+            const uint64_t page = getpagesize();
+            _budget = std::max(page, ((((static_cast<uint64_t>(parameters.Rate.Value()) << 10) * _interval) / 1000) / page) * page);
+            _random.seed(parameters.Seed.Value());
+            _start = Core::Time::Now().Ticks();
+            _ticks = 0;
+            _stride = 1;
+            _samples.clear();
+
+            if (Prepare() == false) {
+                message = _T("Could not set up the memory for the pattern");
+                Release();
+            } else {
+                TRACE(TestCore::TestOutput, (_T("Memory pressure started, %u kB at %u kB/s"), parameters.Size.Value(), parameters.Rate.Value()));
+                _running = true;
+                _worker.Run();
+            }
+        }
+
+        _lock.Unlock();
+
+        return (Response(message));
+    }
+
+    string Stop()
+    {
+        _worker.Block();
+        _worker.Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+
+        _lock.Lock();
+
+        // Report what the workload looked like, before all is given back.
+        string response(Response(_running == true ? EMPTY_STRING : _T("Memory pressure is not running")));
+
+        _running = false;
+        Release();
+
+        _lock.Unlock();
+
+        return (response);
+    }
+
+    string Status()
+    {
+        _lock.Lock();
+        string response(Response(EMPTY_STRING));
+        _lock.Unlock();
+
+        return (response);
+    }
+
+private:
+    uint32_t Step()
+    {
+        _lock.Lock();
+
+        switch (_pattern) {
+        case FRAGMENT:
+            Fragment();
+            break;
+        case LEAK:
+            Leak();
+            break;
+        case TOUCH:
+            Touch();
+            break;
+        case MMAP:
+        case SHARED:
+            Map();
+            break;
+        }
+
+        if ((_ticks % _stride) == 0) {
+            Sample();
+        }
+        _ticks++;
+
+        _lock.Unlock();
+
+        return (_interval);
+    }
+
+    bool Prepare()
+    {
+        bool result = true;
+
+        if (_pattern == TOUCH) {
+            // Reserve it all at once, only the touched pages become resident.
+            void* address = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+            if (address == MAP_FAILED) {
+                result = false;
+            } else {
+                _reserved.Address = static_cast<uint8_t*>(address);
+                _reserved.Length = 0;
+            }
+        } else if (_pattern == SHARED) {
+            const string fileName(_T("/dev/shm/TestUtility.MemoryPressure.") + Core::NumberType<uint32_t>(Core::ProcessInfo().Id()).Text());
+
+            _shared = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+
+            if (_shared == -1) {
+                result = false;
+            } else {
+                // Nothing to clean up if we are killed, the pages live as long as they are mapped.
+                ::unlink(fileName.c_str());
+            }
+        }
+
+        return (result);
+    }
+
+    void Release()
+    {
+        for (const std::pair<void*, size_t>& block : _blocks) {
+            free(block.first);
+        }
+        _blocks.clear();
+
+#ifdef __GLIBC__
+        // Small blocks are not given back to the system by free, the next run starts from scratch.
+        malloc_trim(0);
+#endif
+
+        for (const Mapping& mapping : _mappings) {
+            ::munmap(mapping.Address, mapping.Length);
+        }
+        _mappings.clear();
+
+        if (_reserved.Address != nullptr) {
+            ::munmap(_reserved.Address, _size);
+            _reserved.Address = nullptr;
+            _reserved.Length = 0;
+        }
+
+        if (_shared != -1) {
+            ::close(_shared);
+            _shared = -1;
+        }
+
+        _allocated = 0;
+    }
+
+    void Fragment()
+    {
+        uint64_t budget = _budget;
+
+        while (budget > 0) {
+            // Mostly small blocks, some in between, now and then one large enough to be mapped on its own.
+            const uint32_t kind = _random() % 100;
+            const size_t size = (kind < 70 ? 16 + (_random() % 496) : (kind < 95 ? 1024 + (_random() % (63 * 1024)) : (128 * 1024) + (_random() % (896 * 1024))));
+            void* block = malloc(size);
+
+            if (block == nullptr) {
+                SYSLOG(Trace::Fatal, (_T("*** Failed allocation !!! ***")));
+                break;
+            }
+
+            ::memset(block, static_cast<int>(_random() & 0xFF), size);
+            _blocks.push_back(std::make_pair(block, size));
+            _allocated += size;
+            budget -= std::min(budget, static_cast<uint64_t>(size));
+        }
+
+        // Above the size, free blocks picked at random, leaving holes of all sizes behind.
+        while ((_allocated > _size) && (_blocks.empty() == false)) {
+            const size_t index = _random() % _blocks.size();
+
+            free(_blocks[index].first);
+            _allocated -= _blocks[index].second;
+
+            _blocks[index] = _blocks.back();
+            _blocks.pop_back();
+        }
+    }
+
+    void Leak()
+    {
+        uint64_t budget = std::min(_budget, (_allocated < _size ? _size - _allocated : 0));
+
+        while (budget > 0) {
+            const size_t size = 64 + (_random() % 960);
+            void* block = malloc(size);
+
+            if (block == nullptr) {
+                SYSLOG(Trace::Fatal, (_T("*** Failed allocation !!! ***")));
+                break;
+            }
+
+            ::memset(block, static_cast<int>(_random() & 0xFF), size);
+            _blocks.push_back(std::make_pair(block, size));
+            _allocated += size;
+            budget -= std::min(budget, static_cast<uint64_t>(size));
+        }
+    }
+
+    void Touch()
+    {
+        const size_t page = getpagesize();
+        const size_t end = static_cast<size_t>(std::min(_size, _reserved.Length + _budget));
+
+        for (size_t offset = _reserved.Length; offset < end; offset += page) {
+            _reserved.Address[offset] = static_cast<uint8_t>(_random() & 0xFF);
+        }
+
+        _allocated += (end - _reserved.Length);
+        _reserved.Length = end;
+    }
+
+    void Map()
+    {
+        const size_t length = static_cast<size_t>(std::min(_budget, (_allocated < _size ? _size - _allocated : 0)));
+
+        if (length > 0) {
+            void* address = MAP_FAILED;
+
+            if (_pattern == SHARED) {
+                if (::ftruncate(_shared, static_cast<off_t>(_allocated + length)) == 0) {
+                    address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, _shared, static_cast<off_t>(_allocated));
+                }
+            } else {
+                address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            }
+
+            if (address == MAP_FAILED) {
+                SYSLOG(Trace::Fatal, (_T("*** Failed mapping !!! ***")));
+            } else {
+                ::memset(address, static_cast<int>(_random() & 0xFF), length);
+                _mappings.push_back({ static_cast<uint8_t*>(address), length });
+                _allocated += length;
+            }
+        }
+    }
+
+    void Sample()
+    {
+        Measurement sample;
+
+        sample.Time = static_cast<uint32_t>((Core::Time::Now().Ticks() - _start) / 1000);
+        sample.Allocated = static_cast<uint32_t>(_allocated >> 10);
+        Footprint(sample.Rss, sample.Pss);
+
+        _samples.push_back(sample);
+
+        // Keep the whole run in the timeline, with fewer samples the longer it takes.
+        if (_samples.size() >= MaxSamples) {
+            for (uint16_t index = 1; index < (MaxSamples / 2); index++) {
+                _samples[index] = _samples[index * 2];
+            }
+            _samples.resize(MaxSamples / 2);
+            _stride *= 2;
+        }
+    }
+
+    // Both in kB, smaps_rollup if the kernel has it, otherwise all of smaps added up.
+    static void Footprint(uint32_t& rss, uint32_t& pss)
+    {
+        std::ifstream smaps(_T("/proc/self/smaps_rollup"));
+
+        if (smaps.is_open() == false) {
+            smaps.open(_T("/proc/self/smaps"));
+        }
+
+        string line;
+        rss = 0;
+        pss = 0;
+
+        while (std::getline(smaps, line)) {
+            if (line.compare(0, 4, _T("Rss:")) == 0) {
+                rss += static_cast<uint32_t>(strtoul(&(line.c_str()[4]), nullptr, 10));
+            } else if (line.compare(0, 4, _T("Pss:")) == 0) {
+                pss += static_cast<uint32_t>(strtoul(&(line.c_str()[4]), nullptr, 10));
+            }
+        }
+    }
+
+    string Response(const string& message) const
+    {
+        Report report;
+        string response;
+
+        report.Pattern = _pattern;
+        report.Running = _running;
+        report.Allocated = static_cast<uint32_t>(_allocated >> 10);
+
+        for (const Measurement& sample : _samples) {
+            Report::Sample& entry(report.Samples.Add());
+            entry.Time = sample.Time;
+            entry.Allocated = sample.Allocated;
+            entry.Rss = sample.Rss;
+            entry.Pss = sample.Pss;
+        }
+
+        if (message.empty() == false) {
+            report.ErrorMsg = message;
+        }
+
+        report.ToString(response);
+
+        return (response);
+    }
+
+private:
+    Core::CriticalSection _lock;
+    Generator _worker;
+    bool _running;
+    pattern _pattern;
+    uint64_t _size; // bytes
+    uint64_t _budget; // bytes per step
+    uint16_t _interval; // mS
+    std::mt19937 _random;
+    uint64_t _start;
+    uint32_t _ticks;
+    uint32_t _stride;
+    uint64_t _allocated; // bytes
+    std::vector<std::pair<void*, size_t>> _blocks;
+    std::vector<Mapping> _mappings;
+    Mapping _reserved;
+    int _shared;
+    std::vector<Measurement> _samples;
+};
+
+} // namespace WPEFramework
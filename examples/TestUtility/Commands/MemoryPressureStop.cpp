@@ -0,0 +1,71 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+ 
+#include "../CommandCore/TestCommandBase.h"
+#include "../CommandCore/TestCommandController.h"
+#include "MemoryPressureCore.h"
+
+namespace WPEFramework {
+
+class MemoryPressureStop : public TestCommandBase {
+public:
+    MemoryPressureStop(const MemoryPressureStop&) = delete;
+    MemoryPressureStop& operator=(const MemoryPressureStop&) = delete;
+
+public:
+    using Parameter = JsonData::TestUtility::InputInfo;
+
+    MemoryPressureStop()
+        : TestCommandBase(TestCommandBase::DescriptionBuilder("Stops the allocation workload and releases its memory"),
+              TestCommandBase::SignatureBuilder("memory", JsonData::TestUtility::TypeType::OBJECT, "workload state and RSS/PSS timeline in kB"))
+        , _pressureCore(MemoryPressureCore::Instance())
+    {
+        TestCore::TestCommandController::Instance().Announce(this);
+    }
+
+    virtual ~MemoryPressureStop()
+    {
+        TestCore::TestCommandController::Instance().Revoke(this);
+    }
+
+public:
+    // ICommand methods
+    string Execute(const string& params) final
+    {
+        return _pressureCore.Stop();
+    }
+
+    string Name() const final
+    {
+        return _name;
+    }
+
+private:
+    BEGIN_INTERFACE_MAP(MemoryPressureStop)
+    INTERFACE_ENTRY(Exchange::ITestUtility::ICommand)
+    END_INTERFACE_MAP
+
+private:
+    MemoryPressureCore& _pressureCore;
+    const string _name = _T("MemoryPressureStop");
+};
+
+static MemoryPressureStop* _singleton(Core::Service<MemoryPressureStop>::Create<MemoryPressureStop>());
+
+} // namespace WPEFramework